@@ -4,6 +4,8 @@
 #include "xmlrpc_params.h"
 #include "cros_node.h"
 #include "cros_message.h"
+#include "cros_message_codec.h"
+#include "cros_message_view.h"
 #include "cros_err_codes.h"
 
 #define CROS_INFINITE_TIMEOUT ~0UL
@@ -304,20 +306,131 @@ typedef CallbackResponse (*ServiceCallerApiCallback)(cRosMessage *request, cRosM
 typedef CallbackResponse (*ServiceProviderApiCallback)(cRosMessage *request, cRosMessage *response, void *context);
 typedef CallbackResponse (*SubscriberApiCallback)(cRosMessage *message,  void *context);
 typedef CallbackResponse (*PublisherApiCallback)(cRosMessage *message, void *context);
+typedef CallbackResponse (*SubscriberCodecApiCallback)(void *message,  void *context);
+typedef CallbackResponse (*PublisherCodecApiCallback)(void *message, void *context);
+typedef CallbackResponse (*ServiceProviderCodecApiCallback)(void *request, void *response, void *context);
+typedef CallbackResponse (*SubscriberViewApiCallback)(cRosMessageView *view,  void *context);
+typedef CallbackResponse (*SubscriberFlatApiCallback)(cRosFlatMessage *message,  void *context);
+typedef CallbackResponse (*PublisherFlatApiCallback)(cRosFlatMessage *message, void *context);
 
 // Master api: register/unregister methods
 cRosErrCodePack cRosApiRegisterServiceCaller(CrosNode *node, const char *service_name, const char *service_type, int loop_period, ServiceCallerApiCallback callback, NodeStatusCallback status_callback, void *context, int persistent, int tcp_nodelay, int *svcidx_ptr);
 void cRosApiReleaseServiceCaller(CrosNode *node, int svcidx);
+
+/*! \brief Change the calling period of a service caller. Unlike the loop_period argument of cRosApiRegisterServiceCaller(),
+ *         which is in milliseconds, the period is given in microseconds
+ *
+ *  \param node Pointer to the node
+ *  \param svcidx Index of the service caller
+ *  \param loop_period_us Calling period (in microseconds), or -1 to pause the periodic calling
+ *
+ *  \return Returns CROS_SUCCESS_ERR_PACK on success, or the error code pack if svcidx is not a registered service caller
+ */
+cRosErrCodePack cRosApiSetServiceCallerLoopPeriodUs(CrosNode *node, int svcidx, int64_t loop_period_us);
 cRosErrCodePack cRosApiRegisterServiceProvider(CrosNode *node, const char *service_name, const char *service_type, ServiceProviderApiCallback callback, NodeStatusCallback status_callback, void *context, int *svcidx_ptr);
+
+/*! \brief Register a service provider whose request and response are decoded and encoded by the generated code of the
+ *         service (see cRosGentoolsGenerateC(), which generates a codec for the request and another for the response).
+ *         The callback receives a pointer to the generated struct of the request and a pointer to the generated struct
+ *         of the response, which it must fill. The response keeps its field values from one call to the next.
+ *         The other parameters and the unregistration functions are the same as for cRosApiRegisterServiceProvider()
+ *
+ *  \return Returns CROS_SUCCESS_ERR_PACK on success, CROS_BAD_PARAM_ERR if callback is NULL, or the error code pack
+ *          otherwise
+ */
+cRosErrCodePack cRosApiRegisterServiceProviderCodec(CrosNode *node, const char *service_name, const char *service_type, const CrosMessageCodec *request_codec, const CrosMessageCodec *response_codec, ServiceProviderCodecApiCallback callback, NodeStatusCallback status_callback, void *context, int *svcidx_ptr);
 cRosErrCodePack cRosApiUnregisterServiceProvider(CrosNode *node, int svcidx);
 void cRosApiReleaseServiceProvider(CrosNode *node, int svcidx);
-cRosErrCodePack cRosApiRegisterSubscriber(CrosNode *node, const char *topic_name, const char *topic_type, SubscriberApiCallback callback, NodeStatusCallback status_callback, void *context, int tcp_nodelay, int *subidx_ptr);
+cRosErrCodePack cRosApiRegisterSubscriber(CrosNode *node, const char *topic_name, const char *topic_type, SubscriberApiCallback callback, NodeStatusCallback status_callback, void *context, int tcp_nodelay, int queue_size, int *subidx_ptr);
 cRosErrCodePack cRosApiUnregisterSubscriber(CrosNode *node, int subidx);
 void cRosApiReleaseSubscriber(CrosNode *node, int subidx);
-cRosErrCodePack cRosApiRegisterPublisher(CrosNode *node, const char *topic_name, const char *topic_type, int loop_period, PublisherApiCallback callback, NodeStatusCallback status_callback, void *context, int *pubidx_ptr);
+
+/*! \brief Enable or disable the zero-copy decoding of the messages received by a subscriber registered with
+ *         cRosApiRegisterSubscriber(). When it is enabled, the variable-length arrays of primitive values of the messages
+ *         (e.g., uint8[] image data or float32[] point clouds) point into the received packet instead of being copied
+ *         to the message (see cRosMessageDeserializeBorrow()). The message keeps the packet while it holds these
+ *         arrays, also in the subscriber queue and after cRosNodeReceiveTopicMsg(), and copies an array only when
+ *         elements are pushed back to it. The messages are then decoded only once they have been received completely
+ *         (see cRosApiSetSubscriberStreamMinSize()).
+ *
+ *  \param node Pointer to the node
+ *  \param subidx Index of the subscriber
+ *  \param enable 1 to enable the zero-copy decoding, 0 to disable it (default)
+ *
+ *  \return Returns CROS_SUCCESS_ERR_PACK on success, or the error code pack if subidx is not a subscriber registered
+ *          with cRosApiRegisterSubscriber()
+ */
+cRosErrCodePack cRosApiSetSubscriberBorrowArrays(CrosNode *node, int subidx, int enable);
+
+/*! \brief Set the minimum size of the messages that a subscriber registered with cRosApiRegisterSubscriber() decodes
+ *         while they are being received, instead of once the whole message has been received. This way the decoding
+ *         of a large message overlaps its reception, and the connection keeps only CN_SUBSCRIBER_STREAM_CHUNK_SIZE
+ *         bytes of it at a time. Each connection decodes these messages into its own message before they are passed
+ *         to the callback. It has no effect while the zero-copy decoding is enabled (see
+ *         cRosApiSetSubscriberBorrowArrays())
+ *
+ *  \param node Pointer to the node
+ *  \param subidx Index of the subscriber
+ *  \param min_size Minimum size (in bytes) of the messages decoded while they are received. The default is
+ *                  CN_SUBSCRIBER_STREAM_MIN_SIZE. Use SIZE_MAX to always decode the messages once received
+ *
+ *  \return Returns CROS_SUCCESS_ERR_PACK on success, or the error code pack if subidx is not a subscriber registered
+ *          with cRosApiRegisterSubscriber()
+ */
+cRosErrCodePack cRosApiSetSubscriberStreamMinSize(CrosNode *node, int subidx, size_t min_size);
+
+cRosErrCodePack cRosApiRegisterPublisher(CrosNode *node, const char *topic_name, const char *topic_type, int loop_period, PublisherApiCallback callback, NodeStatusCallback status_callback, void *context, int queue_size, int *pubidx_ptr);
 cRosErrCodePack cRosApiUnregisterPublisher(CrosNode *node, int pubidx);
 void cRosApiReleasePublisher(CrosNode *node, int pubidx);
 
+/*! \brief Change the publication period of a publisher. Unlike the loop_period argument of cRosApiRegisterPublisher(),
+ *         which is in milliseconds, the period is given in microseconds, so periods shorter than one millisecond can be used
+ *
+ *  \param node Pointer to the node
+ *  \param pubidx Index of the publisher
+ *  \param loop_period_us Publication period (in microseconds), or -1 to pause the periodic publication
+ *
+ *  \return Returns CROS_SUCCESS_ERR_PACK on success, or the error code pack if pubidx is not a registered publisher
+ */
+cRosErrCodePack cRosApiSetPublisherLoopPeriodUs(CrosNode *node, int pubidx, int64_t loop_period_us);
+
+/*! \brief Register a subscriber whose messages are decoded by the generated code of their type (see cRosGentoolsGenerateC()).
+ *         The callback receives a pointer to the generated struct of the type. The received messages are not put in the
+ *         queue of the subscriber, so it has no queue_size and cRosNodeReceiveTopicMsg() cannot be used with it.
+ *         The other parameters and the unregistration functions are the same as for cRosApiRegisterSubscriber()
+ */
+cRosErrCodePack cRosApiRegisterSubscriberCodec(CrosNode *node, const char *topic_name, const CrosMessageCodec *codec, SubscriberCodecApiCallback callback, NodeStatusCallback status_callback, void *context, int tcp_nodelay, int *subidx_ptr);
+
+/*! \brief Register a subscriber whose callback receives a read-only view of each received packet (see cros_message_view.h)
+ *         instead of a decoded cRosMessage, so only the fields that the callback reads are decoded. The view is only
+ *         valid until the callback returns. The received messages are not put in the queue of the subscriber, so it
+ *         has no queue_size and cRosNodeReceiveTopicMsg() cannot be used with it.
+ *         The other parameters and the unregistration functions are the same as for cRosApiRegisterSubscriber()
+ */
+cRosErrCodePack cRosApiRegisterSubscriberView(CrosNode *node, const char *topic_name, const char *topic_type, SubscriberViewApiCallback callback, NodeStatusCallback status_callback, void *context, int tcp_nodelay, int *subidx_ptr);
+
+/*! \brief Register a publisher whose messages are encoded by the generated code of their type (see cRosGentoolsGenerateC()).
+ *         The callback receives a pointer to the generated struct of the type, which it must fill, and the messages
+ *         can also be published with cRosNodeSendTopicCodecMsg().
+ *         The other parameters and the unregistration functions are the same as for cRosApiRegisterPublisher()
+ */
+cRosErrCodePack cRosApiRegisterPublisherCodec(CrosNode *node, const char *topic_name, const CrosMessageCodec *codec, int loop_period, PublisherCodecApiCallback callback, NodeStatusCallback status_callback, void *context, int queue_size, int *pubidx_ptr);
+
+/*! \brief Register a subscriber whose messages are decoded into a flat message (see cros_message_layout.h) by the
+ *         serializer program compiled with the layout of the type. The callback receives the same flat message each
+ *         time, which keeps the storage of its strings and arrays from one message to the next. The received messages
+ *         are not put in the queue of the subscriber, so cRosNodeReceiveTopicMsg() cannot be used with it.
+ *         The other parameters and the unregistration functions are the same as for cRosApiRegisterSubscriber()
+ */
+cRosErrCodePack cRosApiRegisterSubscriberFlat(CrosNode *node, const char *topic_name, const char *topic_type, SubscriberFlatApiCallback callback, NodeStatusCallback status_callback, void *context, int tcp_nodelay, int *subidx_ptr);
+
+/*! \brief Register a publisher whose messages are flat messages (see cros_message_layout.h), encoded by the serializer
+ *         program compiled with the layout of the type. The callback receives the flat message to fill, and the
+ *         messages can also be published with cRosNodeSendTopicFlatMsg().
+ *         The other parameters and the unregistration functions are the same as for cRosApiRegisterPublisher()
+ */
+cRosErrCodePack cRosApiRegisterPublisherFlat(CrosNode *node, const char *topic_name, const char *topic_type, int loop_period, PublisherFlatApiCallback callback, NodeStatusCallback status_callback, void *context, int queue_size, int *pubidx_ptr);
+
 // Master api: name service and system state
 cRosErrCodePack cRosApiLookupNode(CrosNode *node, const char *node_name, LookupNodeCallback callback, void *context, int *caller_id_ptr);
 cRosErrCodePack cRosApiGetPublishedTopics(CrosNode *node, const char *subgraph, GetPublishedTopicsCallback callback, void *context, int *caller_id_ptr);
@@ -383,10 +496,149 @@ cRosErrCodePack cRosApiHasParam(CrosNode *node, const char *key, HasParamCallbac
 cRosErrCodePack cRosApiGetParamNames(CrosNode *node, GetParamNamesCallback callback, void *context, int *caller_id_ptr);
 
 // Message polling
+
+/*! \brief Extract the oldest message of the queue of a subscriber, waiting up to time_out milliseconds for one to be received.
+ *         While the node is not run by its own threads, the function runs the node loop while it waits. In threaded mode
+ *         (see cRosNodeStartThreads()) it can be called from any thread and just waits for the callback threads to queue
+ *         a message, but only one thread at a time must receive the messages of each subscriber
+ *
+ *  \param node Pointer to the node
+ *  \param subidx Index of the subscriber
+ *  \param msg Message that receives the fields of the extracted message (see cRosMessageQueueExtractSwap())
+ *  \param buff_overflow If not NULL, it is set to 1 if messages were dropped because the queue was full since the last call
+ *  \param time_out Maximum time to wait (in milliseconds), or CROS_INFINITE_TIMEOUT
+ *
+ *  \return Returns CROS_SUCCESS_ERR_PACK on success, CROS_RCV_TOP_TIMEOUT_ERR if no message was received in time, or the
+ *          error code pack otherwise
+ */
 cRosErrCodePack cRosNodeReceiveTopicMsg(CrosNode *node, int subidx, cRosMessage *msg, unsigned char *buff_overflow, unsigned long time_out);
+
+/*! \brief Publish a message: it is serialized once and queued in every connection of the publisher. In threaded mode
+ *         (see cRosNodeStartThreads()) it can be called from any thread without locks: the message is serialized by the
+ *         calling thread and passed to the I/O thread, which is woken up to send it
+ *
+ *  \param node Pointer to the node
+ *  \param pubidx Index of the publisher
+ *  \param msg Message to publish, which the caller keeps
+ *  \param time_out Ignored, kept for compatibility: publishing never waits for the subscribers. When the outgoing
+ *         queue of a subscriber is full, CrosNodeConfig::tcpros_out_queue_policy is applied instead
+ *
+ *  \return Returns CROS_SUCCESS_ERR_PACK on success, or the error code pack otherwise
+ */
 cRosErrCodePack cRosNodeSendTopicMsg(CrosNode *node, int pubidx, cRosMessage *msg, unsigned long time_out);
+
+/*! \brief Publish a message with a publisher registered with cRosApiRegisterPublisherCodec(). As in
+ *         cRosNodeSendTopicMsg(), the message is encoded once by the calling thread and queued in every connection
+ *
+ *  \param node Pointer to the node
+ *  \param pubidx Index of the publisher
+ *  \param msg Pointer to the generated struct of the type of the publisher, which the caller keeps
+ *  \param time_out Ignored, as in cRosNodeSendTopicMsg()
+ *
+ *  \return Returns CROS_SUCCESS_ERR_PACK on success, or the error code pack otherwise
+ */
+cRosErrCodePack cRosNodeSendTopicCodecMsg(CrosNode *node, int pubidx, const void *msg, unsigned long time_out);
+
+/*! \brief Publish a flat message with a publisher registered with cRosApiRegisterPublisherFlat(). As in
+ *         cRosNodeSendTopicMsg(), the message is encoded once by the calling thread and queued in every connection
+ *
+ *  \param node Pointer to the node
+ *  \param pubidx Index of the publisher
+ *  \param msg Message to publish, which the caller keeps. Its layout must be of the type of the publisher (e.g., the
+ *         message is created with cRosApiCreatePublisherFlatMessage())
+ *  \param time_out Ignored, as in cRosNodeSendTopicMsg()
+ *
+ *  \return Returns CROS_SUCCESS_ERR_PACK on success, or the error code pack otherwise
+ */
+cRosErrCodePack cRosNodeSendTopicFlatMsg(CrosNode *node, int pubidx, cRosFlatMessage *msg, unsigned long time_out);
+
+/*! \brief Call a service and wait up to time_out milliseconds for its response. While the node is not run by its own
+ *         threads, the function runs the node loop while it waits. In threaded mode (see cRosNodeStartThreads()) it can be
+ *         called from any thread: the call is passed to the I/O thread, and the calls of several threads to the same
+ *         service are made one after the other
+ *
+ *  \param node Pointer to the node
+ *  \param svcidx Index of the service caller
+ *  \param req_msg Request message, which the caller keeps
+ *  \param resp_msg Message that receives the fields of the response (see cRosMessageQueueExtractSwap()). It can be NULL
+ *  \param time_out Maximum time to wait (in milliseconds), or CROS_INFINITE_TIMEOUT
+ *
+ *  \return Returns CROS_SUCCESS_ERR_PACK on success, CROS_CALL_INI_TIMEOUT_ERR if the service caller was not ready to send
+ *          the request in time, CROS_CALL_SVC_TIMEOUT_ERR if the response was not received in time, or the error code pack
+ *          otherwise
+ */
 cRosErrCodePack cRosNodeServiceCall(CrosNode *node, int svcidx, cRosMessage *req_msg, cRosMessage *resp_msg, unsigned long time_out);
+
+/*! \brief Create a message of the type of a publisher, to be sent with cRosNodeSendTopicMsg(). The message is taken
+ *         from the message pool of the publisher (see cros_message_pool.h): if it was recycled, it keeps the memory
+ *         and the field values of its previous use. It can be called from any thread, also while the node threads run
+ *
+ *  \param node Pointer to the node
+ *  \param pubidx Index of the publisher
+ *
+ *  \return Pointer to the message, which must be given back with cRosApiRecyclePublisherMessage() (or freed with
+ *          cRosMessageFree()). NULL if pubidx is not a publisher of cRosMessage objects or on memory error
+ */
 cRosMessage *cRosApiCreatePublisherMessage(CrosNode *node, int pubidx);
+
+/*! \brief Give back a message created by cRosApiCreatePublisherMessage() to the message pool of the publisher, so
+ *         that the next created message reuses it. The message is freed if the pool is full. It can be called from any
+ *         thread
+ *
+ *  \param node Pointer to the node
+ *  \param pubidx Index of the publisher
+ *  \param msg Message to recycle. It can be NULL
+ */
+void cRosApiRecyclePublisherMessage(CrosNode *node, int pubidx, cRosMessage *msg);
+
+/*! \brief Create a flat message of the type of a publisher registered with cRosApiRegisterPublisherFlat(), to be sent
+ *         with cRosNodeSendTopicFlatMsg(). All its fields are zero. It can be called from any thread
+ *
+ *  \param node Pointer to the node
+ *  \param pubidx Index of the publisher
+ *
+ *  \return Pointer to the message, which must be freed with cRosFlatMessageFree() before the publisher is released.
+ *          NULL if pubidx is not a publisher of flat messages or on memory error
+ */
+cRosFlatMessage *cRosApiCreatePublisherFlatMessage(CrosNode *node, int pubidx);
+
+/*! \brief Create a message of the type of a subscriber, to be filled with cRosNodeReceiveTopicMsg(). The message is
+ *         taken from the message pool of the subscriber, like in cRosApiCreatePublisherMessage()
+ *
+ *  \param node Pointer to the node
+ *  \param subidx Index of the subscriber
+ *
+ *  \return Pointer to the message, which must be given back with cRosApiRecycleSubscriberMessage() (or freed with
+ *          cRosMessageFree()). NULL if subidx is not a subscriber registered with cRosApiRegisterSubscriber() or on
+ *          memory error
+ */
+cRosMessage *cRosApiCreateSubscriberMessage(CrosNode *node, int subidx);
+
+/*! \brief Give back a message created by cRosApiCreateSubscriberMessage() to the message pool of the subscriber
+ *
+ *  \param node Pointer to the node
+ *  \param subidx Index of the subscriber
+ *  \param msg Message to recycle. It can be NULL
+ */
+void cRosApiRecycleSubscriberMessage(CrosNode *node, int subidx, cRosMessage *msg);
+
+/*! \brief Create a request message of a service caller, to be sent with cRosNodeServiceCall(). The message is taken
+ *         from the message pool of the service caller, like in cRosApiCreatePublisherMessage()
+ *
+ *  \param node Pointer to the node
+ *  \param svcidx Index of the service caller
+ *
+ *  \return Pointer to the message, which must be given back with cRosApiRecycleServiceCallerRequest() (or freed with
+ *          cRosMessageFree()). NULL if svcidx is not a service caller or on memory error
+ */
 cRosMessage *cRosApiCreateServiceCallerRequest(CrosNode *node, int svcidx);
 
+/*! \brief Give back a message created by cRosApiCreateServiceCallerRequest() to the message pool of the service caller
+ *
+ *  \param node Pointer to the node
+ *  \param svcidx Index of the service caller
+ *  \param msg Message to recycle. It can be NULL
+ */
+void cRosApiRecycleServiceCallerRequest(CrosNode *node, int svcidx, cRosMessage *msg);
+
 #endif // _CROS_API_H_
@@ -13,11 +13,13 @@
  *  \param callback Pointer to the callback function that will be called to generate the (raw) packet data of type topic_type
  *  \param status_callback Pointer to the status callback function
  *  \param data_context Pointer to user data than will be passed to the callback function as context information. Can be NULL
+ *  \param queue_size Maximum number of published messages waiting to be sent to each subscriber. If it is 0,
+ *         the tcpros_out_queue_length of the node configuration is used
  *  \return Returns the index of the created publisher on success, -1 on failure (e.g., the maximum number of publisher topics has been reached)
  */
 int cRosNodeRegisterPublisher(CrosNode *n, const char *message_definition, const char *topic_name,
                               const char *topic_type, const char *md5sum, int loop_period,
-                              PublisherCallback callback, NodeStatusCallback status_callback, void *data_context);
+                              PublisherCallback callback, NodeStatusCallback status_callback, void *data_context, int queue_size);
 
 /*! \brief Register the node in roscore as topic subscriber.
  *  \param n Pointer to CrosNode structure that has previously been created with cRosNodeCreate
@@ -30,11 +32,13 @@ int cRosNodeRegisterPublisher(CrosNode *n, const char *message_definition, const
  *  \param data_context Pointer to user data than will be passed to the callback function as context information. Can be NULL
  *  \param tcp_nodelay If this parameter is 1, the publisher is asked to disable the Nagle algorithm for the socket,
  *         so small packets are sent immediately, reducing the latency but increasing the bandwidth usage.
+ *  \param queue_size Maximum number of received messages waiting in the subscriber queue. If it is 0, DEFAULT_QUEUE_LEN is used
  *  \return Returns the index of the created subscriber on success, -1 on failure (e.g., the maximum number of subscriber topics has been reached)
  */
 int cRosNodeRegisterSubscriber(CrosNode *n, const char *message_definition,
                                const char *topic_name, const char *topic_type, const char *md5sum,
-                               SubscriberCallback callback, NodeStatusCallback status_callback, void *data_context, int tcp_nodelay);
+                               SubscriberCallback callback, NodeStatusCallback status_callback, void *data_context, int tcp_nodelay,
+                               int queue_size);
 
 /*! \brief Register the service provider in roscore
  *  \param n Pointer to CrosNode structure that has previously been created with cRosNodeCreate
@@ -0,0 +1,96 @@
+/*! \file cros_arena.h
+ *  \brief This header file declares the CrosArena type and associated functions.
+ *
+ *  CrosArena is a bump allocator: the memory is taken in order from a list of large chunks, and it is not freed
+ *  block by block but all at once, when the arena is reset or released. A reset keeps the chunks, so an arena that
+ *  is reset and refilled with similar objects (e.g., the fields of a message of the same type) stops calling
+ *  malloc() once its chunks are large enough.
+ */
+
+#ifndef _CROS_ARENA_H_
+#define _CROS_ARENA_H_
+
+#include <stddef.h>
+
+/*! \defgroup cros_arena cROS arena allocator */
+
+/*! \addtogroup cros_arena
+ *  @{
+ */
+
+#define CROS_ARENA_DEFAULT_CHUNK_SIZE 4096 //! Default number of bytes of the chunks of an arena
+
+typedef struct CrosArenaChunk CrosArenaChunk;
+
+/*! \brief Arena object. Don't modify its internal members: use the related functions instead */
+typedef struct CrosArena CrosArena;
+struct CrosArena
+{
+  CrosArenaChunk *first;                //! First chunk of the arena (NULL until the first allocation)
+  CrosArenaChunk *current;              //! Chunk where the memory is being allocated. The chunks after it are unused
+  size_t chunk_size;                    //! Minimum number of bytes of the new chunks
+  void *last_block;                     //! Last block allocated in the current chunk, which can be grown in place
+};
+
+/*! \brief Initialize an arena without allocating memory
+ *
+ *  \param arena Pointer to the CrosArena object
+ *  \param chunk_size Minimum number of bytes of the chunks, or 0 to use CROS_ARENA_DEFAULT_CHUNK_SIZE
+ */
+void cRosArenaInit( CrosArena *arena, size_t chunk_size );
+
+/*! \brief Allocate a block of memory in an arena. The block is aligned for any primitive message value
+ *
+ *  \param arena Pointer to the CrosArena object
+ *  \param size Number of bytes of the block
+ *
+ *  \return Pointer to the block, or NULL if a new chunk cannot be allocated
+ */
+void *cRosArenaAlloc( CrosArena *arena, size_t size );
+
+/*! \brief Allocate a zero-filled block of memory in an arena
+ *
+ *  \param arena Pointer to the CrosArena object
+ *  \param n_elems Number of elements of the block
+ *  \param elem_size Number of bytes of each element
+ *
+ *  \return Pointer to the block, or NULL if a new chunk cannot be allocated
+ */
+void *cRosArenaCalloc( CrosArena *arena, size_t n_elems, size_t elem_size );
+
+/*! \brief Change the size of a block of an arena. The block is kept if it is large enough, it is grown in place if it
+ *         is the last one allocated, and otherwise its content is moved to a new block (the old one is not reused
+ *         until the arena is reset)
+ *
+ *  \param arena Pointer to the CrosArena object
+ *  \param block Block allocated in the arena, or NULL to allocate a new one
+ *  \param size New number of bytes of the block
+ *
+ *  \return Pointer to the block, or NULL if a new chunk cannot be allocated (block is not modified)
+ */
+void *cRosArenaRealloc( CrosArena *arena, void *block, size_t size );
+
+/*! \brief Copy a string to a new block of an arena
+ *
+ *  \param arena Pointer to the CrosArena object
+ *  \param str NUL-terminated string
+ *
+ *  \return Pointer to the copy, or NULL if a new chunk cannot be allocated
+ */
+char *cRosArenaStrdup( CrosArena *arena, const char *str );
+
+/*! \brief Free all the blocks of an arena at once. The chunks are kept to allocate the next blocks
+ *
+ *  \param arena Pointer to the CrosArena object
+ */
+void cRosArenaReset( CrosArena *arena );
+
+/*! \brief Free all the blocks and chunks of an arena. The arena can be used again after it
+ *
+ *  \param arena Pointer to the CrosArena object
+ */
+void cRosArenaRelease( CrosArena *arena );
+
+/*! @}*/
+
+#endif // _CROS_ARENA_H_
@@ -2,6 +2,7 @@
 #define _CROS_CLOCK_H_
 
 #include <sys/time.h>
+#include <time.h>
 #include <stdint.h>
 
 /*! \defgroup cros_clock cROS clock
@@ -13,12 +14,29 @@
  *  @{
  */
 
+/*! Number of nanoseconds in a microsecond */
+#define CROS_CLOCK_NS_PER_US 1000ULL
+
+/*! Number of nanoseconds in a millisecond */
+#define CROS_CLOCK_NS_PER_MS 1000000ULL
+
+/*! Number of nanoseconds in a second */
+#define CROS_CLOCK_NS_PER_S 1000000000ULL
+
 /*! \brief Return the current time, expressed as milliseconds since the Epoch
  * 
  *  \return The current time
  */
 uint64_t cRosClockGetTimeMs();
 
+/*! \brief Return the current time of the monotonic clock, expressed as nanoseconds since an unspecified
+ *         starting point. Unlike cRosClockGetTimeMs(), it does not jump when the system time is changed (e.g., by NTP),
+ *         so it is used to schedule the node processes
+ *
+ *  \return The current monotonic time
+ */
+uint64_t cRosClockGetTimeNs();
+
 /*! \brief Convert an interval expressed as milliseconds in a timeval structure, 
  *         that express the same interval as seconds and microseconds
  * 
@@ -26,6 +44,13 @@ uint64_t cRosClockGetTimeMs();
  */
 struct timeval cRosClockGetTimeVal( uint64_t msec );
 
+/*! \brief Convert an interval expressed as nanoseconds in a timespec structure,
+ *         that express the same interval as seconds and nanoseconds
+ *
+ *  \return The time interval express with a timespec structure
+ */
+struct timespec cRosClockGetTimeSpec( uint64_t nsec );
+
 /*! @}*/
 
-#endif
\ No newline at end of file
+#endif
@@ -0,0 +1,89 @@
+/*! \file cros_executor.h
+ *  \brief This header file declares the CrosExecutor type and associated functions: a pool of worker
+ *         threads used by a node in threaded mode to run the user callbacks out of its I/O thread.
+ *
+ *  Each job is submitted with a key. The jobs with the same key are run one after another, in the
+ *  order in which they were submitted, so that the callbacks of a subscriber (or of a service provider)
+ *  are never run concurrently and see the messages in the order they were received. The jobs with
+ *  different keys may run in parallel.
+ */
+
+#ifndef _CROS_EXECUTOR_H_
+#define _CROS_EXECUTOR_H_
+
+#include <pthread.h>
+
+/*! \defgroup cros_executor cROS callback executor */
+
+/*! \addtogroup cros_executor
+ *  @{
+ */
+
+/*! \brief Function run by a worker thread */
+typedef void (*CrosExecutorFn)( void *arg );
+
+typedef struct CrosExecutorJob CrosExecutorJob;
+struct CrosExecutorJob
+{
+  CrosExecutorFn fn;
+  void *arg;
+  CrosExecutorJob *next;
+};
+
+/*! \brief Worker thread of a CrosExecutor object, with its own queue of jobs */
+typedef struct CrosExecutorWorker CrosExecutorWorker;
+struct CrosExecutorWorker
+{
+  pthread_t thread;
+  pthread_mutex_t mutex;                //! Protects the rest of the fields
+  pthread_cond_t job_cond;              //! Signaled when a job is queued or the worker must stop
+  CrosExecutorJob *first_job;           //! Queued jobs, in submission order
+  CrosExecutorJob *last_job;
+  CrosExecutorJob *free_jobs;           //! Jobs already run, kept to be reused
+  int stop;                             //! If 1, the worker exits once its queue is empty
+};
+
+/*! \brief CrosExecutor object. Don't modify directly its internal members: use
+ *         the related functions instead */
+typedef struct CrosExecutor CrosExecutor;
+struct CrosExecutor
+{
+  CrosExecutorWorker *workers;
+  int n_workers;                        //! Number of worker threads (0 if the executor is not started)
+};
+
+/*! \brief Initialize a CrosExecutor object without starting any thread
+ *
+ *  \param e Pointer to the CrosExecutor object
+ */
+void cRosExecutorInit( CrosExecutor *e );
+
+/*! \brief Start the worker threads of a CrosExecutor object
+ *
+ *  \param e Pointer to the CrosExecutor object
+ *  \param n_workers Number of worker threads (at least 1)
+ *
+ *  \return Returns 0 on success, -1 on failure (no thread is left running)
+ */
+int cRosExecutorStart( CrosExecutor *e, int n_workers );
+
+/*! \brief Run the jobs already submitted, stop the worker threads and release all the internally allocated memory
+ *
+ *  \param e Pointer to the CrosExecutor object
+ */
+void cRosExecutorStop( CrosExecutor *e );
+
+/*! \brief Queue a job to be run by a worker thread
+ *
+ *  \param e Pointer to the CrosExecutor object
+ *  \param key Ordering key: the jobs with the same key are run in submission order, one at a time
+ *  \param fn Function to run
+ *  \param arg Argument passed to fn
+ *
+ *  \return Returns 0 on success, -1 if the job cannot be allocated or the executor is not started
+ */
+int cRosExecutorSubmit( CrosExecutor *e, unsigned int key, CrosExecutorFn fn, void *arg );
+
+/*! @}*/
+
+#endif
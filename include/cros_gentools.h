@@ -32,6 +32,20 @@ int cRosGentoolsSHA1(char* filename);
  */
 int cRosGentoolsFulltext(char* filename);
 
+/*! \brief Generate the C code of a message or service type: a plain C struct for the type (and for the custom types
+ *         that it uses) and functions specialized for it that initialize, release, size, serialize and deserialize it
+ *         without any run-time type dispatch (see cros_message_codec.h).
+ *
+ *  The files <package>_<Name>.h and <package>_<Name>.c are created in output_dir. They define the struct
+ *  <package>_<Name> and a CrosMessageCodec named <package>_<Name>_codec, which can be used to register publishers and
+ *  subscribers of the type. For a service, <package>_<Name>Request and <package>_<Name>Response are defined.
+ *  \param filename Full path of the message/service file
+ *  \param output_dir Directory where the generated files are written
+ *
+ *  \return Returns 1 on success, 0 on failure
+ */
+int cRosGentoolsGenerateC(char* filename, char* output_dir);
+
 /*! @}*/
 
 #endif
@@ -0,0 +1,149 @@
+/*! \file cros_io_shard.h
+ *  \brief This header file declares the CrosIoShard type and associated functions: a thread with its own poller that
+ *         streams the published messages of a subset of the TCPROS server connections of a node in threaded mode.
+ *
+ *  The node I/O thread keeps accepting the connections and reading their headers. Then it moves each connection to
+ *  the least loaded shard (see tcprosProcessMoveStream()) and passes the published frames to the shards that have
+ *  connections of the topic. A shard only touches its own connections, so no lock is taken to write the messages:
+ *  the node and the shards exchange CrosIoShardMsg objects through lock-free queues.
+ */
+
+#ifndef _CROS_IO_SHARD_H_
+#define _CROS_IO_SHARD_H_
+
+#include <stdint.h>
+#include <pthread.h>
+
+#include "tcpros_process.h"
+#include "cros_poller.h"
+#include "cros_timer_heap.h"
+#include "cros_wakeup.h"
+#include "cros_mpsc_queue.h"
+
+/*! \defgroup cros_io_shard cROS I/O shard */
+
+/*! \addtogroup cros_io_shard
+ *  @{
+ */
+
+typedef enum CrosIoShardMsgType
+{
+  CROS_IO_SHARD_ADOPT,                  //! The shard must stream the connection conn (node to shard)
+  CROS_IO_SHARD_PUBLISH,                //! The shard must queue frame in its connections of topic_idx, or only in the one of server_idx (node to shard)
+  CROS_IO_SHARD_CLOSED                  //! The connection of server_idx has been closed by the shard (shard to node)
+} CrosIoShardMsgType;
+
+/*! \brief Message exchanged between the node I/O thread and a CrosIoShard */
+typedef struct CrosIoShardMsg CrosIoShardMsg;
+struct CrosIoShardMsg
+{
+  CrosMpscLink link;
+  CrosIoShardMsgType type;
+  int server_idx;                       //! Index of the TCPROS server process of the connection (-1 for all the connections of topic_idx)
+  int topic_idx;                        //! Index of the publisher
+  TcprosFrame *frame;                   //! Frame to publish (the message holds a reference)
+  TcprosProcess *conn;                  //! Connection to adopt, allocated with malloc()
+};
+
+/*! \brief CrosIoShard object. Don't modify directly its internal members: use
+ *         the related functions instead */
+typedef struct CrosIoShard CrosIoShard;
+struct CrosIoShard
+{
+  pthread_t thread;
+  CrosPoller poller;                    //! Waits for the sockets of the shard connections
+  CrosWakeup wakeup;                    //! Wakes up the shard when a message is posted to it
+  CrosMpscQueue inbox;                  //! Messages posted to the shard
+  unsigned char inbox_pending;          //! 1 while the shard has been woken up to attend inbox (accessed atomically)
+  TcprosProcess **conns;                //! Connections of the shard, indexed by their TCPROS server process index (NULL if not in the shard)
+  int *conn_timers;                     //! Timer of each slot of conns in timers (-1 if it has not been created yet)
+  int conns_size;                       //! Number of slots of conns and conn_timers
+  CrosTimerHeap timers;                 //! I/O timeouts of the connections that are sending a frame
+  CrosOutQueuePolicy out_queue_policy;  //! What to do when a frame is published and the queue of a connection is full
+  uint64_t io_timeout_ns;               //! Maximum time to complete the sending of a frame
+  CrosMpscQueue *events;                //! Queue of the node that receives the CROS_IO_SHARD_CLOSED messages
+  unsigned char *events_pending;        //! Flag of the node set when it is woken up to attend events (accessed atomically)
+  CrosWakeup *events_wakeup;            //! Wake-up of the node loop
+  int load;                             //! Number of connections passed to the shard and not closed yet, as counted by the node
+  unsigned char running;                //! 1 while the shard thread exists
+  unsigned char exit_flag;              //! If 1, the shard thread must finish once inbox is empty (accessed atomically)
+  unsigned char failed;                 //! 1 once the shard thread has closed its connections and finished because its poller failed (accessed atomically)
+};
+
+/*! \brief Initialize a CrosIoShard object without starting its thread
+ *
+ *  \param s Pointer to the CrosIoShard object
+ */
+void cRosIoShardInit( CrosIoShard *s );
+
+/*! \brief Start the thread of a CrosIoShard object
+ *
+ *  \param s Pointer to the CrosIoShard object
+ *  \param backend Poller backend of the shard
+ *  \param out_queue_policy What to do when a frame is published and the queue of a connection is full
+ *  \param io_timeout_ns Maximum time to complete the sending of a frame before closing the connection
+ *  \param events Queue that receives the CROS_IO_SHARD_CLOSED messages of the shard
+ *  \param events_pending Flag set by the shard when it wakes up events_wakeup, and cleared by the receiver of events
+ *  \param events_wakeup Wake-up signaled when a message is added to events
+ *
+ *  \return Returns 0 on success, -1 on failure
+ */
+int cRosIoShardStart( CrosIoShard *s, CrosPollerBackend backend, CrosOutQueuePolicy out_queue_policy, uint64_t io_timeout_ns,
+                      CrosMpscQueue *events, unsigned char *events_pending, CrosWakeup *events_wakeup );
+
+/*! \brief Stop the thread of a CrosIoShard object once it has attended the messages already posted. The connections stay
+ *         in the shard, so that they can be taken back with cRosIoShardTakeConn()
+ *
+ *  \param s Pointer to the CrosIoShard object
+ */
+void cRosIoShardStop( CrosIoShard *s );
+
+/*! \brief Close the remaining connections of a stopped CrosIoShard object and release all its memory
+ *
+ *  \param s Pointer to the CrosIoShard object
+ */
+void cRosIoShardRelease( CrosIoShard *s );
+
+/*! \brief Allocate a message to be posted to a CrosIoShard object. It can be called from any thread
+ *
+ *  \param type Type of the message
+ *
+ *  \return A pointer to the message, or NULL if it cannot be allocated
+ */
+CrosIoShardMsg *cRosIoShardNewMsg( CrosIoShardMsgType type );
+
+/*! \brief Release a message, dropping its frame reference and its connection. It can be called from any thread
+ *
+ *  \param msg Pointer to the message (it can be NULL)
+ */
+void cRosIoShardFreeMsg( CrosIoShardMsg *msg );
+
+/*! \brief Post a message to a CrosIoShard object, which takes it. It can be called from any thread
+ *
+ *  \param s Pointer to the CrosIoShard object
+ *  \param msg Pointer to the message
+ */
+void cRosIoShardPost( CrosIoShard *s, CrosIoShardMsg *msg );
+
+/*! \brief Check whether the thread of a CrosIoShard object has finished because its poller failed. Then the shard has
+ *         closed its connections (notifying them to the node), and no connection or frame must be posted to it.
+ *         It can be called from any thread
+ *
+ *  \param s Pointer to the CrosIoShard object
+ *
+ *  \return 1 if the shard has failed, 0 otherwise
+ */
+int cRosIoShardHasFailed( CrosIoShard *s );
+
+/*! \brief Take a connection out of a stopped CrosIoShard object
+ *
+ *  \param s Pointer to the CrosIoShard object
+ *  \param server_idx Index of the TCPROS server process of the connection
+ *
+ *  \return The connection, which the caller must release and free(), or NULL if the shard does not have it
+ */
+TcprosProcess *cRosIoShardTakeConn( CrosIoShard *s, int server_idx );
+
+/*! @}*/
+
+#endif
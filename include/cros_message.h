@@ -3,6 +3,7 @@
 
 #include "dyn_buffer.h"
 #include "cros_err_codes.h"
+#include "cros_arena.h"
 
 /*! \defgroup cros_message cROS TCPROS
  *
@@ -39,6 +40,17 @@ typedef enum CrosMessageType
 typedef struct cRosMessageField cRosMessageField;
 typedef struct cRosMessage cRosMessage;
 
+/*! \brief Length and capacity kept for a string value of a field, so that it is encoded without scanning it and
+ *         overwritten without reallocating it if the new value is not longer
+ */
+typedef struct cRosMessageStringInfo cRosMessageStringInfo;
+struct cRosMessageStringInfo
+{
+  const char *str;      //! String value that len and capacity describe: if the value is not this one anymore, they are ignored
+  uint32_t len;         //! Number of characters of the string
+  uint32_t capacity;    //! Number of characters that the memory of the string can hold (without the NUL)
+};
+
 struct cRosMessageField
 {
     char *name;
@@ -56,7 +68,7 @@ struct cRosMessageField
       uint64_t as_uint64;
       float as_float32;
       double as_float64;
-      char *as_string;
+      char *as_string; //! NUL-terminated string, allocated in the heap (or in the arena of the field) and freed with the field
       cRosMessage *as_msg;
       int8_t *as_int8_array;
       uint8_t *as_uint8_array;
@@ -68,7 +80,7 @@ struct cRosMessageField
       uint64_t *as_uint64_array;
       float *as_float32_array;
       double *as_float64_array;
-      char **as_string_array;
+      char **as_string_array; //! Strings allocated like as_string
       cRosMessage **as_msg_array;
       void *as_array;
     } data;
@@ -78,18 +90,50 @@ struct cRosMessageField
     int is_fixed_array;
     int array_size;
     int array_capacity;
+    int is_borrowed; //! If 1, data.as_array points into the received packet borrowed by the message (see cRosMessageDeserializeBorrow()) and it is not freed with the field
+    CrosArena *arena; //! Arena where the field and its values are allocated, or NULL if they are allocated in the heap
     CrosMessageType type;
     char *type_s;
+    /*! Length and capacity of data.as_string. If the string is assigned directly, its length is computed again when it
+     *  is encoded. A string modified in place, or freed and allocated again (maybe at the same address), must be set
+     *  with cRosMessageSetFieldValueString() (or cRosMessageFieldArrayAtStringSet() for an array element) instead */
+    cRosMessageStringInfo string_info;
+    cRosMessageStringInfo *string_infos; //! Length and capacity of each element of data.as_string_array (like string_info), or NULL
+    int string_infos_capacity; //! Number of elements of string_infos
 };
 
 typedef struct t_msgDef cRosMessageDef;
 
+/*! \brief Reference-counted buffer holding a received packet, which is retained by the messages whose array fields
+ *         point into it (see cRosMessageDeserializeBorrow())
+ */
+typedef struct cRosMessageBuffer cRosMessageBuffer;
+struct cRosMessageBuffer
+{
+  DynBuffer packet;     //! Received packet
+  int ref_count;        //! Number of holders of the buffer (accessed atomically). It is freed when the last one releases it
+};
+
 struct cRosMessage
 {
     cRosMessageField **fields;
     cRosMessageDef *msgDef;
     char *md5sum;
     int n_fields;
+    size_t fixed_size; //! Number of bytes of the encoded message if it has no strings or variable-length arrays (POD), or 0 otherwise
+    cRosMessageBuffer *borrowed_buffer; //! Buffer that the borrowed array fields of the message (and of its nested messages) point into, or NULL
+    CrosArena *arena; //! Arena where the message and its fields are allocated, or NULL if they are allocated in the heap
+};
+
+#define CROS_FIELD_HANDLE_MAX_DEPTH 8 //! Maximum number of nested messages that a field handle can go through
+
+/*! \brief Location of a (possibly nested) field in the messages of a type, resolved once from its dotted path by
+ *         cRosMessageFieldHandleResolve() and used to access the field in any message of that type without name lookups */
+typedef struct cRosMessageFieldHandle cRosMessageFieldHandle;
+struct cRosMessageFieldHandle
+{
+  int depth;                                      //! Number of elements of indices (0 if the handle is not resolved)
+  int indices[CROS_FIELD_HANDLE_MAX_DEPTH];       //! Index of the field in each nested message of the path
 };
 
 cRosMessage * cRosMessageNew(void);
@@ -106,12 +150,36 @@ int cRosMessageFieldCopy(cRosMessageField* new_field, cRosMessageField* orig_fie
 
 int cRosMessageFieldsCopy(cRosMessage *m_dst, cRosMessage *m_src);
 
+void cRosMessageFieldsSwap(cRosMessage *m1, cRosMessage *m2);
+
 cRosMessage *cRosMessageCopyWithoutDef(cRosMessage *m_src);
 
 cRosMessage *cRosMessageCopy(cRosMessage *m_src);
 
 cRosErrCodePack cRosMessageBuildFromDef(cRosMessage** message, cRosMessageDef* msg_def );
 
+/*! \brief Build a message of a type in an arena: the message, its fields, their values and its nested messages are
+ *         allocated in the arena instead of in the heap, and they are all freed at once by cRosArenaReset() or
+ *         cRosArenaRelease() (cRosMessageFree() and the other functions that free parts of the message do nothing with
+ *         that memory). The message does not copy its definition.
+ *         The memory released while the message is modified (e.g., the strings dropped by
+ *         cRosMessageFieldArrayClear(), which is also called to decode the arrays of strings) is only reused after the
+ *         arena is reset, so a message that is decoded many times should be rebuilt in a reset arena from time to time,
+ *         or be allocated in the heap.
+ *         The messages added to an arena message (e.g., by cRosMessageFieldArrayPushBackMsg()) must be allocated in
+ *         the same arena.
+ *         The fields of an arena message are copied instead of moved by the message queues, and it cannot borrow
+ *         received packets (cRosMessageDeserializeBorrow() copies its arrays).
+ *
+ *  \param message_ptr Output parameter: the new message
+ *  \param msg_def Definition of the type, which must be kept while the message is used (e.g., the one of the node
+ *         message registry)
+ *  \param arena Arena where the message is allocated
+ *
+ *  \return Returns CROS_SUCCESS_ERR_PACK on success, or the error code pack otherwise
+ */
+cRosErrCodePack cRosMessageBuildFromDefArena(cRosMessage **message_ptr, cRosMessageDef *msg_def, CrosArena *arena);
+
 void cRosMessageFree(cRosMessage *message);
 
 void cRosMessageFieldsFree(cRosMessage *message);
@@ -128,6 +196,26 @@ void cRosMessageFieldFree(cRosMessageField *field);
 
 cRosMessageField * cRosMessageGetField(cRosMessage *message, char *field);
 
+/*! \brief Resolve the dotted path of a field (e.g., "header.stamp.secs") into a handle. All the elements of the path
+ *         but the last one must be (non-array) message fields
+ *
+ *  \param message A message of the type whose field is resolved (e.g., the message used by a publisher callback)
+ *  \param field_path Dotted path of the field
+ *  \param handle Output parameter: the resolved handle
+ *
+ *  \return Returns 0 on success, or -1 if the path does not correspond to a field of the message
+ */
+int cRosMessageFieldHandleResolve(cRosMessage *message, const char *field_path, cRosMessageFieldHandle *handle);
+
+/*! \brief Get a field of a message through a handle, in constant time
+ *
+ *  \param message A message of the type used to resolve the handle
+ *  \param handle Handle of the field, obtained from cRosMessageFieldHandleResolve()
+ *
+ *  \return Pointer to the field, or NULL if the handle does not match the message
+ */
+cRosMessageField * cRosMessageGetFieldByHandle(cRosMessage *message, const cRosMessageFieldHandle *handle);
+
 int cRosMessageSetFieldValueString(cRosMessageField* field, const char* value);
 
 int cRosMessageFieldArrayPushBackInt8(cRosMessageField *field, int8_t val);
@@ -188,12 +276,113 @@ int cRosMessageFieldArrayAtMsgSet(cRosMessageField *field, int position, cRosMes
 
 int cRosMessageFieldArrayClear(cRosMessageField *field);
 
+/*! \brief Number of bytes of a message encoded in the TCPROS wire format (see cRosMessageSerialize())
+ *
+ *  \param message Pointer to the message
+ *
+ *  \return The encoded size, including the string and variable-length array lengths
+ */
 size_t cRosMessageSize(cRosMessage *message);
 
 cRosErrCodePack cRosMessageSerialize(cRosMessage *message, DynBuffer* buffer);
 
 cRosErrCodePack cRosMessageDeserialize(cRosMessage *message, DynBuffer *buffer);
 
+/*! \brief Create a message buffer that takes the memory of a received packet
+ *
+ *  \param packet Buffer holding the packet. Its memory is moved to the new message buffer, and it is left empty
+ *
+ *  \return The new message buffer, with a reference count of 1, or NULL if it cannot be allocated (packet is not modified)
+ */
+cRosMessageBuffer *cRosMessageBufferNew(DynBuffer *packet);
+
+/*! \brief Add a reference to a message buffer
+ *
+ *  \param msg_buf Pointer to the message buffer
+ *
+ *  \return msg_buf
+ */
+cRosMessageBuffer *cRosMessageBufferRef(cRosMessageBuffer *msg_buf);
+
+/*! \brief Release a reference to a message buffer, freeing it when it was the last one
+ *
+ *  \param msg_buf Pointer to the message buffer. If NULL, nothing is done
+ */
+void cRosMessageBufferUnref(cRosMessageBuffer *msg_buf);
+
+/*! \brief Decode a message from the current position of the packet of a message buffer, without copying its
+ *         variable-length arrays of primitive values: these fields point into the packet instead (when it is aligned
+ *         for their element type, which uint8[] and int8[] always are) and the message keeps a reference to the buffer,
+ *         so the packet is retained while the message holds them, including when it is moved to a queue.
+ *         The borrowed arrays are copied to memory of their own when elements are pushed back to them.
+ *         Writing through the element pointers (e.g., cRosMessageFieldArrayAtUInt8()) modifies the packet.
+ *         A nested message removed from a borrowing message (cRosMessageFieldArrayRemoveLastMsg()) must not outlive it.
+ *
+ *  \param message Pointer to the message, already built according to its definition
+ *  \param msg_buf Message buffer containing the encoded message. The position indicator of its packet is moved to the end of the message
+ *
+ *  \return Returns CROS_SUCCESS_ERR_PACK on success, or the error code pack otherwise
+ */
+cRosErrCodePack cRosMessageDeserializeBorrow(cRosMessage *message, cRosMessageBuffer *msg_buf);
+
+/*! \brief Resumable decoder of encoded messages. It fills a message progressively with the bytes of its encoding as
+ *         they are received, in pieces of any size, so the whole encoded message does not need to be buffered first.
+ *         Don't access its members: use the related functions instead
+ */
+typedef struct cRosMessageDecoder cRosMessageDecoder;
+
+/*! \brief Create a decoder that fills a message
+ *
+ *  \param message Pointer to the message, already built according to its definition. It must be kept while the decoder is used
+ *
+ *  \return Pointer to the decoder, which must be freed with cRosMessageDecoderFree(), or NULL if it cannot be allocated
+ */
+cRosMessageDecoder *cRosMessageDecoderNew(cRosMessage *message);
+
+/*! \brief Free a decoder. Its message is not freed
+ *
+ *  \param decoder Pointer to the decoder. It can be NULL
+ */
+void cRosMessageDecoderFree(cRosMessageDecoder *decoder);
+
+/*! \brief Start decoding a message. A decoding in progress is abandoned
+ *
+ *  \param decoder Pointer to the decoder
+ *  \param size Number of bytes of the encoded message. The lengths of the received arrays and strings are checked
+ *              against it before allocating memory for them
+ */
+void cRosMessageDecoderStart(cRosMessageDecoder *decoder, size_t size);
+
+/*! \brief Decode the next bytes of the encoded message. The fields of the message are overwritten as their values
+ *         are received, reusing their memory like cRosMessageDeserialize() does. The bytes after the end of the
+ *         message and the ones received after an error are ignored
+ *
+ *  \param decoder Pointer to the decoder
+ *  \param data Next bytes of the encoded message
+ *  \param size Number of bytes in data
+ *
+ *  \return Returns CROS_SUCCESS_ERR_PACK if no error has been found so far, or the error code pack otherwise
+ */
+cRosErrCodePack cRosMessageDecoderFeed(cRosMessageDecoder *decoder, const void *data, size_t size);
+
+/*! \brief Check whether a decoder has been started and not finished yet
+ *
+ *  \param decoder Pointer to the decoder
+ *
+ *  \return 1 if cRosMessageDecoderStart() has been called and cRosMessageDecoderFinish() has not, 0 otherwise
+ */
+int cRosMessageDecoderIsBusy(const cRosMessageDecoder *decoder);
+
+/*! \brief End the decoding of a message. The decoder can be started again after it
+ *
+ *  \param decoder Pointer to the decoder
+ *
+ *  \return Returns CROS_SUCCESS_ERR_PACK if the whole message has been decoded, CROS_DEPACK_INSUFF_DAT_ERR if it has
+ *          not been received completely, or the error code pack that stopped the decoding. If the message is not
+ *          decoded, its fields hold a mix of old and received values
+ */
+cRosErrCodePack cRosMessageDecoderFinish(cRosMessageDecoder *decoder);
+
 CrosMessageType getMessageType(const char* type);
 
 const char * getMessageTypeString(CrosMessageType type);
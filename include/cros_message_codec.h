@@ -0,0 +1,152 @@
+/*! \file cros_message_codec.h
+ *  \brief This header file declares the CrosMessageCodec type and the support functions used by the C code generated
+ *         with cRosGentoolsGenerateC().
+ *
+ *  The generator turns a message type into a plain C struct and a set of functions specialized for it (init, release,
+ *  serialized size, serialize and deserialize), which encode the fields one after the other without any run-time type
+ *  dispatch. A CrosMessageCodec groups these functions together with the MD5 sum and full definition text of the type,
+ *  so that a publisher or a subscriber can be registered with it (see cRosApiRegisterPublisherCodec() and
+ *  cRosApiRegisterSubscriberCodec()) instead of using a cRosMessage. The request and the response of a service get a
+ *  codec each, with the MD5 sum and text of the service, to register a service provider with them (see
+ *  cRosApiRegisterServiceProviderCodec()).
+ *  The field values are stored in the generated structs as follows:
+ *  - Primitive types: as the corresponding C type (e.g., int32_t for int32, uint8_t for bool, byte and char).
+ *  - Strings: as char *, pointing to a NUL-terminated string owned by the message (NULL means an empty string).
+ *    Use cRosCodecStringSet() to change them.
+ *  - time, duration and Header: as CrosTime, CrosDuration and CrosHeader.
+ *  - Nested messages: as the generated struct of their type.
+ *  - Fixed-length arrays: as C arrays.
+ *  - Variable-length arrays: as a CROS_CODEC_ARRAY() struct. Use cRosCodecArrayResize() to change their length.
+ *    The elements between size and capacity are kept (with their strings and arrays) to be reused.
+ */
+
+#ifndef _CROS_MESSAGE_CODEC_H_
+#define _CROS_MESSAGE_CODEC_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "cros_err_codes.h"
+#include "dyn_buffer.h"
+
+/*! \defgroup cros_message_codec cROS generated message codecs */
+
+/*! \addtogroup cros_message_codec
+ *  @{
+ */
+
+/*! \brief Type of a variable-length array field whose elements are of type elem_type */
+#define CROS_CODEC_ARRAY(elem_type) struct { elem_type *data; uint32_t size; uint32_t capacity; }
+
+//! Generic view of any CROS_CODEC_ARRAY() struct, which has the same layout
+typedef CROS_CODEC_ARRAY(void) CrosCodecArray;
+
+//! Value of a time field
+typedef struct CrosTime CrosTime;
+struct CrosTime
+{
+  uint32_t secs;
+  uint32_t nsecs;
+};
+
+//! Value of a duration field
+typedef struct CrosDuration CrosDuration;
+struct CrosDuration
+{
+  int32_t secs;
+  int32_t nsecs;
+};
+
+//! Value of a Header field
+typedef struct CrosHeader CrosHeader;
+struct CrosHeader
+{
+  uint32_t seq;
+  CrosTime stamp;
+  char *frame_id;
+};
+
+/*! \brief Functions and type information of a generated message type. The functions receive a pointer to the
+ *         generated struct of the type */
+typedef struct CrosMessageCodec CrosMessageCodec;
+struct CrosMessageCodec
+{
+  const char *type;                     //! Type of the message (e.g., "std_msgs/String")
+  const char *md5sum;                   //! MD5 sum of the type
+  const char *message_definition;       //! Full text of the definition, including the text of the embedded types
+  size_t msg_size;                      //! Size of the generated struct
+  void (*init)(void *msg);              //! Set all the fields to zero (empty strings and arrays)
+  void (*release)(void *msg);           //! Free the strings and arrays owned by the message and set all the fields to zero
+  size_t (*serialized_size)(const void *msg); //! Number of bytes of the encoded message
+  cRosErrCodePack (*serialize)(const void *msg, DynBuffer *buffer); //! Append the encoded message to a buffer
+  cRosErrCodePack (*deserialize)(void *msg, DynBuffer *buffer);     //! Decode the message from the current position of a buffer
+};
+
+/*! \brief Set the value of a string field
+ *
+ *  \param str_ptr Location of the string (e.g., &msg->data)
+ *  \param value New value of the string, which is copied (NULL for an empty string)
+ *
+ *  \return Returns 0 on success, -1 if the memory cannot be allocated (then the string is not modified)
+ */
+int cRosCodecStringSet(char **str_ptr, const char *value);
+
+/*! \brief Change the number of elements of a variable-length array field. New elements are zero, and the memory of
+ *         the array is only reallocated if its capacity is not enough
+ *
+ *  \param array Location of the array (e.g., &msg->points), which is a CROS_CODEC_ARRAY() struct
+ *  \param elem_size Size of an array element (e.g., sizeof(msg->points.data[0]))
+ *  \param size New number of elements
+ *
+ *  \return Returns 0 on success, -1 if the memory cannot be allocated (then the array is not modified)
+ */
+int cRosCodecArrayResize(void *array, size_t elem_size, uint32_t size);
+
+/*! \brief Free the storage of a variable-length array field. The elements must be released before
+ *
+ *  \param array Location of the array
+ */
+void cRosCodecArrayRelease(void *array);
+
+//! Number of bytes of an encoded string
+size_t cRosCodecStringSize(const char *str);
+
+//! Append an encoded string to a buffer
+cRosErrCodePack cRosCodecWriteString(DynBuffer *buffer, const char *str);
+
+//! Decode a string from the current position of a buffer, reusing the string memory
+cRosErrCodePack cRosCodecReadString(DynBuffer *buffer, char **str_ptr);
+
+//! Append n bytes to a buffer
+cRosErrCodePack cRosCodecWriteBytes(DynBuffer *buffer, const void *data, size_t n);
+
+//! Copy n bytes from the current position of a buffer
+cRosErrCodePack cRosCodecReadBytes(DynBuffer *buffer, void *data, size_t n);
+
+/*! \brief Decode the length of a variable-length array field and resize the array accordingly
+ *
+ *  \param buffer Buffer with the encoded array
+ *  \param array Location of the array
+ *  \param elem_size Size of an array element in memory
+ *  \param min_elem_wire_size Minimum number of bytes of an encoded element, used to reject lengths that cannot fit in
+ *         the remaining data before allocating memory for them
+ *
+ *  \return Returns CROS_SUCCESS_ERR_PACK on success, or the error code pack otherwise
+ */
+cRosErrCodePack cRosCodecReadArrayLength(DynBuffer *buffer, void *array, size_t elem_size, size_t min_elem_wire_size);
+
+//! Free the frame_id of a Header and set all its fields to zero
+void cRosCodecHeaderRelease(CrosHeader *header);
+
+//! Number of bytes of an encoded Header
+size_t cRosCodecHeaderSize(const CrosHeader *header);
+
+//! Append an encoded Header to a buffer
+cRosErrCodePack cRosCodecWriteHeader(DynBuffer *buffer, const CrosHeader *header);
+
+//! Decode a Header from the current position of a buffer
+cRosErrCodePack cRosCodecReadHeader(DynBuffer *buffer, CrosHeader *header);
+
+/*! @}*/
+
+#endif // _CROS_MESSAGE_CODEC_H_
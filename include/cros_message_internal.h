@@ -100,6 +100,8 @@ void cRosMD5Readable(unsigned char* data, DynString* output);
 
 cRosErrCodePack getMD5Txt(cRosMessageDef* msg, DynString* buffer);
 
+unsigned char* getMD5Msg(cRosMessageDef* msg);
+
 cRosErrCodePack initCrosMsg(cRosMessageDef* msg);
 
 void initMsgConst(msgConst *msg);
@@ -0,0 +1,241 @@
+/*! \file cros_message_layout.h
+ *  \brief This header file declares the CrosMessageLayout type and the cRosFlatMessage type, used to store
+ *         messages in a single block of memory.
+ *
+ *  A CrosMessageLayout is compiled once from a cRosMessageDef: every field of the message gets an offset into a
+ *  contiguous block, and nested messages (including time, duration and Header fields) and fixed-length arrays are
+ *  stored inline in the block of their parent. Then, an instance of the message (cRosFlatMessage) is created with a
+ *  single allocation and its fields are accessed by index, without any name lookup.
+ *  Only the data whose length is not known from the definition is stored out of the block: each string is a
+ *  pointer to its own NUL-terminated storage (NULL means an empty string) and each variable-length array is a
+ *  CrosFlatArray whose elements are stored in a separate (contiguous) buffer.
+ *  The field values are stored in the block as follows:
+ *  - Primitive types: as the corresponding C type (e.g., int32_t for int32, uint8_t for bool, byte and char).
+ *  - Strings: as char *.
+ *  - Nested messages: as the block of the nested message, described by the child layout of the field.
+ *  - Fixed-length arrays: as array_size consecutive values of elem_size bytes each.
+ *  - Variable-length arrays: as a CrosFlatArray, whose data points to size consecutive values of elem_size bytes each.
+ *
+ *  Flat messages use the same wire format as cRosMessage, so they coexist with it: a flat message can be decoded from a
+ *  packet encoded from a cRosMessage and vice versa. They are encoded and decoded by a serializer program compiled
+ *  together with the layout (see cros_message_program.h). A publisher or a subscriber can use flat messages instead
+ *  of cRosMessage (see cRosApiRegisterPublisherFlat() and cRosApiRegisterSubscriberFlat()).
+ */
+
+#ifndef _CROS_MESSAGE_LAYOUT_H_
+#define _CROS_MESSAGE_LAYOUT_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "cros_message.h"
+#include "cros_message_program.h"
+#include "dyn_buffer.h"
+
+/*! \defgroup cros_message_layout cROS flat message layout */
+
+/*! \addtogroup cros_message_layout
+ *  @{
+ */
+
+typedef struct CrosMessageLayout CrosMessageLayout;
+
+/*! \brief Layout of a single field of a message */
+typedef struct CrosMessageLayoutField CrosMessageLayoutField;
+struct CrosMessageLayoutField
+{
+  char *name;                           //! Name of the field
+  CrosMessageType type;                 //! Type of the field (or of its elements if it is an array)
+  int is_array;                         //! If 1, the field is an array
+  int array_size;                       //! Number of elements of a fixed-length array, or -1 for a variable-length array
+  size_t offset;                        //! Position of the field in the block of the message
+  size_t elem_size;                     //! Size in the block of a single value (or array element) of the field
+  CrosMessageLayout *child;             //! Layout of the nested message (NULL if the field type is primitive or string)
+};
+
+/*! \brief Compiled layout of a message type */
+struct CrosMessageLayout
+{
+  CrosMessageLayoutField *fields;       //! Fields of the message, in definition order
+  int n_fields;                         //! Number of elements of fields
+  size_t size;                          //! Size in bytes of the block of a message (a multiple of align)
+  size_t align;                         //! Alignment required by the block of a message
+  int has_external_data;                //! If 1, some fields (or fields of nested messages) are strings or variable-length arrays
+  size_t wire_size;                     //! Number of bytes of an encoded message if has_external_data is 0 (otherwise 0)
+  char md5sum[33];                      //! MD5 sum of the message definition (empty for the layouts of nested fields)
+  CrosSerialProgram program;            //! Compiled serializer of the message (empty for the layouts of nested fields)
+};
+
+/*! \brief Storage of a variable-length array field */
+typedef struct CrosFlatArray CrosFlatArray;
+struct CrosFlatArray
+{
+  void *data;                           //! Elements of the array (NULL if capacity is 0)
+  uint32_t size;                        //! Number of elements in the array
+  uint32_t capacity;                    //! Number of elements that data can hold
+};
+
+/*! \brief Location of a (possibly nested) field in the block of the messages of a layout, resolved once from its
+ *         dotted path by cRosMessageLayoutFieldHandleResolve() */
+typedef struct CrosMessageLayoutFieldHandle CrosMessageLayoutFieldHandle;
+struct CrosMessageLayoutFieldHandle
+{
+  size_t offset;                        //! Position of the field in the block of the root message
+  const CrosMessageLayoutField *field;  //! Layout of the field (NULL if the handle is not resolved)
+};
+
+/*! \brief Message stored in a single block according to a CrosMessageLayout. Don't modify its members directly */
+typedef struct cRosFlatMessage cRosFlatMessage;
+struct cRosFlatMessage
+{
+  CrosMessageLayout *layout;            //! Layout of the message. It is not owned by the message
+  unsigned char *data;                  //! Block of the message, allocated together with this struct
+};
+
+/*! \brief Compile the layout of a message type from its definition
+ *
+ *  \param layout_ptr Output parameter: pointer to the new layout, which must be freed with cRosMessageLayoutFree()
+ *  \param msg_def Definition of the message. It is not referenced by the layout, so it can be freed afterwards
+ *
+ *  \return Returns CROS_SUCCESS_ERR_PACK on success, or the error code pack otherwise
+ */
+cRosErrCodePack cRosMessageLayoutBuild(CrosMessageLayout **layout_ptr, cRosMessageDef *msg_def);
+
+/*! \brief Load the definition of a message type from its file and compile its layout
+ *
+ *  \param msg_root_dir Directory that contains the message definition files of all the packages
+ *  \param msg_type Type of the message (e.g., "std_msgs/String")
+ *  \param layout_ptr Output parameter: pointer to the new layout, which must be freed with cRosMessageLayoutFree()
+ *
+ *  \return Returns CROS_SUCCESS_ERR_PACK on success, or the error code pack otherwise
+ */
+cRosErrCodePack cRosMessageLayoutNewBuild(const char *msg_root_dir, const char *msg_type, CrosMessageLayout **layout_ptr);
+
+/*! \brief Free a layout. The flat messages created from it must be freed before
+ *
+ *  \param layout Pointer to the layout (it can be NULL)
+ */
+void cRosMessageLayoutFree(CrosMessageLayout *layout);
+
+/*! \brief Find the index of a field of a layout by its name. It should be called once (e.g., when the layout is built)
+ *         and the index reused to access the field in every message
+ *
+ *  \param layout Pointer to the layout
+ *  \param field_name Name of the field
+ *
+ *  \return The index of the field, or -1 if the layout has no field with that name
+ */
+int cRosMessageLayoutGetFieldIndex(const CrosMessageLayout *layout, const char *field_name);
+
+/*! \brief Resolve the dotted path of a field (e.g., "header.stamp.secs") into a handle. All the elements of the path
+ *         but the last one must be (non-array) message fields
+ *
+ *  \param layout Pointer to the layout of the root message
+ *  \param field_path Dotted path of the field
+ *  \param handle Output parameter: the resolved handle
+ *
+ *  \return Returns 0 on success, or -1 if the path does not correspond to a field of the layout
+ */
+int cRosMessageLayoutFieldHandleResolve(const CrosMessageLayout *layout, const char *field_path, CrosMessageLayoutFieldHandle *handle);
+
+/*! \brief Release the strings and variable-length arrays stored out of a message block and reset all its fields to zero
+ *
+ *  \param layout Layout of the message
+ *  \param block Block of the message
+ */
+void cRosMessageLayoutBlockRelease(const CrosMessageLayout *layout, void *block);
+
+/*! \brief Create a message of a layout with a single allocation. All its fields are zero (empty strings and arrays)
+ *
+ *  \param layout Layout of the message, which must be kept until the message is freed
+ *
+ *  \return Pointer to the new message, or NULL if the memory cannot be allocated
+ */
+cRosFlatMessage *cRosFlatMessageNew(CrosMessageLayout *layout);
+
+/*! \brief Free a flat message and the strings and arrays that it owns
+ *
+ *  \param msg Pointer to the message (it can be NULL)
+ */
+void cRosFlatMessageFree(cRosFlatMessage *msg);
+
+/*! \brief Get the location of a field of a flat message
+ *
+ *  \param msg Pointer to the message
+ *  \param field_idx Index of the field in the message layout (see cRosMessageLayoutGetFieldIndex())
+ *
+ *  \return Pointer to the value of the field in the message block (see the storage of each type in cros_message_layout.h),
+ *          or NULL if field_idx is not valid
+ */
+void *cRosFlatMessageField(cRosFlatMessage *msg, int field_idx);
+
+/*! \brief Get the location of a (possibly nested) field of a flat message through a handle
+ *
+ *  \param msg Pointer to the message
+ *  \param handle Handle of the field, resolved with the layout of the message
+ *
+ *  \return Pointer to the value of the field in the message block, or NULL if the handle is not resolved
+ */
+void *cRosFlatMessageFieldByHandle(cRosFlatMessage *msg, const CrosMessageLayoutFieldHandle *handle);
+
+/*! \brief Set the value of a string stored in a message block
+ *
+ *  \param str_ptr Location of the string in the block (e.g., returned by cRosFlatMessageField())
+ *  \param value New value of the string, which is copied (NULL for an empty string)
+ *
+ *  \return Returns 0 on success, -1 if the memory cannot be allocated
+ */
+int cRosFlatStringSet(char **str_ptr, const char *value);
+
+/*! \brief Change the number of elements of a variable-length array field. The new elements are zero and the removed
+ *         elements are released. The array memory is only reallocated if its capacity is not enough
+ *
+ *  \param field Layout of the array field
+ *  \param array Location of the array in the block (e.g., returned by cRosFlatMessageField())
+ *  \param size New number of elements
+ *
+ *  \return Returns 0 on success, -1 if the memory cannot be allocated (then the array is not modified)
+ */
+int cRosFlatArrayResize(const CrosMessageLayoutField *field, CrosFlatArray *array, uint32_t size);
+
+/*! \brief Get the location of an element of an array field
+ *
+ *  \param field Layout of the array field
+ *  \param array_ptr Location of the array in the block (e.g., returned by cRosFlatMessageField()), either a
+ *         fixed-length array or a CrosFlatArray
+ *  \param position Index of the element
+ *
+ *  \return Pointer to the element, or NULL if position is out of the array bounds
+ */
+void *cRosFlatArrayAt(const CrosMessageLayoutField *field, void *array_ptr, uint32_t position);
+
+/*! \brief Get the number of bytes of a flat message encoded in the TCPROS wire format
+ *
+ *  \param msg Pointer to the message
+ *
+ *  \return The encoded size, including the string and variable-length array lengths
+ */
+size_t cRosFlatMessageSize(cRosFlatMessage *msg);
+
+/*! \brief Encode a flat message in the TCPROS wire format, appending it to a buffer
+ *
+ *  \param msg Pointer to the message
+ *  \param buffer Buffer where the encoded message is appended
+ *
+ *  \return Returns CROS_SUCCESS_ERR_PACK on success, or the error code pack otherwise
+ */
+cRosErrCodePack cRosFlatMessageSerialize(cRosFlatMessage *msg, DynBuffer *buffer);
+
+/*! \brief Decode a flat message from the TCPROS wire format, starting at the current position of a buffer
+ *
+ *  The storage of the strings and variable-length arrays of the message is reused when it is big enough.
+ *  \param msg Pointer to the message
+ *  \param buffer Buffer containing the encoded message. Its position indicator is moved to the end of the message
+ *
+ *  \return Returns CROS_SUCCESS_ERR_PACK on success, or the error code pack otherwise
+ */
+cRosErrCodePack cRosFlatMessageDeserialize(cRosFlatMessage *msg, DynBuffer *buffer);
+
+/*! @}*/
+
+#endif // _CROS_MESSAGE_LAYOUT_H_
@@ -0,0 +1,74 @@
+/*! \file cros_message_pool.h
+ *  \brief This header file declares the cRosMessagePool type, a free list of messages of a single type.
+ *
+ *  A cRosMessagePool keeps the messages that are given back to it (recycled) instead of freeing them, and returns them
+ *  again when a message of its type is acquired. A recycled message keeps all its memory: its strings, the capacity of
+ *  its variable-length arrays and the messages of its arrays of messages. So, once the pool has recycled a message
+ *  large enough for the traffic, acquiring a message and filling it (e.g., with cRosMessageFieldsCopy() or
+ *  cRosMessageDeserialize()) does not allocate memory.
+ *  An acquired message keeps the field values of its previous use, or the values of the pool prototype if it is new.
+ *  The messages can be acquired and recycled from any thread: the free list is protected by a mutex.
+ */
+
+#ifndef _CROS_MESSAGE_POOL_H_
+#define _CROS_MESSAGE_POOL_H_
+
+#include <pthread.h>
+
+#include "cros_message.h"
+
+/*! \defgroup cros_message_pool cROS message pools */
+
+/*! \addtogroup cros_message_pool
+ *  @{
+ */
+
+#define CROS_MESSAGE_POOL_DEFAULT_CAPACITY 4 //! Default maximum number of recycled messages kept in a pool
+
+/*! \brief Pool of messages of a type. Don't modify its members directly */
+typedef struct cRosMessagePool cRosMessagePool;
+struct cRosMessagePool
+{
+  cRosMessage *prototype;               //! Message of the pool type, copied to create a message when the pool is empty
+  cRosMessage **msgs;                   //! Recycled messages, ready to be acquired (allocated when the first one is recycled)
+  unsigned int n_msgs;                  //! Number of messages in msgs
+  unsigned int capacity;                //! Maximum number of messages kept in msgs
+  pthread_mutex_t mutex;                //! Protects msgs and n_msgs
+};
+
+/*! \brief Initialize a pool without allocating memory
+ *
+ *  \param pool Pointer to the pool
+ *  \param prototype Message of the pool type, which must be kept unmodified while the pool is used (it is copied
+ *                   without lock). The pool does not free it
+ *  \param capacity Maximum number of recycled messages kept in the pool, or 0 to use CROS_MESSAGE_POOL_DEFAULT_CAPACITY
+ */
+void cRosMessagePoolInit(cRosMessagePool *pool, cRosMessage *prototype, unsigned int capacity);
+
+/*! \brief Take a message from a pool. If the pool is empty, a copy of its prototype (including its definition) is
+ *         created
+ *
+ *  \param pool Pointer to the pool
+ *
+ *  \return Pointer to the message, which must be given back with cRosMessagePoolRecycle() or freed with
+ *          cRosMessageFree(). NULL if the message cannot be allocated
+ */
+cRosMessage *cRosMessagePoolAcquire(cRosMessagePool *pool);
+
+/*! \brief Give back a message to a pool. The message is freed instead if the pool is full, if it is not of the pool
+ *         type or if it holds arrays borrowed from a received packet (see cRosMessageDeserializeBorrow())
+ *
+ *  \param pool Pointer to the pool
+ *  \param message Message obtained from cRosMessagePoolAcquire() (or any other heap message). It can be NULL
+ */
+void cRosMessagePoolRecycle(cRosMessagePool *pool, cRosMessage *message);
+
+/*! \brief Free all the messages kept in a pool and its mutex. The pool must be initialized again to be used again
+ *
+ *  \param pool Pointer to the pool
+ */
+void cRosMessagePoolRelease(cRosMessagePool *pool);
+
+/*! @}*/
+
+#endif // _CROS_MESSAGE_POOL_H_
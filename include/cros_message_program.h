@@ -0,0 +1,114 @@
+/*! \file cros_message_program.h
+ *  \brief This header file declares the CrosSerialProgram type, used to encode and decode flat messages.
+ *
+ *  A CrosSerialProgram is compiled once from the CrosMessageLayout of a message type (see cRosMessageLayoutBuild()) and
+ *  turns the walk over the fields of the layout into a flat list of op-codes that are run by a small interpreter over
+ *  the block of a message. The compiler:
+ *  - Inlines the nested messages (including time, duration and Header fields) into the program of their parent, since
+ *    they are stored inline in its block.
+ *  - Fuses the primitive values that are consecutive both in the wire format and in the block (e.g., the fields of a
+ *    Point, or the secs and nsecs of a time) into a single copy op, and so the fixed-length arrays of these values.
+ *  - Encodes the variable-length arrays whose elements are copied as a whole with a single copy of all their elements.
+ *  The fields that are separated by padding in the block, the strings and the other arrays keep their own ops.
+ */
+
+#ifndef _CROS_MESSAGE_PROGRAM_H_
+#define _CROS_MESSAGE_PROGRAM_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "cros_err_codes.h"
+#include "dyn_buffer.h"
+
+/*! \defgroup cros_message_program cROS flat message serializer programs */
+
+/*! \addtogroup cros_message_program
+ *  @{
+ */
+
+struct CrosMessageLayout;
+struct CrosMessageLayoutField;
+
+/*! \brief Operation codes of a CrosSerialProgram */
+typedef enum CrosSerialOpCode
+{
+  CROS_SERIAL_OP_COPY,                  //! Copy size bytes from/to offset
+  CROS_SERIAL_OP_STRING,                //! Length-prefixed string, stored at offset as a char *
+  CROS_SERIAL_OP_LOOP,                  //! Run the next body_len ops count times, the i-th time over the block at offset + i * size
+  CROS_SERIAL_OP_ARRAY,                 //! Variable-length array at offset: its length, then the next body_len ops over each element
+  CROS_SERIAL_OP_ARRAY_COPY             //! Variable-length array at offset: its length, then all its elements copied at once
+} CrosSerialOpCode;
+
+/*! \brief A single operation of a CrosSerialProgram */
+typedef struct CrosSerialOp CrosSerialOp;
+struct CrosSerialOp
+{
+  CrosSerialOpCode code;                //! Operation code
+  size_t offset;                        //! Position of the value in the block where the op is run
+  size_t size;                          //! Number of bytes to copy (COPY) or size of an element (LOOP, ARRAY and ARRAY_COPY)
+  uint32_t count;                       //! Number of iterations (LOOP)
+  int body_len;                         //! Number of ops following this one that are run for each element (LOOP and ARRAY)
+  size_t min_elem_wire_size;            //! Minimum number of encoded bytes of an element (ARRAY and ARRAY_COPY)
+  const struct CrosMessageLayoutField *field; //! Layout of the array field, used to resize it (ARRAY and ARRAY_COPY)
+};
+
+/*! \brief Compiled serializer of a message layout */
+typedef struct CrosSerialProgram CrosSerialProgram;
+struct CrosSerialProgram
+{
+  CrosSerialOp *ops;                    //! Operations of the program, run in order
+  int n_ops;                            //! Number of elements of ops
+  int capacity;                         //! Number of elements that ops can hold
+  int can_merge_copy;                   //! Used while compiling: if 1, the last op is a copy that can be extended
+};
+
+/*! \brief Compile the serializer program of a layout
+ *
+ *  \param prog Pointer to the program to fill, which must be released with cRosSerialProgramRelease()
+ *  \param layout Layout of the message. It must be kept while the program is used, since the array ops reference
+ *         its fields
+ *
+ *  \return Returns 0 on success, -1 if the memory cannot be allocated
+ */
+int cRosSerialProgramCompile(CrosSerialProgram *prog, const struct CrosMessageLayout *layout);
+
+/*! \brief Free the operations of a program
+ *
+ *  \param prog Pointer to the program
+ */
+void cRosSerialProgramRelease(CrosSerialProgram *prog);
+
+/*! \brief Run a program to compute the number of bytes of an encoded message block
+ *
+ *  \param prog Pointer to the program
+ *  \param block Block of the message
+ *
+ *  \return The encoded size of the message
+ */
+size_t cRosSerialProgramSize(const CrosSerialProgram *prog, const void *block);
+
+/*! \brief Run a program to encode a message block, appending it to a buffer. The space of the whole message is
+ *         reserved in the buffer before encoding it
+ *
+ *  \param prog Pointer to the program
+ *  \param block Block of the message
+ *  \param buffer Buffer where the encoded message is appended
+ *
+ *  \return Returns CROS_SUCCESS_ERR_PACK on success, or the error code pack otherwise
+ */
+cRosErrCodePack cRosSerialProgramSerialize(const CrosSerialProgram *prog, const void *block, DynBuffer *buffer);
+
+/*! \brief Run a program to decode a message block from the current position of a buffer
+ *
+ *  \param prog Pointer to the program
+ *  \param block Block of the message
+ *  \param buffer Buffer containing the encoded message. Its position indicator is moved to the end of the message
+ *
+ *  \return Returns CROS_SUCCESS_ERR_PACK on success, or the error code pack otherwise
+ */
+cRosErrCodePack cRosSerialProgramDeserialize(const CrosSerialProgram *prog, void *block, DynBuffer *buffer);
+
+/*! @}*/
+
+#endif // _CROS_MESSAGE_PROGRAM_H_
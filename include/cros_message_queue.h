@@ -4,6 +4,13 @@
  *  cRosMessageQueue implements a queue of TCPROS-protocol messages. This queue behaves as a
  *  FIFO (First In First Out).
  *  This queue is only stores the fields of the messages (fields fields of the struct), not the message definition (msgDef field).
+ *  Its capacity is set per queue (e.g., the queue_size of a subscribed topic). The messages are kept in a CrosRingBuffer
+ *  as a pool: their containers are allocated when the first message is added and reused afterwards. The fields of the
+ *  removed messages are also kept in their containers, so a message added later to the same container reuses their
+ *  memory if it is of the same type.
+ *  One thread can add messages (cRosMessageQueueAdd(), cRosMessageQueueAddSwap()) while another one extracts them
+ *  (cRosMessageQueueExtract(), cRosMessageQueueExtractSwap(), cRosMessageQueueRemove()) without locks. The rest of
+ *  the functions that modify the queue must not run concurrently with any other call.
  *  \author Richard R. Carrillo. Aging in Vision and Action lab, Institut de la Vision, Sorbonne University, Paris, France.
  *  \date 31 Oct 2017
  */
@@ -12,15 +19,14 @@
 #define _CROS_MESSAGE_QUEUE_H_
 
 #include "cros_message.h"
+#include "cros_ring_buffer.h"
 
 
-#define MAX_QUEUE_LEN 3 //! Maximum number of messages that can be hold in the queue
+#define DEFAULT_QUEUE_LEN 3 //! Default maximum number of messages that can be hold in a queue
 
 struct cRosMessageQueue
 {
-  cRosMessage msgs[MAX_QUEUE_LEN]; //! Content of the queue
-  unsigned int length; //! Number of messages currently in the queue
-  unsigned int first_msg_ind; //! Index of the oldest message in the queue (the one that was inserted first)
+  CrosRingBuffer msgs; //! Content of the queue: a ring of cRosMessage containers
 };
 
 typedef struct cRosMessageQueue cRosMessageQueue;
@@ -32,6 +38,14 @@ typedef struct cRosMessageQueue cRosMessageQueue;
  */
 void cRosMessageQueueInit(cRosMessageQueue *q);
 
+/*! \brief Set the maximum number of messages of a queue.
+ *
+ *  The messages currently in the queue are removed.
+ *  \param q Pointer to the queue.
+ *  \param capacity Maximum number of messages. If it is 0, DEFAULT_QUEUE_LEN is used.
+ */
+void cRosMessageQueueSetCapacity(cRosMessageQueue *q, unsigned int capacity);
+
 /*! \brief Empty queue.
  *
  *  This function removes all the messages in a queue.
@@ -69,6 +83,19 @@ unsigned int cRosMessageQueueUsage(cRosMessageQueue *q);
  */
 int cRosMessageQueueAdd(cRosMessageQueue *q, cRosMessage *m);
 
+/*! \brief Add a new message at the end of the queue by transferring its fields.
+ *
+ *  This function adds a new element (message) at the end of the queue without copying it: the fields of the message pointed by m
+ *  are exchanged with the fields that the queue kept from a previously extracted message of the same type, so no memory is allocated.
+ *  After the call m holds these old fields (with undefined values), so it can be filled again (e.g., by cRosMessageDeserialize()).
+ *  If the queue has no such fields (e.g., the first messages added to it) or m is allocated in an arena, the message is copied as
+ *  cRosMessageQueueAdd() does.
+ *  \param q Pointer to the queue.
+ *  \param m Pointer to the message to be added.
+ *  \return 0 on success, otherwise an error code: -1 = error allocating memory, -2 = No free space to add a new element.
+ */
+int cRosMessageQueueAddSwap(cRosMessageQueue *q, cRosMessage *m);
+
 /*! \brief Extract the first message of the queue.
  *
  *  This function removes a element (message) at the start of the queue. The fields of the message at the start of the queue will be copied
@@ -80,6 +107,19 @@ int cRosMessageQueueAdd(cRosMessageQueue *q, cRosMessage *m);
  */
 int cRosMessageQueueExtract(cRosMessageQueue *q, cRosMessage *m);
 
+/*! \brief Extract the first message of the queue by transferring its fields.
+ *
+ *  This function removes a element (message) at the start of the queue without copying it: the fields of the message pointed by m
+ *  are exchanged with the fields of the removed message, so no memory is allocated. The previous fields of m are kept by the queue
+ *  and reused by cRosMessageQueueAddSwap(), so m should be a message of the same type as the queue messages. If m is allocated in an
+ *  arena, the message is copied as cRosMessageQueueExtract() does.
+ *  \param q Pointer to the queue.
+ *  \param m Pointer to the message that receives the fields of the removed message.
+ *  \return 0 on success, otherwise an error code: -1 = error allocating memory (only if m is allocated in an arena), -2 = No messages
+ *          in the queue.
+ */
+int cRosMessageQueueExtractSwap(cRosMessageQueue *q, cRosMessage *m);
+
 /*! \brief Get a copy of the first message from the queue.
  *
  *  This function obtains the element (message) at the start of the queue. The fields of the message at the start of the queue will be copied
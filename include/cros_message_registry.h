@@ -0,0 +1,83 @@
+/*! \file cros_message_registry.h
+ *  \brief This header file declares the CrosMessageRegistry type and associated functions.
+ *
+ *  CrosMessageRegistry is a node-wide cache of the message and service types used by the node: the first time that a
+ *  type is requested, its definition file (and the files of its dependencies) is loaded and parsed, and its MD5 sum
+ *  and full text (message_definition) are computed. The following requests of the same type (e.g., several topics
+ *  of the same type) get the same entry, so they do not access the disk again.
+ *  The entries are kept until the registry is released and their address does not change, so the registered
+ *  publishers, subscribers and services can reference their content instead of copying it.
+ */
+
+#ifndef _CROS_MESSAGE_REGISTRY_H_
+#define _CROS_MESSAGE_REGISTRY_H_
+
+#include "cros_message.h"
+#include "cros_err_codes.h"
+
+/*! \defgroup cros_message_registry cROS message type registry */
+
+/*! \addtogroup cros_message_registry
+ *  @{
+ */
+
+struct t_srvDef;
+
+/*! \brief Parsed definition of a message or service type. Don't modify its members */
+typedef struct CrosMessageRegistryEntry CrosMessageRegistryEntry;
+struct CrosMessageRegistryEntry
+{
+  char *file_path;                      //! Path of the definition file of the type (the key of the entry)
+  cRosMessageDef *msg_def;              //! Definition of the message (NULL for service types)
+  struct t_srvDef *srv_def;             //! Definition of the service (NULL for message types)
+  char *message_definition;             //! Full text of the definition, including the text of the embedded types (part of msg_def or srv_def)
+  char md5sum[33];                      //! MD5 sum of the type
+};
+
+/*! \brief Registry object. Don't modify its internal members: use
+ *         the related functions instead */
+typedef struct CrosMessageRegistry CrosMessageRegistry;
+struct CrosMessageRegistry
+{
+  CrosMessageRegistryEntry **entries;   //! Loaded types. The array is reallocated when it grows, but not the entries
+  int n_entries;                        //! Number of loaded types
+  int capacity;                         //! Number of elements that entries can hold
+};
+
+/*! \brief Initialize an empty registry
+ *
+ *  \param reg Pointer to the CrosMessageRegistry object
+ */
+void cRosMessageRegistryInit( CrosMessageRegistry *reg );
+
+/*! \brief Free all the entries of a registry. The objects referencing them must be released before
+ *
+ *  \param reg Pointer to the CrosMessageRegistry object
+ */
+void cRosMessageRegistryRelease( CrosMessageRegistry *reg );
+
+/*! \brief Get the entry of a message type, loading its definition file if it is not in the registry yet
+ *
+ *  \param reg Pointer to the CrosMessageRegistry object
+ *  \param msg_file_path Path of the .msg file of the type (e.g., obtained with cRosGetMsgFilePath())
+ *  \param entry_ptr Output parameter: pointer to the entry, which is valid until the registry is released
+ *
+ *  \return Returns CROS_SUCCESS_ERR_PACK on success, or the error code pack otherwise
+ */
+cRosErrCodePack cRosMessageRegistryGetMsg( CrosMessageRegistry *reg, const char *msg_file_path,
+                                           const CrosMessageRegistryEntry **entry_ptr );
+
+/*! \brief Get the entry of a service type, loading its definition file if it is not in the registry yet
+ *
+ *  \param reg Pointer to the CrosMessageRegistry object
+ *  \param srv_file_path Path of the .srv file of the type
+ *  \param entry_ptr Output parameter: pointer to the entry, which is valid until the registry is released
+ *
+ *  \return Returns CROS_SUCCESS_ERR_PACK on success, or the error code pack otherwise
+ */
+cRosErrCodePack cRosMessageRegistryGetSrv( CrosMessageRegistry *reg, const char *srv_file_path,
+                                           const CrosMessageRegistryEntry **entry_ptr );
+
+/*! @}*/
+
+#endif // _CROS_MESSAGE_REGISTRY_H_
@@ -0,0 +1,131 @@
+/*! \file cros_message_view.h
+ *  \brief This header file declares the cRosMessageView type, a read-only view of an encoded message.
+ *
+ *  A cRosMessageView references a message in the TCPROS wire format (e.g., the packet just received by a subscriber)
+ *  and decodes its fields on demand: the position of a field in the encoded data is found by skipping the preceding
+ *  fields according to the CrosMessageLayout of the type, and it is kept in the view so that the next accesses to it
+ *  (and to the fields before it) do not skip them again. Fields that are never read are not decoded, and no memory is
+ *  allocated: strings and arrays are returned as pointers into the encoded data.
+ *  The view is only valid while the encoded data is. In the case of a subscriber registered with
+ *  cRosApiRegisterSubscriberView(), until its callback returns.
+ *  Values returned as pointers into the encoded data are not aligned: copy them with memcpy() before using them as
+ *  anything but bytes.
+ */
+
+#ifndef _CROS_MESSAGE_VIEW_H_
+#define _CROS_MESSAGE_VIEW_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "cros_message_layout.h"
+
+/*! \defgroup cros_message_view cROS message views */
+
+/*! \addtogroup cros_message_view
+ *  @{
+ */
+
+#define CROS_MESSAGE_VIEW_INDEX_SIZE 16 //! Number of fields whose position is kept in a view (the following are found from the last one)
+
+/*! \brief View of an encoded message. Don't modify its members directly */
+typedef struct cRosMessageView cRosMessageView;
+struct cRosMessageView
+{
+  const CrosMessageLayout *layout;      //! Layout of the message type
+  const unsigned char *data;            //! Start of the encoded message
+  size_t size;                          //! Number of bytes available from data (the encoded message can be shorter)
+  int n_indexed;                        //! Number of the first fields whose position is in offsets
+  size_t offsets[CROS_MESSAGE_VIEW_INDEX_SIZE]; //! Position of the first fields, relative to data
+};
+
+/*! \brief Initialize a view of an encoded message
+ *
+ *  \param view Pointer to the view
+ *  \param layout Layout of the message type, which must be kept while the view is used
+ *  \param data Start of the encoded message
+ *  \param size Number of bytes available from data
+ */
+void cRosMessageViewInit(cRosMessageView *view, const CrosMessageLayout *layout, const void *data, size_t size);
+
+/*! \brief Get the value of a primitive (non-array) field
+ *
+ *  \param view Pointer to the view
+ *  \param field_idx Index of the field in the layout (see cRosMessageLayoutGetFieldIndex())
+ *  \param value Output parameter: the value is copied here (field elem_size bytes, e.g., an int32_t for an int32 field)
+ *
+ *  \return Returns 0 on success, or -1 if the field is not a primitive one or the encoded data is truncated
+ */
+int cRosMessageViewGetValue(cRosMessageView *view, int field_idx, void *value);
+
+/*! \brief Get the value of a string (non-array) field
+ *
+ *  \param view Pointer to the view
+ *  \param field_idx Index of the field in the layout
+ *  \param str Output parameter: start of the string in the encoded data. It is NOT NUL-terminated
+ *  \param len Output parameter: number of characters of the string
+ *
+ *  \return Returns 0 on success, or -1 if the field is not a string or the encoded data is truncated
+ */
+int cRosMessageViewGetString(cRosMessageView *view, int field_idx, const char **str, uint32_t *len);
+
+/*! \brief Get a view of a nested (non-array) message field
+ *
+ *  \param view Pointer to the view
+ *  \param field_idx Index of the field in the layout
+ *  \param msg_view Output parameter: the view of the nested message
+ *
+ *  \return Returns 0 on success, or -1 if the field is not a message or the encoded data is truncated
+ */
+int cRosMessageViewGetMsg(cRosMessageView *view, int field_idx, cRosMessageView *msg_view);
+
+/*! \brief Get the number of elements of an array field (fixed or variable-length)
+ *
+ *  \param view Pointer to the view
+ *  \param field_idx Index of the field in the layout
+ *  \param n_elems Output parameter: the number of elements
+ *
+ *  \return Returns 0 on success, or -1 if the field is not an array or the encoded data is truncated
+ */
+int cRosMessageViewGetArrayLength(cRosMessageView *view, int field_idx, uint32_t *n_elems);
+
+/*! \brief Get the elements of an array of primitive values
+ *
+ *  \param view Pointer to the view
+ *  \param field_idx Index of the field in the layout
+ *  \param values Output parameter: start of the elements in the encoded data (elem_size bytes each, not aligned)
+ *  \param n_elems Output parameter: the number of elements
+ *
+ *  \return Returns 0 on success, or -1 if the field is not an array of primitive values or the encoded data is truncated
+ */
+int cRosMessageViewGetArray(cRosMessageView *view, int field_idx, const void **values, uint32_t *n_elems);
+
+/*! \brief Get an element of an array of strings. The preceding elements are skipped to find it
+ *
+ *  \param view Pointer to the view
+ *  \param field_idx Index of the field in the layout
+ *  \param position Index of the element
+ *  \param str Output parameter: start of the string in the encoded data. It is NOT NUL-terminated
+ *  \param len Output parameter: number of characters of the string
+ *
+ *  \return Returns 0 on success, or -1 if the field is not an array of strings, position is out of the array bounds or
+ *          the encoded data is truncated
+ */
+int cRosMessageViewGetArrayString(cRosMessageView *view, int field_idx, uint32_t position, const char **str, uint32_t *len);
+
+/*! \brief Get a view of an element of an array of messages. If the elements do not have a fixed encoded size, the
+ *         preceding elements are skipped to find it
+ *
+ *  \param view Pointer to the view
+ *  \param field_idx Index of the field in the layout
+ *  \param position Index of the element
+ *  \param msg_view Output parameter: the view of the element
+ *
+ *  \return Returns 0 on success, or -1 if the field is not an array of messages, position is out of the array bounds
+ *          or the encoded data is truncated
+ */
+int cRosMessageViewGetArrayMsg(cRosMessageView *view, int field_idx, uint32_t position, cRosMessageView *msg_view);
+
+/*! @}*/
+
+#endif // _CROS_MESSAGE_VIEW_H_
@@ -0,0 +1,64 @@
+/*! \file cros_mpsc_queue.h
+ *  \brief This header file declares the CrosMpscQueue type and associated functions: a lock-free FIFO through which
+ *         any number of threads pass objects to a single consumer thread (e.g., the node I/O thread).
+ *
+ *  The queue is intrusive: each queued object embeds a CrosMpscLink, so pushing an object does not allocate memory.
+ *  A push takes a single atomic exchange, so the producers never wait for each other nor for the consumer.
+ */
+
+#ifndef _CROS_MPSC_QUEUE_H_
+#define _CROS_MPSC_QUEUE_H_
+
+#include <stddef.h>
+
+/*! \defgroup cros_mpsc_queue cROS multi-producer single-consumer queue */
+
+/*! \addtogroup cros_mpsc_queue
+ *  @{
+ */
+
+/*! \brief Link embedded in the objects passed through a CrosMpscQueue */
+typedef struct CrosMpscLink CrosMpscLink;
+struct CrosMpscLink
+{
+  CrosMpscLink *next;
+};
+
+/*! \brief Get a pointer to the object that embeds a CrosMpscLink as its member */
+#define CROS_MPSC_CONTAINER( link, type, member ) ( (type *)( (char *)(link) - offsetof( type, member ) ) )
+
+/*! \brief CrosMpscQueue object. Don't modify directly its internal members: use
+ *         the related functions instead */
+typedef struct CrosMpscQueue CrosMpscQueue;
+struct CrosMpscQueue
+{
+  CrosMpscLink *head;                   //! Last pushed link (changed by the producers)
+  CrosMpscLink *tail;                   //! Next link to pop (changed by the consumer)
+  CrosMpscLink stub;                    //! Link kept in the queue when all the objects have been popped
+};
+
+/*! \brief Initialize an empty CrosMpscQueue object
+ *
+ *  \param q Pointer to the CrosMpscQueue object
+ */
+void cRosMpscQueueInit( CrosMpscQueue *q );
+
+/*! \brief Append an object to the queue. It can be called from any thread
+ *
+ *  \param q Pointer to the CrosMpscQueue object
+ *  \param link Link embedded in the object, which must not be in any queue
+ */
+void cRosMpscQueuePush( CrosMpscQueue *q, CrosMpscLink *link );
+
+/*! \brief Remove the oldest object from the queue. It must be called only by the consumer thread
+ *
+ *  \param q Pointer to the CrosMpscQueue object
+ *
+ *  \return Link of the removed object, or NULL if the queue is empty. NULL may also be returned while a producer
+ *          is in the middle of a push: the producer must then notify the consumer after pushing (e.g., with a CrosWakeup)
+ */
+CrosMpscLink *cRosMpscQueuePop( CrosMpscQueue *q );
+
+/*! @}*/
+
+#endif
@@ -14,11 +14,19 @@
 #define _CROS_NODE_H_
 
 #include <stdint.h>
+#include <pthread.h>
 #include "xmlrpc_process.h"
 #include "tcpros_process.h"
 #include "cros_api_call.h"
 #include "cros_message_queue.h"
+#include "cros_message_registry.h"
 #include "cros_err_codes.h"
+#include "cros_poller.h"
+#include "cros_timer_heap.h"
+#include "cros_executor.h"
+#include "cros_wakeup.h"
+#include "cros_mpsc_queue.h"
+#include "cros_io_shard.h"
 
 /*! \defgroup cros_node cROS Node */
 
@@ -27,47 +35,59 @@
  */
 
 
-/*! Max num published topics */
+/*! Default initial size of the published-topic table (the table grows when needed) */
 #define CN_MAX_PUBLISHED_TOPICS 5
 
-/*! Max num subscribed topics */
+/*! Default initial size of the subscribed-topic table */
 #define CN_MAX_SUBSCRIBED_TOPICS 5
 
-/*! Max num service providers */
+/*! Default initial size of the service-provider table */
 #define CN_MAX_SERVICE_PROVIDERS 8
 
-/*! Max num service callers */
+/*! Default initial size of the service-caller table */
 #define CN_MAX_SERVICE_CALLERS 8
 
-/*! Max num parameter subscriptions */
+/*! Default initial size of the parameter-subscription table */
 #define CN_MAX_PARAMETER_SUBSCRIPTIONS 20
 
-/*! Max num serving XMLRPC connections */
+/*! Default initial num serving XMLRPC connections */
 #define CN_MAX_XMLRPC_SERVER_CONNECTIONS 5
 
-/*! Max num serving TCPROS connections */
+/*! Default initial num serving TCPROS connections */
 #define CN_MAX_TCPROS_SERVER_CONNECTIONS 5
 
-/*! Max num serving RPCROS connections */
+/*! Default initial num serving RPCROS connections */
 #define CN_MAX_RPCROS_SERVER_CONNECTIONS CN_MAX_SERVICE_PROVIDERS
 
 /*!
- * Max num XMLRPC connections against another subscribed nodes
+ * Default num XMLRPC connections against another subscribed nodes
  *  (first connection index reserved to roscore)
  * */
-#define CN_MAX_XMLRPC_CLIENT_CONNECTIONS 1 + CN_MAX_SUBSCRIBED_TOPICS
+#define CN_MAX_XMLRPC_CLIENT_CONNECTIONS (1 + CN_MAX_SUBSCRIBED_TOPICS)
 
 /*!
- * Max num TCPROS connections against another subscribed nodes
+ * Default initial num TCPROS connections against another subscribed nodes
  * */
 #define CN_MAX_TCPROS_CLIENT_CONNECTIONS CN_MAX_SUBSCRIBED_TOPICS
 
 /*!
- * Max num RPCROS connections against other service-providing nodes
+ * Default initial num RPCROS connections against other service-providing nodes
  * (service calls are one to one, so, one TcprosProcess per ServiceCallerNode)
  * */
 #define CN_MAX_RPCROS_CLIENT_CONNECTIONS CN_MAX_SERVICE_CALLERS
 
+/*! Default length of the outgoing message queue of each TCPROS connection against a subscriber */
+#define CN_TCPROS_OUT_QUEUE_LENGTH 3
+
+/*! Default minimum size (in bytes) of the messages that a subscriber decodes while they are being received */
+#define CN_SUBSCRIBER_STREAM_MIN_SIZE 65536
+
+/*! Maximum number of bytes of a message received at once by a subscriber that decodes it while it is being received */
+#define CN_SUBSCRIBER_STREAM_CHUNK_SIZE 65536
+
+/*! Maximum number of I/O shard threads that stream the published messages of a node in threaded mode */
+#define CN_MAX_IO_SHARDS 64
+
 /*! Node automatic XMLRPC ping cycle period (in msec) */
 #define CN_PING_LOOP_PERIOD 1000
 
@@ -81,6 +101,7 @@ typedef struct PublisherNode PublisherNode;
 typedef struct SubscriberNode SubscriberNode;
 typedef struct ServiceProviderNode ServiceProviderNode;
 typedef struct ServiceCallerNode ServiceCallerNode;
+typedef struct CrosNodeServiceCall CrosNodeServiceCall;
 typedef struct ParameterSubscription ParameterSubscription;
 
 typedef enum CrosNodeStatus
@@ -111,6 +132,8 @@ typedef struct CrosNodeStatusUsr
  */
 typedef void (*NodeStatusCallback)(CrosNodeStatusUsr *status, void* context);
 
+/*! Callback that serializes the next message of a periodic publication into buffer. send_queue_msg is always 0: the
+ *  messages published with cRosNodeSendTopicMsg() are serialized when they are sent */
 typedef cRosErrCodePack (*PublisherCallback)(DynBuffer *buffer, int send_queue_msg, void* context);
 
 /*! Structure that define a published topic */
@@ -124,12 +147,19 @@ struct PublisherNode
   void *context;
   PublisherCallback callback;               //! The callback called to generate the (raw) packet data of type topic_type
   NodeStatusCallback status_callback;
-  int loop_period;                          //! Period (in msec) for publication cycle
-  cRosMessageQueue msg_queue;               //! Messages on this topic wait in this queue to be send for every process
+  int64_t loop_period_ns;                   //! Period (in nsec) for publication cycle (-1 if the publication is paused)
+  int queue_size;                           //! Maximum number of published messages waiting to be sent to each subscriber
+  TcprosFrame *periodic_frame;              //! Serialized packet of the last periodic publication cycle, shared by the processes of that cycle
+  uint64_t periodic_frame_time;             //! Start time (in nsec, see cRosClockGetTimeNs()) of the publication cycle of periodic_frame
 };
 
 typedef cRosErrCodePack (*SubscriberCallback)(DynBuffer *buffer,  void* context);
 
+/*! \brief Callback of a subscriber that receives its messages already decoded (see SubscriberNode::msg_callback).
+ *         The message belongs to the connection that decoded it: the callback can swap its fields but not keep it
+ */
+typedef cRosErrCodePack (*SubscriberMessageCallback)(cRosMessage *message, void* context);
+
 /*! Structure that define a subscribed topic
  */
 struct SubscriberNode
@@ -141,8 +171,11 @@ struct SubscriberNode
   unsigned char tcp_nodelay;                //! If 1, the publisher should set TCP_NODELAY on the socket, if possible
   void *context;
   SubscriberCallback callback;
+  SubscriberMessageCallback msg_callback;   //! If not NULL, the messages of at least stream_min_size bytes are decoded while they are received and passed to it instead of to callback
+  cRosMessage *msg_prototype;               //! Message of the topic type, copied by each connection to create the message that it decodes (used with msg_callback)
+  size_t stream_min_size;                   //! Minimum size (in bytes) of the messages passed to msg_callback
   NodeStatusCallback status_callback;
-  cRosMessageQueue msg_queue;               //! Each time a message on this topic is received it is queued here
+  cRosMessageQueue msg_queue;               //! Each time a message on this topic is received it is queued here (its capacity is the topic queue_size)
   unsigned char msg_queue_overflow;         //! If 1, the subscriber tried to insert a message in the queue but it was full
 };
 
@@ -178,8 +211,9 @@ struct ServiceCallerNode
   void *context;
   ServiceCallerCallback callback;
   NodeStatusCallback status_callback;
-  int loop_period;                          //! Period (in msec) for service-call cycle
+  int64_t loop_period_ns;                   //! Period (in nsec) for service-call cycle (-1 if the calling is paused)
   cRosMessageQueue msg_queue;               //! Service requests and service responses for this service wait in this queue to be send
+  CrosNodeServiceCall *posted_calls;        //! Calls made by other threads in threaded mode: the first one is attended by the I/O thread
 };
 
 struct ParameterSubscription
@@ -230,9 +264,93 @@ typedef enum CrosLogLevel //!Logging levels
   CROS_LOGLEVEL_FATAL = 16
 } CrosLogLevel;
 
+/*! \brief Capacity configuration of a CrosNode, used by cRosNodeCreateWithConfig().
+ *         Initialize it with cRosNodeConfigInit() and then change the required fields.
+ *
+ *  The values are the initial sizes of the node tables. All the tables but the XMLRPC-client one grow
+ *  automatically when a new element is registered or a new connection is accepted and no free slot is left.
+ */
+typedef struct CrosNodeConfig CrosNodeConfig;
+struct CrosNodeConfig
+{
+  CrosPollerBackend poller_backend;     //! Backend used to wait for socket events (see cRosNodeCreateWithPoller())
+  int published_topics;                 //! Initial size of the published-topic table
+  int subscribed_topics;                //! Initial size of the subscribed-topic table
+  int service_providers;                //! Initial size of the service-provider table
+  int service_callers;                  //! Initial size of the service-caller table (and of the RPCROS client connections)
+  int parameter_subscriptions;          //! Initial size of the parameter-subscription table
+  int xmlrpc_client_connections;        //! Number of XMLRPC client connections, including the one reserved to roscore (at least 2). This table does not grow
+  int xmlrpc_server_connections;        //! Initial number of serving XMLRPC connections
+  int tcpros_client_connections;        //! Initial number of TCPROS connections against publishers
+  int tcpros_server_connections;        //! Initial number of TCPROS connections against subscribers
+  int rpcros_server_connections;        //! Initial number of serving RPCROS connections
+  int tcpros_out_queue_length;          //! Maximum number of published messages waiting to be sent to each subscriber, for the publishers registered with queue_size 0
+  CrosOutQueuePolicy tcpros_out_queue_policy; //! What to do when a message is published and the queue of a subscriber is full
+  int tcpros_io_shards;                 //! Number of I/O shard threads that send the published messages in threaded mode (0: the I/O thread sends them). At most CN_MAX_IO_SHARDS
+};
+
+/*! \brief Handles of the fields of the rosgraph_msgs/Log messages that the node publishes in /rosout.
+ *         They are resolved (and their types checked) before registering the /rosout publisher
+ */
+typedef struct CrosRosoutFields CrosRosoutFields;
+struct CrosRosoutFields
+{
+  int resolved;                         //! If 1, all the handles are resolved
+  cRosMessageFieldHandle seq, stamp_secs, stamp_nsecs, frame_id;
+  cRosMessageFieldHandle level, name, msg, file, function, line, topics;
+};
+
+/*! \brief Slot bookkeeping of a node table (publishers, subscribers, processes...).
+ *
+ *  The elements of a table are always addressed by their index, which does not change when the table grows.
+ *  However the table array is reallocated when it grows, so pointers to its elements must not be kept across
+ *  calls that can register new elements (e.g., user callbacks).
+ */
+typedef struct CrosNodeTable CrosNodeTable;
+struct CrosNodeTable
+{
+  int size;                     //! Number of allocated slots
+  int *free_slots;              //! Stack with the indices of the unused slots. Only the tables of registered elements use it:
+                                //! process slots are free when the process is idle
+  int n_free_slots;             //! Number of indices in free_slots
+};
+
+typedef struct CrosNode CrosNode;
+
+/*! \brief Received message or service request passed to a worker thread of the node executor (see cRosNodeStartThreads()).
+ *         NOTE: this is a cROS internal object, usually you don't need to use it.
+ */
+typedef struct CrosNodeTask CrosNodeTask;
+struct CrosNodeTask
+{
+  CrosNode *node;                       //! The node that received the message
+  int owner_idx;                        //! Index of the subscriber or service provider whose callback must be run
+  int proc_idx;                         //! Index of the RPCROS server process waiting for the response (service requests only)
+  unsigned int proc_stamp;              //! State-change count of that process when the request was dispatched
+  DynBuffer packet;                     //! The received packet, and then the response packet to be sent (service requests)
+  cRosMessage *msg;                     //! If not NULL, message decoded while it was received, passed instead of packet (subscribers only)
+  CrosNodeTask *next;                   //! Next task in the list of free or completed tasks
+};
+
+/*! \brief Service call made by another thread while the node is run by its own threads (see cRosNodeServiceCall()).
+ *         The fields below link are protected by CrosNode::recv_mutex.
+ *         NOTE: this is a cROS internal object, usually you don't need to use it.
+ */
+struct CrosNodeServiceCall
+{
+  CrosMpscLink link;                    //! Link in the posted_calls queue of the node
+  int svc_idx;                          //! Index of the service caller
+  CrosNodeServiceCall *next;            //! Next call waiting for the same service caller (accessed by the I/O thread only)
+  cRosMessage *req_msg;                 //! Request, owned by the calling thread (only accessed while abandoned is 0)
+  cRosMessage *resp_msg;                //! Message that receives the response, owned by the calling thread (same as req_msg)
+  unsigned char sent;                   //! 1 once the request has been queued in the service caller
+  unsigned char done;                   //! 1 once the call has finished: the calling thread frees it
+  unsigned char abandoned;              //! 1 if the calling thread stopped waiting: the I/O thread frees it
+  cRosErrCodePack err;                  //! Result of the call, once done
+};
+
 /*! \brief CrosNode object. Don't modify its internal members: use
  *         the related functions instead */
-typedef struct CrosNode CrosNode;
 struct CrosNode
 {
   char *name;                   //! The node name: it is the absolute name, i.e. it includes the namespace
@@ -248,40 +366,80 @@ struct CrosNode
   unsigned short roscore_port;  //! The roscore port
 
   char *message_root_path;      //! Directory with the message register
+  CrosMessageRegistry msg_registry; //! Definitions of the message and service types used by the node, loaded once
 
   CrosLogLevel log_level;
   CrosLogQueue* log_queue;
   uint32_t log_last_id;
+  CrosRosoutFields rosout_fields;       //! Fields of the published /rosout messages
 
   unsigned int next_call_id;
   ApiCallQueue master_api_queue;
   ApiCallQueue slave_api_queue;
 
   //! Manage connections for XMLRPC calls from this node to others
-  XmlrpcProcess xmlrpc_client_proc[CN_MAX_XMLRPC_CLIENT_CONNECTIONS];
+  XmlrpcProcess *xmlrpc_client_proc;
+  CrosNodeTable xmlrpc_client_proc_table;
   XmlrpcProcess xmlrpc_listner_proc;   //! Accept new XMLRPC connections from roscore or other nodes
   /*! Manage connections for XMLRPC calls from roscore or other nodes to this node */
-  XmlrpcProcess xmlrpc_server_proc[CN_MAX_XMLRPC_SERVER_CONNECTIONS];
+  XmlrpcProcess *xmlrpc_server_proc;
+  CrosNodeTable xmlrpc_server_proc_table;
 
   //! Manage connections for TCPROS calls from this node to others
-  TcprosProcess tcpros_client_proc[CN_MAX_TCPROS_CLIENT_CONNECTIONS];
+  TcprosProcess *tcpros_client_proc;
+  CrosNodeTable tcpros_client_proc_table;
   TcprosProcess tcpros_listner_proc;   //! Accept new TCPROS connections from roscore or other nodes
 
   /*! Manage connections for TCPROS between this and other nodes  */
-  TcprosProcess tcpros_server_proc[CN_MAX_TCPROS_SERVER_CONNECTIONS];
+  TcprosProcess *tcpros_server_proc;
+  CrosNodeTable tcpros_server_proc_table;
 
-  //! Manage connections for RPCROS calls from this node to others
-  TcprosProcess rpcros_client_proc[CN_MAX_RPCROS_CLIENT_CONNECTIONS];
+  //! Manage connections for RPCROS calls from this node to others (rpcros_client_proc[i] is used by service_callers[i])
+  TcprosProcess *rpcros_client_proc;
+  CrosNodeTable rpcros_client_proc_table;
   TcprosProcess rpcros_listner_proc;   //! Accept new TCPROS connections from roscore or other nodes
 
   /*! Manage connections for RPCROS between this and other nodes  */
-  TcprosProcess rpcros_server_proc[CN_MAX_RPCROS_SERVER_CONNECTIONS];
-
-  PublisherNode pubs[CN_MAX_PUBLISHED_TOPICS];            //! All the published topic, defined by PublisherNode structures
-  SubscriberNode subs[CN_MAX_SUBSCRIBED_TOPICS];          //! All the subscribed topic, defined by PublisherNode structures
-  ServiceProviderNode service_providers[CN_MAX_SERVICE_PROVIDERS]; //! All the provided services to register
-  ServiceCallerNode service_callers[CN_MAX_SERVICE_CALLERS]; //! All the services to call
-  ParameterSubscription paramsubs[CN_MAX_PARAMETER_SUBSCRIPTIONS];
+  TcprosProcess *rpcros_server_proc;
+  CrosNodeTable rpcros_server_proc_table;
+
+  PublisherNode *pubs;                          //! All the published topic, defined by PublisherNode structures
+  CrosNodeTable pubs_table;
+  SubscriberNode *subs;                         //! All the subscribed topic, defined by PublisherNode structures
+  CrosNodeTable subs_table;
+  ServiceProviderNode *service_providers;       //! All the provided services to register
+  CrosNodeTable service_providers_table;
+  ServiceCallerNode *service_callers;           //! All the services to call
+  CrosNodeTable service_callers_table;
+  ParameterSubscription *paramsubs;
+  CrosNodeTable paramsubs_table;
+
+  CrosPoller poller;            //! Waits for I/O readiness on the sockets of all the node processes
+  CrosTimerHeap timers;         //! Deadlines of the node processes (periodic wake-ups and I/O timeouts)
+
+  /* Threaded mode (see cRosNodeStartThreads()) */
+  CrosWakeup wakeup;            //! Wakes up the node loop when other threads have work for it (e.g., a service response)
+  CrosExecutor executor;        //! Worker threads running the subscriber and service provider callbacks (no threads if they run in the node loop)
+  pthread_t io_thread;          //! Thread running the node loop
+  unsigned char io_thread_running; //! 1 while io_thread exists
+  CrosMpscQueue posted_frames;  //! Messages published by other threads, waiting for io_thread to queue them in the connections
+  unsigned char posts_pending;  //! 1 while io_thread has been woken up to attend posted_frames (accessed atomically)
+  pthread_mutex_t recv_mutex;   //! Protects the wait of the threads receiving messages (see cRosNodeReceiveTopicMsg())
+  pthread_cond_t recv_cond;     //! Signaled when a subscriber queue receives a message while recv_waiters > 0
+  int recv_waiters;             //! Number of threads waiting for recv_cond (accessed atomically)
+  CrosMpscQueue posted_calls;   //! Service calls made by other threads, waiting for io_thread to attend them (signaled as posted_frames)
+  CrosIoShard *io_shards;       //! Threads streaming the TCPROS server connections that have completed their handshake
+  int n_io_shards;              //! Number of started io_shards
+  CrosMpscQueue io_shard_events; //! Connections closed by io_shards, waiting for io_thread to release their processes (signaled as posted_frames)
+  pthread_mutex_t tasks_mutex;  //! Protects the fields below
+  unsigned char io_thread_exit; //! If 1, io_thread must finish
+  cRosErrCodePack io_thread_err; //! Error that made io_thread finish
+  CrosNodeTask *free_tasks;     //! Tasks that can be reused
+  CrosNodeTask *done_tasks;     //! Service requests whose response has been prepared by the executor, waiting to be sent
+
+  int tcpros_out_queue_length;  //! Default capacity of the outgoing message queue of each TCPROS server process
+  CrosOutQueuePolicy tcpros_out_queue_policy; //! Overflow policy of the outgoing message queues
+  int tcpros_io_shards;         //! Number of io_shards started by cRosNodeStartThreads()
 
   int n_pubs;                   //! Number of node's published topics
   int n_subs;                   //! Number of node's subscribed topics
@@ -315,6 +473,45 @@ void cRosGetMsgFilePath(CrosNode *node, char *buffer, size_t bufsize, const char
 CrosNode *cRosNodeCreate(char* node_name, char *node_host, char *roscore_host, unsigned short roscore_port,
                          char *message_root_path );
 
+/*! \brief Dynamically create a CrosNode instance that uses a specific backend to wait for socket events.
+ *         cRosNodeCreate() is equivalent to this function with the CROS_POLLER_SELECT backend
+ *
+ *  \param node_name The node name: it is the absolute name, i.e. it should includes the namespace
+ *  \param node_host The node host (ipv4, e.g. 192.168.0.2)
+ *  \param roscore_host The roscore host (ipv4, e.g. 192.168.0.1)
+ *  \param roscore_port The roscore port
+ *  \param message_root_path Directory with the message register
+ *  \param poller_backend CROS_POLLER_SELECT or CROS_POLLER_EPOLL. The epoll backend keeps the sockets registered between
+ *         loop cycles and only attends the ready ones, which scales better for nodes with many connections (Linux only)
+ *
+ *  \return A pointer to the new CrosNode on success, NULL on failure (e.g. the backend is not available)
+ */
+CrosNode *cRosNodeCreateWithPoller(char* node_name, char *node_host, char *roscore_host, unsigned short roscore_port,
+                                   char *message_root_path, CrosPollerBackend poller_backend );
+
+/*! \brief Initialize a CrosNodeConfig object with the default capacities (CN_MAX_* values), the select() backend,
+ *         outgoing queues of CN_TCPROS_OUT_QUEUE_LENGTH messages that drop the oldest message when they are full
+ *         and no I/O shard threads
+ *
+ *  \param config Pointer to the CrosNodeConfig object
+ */
+void cRosNodeConfigInit( CrosNodeConfig *config );
+
+/*! \brief Dynamically create a CrosNode instance with a specific capacity configuration.
+ *         cRosNodeCreate() is equivalent to this function with a configuration initialized by cRosNodeConfigInit()
+ *
+ *  \param node_name The node name: it is the absolute name, i.e. it should includes the namespace
+ *  \param node_host The node host (ipv4, e.g. 192.168.0.2)
+ *  \param roscore_host The roscore host (ipv4, e.g. 192.168.0.1)
+ *  \param roscore_port The roscore port
+ *  \param message_root_path Directory with the message register
+ *  \param config Initial sizes of the node tables and poller backend. If NULL, the default configuration is used
+ *
+ *  \return A pointer to the new CrosNode on success, NULL on failure
+ */
+CrosNode *cRosNodeCreateWithConfig(char* node_name, char *node_host, char *roscore_host, unsigned short roscore_port,
+                                   char *message_root_path, const CrosNodeConfig *config );
+
 /*! \brief Unregister from ROS master and release all the internal allocated memory for a CrosNode
  *          object previously crated with cRosNodeCreate()
  *
@@ -358,6 +555,74 @@ cRosErrCodePack cRosNodeDoEventsLoop ( CrosNode *n, uint64_t timeout );
  */
 cRosErrCodePack cRosNodeStart( CrosNode *n, unsigned long time_out, unsigned char *exit_flag );
 
+/*! \brief Run the cROS node in its own threads, and return immediately.
+ *
+ *  An I/O thread runs cRosNodeDoEventsLoop(): it owns the sockets and the state of the node processes, and it runs the
+ *  publisher, service caller and status callbacks. The subscriber and service provider callbacks are passed to
+ *  n_workers worker threads: the callbacks of a subscriber (or of a service provider) are run one at a time and in the
+ *  order the messages (or requests) were received, while the callbacks of different ones may run in parallel.
+ *  Meanwhile, other threads can publish messages and receive the messages of the subscriber queues (see
+ *  cRosNodeSendTopicMsg() and cRosNodeReceiveTopicMsg()) and call the services (see cRosNodeServiceCall()), but the
+ *  rest of the functions that run the node loop (e.g., cRosNodeStart()) fail with CROS_NODE_THREADED_ERR, and the
+ *  subscribers, publishers and services must be registered before calling this function and unregistered after
+ *  cRosNodeStopThreads().
+ *  If the node was created with CrosNodeConfig::tcpros_io_shards > 0, that number of I/O shard threads is started as
+ *  well: once a subscriber connection has completed its handshake, it is moved to the least loaded shard, which sends
+ *  it the published messages with its own poller (see cros_io_shard.h). The connections go back to the node when the
+ *  threads are stopped.
+ *  \param n A pointer to a CrosNode object (e.g., created with cRosNodeCreate())
+ *  \param n_workers Number of worker threads. If 0, all the callbacks run in the I/O thread
+ *  \return CROS_SUCCESS_ERR_PACK (0) on success
+ */
+cRosErrCodePack cRosNodeStartThreads( CrosNode *n, int n_workers );
+
+/*! \brief Stop the threads started by cRosNodeStartThreads(), once the worker threads have run the callbacks of the messages
+ *         already received. The node can then be used again from the calling thread (e.g., with cRosNodeStart())
+ *
+ *  \param n A pointer to a CrosNode object
+ *  \return CROS_SUCCESS_ERR_PACK (0) if the I/O thread ran without errors. Otherwise the error code pack that made it finish
+ */
+cRosErrCodePack cRosNodeStopThreads( CrosNode *n );
+
+/*! \brief Get a task to pass a received message or service request to the executor of the node. It can be called from any thread
+ *
+ *  \param n A pointer to a CrosNode object
+ *  \return A pointer to the task (with an empty packet), or NULL if it cannot be allocated
+ */
+CrosNodeTask *cRosNodeAcquireTask( CrosNode *n );
+
+/*! \brief Give back a task obtained with cRosNodeAcquireTask(), so that it can be reused. It can be called from any thread
+ *
+ *  \param n A pointer to a CrosNode object
+ *  \param task Pointer to the task
+ */
+void cRosNodeReleaseTask( CrosNode *n, CrosNodeTask *task );
+
+/*! \brief Pass to the node loop a task whose packet holds the response to a service request, so that it is sent by the
+ *         RPCROS server process that received the request. It can be called from any thread
+ *
+ *  \param n A pointer to a CrosNode object
+ *  \param task Pointer to the task
+ */
+void cRosNodeCompleteTask( CrosNode *n, CrosNodeTask *task );
+
+/*! \brief Wake up the threads waiting in cRosNodeReceiveTopicMsg() after a subscriber callback has added a message to its
+ *         queue. It can be called from any thread
+ *
+ *  \param n A pointer to a CrosNode object
+ */
+void cRosNodeNotifyReceivers( CrosNode *n );
+
+/*! \brief Publish a message already encoded in a TCPROS frame (see cRosMessageOpenPublicationFrame()): the frame is
+ *         queued in every connection of the publisher, as in cRosNodeSendTopicMsg(). It can be called from any thread
+ *
+ *  \param node A pointer to a CrosNode object
+ *  \param pubidx Index of the publisher, which must be registered
+ *  \param frame Pointer to the frame. Its reference is taken by the function, also on failure
+ *  \return CROS_SUCCESS_ERR_PACK on success, otherwise an error code
+ */
+cRosErrCodePack cRosNodeSendTopicFrame( CrosNode *node, int pubidx, TcprosFrame *frame );
+
 XmlrpcParam * cRosNodeGetParameterValue( CrosNode *n, const char *key);
 /*! @}*/
 
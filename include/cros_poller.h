@@ -0,0 +1,207 @@
+/*! \file cros_poller.h
+ *  \brief This header file declares the CrosPoller type and associated functions, used by the node
+ *         main loop to wait for I/O readiness on the sockets of its processes.
+ *
+ *  Two backends are available:
+ *  - CROS_POLLER_SELECT: the portable select()-based backend. The monitored file descriptors
+ *    are kept in persistent sets, which are copied before each wait.
+ *  - CROS_POLLER_EPOLL: the epoll()-based backend (only on Linux). The file descriptors stay
+ *    registered in the kernel, so that a wait only reports the processes that are actually ready.
+ *    It is not limited by FD_SETSIZE.
+ *
+ *  In both backends the watched events of a process are only updated when the process changes its state:
+ *  the process entry is bound to the poller (see cRosPollerEntryBind()), its state changes are queued
+ *  with cRosPollerEntryNotify(), and the owner of the poller watches again the queued entries
+ *  (see cRosPollerPopChange()) before the next wait.
+ */
+
+#ifndef _CROS_POLLER_H_
+#define _CROS_POLLER_H_
+
+#include <stdint.h>
+#include <sys/select.h>
+
+#if defined(__linux__)
+#  define CROS_POLLER_HAS_EPOLL 1
+#else
+#  define CROS_POLLER_HAS_EPOLL 0
+#endif
+
+/* epoll_pwait2() (glibc 2.35) waits with a nanosecond timeout instead of a millisecond one */
+#define CROS_POLLER_HAS_EPOLL_PWAIT2 0
+#if CROS_POLLER_HAS_EPOLL && defined(__GLIBC_PREREQ)
+#  if __GLIBC_PREREQ(2, 35)
+#    undef CROS_POLLER_HAS_EPOLL_PWAIT2
+#    define CROS_POLLER_HAS_EPOLL_PWAIT2 1
+#  endif
+#endif
+
+/*! \defgroup cros_poller cROS poller */
+
+/*! \addtogroup cros_poller
+ *  @{
+ */
+
+typedef enum CrosPollerBackend
+{
+  CROS_POLLER_SELECT = 0,               //! select()-based backend (default)
+  CROS_POLLER_EPOLL                     //! epoll()-based backend (Linux only)
+} CrosPollerBackend;
+
+/*! Events that can be watched for, and reported for, a file descriptor */
+enum
+{
+  CROS_POLLER_READ = 0x1,               //! The file descriptor is ready for reading (or accepting)
+  CROS_POLLER_WRITE = 0x2,              //! The file descriptor is ready for writing (or the connection is completed)
+  CROS_POLLER_ERROR = 0x4               //! An exceptional condition is pending in the file descriptor
+};
+
+typedef struct CrosPoller CrosPoller;
+
+/*! \brief Watching state of the file descriptor of a process. Each process keeps its own entry
+ *         so that the poller can avoid registering again descriptors that did not change.
+ */
+typedef struct CrosPollerEntry CrosPollerEntry;
+struct CrosPollerEntry
+{
+  CrosPoller *poller;                   //! Poller that queues the state changes of the process (NULL if the entry is not bound)
+  uint64_t tag;                         //! Tag queued in poller when the process changes its state
+  int change_pos;                       //! Position + 1 of tag in the change queue of poller when it was last queued (0 if never)
+  int fd;                               //! File descriptor watched at the last cRosPollerWatch() call (-1 if none)
+  unsigned int events;                  //! Events watched at the last cRosPollerWatch() call (0 if none)
+  unsigned int stamp;                   //! State stamp of the process at the last cRosPollerWatch() call
+  unsigned char registered;             //! If 1, fd is currently registered in the kernel (epoll backend only)
+};
+
+/*! \brief CrosPoller object. Don't modify directly its internal members: use
+ *         the related functions instead */
+struct CrosPoller
+{
+  CrosPollerBackend backend;            //! The backend used to wait for events
+  fd_set watch_r_fds, watch_w_fds, watch_err_fds; //! Watched file descriptors (select backend only)
+  fd_set r_fds, w_fds, err_fds;         //! File descriptors reported by the last wait (select backend only)
+  int max_fd;                           //! Highest watched file descriptor (select backend only)
+  uint64_t *fd_tags;                    //! Tag of the process that watches each file descriptor, allocated with the first watch (select backend only)
+  int *ready_fds;                       //! File descriptors reported by the last wait (select backend only)
+  uint64_t *changed_tags;               //! Tags of the bound entries whose processes changed their state
+  int n_changed_tags;                   //! Number of tags in changed_tags
+  int max_changed_tags;                 //! Capacity of changed_tags
+  int n_bound_entries;                  //! Number of entries bound to the poller
+  int epoll_fd;                         //! The epoll instance (epoll backend only)
+  void *ready_events;                   //! Array of events returned by the last wait (epoll backend only)
+  int max_ready_events;                 //! Capacity of ready_events
+  int n_ready_events;                   //! Number of events returned by the last wait
+  unsigned char ms_timeouts;            //! If 1, the kernel does not support epoll_pwait2(): timeouts are rounded up to milliseconds (epoll backend only)
+};
+
+/*! \brief Initialize a CrosPollerEntry object with default values
+ *
+ *  \param e Pointer to the CrosPollerEntry object
+ */
+void cRosPollerEntryInit( CrosPollerEntry *e );
+
+/*! \brief Enlarge the change queue of a poller, so that binding the next n_entries entries does not fail
+ *
+ *  \param p Pointer to the CrosPoller object
+ *  \param n_entries Number of entries that will be bound
+ *
+ *  \return Returns 0 on success, -1 if the queue cannot be enlarged
+ */
+int cRosPollerReserveBindings( CrosPoller *p, int n_entries );
+
+/*! \brief Bind the entry of a process to a poller, so that the state changes of the process are queued in it
+ *
+ *  \param p Pointer to the CrosPoller object
+ *  \param e Watching entry of the process
+ *  \param tag Value reported by cRosPollerPopChange() when the process changes its state
+ *
+ *  \return Returns 0 on success, -1 if the change queue of the poller cannot be enlarged (it cannot fail if the
+ *          binding has been reserved with cRosPollerReserveBindings())
+ */
+int cRosPollerEntryBind( CrosPoller *p, CrosPollerEntry *e, uint64_t tag );
+
+/*! \brief Queue the tag of an entry in its poller, so that the events watched for the process are updated before the
+ *         next wait. Nothing is done if the entry is not bound or its tag is still queued
+ *
+ *  \param e Watching entry of the process
+ */
+void cRosPollerEntryNotify( CrosPollerEntry *e );
+
+/*! \brief Take the tag of the last entry queued by cRosPollerEntryNotify()
+ *
+ *  \param p Pointer to the CrosPoller object
+ *  \param tag Output parameter: the tag of the entry
+ *
+ *  \return Returns 1 if a tag was taken, 0 if the queue is empty
+ */
+int cRosPollerPopChange( CrosPoller *p, uint64_t *tag );
+
+/*! \brief Initialize a CrosPoller object
+ *
+ *  \param p Pointer to the CrosPoller object
+ *  \param backend The backend to be used
+ *  \param max_events Maximum number of events reported by a single wait (at least 1)
+ *
+ *  \return Returns 0 on success, -1 on failure (e.g. the backend is not supported in this platform)
+ */
+int cRosPollerInit( CrosPoller *p, CrosPollerBackend backend, int max_events );
+
+/*! \brief Release all the internally allocated resources of a CrosPoller object
+ *
+ *  \param p Pointer to the CrosPoller object
+ */
+void cRosPollerRelease( CrosPoller *p );
+
+/*! \brief Prepare a new wait cycle, forgetting the file descriptors reported by the previous wait
+ *
+ *  \param p Pointer to the CrosPoller object
+ */
+void cRosPollerBegin( CrosPoller *p );
+
+/*! \brief Set the events that must be watched for the file descriptor of a process
+ *
+ *  The watched events are kept until the next call, which only updates them if fd, events or stamp differ from the
+ *  previous call. When a process closes its socket, it must be watched again (e.g. with fd -1) before the next wait.
+ *  \param p Pointer to the CrosPoller object
+ *  \param e Watching entry of the process
+ *  \param fd The file descriptor of the process socket (-1 if it has no socket)
+ *  \param events Bitwise OR of CROS_POLLER_READ, CROS_POLLER_WRITE and CROS_POLLER_ERROR (0 to stop watching)
+ *  \param stamp Value that changes whenever the process changes its state (e.g. a state-change counter)
+ *  \param tag Value reported by cRosPollerGetReadyTag() to identify the process
+ *
+ *  \return Returns 0 on success, -1 on failure
+ */
+int cRosPollerWatch( CrosPoller *p, CrosPollerEntry *e, int fd, unsigned int events, unsigned int stamp, uint64_t tag );
+
+/*! \brief Wait until a watched file descriptor is ready or the timeout expires
+ *
+ *  \param p Pointer to the CrosPoller object
+ *  \param timeout Maximum time to wait in nanoseconds. It is rounded up to the resolution of the backend
+ *                 (microseconds for select(), and milliseconds for epoll if epoll_pwait2() is not available)
+ *
+ *  \return Returns the number of ready file descriptors, 0 on timeout, or -1 on failure (errno is set)
+ */
+int cRosPollerWait( CrosPoller *p, uint64_t timeout_ns );
+
+/*! \brief Return the tag of a file descriptor reported by the last cRosPollerWait()
+ *
+ *  \param p Pointer to the CrosPoller object
+ *  \param ready_idx Index of the reported file descriptor, between 0 and the value returned by cRosPollerWait() - 1
+ *
+ *  \return The tag provided to cRosPollerWatch()
+ */
+uint64_t cRosPollerGetReadyTag( CrosPoller *p, int ready_idx );
+
+/*! \brief Return the events reported for a file descriptor by the last cRosPollerWait()
+ *
+ *  \param p Pointer to the CrosPoller object
+ *  \param ready_idx Index of the reported file descriptor
+ *  \param e Watching entry of the process identified by cRosPollerGetReadyTag()
+ *
+ *  \return Bitwise OR of the ready events, restricted to the events watched for the process
+ */
+unsigned int cRosPollerGetReadyEvents( CrosPoller *p, int ready_idx, CrosPollerEntry *e );
+
+/*! @}*/
+
+#endif
@@ -0,0 +1,125 @@
+/*! \file cros_ring_buffer.h
+ *  \brief This header file declares the CrosRingBuffer type and associated functions.
+ *
+ *  CrosRingBuffer implements a bounded FIFO of fixed-size items whose capacity is chosen at run time
+ *  (e.g., the queue_size of a topic). The items are stored by value in a single array, so the buffer can
+ *  hold pointers (e.g., to serialized TCPROS frames) as well as whole objects that are kept initialized in
+ *  their slots and reused (e.g., a pool of cRosMessage objects).
+ *
+ *  One thread can append items while another one removes them, without locks (single producer and single
+ *  consumer): the producer fills the slot returned by cRosRingBufferGetBack() before appending it with
+ *  cRosRingBufferPushBack(), and the consumer uses the item returned by cRosRingBufferPeekFirst() before
+ *  releasing its slot with cRosRingBufferPopFront().
+ */
+
+#ifndef _CROS_RING_BUFFER_H_
+#define _CROS_RING_BUFFER_H_
+
+#include <stddef.h>
+
+/*! \defgroup cros_ring_buffer cROS ring buffer */
+
+/*! \addtogroup cros_ring_buffer
+ *  @{
+ */
+
+/*! \brief Ring buffer object. Don't modify its internal members: use
+ *         the related functions instead */
+typedef struct CrosRingBuffer CrosRingBuffer;
+struct CrosRingBuffer
+{
+  unsigned char *items;                 //! Storage of the items (NULL until cRosRingBufferAlloc() is called)
+  size_t item_size;                     //! Size in bytes of each item
+  unsigned int capacity;                //! Maximum number of items
+  unsigned int first;                   //! Position of the oldest item, between 0 and 2 * capacity - 1 (only changed by the consumer)
+  unsigned int end;                     //! Position after the newest item, between 0 and 2 * capacity - 1 (only changed by the producer)
+};
+
+/*! \brief Initialize a ring buffer without allocating its storage
+ *
+ *  \param rb Pointer to the CrosRingBuffer object
+ *  \param item_size Size in bytes of each item
+ *  \param capacity Maximum number of items (at least 1)
+ */
+void cRosRingBufferInit( CrosRingBuffer *rb, size_t item_size, unsigned int capacity );
+
+/*! \brief Allocate the storage of a ring buffer, if it was not allocated yet. The new slots are zero-filled
+ *
+ *  \param rb Pointer to the CrosRingBuffer object
+ *
+ *  \return Returns 0 on success, -1 on failure
+ */
+int cRosRingBufferAlloc( CrosRingBuffer *rb );
+
+/*! \brief Free the storage of a ring buffer. The items are not released: the owner must release them before
+ *
+ *  \param rb Pointer to the CrosRingBuffer object
+ */
+void cRosRingBufferRelease( CrosRingBuffer *rb );
+
+/*! \brief Get a slot of a ring buffer by its position in the storage array, regardless of whether it holds an item
+ *
+ *  \param rb Pointer to the CrosRingBuffer object (its storage must be allocated)
+ *  \param slot Slot index, between 0 and capacity - 1
+ *
+ *  \return Pointer to the slot
+ */
+void *cRosRingBufferGetSlot( CrosRingBuffer *rb, unsigned int slot );
+
+/*! \brief Get the slot that the next item appended to a ring buffer will use, allocating its storage if needed
+ *
+ *  \param rb Pointer to the CrosRingBuffer object
+ *
+ *  \return Pointer to the slot, which the caller can fill before calling cRosRingBufferPushBack(), or NULL if the
+ *          buffer is full or its storage cannot be allocated. The slot keeps the content it had when it was last popped
+ */
+void *cRosRingBufferGetBack( CrosRingBuffer *rb );
+
+/*! \brief Append an item at the end of a ring buffer, allocating its storage if needed
+ *
+ *  \param rb Pointer to the CrosRingBuffer object
+ *
+ *  \return Pointer to the slot of the new item, which the caller must fill, or NULL if the buffer is full
+ *          or its storage cannot be allocated. The slot keeps the content it had when it was last popped
+ */
+void *cRosRingBufferPushBack( CrosRingBuffer *rb );
+
+/*! \brief Remove the oldest item of a ring buffer
+ *
+ *  \param rb Pointer to the CrosRingBuffer object
+ *
+ *  \return Pointer to the slot of the removed item, which stays valid until the next push, or NULL if the buffer is empty
+ */
+void *cRosRingBufferPopFront( CrosRingBuffer *rb );
+
+/*! \brief Get the oldest item of a ring buffer without removing it
+ *
+ *  \param rb Pointer to the CrosRingBuffer object
+ *
+ *  \return Pointer to the item, or NULL if the buffer is empty
+ */
+void *cRosRingBufferPeekFirst( CrosRingBuffer *rb );
+
+/*! \brief Get the newest item of a ring buffer without removing it
+ *
+ *  \param rb Pointer to the CrosRingBuffer object
+ *
+ *  \return Pointer to the item, or NULL if the buffer is empty
+ */
+void *cRosRingBufferPeekLast( CrosRingBuffer *rb );
+
+/*! \brief Return the number of items in a ring buffer
+ *
+ *  \param rb Pointer to the CrosRingBuffer object
+ */
+unsigned int cRosRingBufferUsage( CrosRingBuffer *rb );
+
+/*! \brief Return the number of items that can still be appended to a ring buffer
+ *
+ *  \param rb Pointer to the CrosRingBuffer object
+ */
+unsigned int cRosRingBufferVacancies( CrosRingBuffer *rb );
+
+/*! @}*/
+
+#endif // _CROS_RING_BUFFER_H_
@@ -23,6 +23,14 @@ struct t_srvDef
 typedef struct t_srvDef cRosSrvDef;
 
 cRosErrCodePack cRosServiceBuildInner(cRosMessage **request, cRosMessage **response, char **message_definition, char *md5sum, const char* filepath);
+
+// Load a service definition (and the definitions of its dependencies) from its file and compute its MD5 sum.
+// The returned definition must be freed with cRosServiceDefFree()
+cRosErrCodePack cRosServiceDefBuild(cRosSrvDef **srv_def_ptr, char *md5sum, const char* filepath);
+
+// Build the request and response messages of a service from its definition, which is not referenced by them.
+// A message is not built if the corresponding part of the service definition is empty
+cRosErrCodePack cRosServiceBuildFromDef(cRosMessage **request_ptr, cRosMessage **response_ptr, cRosSrvDef *srv);
 cRosErrCodePack initCrosSrv(cRosSrvDef* srv);
 
 cRosErrCodePack getFileDependenciesSrv(char* filename, cRosSrvDef* srv, msgDep* deps);
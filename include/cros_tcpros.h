@@ -53,7 +53,31 @@ void cRosMessagePrepareSubcriptionHeader( CrosNode *n, int client_idx );
  */
 void cRosMessagePreparePublicationHeader( CrosNode *n, int server_idx );
 
-/*! \brief Prepare a TCPROS message (with data) to be sent to a subscriber
+/*! \brief Serialize a published message into a new TCPROS frame, which can be queued for all the subscribers of the topic
+ *
+ *  \param msg Pointer to the message to be published
+ *  \param frame_ptr Pointer to the variable that receives the new frame, whose reference is owned by the caller (NULL on failure)
+ *  \return CROS_SUCCESS_ERR_PACK on success, otherwise an error code
+ */
+cRosErrCodePack cRosMessagePreparePublicationFrame( cRosMessage *msg, TcprosFrame **frame_ptr );
+
+/*! \brief Create a TCPROS frame for a published message that is encoded by other means than cRosMessageSerialize()
+ *         (e.g., a generated codec or a flat message). The encoded message must be appended to the packet of the frame,
+ *         and then the frame closed with cRosMessageClosePublicationFrame()
+ *
+ *  \param msg_size Size of the encoded message, used to allocate the frame once (it can be 0 if it is not known)
+ *  \return Pointer to the new frame, whose reference is owned by the caller, or NULL if it cannot be allocated
+ */
+TcprosFrame *cRosMessageOpenPublicationFrame( size_t msg_size );
+
+/*! \brief Write the size of the message appended to a frame created with cRosMessageOpenPublicationFrame()
+ *
+ *  \param frame Pointer to the frame
+ */
+void cRosMessageClosePublicationFrame( TcprosFrame *frame );
+
+/*! \brief Prepare a TCPROS message (with data) to be sent to a subscriber. The oldest frame in the outgoing queue
+ *         of the process is sent if there is any, otherwise the publisher callback is called (periodic publication)
  *
  *  \param n Ponter to the CrosNode object
  *  \param server_idx Index of the TcprosProcess ( tcpros_server_proc[server_idx] ) to be considered
@@ -69,6 +93,26 @@ cRosErrCodePack cRosMessagePreparePublicationPacket( CrosNode *n, int server_idx
  */
 cRosErrCode cRosMessageParsePublicationPacket( CrosNode *n, int client_idx );
 
+/*! \brief Decide whether the TCPROS message that a subscriber process is going to receive is decoded while it is
+ *         being received, and start its decoding if so
+ *
+ *  \param n Ponter to the CrosNode object
+ *  \param client_idx Index of the TcprosProcess ( tcpros_client_proc[client_idx] ) to be considered
+ *  \param msg_size Size (in bytes) of the message
+ *  \return 1 if the received bytes must be passed to cRosMessageParsePublicationChunk(), or 0 if the whole message
+ *          must be received and passed to cRosMessageParsePublicationPacket()
+ */
+int cRosMessageStartPublicationStream( CrosNode *n, int client_idx, size_t msg_size );
+
+/*! \brief Decode the bytes of the TCPROS message received since the last call, and empty the process packet.
+ *         When the whole message has been received, pass it to the subscriber
+ *
+ *  \param n Ponter to the CrosNode object
+ *  \param client_idx Index of the TcprosProcess ( tcpros_client_proc[client_idx] ) to be considered for the parsing
+ *  \return CROS_SUCCESS_ERR_PACK on success, otherwise an error code
+ */
+cRosErrCodePack cRosMessageParsePublicationChunk( CrosNode *n, int client_idx );
+
 /*! \brief Parse a RCPROS header sent from a service caller
  *
  *  \param n Ponter to the CrosNode object
@@ -127,6 +171,17 @@ cRosErrCodePack cRosMessageParseServiceResponsePacket( CrosNode *n, int client_i
  */
 cRosErrCodePack cRosMessagePrepareServiceResponsePacket( CrosNode *n, int server_idx);
 
+/*! \brief Pass a service request received by a RPCROS server process to a worker thread of the node executor
+ *         (threaded mode), which prepares the response. Meanwhile the process waits in the
+ *         TCPROS_PROCESS_STATE_WAIT_FOR_RESPONSE state
+ *
+ *  \param n Ponter to the CrosNode object
+ *  \param server_idx Index of the TcprosProcess ( rpcros_server_proc[server_idx] ) to be considered
+ *  \return 0 on success, or -1 if the request has not been passed (e.g., the node has no worker threads), so that
+ *          the response must be prepared with cRosMessagePrepareServiceResponsePacket()
+ */
+int cRosMessageDispatchServiceRequest( CrosNode *n, int server_idx );
+
 /*! \brief Prepare a RCPROS header to be initially sent to a service provider
  *
  *  \param n Ponter to the CrosNode object
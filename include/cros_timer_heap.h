@@ -0,0 +1,104 @@
+/*! \file cros_timer_heap.h
+ *  \brief This header file declares the CrosTimerHeap type and associated functions, used by the node
+ *         main loop to keep the deadlines of its processes (periodic wake-ups and I/O timeouts).
+ *
+ *  The armed timers are kept in a binary min-heap ordered by deadline, so the next deadline is known
+ *  without scanning the processes, and only the timers that expired are dispatched. Each timer has
+ *  a fixed identifier (returned by cRosTimerHeapAdd()) that its owner keeps, so it can be re-armed or
+ *  disarmed in O(log n) even if the owner is moved in memory (e.g., when a node table grows).
+ */
+
+#ifndef _CROS_TIMER_HEAP_H_
+#define _CROS_TIMER_HEAP_H_
+
+#include <stdint.h>
+
+/*! \defgroup cros_timer_heap cROS timer heap */
+
+/*! \addtogroup cros_timer_heap
+ *  @{
+ */
+
+/*! Deadline of a disarmed timer */
+#define CROS_TIMER_NEVER UINT64_MAX
+
+/*! \brief Timer of a CrosTimerHeap object */
+typedef struct CrosTimer CrosTimer;
+struct CrosTimer
+{
+  uint64_t deadline;                    //! Time at which the timer expires (CROS_TIMER_NEVER if it is not armed)
+  uint64_t tag;                         //! Value reported when the timer expires to identify its owner
+  int heap_pos;                         //! Position of the timer in the heap (-1 if it is not armed)
+};
+
+/*! \brief CrosTimerHeap object. Don't modify directly its internal members: use
+ *         the related functions instead */
+typedef struct CrosTimerHeap CrosTimerHeap;
+struct CrosTimerHeap
+{
+  CrosTimer *timers;                    //! All the timers, indexed by their identifier
+  int n_timers;                         //! Number of timers created
+  int *heap;                            //! Identifiers of the armed timers, ordered as a binary min-heap by deadline
+  int n_armed;                          //! Number of armed timers (used positions of heap)
+  int capacity;                         //! Allocated length of timers and heap
+};
+
+/*! \brief Initialize a CrosTimerHeap object without allocating memory
+ *
+ *  \param h Pointer to the CrosTimerHeap object
+ */
+void cRosTimerHeapInit( CrosTimerHeap *h );
+
+/*! \brief Release all the internally allocated memory of a CrosTimerHeap object
+ *
+ *  \param h Pointer to the CrosTimerHeap object
+ */
+void cRosTimerHeapRelease( CrosTimerHeap *h );
+
+/*! \brief Create a new disarmed timer
+ *
+ *  \param h Pointer to the CrosTimerHeap object
+ *  \param tag Value reported by cRosTimerHeapPopExpired() to identify the owner of the timer
+ *
+ *  \return The identifier of the timer, or -1 if it cannot be allocated
+ */
+int cRosTimerHeapAdd( CrosTimerHeap *h, uint64_t tag );
+
+/*! \brief Set the deadline of a timer, arming it or moving it in the heap if it was already armed
+ *
+ *  \param h Pointer to the CrosTimerHeap object
+ *  \param timer_id Identifier of the timer
+ *  \param deadline Time at which the timer expires, or CROS_TIMER_NEVER to disarm it
+ */
+void cRosTimerHeapArm( CrosTimerHeap *h, int timer_id, uint64_t deadline );
+
+/*! \brief Return the deadline of a timer
+ *
+ *  \param h Pointer to the CrosTimerHeap object
+ *  \param timer_id Identifier of the timer
+ *
+ *  \return The deadline, or CROS_TIMER_NEVER if the timer is not armed
+ */
+uint64_t cRosTimerHeapGetDeadline( const CrosTimerHeap *h, int timer_id );
+
+/*! \brief Return the earliest deadline of the armed timers
+ *
+ *  \param h Pointer to the CrosTimerHeap object
+ *
+ *  \return The earliest deadline, or CROS_TIMER_NEVER if no timer is armed
+ */
+uint64_t cRosTimerHeapNextDeadline( const CrosTimerHeap *h );
+
+/*! \brief Disarm the timer with the earliest deadline if it has expired
+ *
+ *  \param h Pointer to the CrosTimerHeap object
+ *  \param now The current time
+ *  \param tag Pointer where the tag of the expired timer is stored
+ *
+ *  \return 1 if a timer has expired (and it has been disarmed), 0 otherwise
+ */
+int cRosTimerHeapPopExpired( CrosTimerHeap *h, uint64_t now, uint64_t *tag );
+
+/*! @}*/
+
+#endif
@@ -0,0 +1,64 @@
+/*! \file cros_wakeup.h
+ *  \brief This header file declares the CrosWakeup type and associated functions, used by other threads
+ *         to wake up a node loop that is waiting in cRosPollerWait().
+ *
+ *  On Linux the wake-up uses an eventfd, elsewhere it uses a pipe. In both cases the signals sent
+ *  before the loop attends the wake-up are merged into a single one.
+ */
+
+#ifndef _CROS_WAKEUP_H_
+#define _CROS_WAKEUP_H_
+
+#include "cros_poller.h"
+
+/*! \defgroup cros_wakeup cROS wake-up */
+
+/*! \addtogroup cros_wakeup
+ *  @{
+ */
+
+/*! \brief CrosWakeup object. Don't modify directly its internal members: use
+ *         the related functions instead */
+typedef struct CrosWakeup CrosWakeup;
+struct CrosWakeup
+{
+  int read_fd;                          //! File descriptor watched by the node loop (-1 if not opened)
+  int write_fd;                         //! File descriptor written by cRosWakeupSignal() (the same as read_fd for an eventfd)
+  CrosPollerEntry poller_entry;         //! Watching state of read_fd in the node poller
+};
+
+/*! \brief Initialize a CrosWakeup object without opening its file descriptors
+ *
+ *  \param w Pointer to the CrosWakeup object
+ */
+void cRosWakeupInit( CrosWakeup *w );
+
+/*! \brief Open the non-blocking file descriptors of a CrosWakeup object
+ *
+ *  \param w Pointer to the CrosWakeup object
+ *
+ *  \return Returns 0 on success, -1 on failure
+ */
+int cRosWakeupOpen( CrosWakeup *w );
+
+/*! \brief Close the file descriptors of a CrosWakeup object
+ *
+ *  \param w Pointer to the CrosWakeup object
+ */
+void cRosWakeupClose( CrosWakeup *w );
+
+/*! \brief Make the file descriptor of a CrosWakeup object readable. It can be called from any thread
+ *
+ *  \param w Pointer to the CrosWakeup object
+ */
+void cRosWakeupSignal( CrosWakeup *w );
+
+/*! \brief Consume the pending signals of a CrosWakeup object, so that its file descriptor is not readable anymore
+ *
+ *  \param w Pointer to the CrosWakeup object
+ */
+void cRosWakeupDrain( CrosWakeup *w );
+
+/*! @}*/
+
+#endif
@@ -32,6 +32,13 @@ void dynBufferInit( DynBuffer *d_buf );
  */
 void dynBufferRelease( DynBuffer *d_buf );
 
+/*! \brief Exchange the contents (data, size and position indicator) of two dynamic buffers without copying them
+ *
+ *  \param d_buf1 Pointer to a DynBuffer object
+ *  \param d_buf2 Pointer to the other DynBuffer object
+ */
+void dynBufferSwap( DynBuffer *d_buf1, DynBuffer *d_buf2 );
+
 /*! \brief Append a copy of the n bytes pointed by new_buf to the end of the dynamic buffer pointed by d_buf
  *
  *  \param d_buf Pointer to a DynBuffer object
@@ -42,6 +49,34 @@ void dynBufferRelease( DynBuffer *d_buf );
  */
 int dynBufferPushBackBuf( DynBuffer *d_buf, const unsigned char *new_buf, size_t n );
 
+/*! \brief Make sure that n bytes can be appended to the dynamic buffer without reallocating its memory.
+ *
+ *  Together with dynBufferGetTailData() and dynBufferExtendSize(), it allows to write data (e.g., received
+ *  from a socket) directly at the end of the dynamic buffer, without intermediate copies.
+ *  \param d_buf Pointer to a DynBuffer object
+ *  \param n Number of bytes to be reserved after the current content
+ *
+ *  \return 0 on success, or -1 on failure
+ */
+int dynBufferReserve( DynBuffer *d_buf, size_t n );
+
+/*! \brief Get a pointer to the memory just after the content of the dynamic buffer.
+ *         Only the bytes previously reserved with dynBufferReserve() can be written
+ *
+ *  \param d_buf Pointer to a DynBuffer object
+ *
+ *  \return The pointer to the first byte after the buffer content
+ */
+unsigned char *dynBufferGetTailData( DynBuffer *d_buf );
+
+/*! \brief Append to the content of the dynamic buffer n bytes already written after its end
+ *         (see dynBufferGetTailData())
+ *
+ *  \param d_buf Pointer to a DynBuffer object
+ *  \param n Number of written bytes. It must not exceed the reserved bytes
+ */
+void dynBufferExtendSize( DynBuffer *d_buf, size_t n );
+
 /*! \brief Replace the content of the dynamic buffer starting from current position indicator with the content
  *         of the buffer cont_buf.
  *
@@ -160,6 +160,22 @@ int tcpIpSocketDisconnect( TcpIpSocket *s );
  */
 TcpIpSocketState tcpIpSocketWriteBuffer( TcpIpSocket *s, DynBuffer *d_buf );
 
+/*! \brief Send a binary message on a connected socket, starting from a given position of the buffer.
+ *         Unlike tcpIpSocketWriteBuffer(), the position indicator of the buffer is not used, so
+ *         the same buffer can be written on several sockets at the same time
+ *
+ *  \param s Pointer to a TcpIpSocket object
+ *  \param d_buf The dynamic buffer to be written
+ *  \param pos_offset Pointer to the offset of the first byte to be written. It is advanced by the number of written bytes
+ *
+ *  \return Returns TCPIPSOCKET_DONE on success,
+ *          TCPIPSOCKET_IN_PROGRESS (only if the socket is non-blocking)
+ *          if the write operation is not yet completed,
+ *          TCPIPSOCKET_DISCONNECTED if the socket has been disconnectd,
+ *          or TCPIPSOCKET_FAILED on failure
+ */
+TcpIpSocketState tcpIpSocketWriteBufferEx( TcpIpSocket *s, DynBuffer *d_buf, size_t *pos_offset );
+
 /*! \brief Send a string on a connected socket
  *
  *  \param s Pointer to a TcpIpSocket object
@@ -175,8 +191,12 @@ TcpIpSocketState tcpIpSocketWriteString( TcpIpSocket *s, DynString *d_str );
 
 /*! \brief Receive a binary message from a connected socket
  *
+ *  The data is received directly at the end of the dynamic buffer: length bytes are reserved
+ *  in it before reading, so when the message size is known no further allocation is needed.
  *  \param s Pointer to a TcpIpSocket object
  *  \param d_buf Pointer to the input dynamic string
+ *  \param length Maximum number of bytes to be read
+ *  \param reads Pointer to the number of bytes actually read
  *
  *  \return Returns TCPIPSOCKET_DONE on success,
  *          TCPIPSOCKET_IN_PROGRESS (only if the socket is non-blocking)
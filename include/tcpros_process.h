@@ -2,6 +2,10 @@
 #define _TCPROS_PROCESS_H_
 
 #include "tcpip_socket.h"
+#include "cros_poller.h"
+#include "cros_ring_buffer.h"
+#include "cros_mpsc_queue.h"
+#include "cros_message.h"
 
 /*! \defgroup tcpros_process TCPROS process */
 
@@ -21,9 +25,31 @@ typedef enum
   TCPROS_PROCESS_STATE_START_WRITING,
   TCPROS_PROCESS_STATE_READING_SIZE,
   TCPROS_PROCESS_STATE_READING,
-  TCPROS_PROCESS_STATE_WRITING
+  TCPROS_PROCESS_STATE_WRITING,
+  TCPROS_PROCESS_STATE_WAIT_FOR_RESPONSE, //! The service request is being attended by a worker thread (threaded mode)
+  TCPROS_PROCESS_STATE_SHARDED            //! The connection is streamed by an I/O shard thread (threaded mode, see cros_io_shard.h)
 } TcprosProcessState;
 
+/*! Action taken when a message is published and the outgoing queue of a subscriber connection is full */
+typedef enum CrosOutQueuePolicy
+{
+  CROS_OUT_QUEUE_DROP_OLDEST = 0,       //! Discard the oldest message waiting in the queue (default)
+  CROS_OUT_QUEUE_DROP_NEWEST,           //! Discard the new message for that subscriber
+  CROS_OUT_QUEUE_DISCONNECT             //! Close the connection of the subscriber
+} CrosOutQueuePolicy;
+
+/*! \brief Outgoing TCPROS packet shared by several processes, e.g. a message published to many subscribers,
+ *         so that it is serialized only once. It is released when the last reference is dropped
+ */
+typedef struct TcprosFrame TcprosFrame;
+struct TcprosFrame
+{
+  DynBuffer packet;                     //! The serialized packet (its position indicator is not used)
+  int ref_count;                        //! Number of references to the frame (changed atomically: the I/O shard threads share the frames)
+  CrosMpscLink post_link;               //! Link used while the frame is posted to the node I/O thread by another thread
+  int post_topic_idx;                   //! Index of the publisher of the posted frame
+};
+
 /*! \brief The TcprosProcess object represents a client or server connection used to manage
  *         peer to peer TCPROS connections between nodes. It is internally used to emulate the
  *         "precess descriptor" in a multi-task system (here used in a mono task system), including
@@ -46,16 +72,25 @@ struct TcprosProcess
   unsigned char tcp_nodelay;            //! If 1, the publisher should set TCP_NODELAY on the socket, if possible. Otherwise 0
   unsigned char persistent;             //! If 1, the service connection should be kept open for multiple requests. Otherwise it should be 0
   DynBuffer packet;                     //! The incoming/outgoing TCPROS packet
-  uint64_t last_change_time;            //! Last state change time (in ms)
-  uint64_t wake_up_time_ms;             //! The time for the next automatic cycle (in msec, since the Epoch)
+  TcprosFrame *frame;                   //! If not NULL, shared packet sent instead of packet
+  size_t frame_pos_offset;              //! Number of bytes of frame already sent
+  CrosRingBuffer out_frames;            //! Queue of frames (TcprosFrame pointers) waiting to be sent (published messages)
+  uint64_t last_change_time;            //! Last state change time (in nsec, see cRosClockGetTimeNs())
+  uint64_t wake_up_time;                //! The time for the next automatic cycle (in nsec, see cRosClockGetTimeNs())
   int topic_idx;                        //! Index used to associate the process to a publisher or a subscribed
   int service_idx;                      //! Index used to associate the process to a service provider or a service client
+  int io_shard;                         //! Index of the I/O shard streaming the connection (TCPROS_PROCESS_STATE_SHARDED only)
   size_t left_to_recv;                  //! Remaining to receive
+  cRosMessageDecoder *decoder;          //! If not NULL, decoder of the messages received progressively (subscriber processes)
+  cRosMessage *decoded_msg;             //! Message filled by decoder, owned by the process
   uint8_t ok_byte;						          //! 'ok' byte send by a service provider in response to the last service request
   int probe;							              //! The current session is a probing one
   int sub_tcpros_port;                  //! Port (obtained from a publisher node) to which the process must connect
   char *sub_tcpros_host;                //! Host (obtained from a publisher node) to which the process must connect
-  int send_msg_now;                     //! When different from 0 the publisher/caller should send the message in the buffer now (used for non-periodic sending)
+  int send_msg_now;                     //! When different from 0 the service caller should send the message in the buffer now (used for non-periodic calls)
+  unsigned int state_changes;           //! Number of state changes (used to know when the socket events to watch must be updated)
+  CrosPollerEntry poller_entry;         //! Watching state of the socket in the node poller
+  int timer_id;                         //! Timer of the process in the node timer heap (-1 if it has not been created yet)
 };
 
 
@@ -79,7 +114,101 @@ void tcprosProcessRelease( TcprosProcess *p );
  */
 void tcprosProcessClear( TcprosProcess *p , int fullreset );
 
-/*! \brief Change the internal state of an TcprosProcess object, and update its timer
+/*! \brief Set the decoder that a TcprosProcess object uses to decode the messages while they are received.
+ *         The process takes over the decoder and its message, and frees them when it is fully reset
+ *
+ *  \param s Pointer to TcprosProcess object
+ *  \param decoder Pointer to the decoder (it can be NULL)
+ *  \param decoded_msg Pointer to the message filled by decoder (it can be NULL)
+ */
+void tcprosProcessSetDecoder( TcprosProcess *p, cRosMessageDecoder *decoder, cRosMessage *decoded_msg );
+
+/*! \brief Take the message filled by the decoder of a TcprosProcess object, which is released. The decoder is created
+ *         again for the next message to be decoded while it is received
+ *
+ *  \param s Pointer to TcprosProcess object
+ *
+ *  \return Pointer to the message, that the caller must free with cRosMessageFree()
+ */
+cRosMessage *tcprosProcessTakeDecodedMessage( TcprosProcess *p );
+
+/*! \brief Check whether a TcprosProcess object is decoding a message while it is being received
+ *
+ *  \param s Pointer to TcprosProcess object
+ *
+ *  \return 1 if the bytes received must be passed to the decoder of the process, 0 otherwise
+ */
+int tcprosProcessIsDecoding( const TcprosProcess *p );
+
+/*! \brief Set the shared frame that a TcprosProcess object must send instead of its own packet.
+ *         The process takes over the reference to the frame, and drops it when it is cleared
+ *
+ *  \param s Pointer to TcprosProcess object
+ *  \param frame Pointer to the frame (it can be NULL)
+ */
+void tcprosProcessSetFrame( TcprosProcess *p, TcprosFrame *frame );
+
+/*! \brief Move the socket, the outgoing queue and the frame being sent from a TcprosProcess object to another one,
+ *         e.g., to pass a connection to the thread that streams it. The source keeps an empty queue of the same capacity
+ *
+ *  \param dst Pointer to the TcprosProcess object that receives the stream (its socket must be closed and its queue empty)
+ *  \param src Pointer to the TcprosProcess object that gives the stream
+ */
+void tcprosProcessMoveStream( TcprosProcess *dst, TcprosProcess *src );
+
+/*! \brief Set the maximum number of frames of the outgoing queue of a TcprosProcess object, dropping the frames in it
+ *
+ *  \param s Pointer to TcprosProcess object
+ *  \param max_frames Capacity of the queue
+ */
+void tcprosProcessSetOutQueueLength( TcprosProcess *p, int max_frames );
+
+/*! \brief Append a frame to the outgoing queue of a TcprosProcess object. The queue takes a new reference
+ *         to the frame if it is appended
+ *
+ *  \param s Pointer to TcprosProcess object
+ *  \param frame Pointer to the frame
+ *
+ *  \return Returns 0 on success, -1 if the queue is full, or -2 if the queue cannot be allocated
+ */
+int tcprosProcessPushOutFrame( TcprosProcess *p, TcprosFrame *frame );
+
+/*! \brief Remove the oldest frame from the outgoing queue of a TcprosProcess object
+ *
+ *  \param s Pointer to TcprosProcess object
+ *
+ *  \return The frame, whose reference is passed to the caller, or NULL if the queue is empty
+ */
+TcprosFrame *tcprosProcessPopOutFrame( TcprosProcess *p );
+
+/*! \brief Drop all the frames of the outgoing queue of a TcprosProcess object
+ *
+ *  \param s Pointer to TcprosProcess object
+ */
+void tcprosProcessClearOutFrames( TcprosProcess *p );
+
+/*! \brief Allocate a new empty TcprosFrame object, with one reference owned by the caller
+ *
+ *  \return A pointer to the new frame, or NULL on failure
+ */
+TcprosFrame *tcprosFrameNew( void );
+
+/*! \brief Add a reference to a TcprosFrame object
+ *
+ *  \param frame Pointer to the frame
+ *
+ *  \return The frame pointer
+ */
+TcprosFrame *tcprosFrameRef( TcprosFrame *frame );
+
+/*! \brief Drop a reference to a TcprosFrame object, releasing it if it was the last one
+ *
+ *  \param frame Pointer to the frame (it can be NULL)
+ */
+void tcprosFrameUnref( TcprosFrame *frame );
+
+/*! \brief Change the internal state of an TcprosProcess object, update its timer, and queue the change in the
+ *         poller its entry is bound to (see cRosPollerEntryNotify())
  *
  *  \param s Pointer to TcprosProcess object
  *  \param state The new state
@@ -2,6 +2,7 @@
 #define _XMLRPC_PROCESS_H_
 
 #include "tcpip_socket.h"
+#include "cros_poller.h"
 #include "xmlrpc_protocol.h"
 #include "cros_api_call.h"
 
@@ -38,10 +39,13 @@ struct XmlrpcProcess
    /*! The incoming/outgoing XMLRPC message
     *  (e.g., generated using generateXmlrpcMessage() ) */
   DynString message;
-  uint64_t last_change_time;            //! Last state change time (in ms)
-  uint64_t wake_up_time_ms;             //! The time for the next automatic cycle (in msec, since the Epoch)
+  uint64_t last_change_time;            //! Last state change time (in nsec, see cRosClockGetTimeNs())
+  uint64_t wake_up_time;                //! The time for the next automatic cycle (in nsec, see cRosClockGetTimeNs())
   char host[256];
   int port;
+  unsigned int state_changes;           //! Number of state changes (used to know when the socket events to watch must be updated)
+  CrosPollerEntry poller_entry;         //! Watching state of the socket in the node poller
+  int timer_id;                         //! Timer of the process in the node timer heap (-1 if it has not been created yet)
 };
 
 
@@ -64,7 +68,8 @@ void xmlrpcProcessRelease( XmlrpcProcess *p );
  */
 void xmlrpcProcessClear( XmlrpcProcess *p, int fullclear);
 
-/*! \brief Change the internal state of an XmlrpcProcess object, and update its timer
+/*! \brief Change the internal state of an XmlrpcProcess object, update its timer, and queue the change in the
+ *         poller its entry is bound to (see cRosPollerEntryNotify())
  *
  *  \param s Pointer to XmlrpcProcess object
  *  \param state The new state
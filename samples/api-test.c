@@ -296,12 +296,12 @@ int main(int argc, char **argv)
 #ifdef SUBSCRIBER
 
   err_cod = cRosApiRegisterSubscriber(node, "/gripperstatus", "gripping_robot/GripperStatus",
-                                 gripperstatus_sub_callback, NULL, NULL, 0, NULL);
+                                 gripperstatus_sub_callback, NULL, NULL, 0, 0, NULL);
   if (err_cod != CROS_SUCCESS_ERR_PACK)
     return EXIT_FAILURE;
 
   err_cod = cRosApiRegisterSubscriber(node, "/gripperjoints", "gripping_robot/GripperJoints",
-                                 gripperjoints_sub_callback, NULL, NULL, 0, NULL);
+                                 gripperjoints_sub_callback, NULL, NULL, 0, 0, NULL);
   if (err_cod != CROS_SUCCESS_ERR_PACK)
     return EXIT_FAILURE;
 
@@ -314,12 +314,12 @@ Publisher Example
 #ifdef PUBLISHER
 
   err_cod = cRosApiRegisterPublisher(node, "/gripperstatus","gripping_robot/GripperStatus",1000,
-                                callback_pub_gripperstatus, NULL, NULL, NULL);
+                                callback_pub_gripperstatus, NULL, NULL, 0, NULL);
   if (err_cod != CROS_SUCCESS_ERR_PACK)
     return EXIT_FAILURE;
 
   err_cod = cRosApiRegisterPublisher(node,"/gripperjoints","gripping_robot/GripperJoints", 1000,
-                                callback_pub_gripperjoints, NULL, NULL, NULL);
+                                callback_pub_gripperjoints, NULL, NULL, 0, NULL);
   if (err_cod != CROS_SUCCESS_ERR_PACK)
     return EXIT_FAILURE;
 
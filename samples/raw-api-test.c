@@ -659,22 +659,22 @@ int main(int argc, char **argv)
 
 #ifndef CROS_MESSAGE_SERIALIZATION_TEST
   rc = cRosNodeRegisterPublisher ( node, "string data\n\n", "/topic_clock", "std_msgs/String",
-                                   "992ce8a1687cec8c8bd883ec73ca41d1", 1000, clock_callback, NULL, NULL);
+                                   "992ce8a1687cec8c8bd883ec73ca41d1", 1000, clock_callback, NULL, NULL, 0);
   if (rc == -1)
     return EXIT_FAILURE;
 
   rc = cRosNodeRegisterPublisher ( node, "float64[] val\n\n", "/double_vector", "cros_testbed/DoubleVector",
-                                   "65ac3f59e35977c61c27adccf4c68288", 1000, double_vector_callback, NULL, NULL);
+                                   "65ac3f59e35977c61c27adccf4c68288", 1000, double_vector_callback, NULL, NULL, 0);
   if (rc == -1)
     return EXIT_FAILURE;
 
   rc = cRosNodeRegisterPublisher ( node, "string data\n\n", "/topic_counter", "std_msgs/String",
-                                   "992ce8a1687cec8c8bd883ec73ca41d1", 500, counter_callback, NULL, NULL);
+                                   "992ce8a1687cec8c8bd883ec73ca41d1", 500, counter_callback, NULL, NULL, 0);
   if (rc == -1)
     return EXIT_FAILURE;
 
   rc = cRosNodeRegisterSubscriber(node, "string data\n\n", "/test", "std_msgs/String",
-                                  "992ce8a1687cec8c8bd883ec73ca41d1", test_subscription_callback, getNodeStatusCallback, NULL, 0);
+                                  "992ce8a1687cec8c8bd883ec73ca41d1", test_subscription_callback, getNodeStatusCallback, NULL, 0, 0);
   if (rc == -1)
     return EXIT_FAILURE;
 
@@ -684,12 +684,12 @@ int main(int argc, char **argv)
                                  "uint32 Configuration\n\n";
 
   rc = cRosNodeRegisterSubscriber(node, gripperjointstatus_def, "/gripperstatus", "gripping_robot/GripperStatus",
-                                  "bba69b1f07d275244b4a697ef69e1b2e", gripperstatus_callback, NULL, NULL, 0);
+                                  "bba69b1f07d275244b4a697ef69e1b2e", gripperstatus_callback, NULL, NULL, 0, 0);
   if (rc == -1)
     return EXIT_FAILURE;
 
   err_cod = cRosApiRegisterSubscriber(node, "/gripperjoints", "gripping_robot/GripperJoints",
-                                 gripperjointstate_callbacknewapi, getNodeStatusCallback, NULL, 0, NULL);
+                                 gripperjointstate_callbacknewapi, getNodeStatusCallback, NULL, 0, 0, NULL);
   if(err_cod != CROS_SUCCESS_ERR_PACK)
   {
     cRosPrintErrCodePack(err_cod, "cRosApiRegisterSubscriber() returned an error code");
@@ -698,12 +698,12 @@ int main(int argc, char **argv)
 
 /*
   rc = cRosNodeRegisterSubscriber(node, "float64[9] Position\n\n", "/gripperjoints", "gripping_robot/GripperJoints",
-                                  "8351d4f138c16ac67e83ce06ead5a2f3", gripperjointstate_callback, NULL, NULL, 0);
+                                  "8351d4f138c16ac67e83ce06ead5a2f3", gripperjointstate_callback, NULL, NULL, 0, 0);
   if (rc == -1)
     return EXIT_FAILURE;
 
   rc = cRosNodeRegisterSubscriber(node, "float64[] val\n\n", "/double_vector", "cros_testbed/DoubleVector",
-                                  "65ac3f59e35977c61c27adccf4c68288", doublevector_subscription_callback, NULL, NULL, 0);
+                                  "65ac3f59e35977c61c27adccf4c68288", doublevector_subscription_callback, NULL, NULL, 0, 0);
   if (rc == -1)
     return EXIT_FAILURE;
 */
@@ -738,19 +738,19 @@ int main(int argc, char **argv)
   cRosMessageBuild(&msgPointMixes,"/home/nico/Desktop/test_msgs/gripping_robot/PointMixes.msg");
 
   rc = cRosNodeRegisterPublisher ( node, msgPoint.msgDef->plain_text, "/point_test", "geometry_msgs/Point",
-                                   msgPoint.md5sum, 1000, point_pub_callback, NULL, NULL);
+                                   msgPoint.md5sum, 1000, point_pub_callback, NULL, NULL, 0);
   if (rc == -1)
     return EXIT_FAILURE;
 
 
   rc = cRosNodeRegisterPublisher ( node, msgPointMixes.msgDef->plain_text, "/many_points", "gripping_robot/PointMixes",
-                                    msgPointMixes.md5sum, 1000, manyPoints_pub_callback, NULL, NULL);
+                                    msgPointMixes.md5sum, 1000, manyPoints_pub_callback, NULL, NULL, 0);
   if (rc == -1)
     return EXIT_FAILURE;
 
 
   rc = cRosNodeRegisterPublisher ( node, msgStringMixes.msgDef->plain_text, "/many_strings", "gripping_robot/StringMixes",
-                                   msgStringMixes.md5sum, 1000, manyStrings_pub_callback, NULL, NULL);
+                                   msgStringMixes.md5sum, 1000, manyStrings_pub_callback, NULL, NULL, 0);
 #endif
 
 #ifdef STD_MSGS_TEST
@@ -771,158 +771,158 @@ int main(int argc, char **argv)
                      "string frame_id\n\n";
 
   rc = cRosNodeRegisterPublisher ( node, "bool data\n\n", "/bool", "std_msgs/Bool",
-                                   "8b94c1b53db61fb6aed406028ad6332a", 1000, bool_pub_callback, NULL, NULL);
+                                   "8b94c1b53db61fb6aed406028ad6332a", 1000, bool_pub_callback, NULL, NULL, 0);
   if (rc == -1)
     return EXIT_FAILURE;
 
   rc = cRosNodeRegisterPublisher ( node, "byte data\n\n", "/byte", "std_msgs/Byte",
-                                   "ad736a2e8818154c487bb80fe42ce43b", 1000, byte_pub_callback, NULL, NULL);
+                                   "ad736a2e8818154c487bb80fe42ce43b", 1000, byte_pub_callback, NULL, NULL, 0);
   if (rc == -1)
     return EXIT_FAILURE;
 
   rc = cRosNodeRegisterPublisher ( node, "char data\n\n", "/char", "std_msgs/Char",
-                                   "1bf77f25acecdedba0e224b162199717", 1000, char_pub_callback, NULL, NULL);
+                                   "1bf77f25acecdedba0e224b162199717", 1000, char_pub_callback, NULL, NULL, 0);
   if (rc == -1)
     return EXIT_FAILURE;
 
   rc = cRosNodeRegisterPublisher ( node, "duration data\n\n", "/duration", "std_msgs/Duration",
-                                   "3e286caf4241d664e55f3ad380e2ae46", 1000, duration_pub_callback, NULL, NULL);
+                                   "3e286caf4241d664e55f3ad380e2ae46", 1000, duration_pub_callback, NULL, NULL, 0);
   if (rc == -1)
     return EXIT_FAILURE;
 
   rc = cRosNodeRegisterPublisher ( node, header_def, "/header", "std_msgs/Header",
-                                   "2176decaecbce78abc3b96ef049fabed", 1000, header_pub_callback, NULL, NULL);
+                                   "2176decaecbce78abc3b96ef049fabed", 1000, header_pub_callback, NULL, NULL, 0);
   if (rc == -1)
     return EXIT_FAILURE;
 
   rc = cRosNodeRegisterPublisher ( node, "int16 data\n\n", "/int16", "std_msgs/Int16",
-                                   "8524586e34fbd7cb1c08c5f5f1ca0e57", 1000, int16_pub_callback, NULL, NULL);
+                                   "8524586e34fbd7cb1c08c5f5f1ca0e57", 1000, int16_pub_callback, NULL, NULL, 0);
   if (rc == -1)
     return EXIT_FAILURE;
 
   rc = cRosNodeRegisterPublisher ( node, "int32 data\n\n", "/int32", "std_msgs/Int32",
-                                   "da5909fbe378aeaf85e547e830cc1bb7", 1000, int32_pub_callback, NULL, NULL);
+                                   "da5909fbe378aeaf85e547e830cc1bb7", 1000, int32_pub_callback, NULL, NULL, 0);
   if (rc == -1)
     return EXIT_FAILURE;
 
   rc = cRosNodeRegisterPublisher ( node, "int64 data\n\n", "/int64", "std_msgs/Int64",
-                                   "34add168574510e6e17f5d23ecc077ef", 1000, int64_pub_callback, NULL, NULL);
+                                   "34add168574510e6e17f5d23ecc077ef", 1000, int64_pub_callback, NULL, NULL, 0);
   if (rc == -1)
     return EXIT_FAILURE;
 
   rc = cRosNodeRegisterPublisher ( node, "int8 data\n\n", "/int8", "std_msgs/Int8",
-                                   "27ffa0c9c4b8fb8492252bcad9e5c57b", 1000, int8_pub_callback, NULL, NULL);
+                                   "27ffa0c9c4b8fb8492252bcad9e5c57b", 1000, int8_pub_callback, NULL, NULL, 0);
   if (rc == -1)
     return EXIT_FAILURE;
 
   rc = cRosNodeRegisterPublisher ( node, "time data\n\n", "/time", "std_msgs/Time",
-                                   "cd7166c74c552c311fbcc2fe5a7bc289", 1000, time_pub_callback, NULL, NULL);
+                                   "cd7166c74c552c311fbcc2fe5a7bc289", 1000, time_pub_callback, NULL, NULL, 0);
   if (rc == -1)
     return EXIT_FAILURE;
 
   rc = cRosNodeRegisterPublisher ( node, "uint16 data\n\n", "/uint16", "std_msgs/UInt16",
-                                   "1df79edf208b629fe6b81923a544552d", 1000, uint16_pub_callback, NULL, NULL);
+                                   "1df79edf208b629fe6b81923a544552d", 1000, uint16_pub_callback, NULL, NULL, 0);
   if (rc == -1)
     return EXIT_FAILURE;
 
   rc = cRosNodeRegisterPublisher ( node, "uint32 data\n\n", "/uint32", "std_msgs/UInt32",
-                                   "304a39449588c7f8ce2df6e8001c5fce", 1000, uint32_pub_callback, NULL, NULL);
+                                   "304a39449588c7f8ce2df6e8001c5fce", 1000, uint32_pub_callback, NULL, NULL, 0);
     return EXIT_FAILURE;
 
   rc = cRosNodeRegisterPublisher ( node, "uint64 data\n\n", "/uint64", "std_msgs/UInt64",
-                                   "1b2a79973e8bf53d7b53acb71299cb57", 1000, uint64_pub_callback, NULL, NULL);
+                                   "1b2a79973e8bf53d7b53acb71299cb57", 1000, uint64_pub_callback, NULL, NULL, 0);
     return EXIT_FAILURE;
 
   rc = cRosNodeRegisterPublisher ( node, "uint8 data\n\n", "/uint8", "std_msgs/UInt8",
-                                   "7c8164229e7d2c17eb95e9231617fdee", 1000, uint8_pub_callback, NULL, NULL);
+                                   "7c8164229e7d2c17eb95e9231617fdee", 1000, uint8_pub_callback, NULL, NULL, 0);
   if (rc == -1)
     return EXIT_FAILURE;
 
 
   rc = cRosNodeRegisterPublisher ( node, "float32 data\n\n", "/float32", "std_msgs/Float32",
-                                   "73fcbf46b49191e672908e50842a83d4", 1000, float32_pub_callback, NULL, NULL);
+                                   "73fcbf46b49191e672908e50842a83d4", 1000, float32_pub_callback, NULL, NULL, 0);
     return EXIT_FAILURE;
 
   rc = cRosNodeRegisterPublisher ( node, "float64 data\n\n", "/float64", "std_msgs/Float64",
-                                   "fdb28210bfa9d7c91146260178d9a584", 1000, float64_pub_callback, NULL, NULL);
+                                   "fdb28210bfa9d7c91146260178d9a584", 1000, float64_pub_callback, NULL, NULL, 0);
   if (rc == -1)
     return EXIT_FAILURE;
 
   // STD_MSGS Subscribers
   rc = cRosNodeRegisterSubscriber ( node, "bool data\n\n", "/bool", "std_msgs/Bool",
-                                   "8b94c1b53db61fb6aed406028ad6332a", bool_sub_callback, NULL, NULL, 0);
+                                   "8b94c1b53db61fb6aed406028ad6332a", bool_sub_callback, NULL, NULL, 0, 0);
   if (rc == -1)
     return EXIT_FAILURE;
 
   rc = cRosNodeRegisterSubscriber ( node, "byte data\n\n", "/byte", "std_msgs/Byte",
-                                   "ad736a2e8818154c487bb80fe42ce43b", byte_sub_callback, NULL, NULL, 0);
+                                   "ad736a2e8818154c487bb80fe42ce43b", byte_sub_callback, NULL, NULL, 0, 0);
     return EXIT_FAILURE;
 
   rc = cRosNodeRegisterSubscriber ( node, "char data\n\n", "/char", "std_msgs/Char",
-                                   "1bf77f25acecdedba0e224b162199717", char_sub_callback, NULL, NULL, 0);
+                                   "1bf77f25acecdedba0e224b162199717", char_sub_callback, NULL, NULL, 0, 0);
   if (rc == -1)
     return EXIT_FAILURE;
 
   rc = cRosNodeRegisterSubscriber ( node, "duration data\n\n", "/duration", "std_msgs/Duration",
-                                   "3e286caf4241d664e55f3ad380e2ae46", duration_sub_callback, NULL, NULL, 0);
+                                   "3e286caf4241d664e55f3ad380e2ae46", duration_sub_callback, NULL, NULL, 0, 0);
   if (rc == -1)
     return EXIT_FAILURE;
 
   rc = cRosNodeRegisterSubscriber ( node, header_def, "/header", "std_msgs/Header",
-                                   "2176decaecbce78abc3b96ef049fabed", header_sub_callback, NULL, NULL, 0);
+                                   "2176decaecbce78abc3b96ef049fabed", header_sub_callback, NULL, NULL, 0, 0);
   if (rc == -1)
     return EXIT_FAILURE;
 
   rc = cRosNodeRegisterSubscriber ( node, "int16 data\n\n", "/int16", "std_msgs/Int16",
-                                   "8524586e34fbd7cb1c08c5f5f1ca0e57", int16_sub_callback, NULL, NULL, 0);
+                                   "8524586e34fbd7cb1c08c5f5f1ca0e57", int16_sub_callback, NULL, NULL, 0, 0);
   if (rc == -1)
     return EXIT_FAILURE;
 
   rc = cRosNodeRegisterSubscriber ( node, "int32 data\n\n", "/int32", "std_msgs/Int32",
-                                   "da5909fbe378aeaf85e547e830cc1bb7", int32_sub_callback, NULL, NULL, 0);
+                                   "da5909fbe378aeaf85e547e830cc1bb7", int32_sub_callback, NULL, NULL, 0, 0);
   if (rc == -1)
     return EXIT_FAILURE;
 
   rc = cRosNodeRegisterSubscriber ( node, "int64 data\n\n", "/int64", "std_msgs/Int64",
-                                   "34add168574510e6e17f5d23ecc077ef", int64_sub_callback, NULL, NULL, 0);
+                                   "34add168574510e6e17f5d23ecc077ef", int64_sub_callback, NULL, NULL, 0, 0);
   if (rc == -1)
     return EXIT_FAILURE;
 
   rc = cRosNodeRegisterSubscriber ( node, "int8 data\n\n", "/int8", "std_msgs/Int8",
-                                   "27ffa0c9c4b8fb8492252bcad9e5c57b", int8_sub_callback, NULL, NULL, 0);
+                                   "27ffa0c9c4b8fb8492252bcad9e5c57b", int8_sub_callback, NULL, NULL, 0, 0);
   if (rc == -1)
     return EXIT_FAILURE;
 
   rc = cRosNodeRegisterSubscriber ( node, "time data\n\n", "/time", "std_msgs/Time",
-                                   "cd7166c74c552c311fbcc2fe5a7bc289", time_sub_callback, NULL, NULL, 0);
+                                   "cd7166c74c552c311fbcc2fe5a7bc289", time_sub_callback, NULL, NULL, 0, 0);
     return EXIT_FAILURE;
 
   rc = cRosNodeRegisterSubscriber ( node, "uint16 data\n\n", "/uint16", "std_msgs/UInt16",
-                                   "1df79edf208b629fe6b81923a544552d", uint16_sub_callback, NULL, NULL, 0);
+                                   "1df79edf208b629fe6b81923a544552d", uint16_sub_callback, NULL, NULL, 0, 0);
   if (rc == -1)
     return EXIT_FAILURE;
 
   rc = cRosNodeRegisterSubscriber ( node, "uint32 data\n\n", "/uint32", "std_msgs/UInt32",
-                                   "304a39449588c7f8ce2df6e8001c5fce", uint32_sub_callback, NULL, NULL, 0);
+                                   "304a39449588c7f8ce2df6e8001c5fce", uint32_sub_callback, NULL, NULL, 0, 0);
   if (rc == -1)
     return EXIT_FAILURE;
   rc = cRosNodeRegisterSubscriber ( node, "uint64 data\n\n", "/uint64", "std_msgs/UInt64",
-                                   "1b2a79973e8bf53d7b53acb71299cb57", uint64_sub_callback, NULL, NULL, 0);
+                                   "1b2a79973e8bf53d7b53acb71299cb57", uint64_sub_callback, NULL, NULL, 0, 0);
   if (rc == -1)
     return EXIT_FAILURE;
 
   rc = cRosNodeRegisterSubscriber ( node, "uint8 data\n\n", "/uint8", "std_msgs/UInt8",
-                                   "7c8164229e7d2c17eb95e9231617fdee", uint8_sub_callback, NULL, NULL, 0);
+                                   "7c8164229e7d2c17eb95e9231617fdee", uint8_sub_callback, NULL, NULL, 0, 0);
   if (rc == -1)
     return EXIT_FAILURE;
 
   rc = cRosNodeRegisterSubscriber ( node, "float32 data\n\n", "/float32", "std_msgs/Float32",
-                                   "73fcbf46b49191e672908e50842a83d4", float32_sub_callback, NULL, NULL, 0);
+                                   "73fcbf46b49191e672908e50842a83d4", float32_sub_callback, NULL, NULL, 0, 0);
   if (rc == -1)
     return EXIT_FAILURE;
 
   rc = cRosNodeRegisterSubscriber ( node, "float64 data\n\n", "/float64", "std_msgs/Float64",
-                                   "fdb28210bfa9d7c91146260178d9a584", float64_sub_callback, NULL, NULL, 0);
+                                   "fdb28210bfa9d7c91146260178d9a584", float64_sub_callback, NULL, NULL, 0, 0);
   if (rc == -1)
     return EXIT_FAILURE;
 
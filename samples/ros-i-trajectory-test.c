@@ -106,7 +106,7 @@ int main(int argc, char **argv)
     ROS_INFO(node, "cROS Node (version %.2f) created!\n", 0.9);
 
     err_cod = cRosApiRegisterSubscriber(node, "/arm/joint_states", "sensor_msgs/JointState",
-                                   jointstates_sub_callback, NULL, NULL, 0, NULL);
+                                   jointstates_sub_callback, NULL, NULL, 0, 0, NULL);
     if (err_cod != CROS_SUCCESS_ERR_PACK)
         return EXIT_FAILURE;
 
@@ -9,7 +9,11 @@
 #include "cros_service.h"
 #include "cros_service_internal.h"
 #include "cros_message_queue.h"
+#include "cros_message_pool.h"
+#include "cros_message_registry.h"
+#include "cros_tcpros.h"
 #include "xmlrpc_process.h"
+#include "cros_clock.h"
 
 static LookupNodeResult * fetchLookupNodeResult(XmlrpcParamVector *response);
 static GetPublishedTopicsResult * fetchGetPublishedTopicsResult(XmlrpcParamVector *response);
@@ -64,11 +68,21 @@ typedef struct ProviderContext
   ProviderType type;
   cRosMessage *incoming;
   cRosMessage *outgoing;
-  char *message_definition;
-  char *md5sum;
+  const char *message_definition; // Full text of the type definition, owned by the node msg registry (or by the codec)
+  const char *md5sum; // MD5 sum of the type, owned by the node msg registry (or by the codec)
+  const CrosMessageCodec *codec; // Generated code of the type, used instead of incoming/outgoing by codec providers
+  void *codec_msg; // Generated struct of the type that is passed to the callback of codec providers
+  const CrosMessageCodec *response_codec; // Generated code of the response type, used instead of outgoing by codec service providers
+  void *response_codec_msg; // Generated struct of the response type that is passed to the callback of codec service providers
+  CrosMessageLayout *layout; // Layout of the type, used instead of incoming/outgoing by view subscribers and flat providers
+  cRosFlatMessage *flat_msg; // Flat message of the type that is passed to the callback of flat providers
+  int borrow_arrays; // If 1, the subscriber decodes the arrays of primitive values of incoming without copying them (see cRosApiSetSubscriberBorrowArrays())
+  cRosMessagePool msg_pool; // Messages created for the user (publisher and service caller: outgoing type, subscriber: incoming type)
+  cRosMessage *pool_prototype; // Pristine copy of the msg_pool type: incoming and outgoing are modified by the callbacks while the pool copies it
   NodeStatusCallback status_callback;
   void *api_callback;
-  cRosMessageQueue *msg_queue; // It is just a reference to the queue declared in node. For the publisher: msgs to send. For the subscriber: msgs received. For the svc caller: first svc request and then svc response
+  CrosNode *node; // Node owning the provider: its tables can be moved when they grow, so the msg queue is accessed through provider_idx
+  int provider_idx; // Index of the provider in the node table corresponding to type
   void *context;
 } ProviderContext;
 
@@ -79,29 +93,66 @@ static void initProviderContext(ProviderContext *context)
   context->outgoing=NULL;
   context->message_definition=NULL;
   context->md5sum=NULL;
+  context->codec=NULL;
+  context->codec_msg=NULL;
+  context->response_codec=NULL;
+  context->response_codec_msg=NULL;
+  context->layout=NULL;
+  context->flat_msg=NULL;
+  context->borrow_arrays=0;
+  cRosMessagePoolInit(&context->msg_pool, NULL, 0);
+  context->pool_prototype=NULL;
   context->status_callback=NULL;
   context->api_callback=NULL;
-  context->msg_queue=NULL;
+  context->node=NULL;
+  context->provider_idx=-1;
   context->context=NULL;
 }
 
+// Returns the msg queue declared in node for the provider. For the subscriber: msgs received. For the svc caller: first svc request and then svc response
+// (the messages published with cRosNodeSendTopicMsg() wait serialized in the outgoing queue of each TCPROS process)
+static cRosMessageQueue *getProviderMsgQueue(ProviderContext *context)
+{
+  switch (context->type)
+  {
+    case CROS_SUBSCRIBER:
+      return &context->node->subs[context->provider_idx].msg_queue;
+    case CROS_SERVICE_CALLER:
+      return &context->node->service_callers[context->provider_idx].msg_queue;
+    default:
+      return NULL;
+  }
+}
+
 static void freeProviderContext(ProviderContext *context)
 {
   if(context != NULL)
   {
+    cRosMessagePoolRelease(&context->msg_pool);
+    cRosMessageFree(context->pool_prototype);
     cRosMessageFree(context->incoming);
     cRosMessageFree(context->outgoing);
-    free(context->message_definition);
-    free(context->md5sum);
+    if(context->codec_msg != NULL)
+    {
+      context->codec->release(context->codec_msg);
+      free(context->codec_msg);
+    }
+    if(context->response_codec_msg != NULL)
+    {
+      context->response_codec->release(context->response_codec_msg);
+      free(context->response_codec_msg);
+    }
+    cRosFlatMessageFree(context->flat_msg);
+    cRosMessageLayoutFree(context->layout);
     free(context);
   }
 }
 
-static cRosErrCodePack newProviderContext(const char *provider_path, ProviderType type, ProviderContext **context_ptr)
+static cRosErrCodePack newProviderContext(CrosNode *node, const char *provider_path, ProviderType type, ProviderContext **context_ptr)
 {
   cRosErrCodePack ret_err;
-
-  ret_err = CROS_SUCCESS_ERR_PACK; // Default return value: success
+  const CrosMessageRegistryEntry *type_entry;
+  cRosMessage *pool_type;
 
   ProviderContext *context = (ProviderContext *)malloc(sizeof(ProviderContext));
   if (context == NULL)
@@ -109,43 +160,31 @@ static cRosErrCodePack newProviderContext(const char *provider_path, ProviderTyp
 
   initProviderContext(context);
   context->type = type;
-  context->md5sum = (char*) calloc(sizeof(char), 33);// 32 chars + '\0';
-  if (context->md5sum == NULL)
-  {
-    free(context);
-    return CROS_MEM_ALLOC_ERR;
-  }
 
+  // The type definition is only loaded from its file the first time that the node uses it: the messages of the
+  // provider are built from the definition stored in the registry and the MD5 sum and full text are referenced
   switch(type)
   {
     case CROS_SUBSCRIBER:
-    {
-      ret_err = cRosMessageNewBuild(NULL, provider_path, &context->incoming);
-      if (ret_err == CROS_SUCCESS_ERR_PACK)
-      {
-        strcpy(context->md5sum, context->incoming->md5sum);
-        context->message_definition = strdup(context->incoming->msgDef->plain_text); // Alloc new mem so that it can be freed independently
-      }
-      break;
-    }
     case CROS_PUBLISHER:
     {
-      ret_err = cRosMessageNewBuild(NULL, provider_path, &context->outgoing);
+      ret_err = cRosMessageRegistryGetMsg(&node->msg_registry, provider_path, &type_entry);
       if (ret_err == CROS_SUCCESS_ERR_PACK)
-      {
-        strcpy(context->md5sum, context->outgoing->md5sum);
-        context->message_definition = strdup(context->outgoing->msgDef->plain_text);
-      }
+        ret_err = cRosMessageBuildFromDef((type == CROS_SUBSCRIBER)? &context->incoming : &context->outgoing, type_entry->msg_def);
       break;
     }
     case CROS_SERVICE_PROVIDER:
     {
-      ret_err = cRosServiceBuildInner(&context->incoming, &context->outgoing, NULL, context->md5sum, provider_path);
+      ret_err = cRosMessageRegistryGetSrv(&node->msg_registry, provider_path, &type_entry);
+      if (ret_err == CROS_SUCCESS_ERR_PACK)
+        ret_err = cRosServiceBuildFromDef(&context->incoming, &context->outgoing, type_entry->srv_def);
       break;
     }
     case CROS_SERVICE_CALLER:
     {
-      ret_err = cRosServiceBuildInner(&context->outgoing, &context->incoming, &context->message_definition, context->md5sum, provider_path);
+      ret_err = cRosMessageRegistryGetSrv(&node->msg_registry, provider_path, &type_entry);
+      if (ret_err == CROS_SUCCESS_ERR_PACK)
+        ret_err = cRosServiceBuildFromDef(&context->outgoing, &context->incoming, type_entry->srv_def);
       break;
     }
     default:
@@ -155,6 +194,24 @@ static cRosErrCodePack newProviderContext(const char *provider_path, ProviderTyp
     }
   }
 
+  if(ret_err == CROS_SUCCESS_ERR_PACK)
+  {
+    context->md5sum = type_entry->md5sum;
+    context->message_definition = type_entry->message_definition;
+    pool_type = (type == CROS_SUBSCRIBER)? context->incoming : context->outgoing;
+    if(pool_type != NULL) // An empty service request or response is not built
+    {
+      context->pool_prototype = cRosMessageCopy(pool_type);
+      if(context->pool_prototype != NULL)
+      {
+        cRosMessagePoolRelease(&context->msg_pool); // Initialized again with the prototype of the provider type
+        cRosMessagePoolInit(&context->msg_pool, context->pool_prototype, 0);
+      }
+      else
+        ret_err = CROS_MEM_ALLOC_ERR;
+    }
+  }
+
   if(ret_err == CROS_SUCCESS_ERR_PACK)
     *context_ptr = context; // No error occurred: return the created context
   else
@@ -163,33 +220,96 @@ static cRosErrCodePack newProviderContext(const char *provider_path, ProviderTyp
   return ret_err;
 }
 
+// response_codec is only used by the service providers (the codecs of a service have the MD5 sum and text of the service)
+static cRosErrCodePack newCodecProviderContext(const CrosMessageCodec *codec, const CrosMessageCodec *response_codec, ProviderType type, ProviderContext **context_ptr)
+{
+  ProviderContext *context = (ProviderContext *)malloc(sizeof(ProviderContext));
+  if (context == NULL)
+    return CROS_MEM_ALLOC_ERR;
+
+  initProviderContext(context);
+  context->type = type;
+  context->codec_msg = malloc(codec->msg_size);
+  if (context->codec_msg == NULL)
+  {
+    free(context);
+    return CROS_MEM_ALLOC_ERR;
+  }
+  codec->init(context->codec_msg);
+  context->codec = codec;
+  context->md5sum = codec->md5sum;
+  context->message_definition = codec->message_definition;
+
+  if (response_codec != NULL)
+  {
+    context->response_codec_msg = malloc(response_codec->msg_size);
+    if (context->response_codec_msg == NULL)
+    {
+      freeProviderContext(context);
+      return CROS_MEM_ALLOC_ERR;
+    }
+    response_codec->init(context->response_codec_msg);
+    context->response_codec = response_codec;
+  }
+
+  *context_ptr = context;
+  return CROS_SUCCESS_ERR_PACK;
+}
+
+// Context of the view subscribers and of the flat providers, whose messages are accessed through the layout of the type
+static cRosErrCodePack newLayoutProviderContext(CrosNode *node, const char *provider_path, ProviderType type, int flat, ProviderContext **context_ptr)
+{
+  cRosErrCodePack ret_err;
+  const CrosMessageRegistryEntry *type_entry;
+  cRosMessage *pool_type;
+
+  ProviderContext *context = (ProviderContext *)malloc(sizeof(ProviderContext));
+  if (context == NULL)
+    return CROS_MEM_ALLOC_ERR;
+
+  initProviderContext(context);
+  context->type = type;
+
+  ret_err = cRosMessageRegistryGetMsg(&node->msg_registry, provider_path, &type_entry);
+  if (ret_err == CROS_SUCCESS_ERR_PACK)
+    ret_err = cRosMessageLayoutBuild(&context->layout, type_entry->msg_def);
+  if (ret_err == CROS_SUCCESS_ERR_PACK && flat)
+  {
+    context->flat_msg = cRosFlatMessageNew(context->layout);
+    if (context->flat_msg == NULL)
+      ret_err = CROS_MEM_ALLOC_ERR;
+  }
+
+  if(ret_err == CROS_SUCCESS_ERR_PACK)
+  {
+    context->md5sum = type_entry->md5sum;
+    context->message_definition = type_entry->message_definition;
+    *context_ptr = context;
+  }
+  else
+    freeProviderContext(context);
+
+  return ret_err;
+}
+
 static cRosErrCodePack cRosNodePublisherCallback(DynBuffer *buffer, int non_period_msg, void* context_)
 {
   cRosErrCodePack ret_err;
   CallbackResponse ret_cb;
   ProviderContext *context = (ProviderContext *)context_;
 
+  (void)non_period_msg; // The node only calls it for the periodic publication: cRosNodeSendTopicMsg() serializes the message itself
+
   ret_err = CROS_SUCCESS_ERR_PACK; // Default return value
-  if(non_period_msg != 0) // check that a msg is available in queue and that it has not been sent by this process yet
+  // Cast to the appropriate public api callback and invoke it on the user context
+  PublisherApiCallback publisherApiCallback = (SubscriberApiCallback)context->api_callback;
+  if(publisherApiCallback != NULL)
   {
-    if(cRosMessageQueueUsage(context->msg_queue) > 0)
-      ret_err = cRosMessageSerialize(cRosMessageQueuePeekFirst(context->msg_queue), buffer);
+    ret_cb = publisherApiCallback(context->outgoing, context->context);
+    if(ret_cb == 0)
+      ret_err = cRosMessageSerialize(context->outgoing, buffer);
     else
-      PRINT_ERROR ( "cRosNodePublisherCallback() : There is not an available message to be sent in the queue\n" );
-  }
-  else
-  {
-    // Cast to the appropriate public api callback and invoke it on the user context
-    PublisherApiCallback publisherApiCallback = (SubscriberApiCallback)context->api_callback;
-    if(publisherApiCallback != NULL)
-    {
-      ret_err = CROS_SUCCESS_ERR_PACK;
-      ret_cb = publisherApiCallback(context->outgoing, context->context); // Use the callback if it is available and no msg is waiting in the queue
-      if(ret_cb == 0)
-        ret_err = cRosMessageSerialize(context->outgoing, buffer);
-      else
-        ret_err = CROS_TOP_PUB_CALLBACK_ERR;
-    }
+      ret_err = CROS_TOP_PUB_CALLBACK_ERR;
   }
 
   if(ret_err != CROS_SUCCESS_ERR_PACK)
@@ -198,24 +318,52 @@ static cRosErrCodePack cRosNodePublisherCallback(DynBuffer *buffer, int non_peri
   return ret_err;
 }
 
+// Pass a received message to the user callback, and then move it to the subscriber queue
+static cRosErrCodePack consumeSubscriberMessage(ProviderContext *context, cRosMessage *message)
+{
+  cRosErrCodePack ret_err = CROS_SUCCESS_ERR_PACK;
+
+  // Cast to the appropriate public api callback and invoke it on the user context
+  SubscriberApiCallback subs_user_callback_fn = (SubscriberApiCallback)context->api_callback;
+  if(subs_user_callback_fn != NULL)
+  {
+    CallbackResponse ret_cb = subs_user_callback_fn(message, context->context);
+    if(ret_cb != 0)
+      ret_err = CROS_TOP_SUB_CALLBACK_ERR;
+  }
+
+  // Move the message to the queue once the callback has used it: message gets the fields of an already-consumed message
+  cRosMessageQueueAddSwap(getProviderMsgQueue(context), message);
+  return ret_err;
+}
+
+// Used for the messages decoded while they were received: the message belongs to the TCPROS process
+static cRosErrCodePack cRosNodeSubscriberMessageCallback(cRosMessage *message, void* context_)
+{
+  return consumeSubscriberMessage((ProviderContext *)context_, message);
+}
+
 static cRosErrCodePack cRosNodeSubscriberCallback(DynBuffer *buffer, void* context_)
 {
   cRosErrCodePack ret_err;
   ProviderContext *context = (ProviderContext *)context_;
-  ret_err = cRosMessageDeserialize(context->incoming, buffer);
-  if(ret_err == CROS_SUCCESS_ERR_PACK)
+  if(context->borrow_arrays)
   {
-    cRosMessageQueueAdd(context->msg_queue, context->incoming);
-
-    // Cast to the appropriate public api callback and invoke it on the user context
-    SubscriberApiCallback subs_user_callback_fn = (SubscriberApiCallback)context->api_callback;
-    if(subs_user_callback_fn != NULL)
+    // The received packet is moved to a message buffer that the arrays of incoming point into, and the TCPROS
+    // process allocates a new packet for the next message
+    cRosMessageBuffer *msg_buf = cRosMessageBufferNew(buffer);
+    if(msg_buf != NULL)
     {
-      CallbackResponse ret_cb = subs_user_callback_fn(context->incoming, context->context);
-      if(ret_cb != 0)
-        ret_err = CROS_TOP_SUB_CALLBACK_ERR;
+      ret_err = cRosMessageDeserializeBorrow(context->incoming, msg_buf);
+      cRosMessageBufferUnref(msg_buf); // incoming keeps its own reference while it uses the packet
     }
+    else
+      ret_err = CROS_MEM_ALLOC_ERR;
   }
+  else
+    ret_err = cRosMessageDeserialize(context->incoming, buffer);
+  if(ret_err == CROS_SUCCESS_ERR_PACK)
+    ret_err = consumeSubscriberMessage(context, context->incoming);
   else
     cRosPrintErrCodePack(ret_err, "cRosNodeSubscriberCallback() failed decoding the received packet");
 
@@ -223,6 +371,103 @@ static cRosErrCodePack cRosNodeSubscriberCallback(DynBuffer *buffer, void* conte
   return ret_err;
 }
 
+static cRosErrCodePack cRosNodeCodecPublisherCallback(DynBuffer *buffer, int non_period_msg, void* context_)
+{
+  cRosErrCodePack ret_err;
+  ProviderContext *context = (ProviderContext *)context_;
+
+  (void)non_period_msg; // Only called for the periodic publication, as cRosNodePublisherCallback()
+
+  ret_err = CROS_SUCCESS_ERR_PACK;
+  PublisherCodecApiCallback publisherApiCallback = (PublisherCodecApiCallback)context->api_callback;
+  if(publisherApiCallback != NULL)
+  {
+    if(publisherApiCallback(context->codec_msg, context->context) == 0)
+      ret_err = context->codec->serialize(context->codec_msg, buffer);
+    else
+      ret_err = CROS_TOP_PUB_CALLBACK_ERR;
+  }
+
+  if(ret_err != CROS_SUCCESS_ERR_PACK)
+    cRosPrintErrCodePack(ret_err, "cRosNodeCodecPublisherCallback() failed encoding the packet to send");
+
+  return ret_err;
+}
+
+static cRosErrCodePack cRosNodeCodecSubscriberCallback(DynBuffer *buffer, void* context_)
+{
+  cRosErrCodePack ret_err;
+  ProviderContext *context = (ProviderContext *)context_;
+
+  ret_err = context->codec->deserialize(context->codec_msg, buffer);
+  if(ret_err == CROS_SUCCESS_ERR_PACK)
+  {
+    SubscriberCodecApiCallback subs_user_callback_fn = (SubscriberCodecApiCallback)context->api_callback;
+    if(subs_user_callback_fn != NULL && subs_user_callback_fn(context->codec_msg, context->context) != 0)
+      ret_err = CROS_TOP_SUB_CALLBACK_ERR;
+  }
+  else
+    cRosPrintErrCodePack(ret_err, "cRosNodeCodecSubscriberCallback() failed decoding the received packet");
+
+  return ret_err;
+}
+
+static cRosErrCodePack cRosNodeViewSubscriberCallback(DynBuffer *buffer, void* context_)
+{
+  ProviderContext *context = (ProviderContext *)context_;
+  SubscriberViewApiCallback subs_user_callback_fn = (SubscriberViewApiCallback)context->api_callback;
+  cRosMessageView view;
+
+  // The fields are decoded by the callback directly from the received packet, only when it reads them
+  cRosMessageViewInit(&view, context->layout, dynBufferGetCurrentData(buffer), dynBufferGetRemainingDataSize(buffer));
+  if(subs_user_callback_fn != NULL && subs_user_callback_fn(&view, context->context) != 0)
+    return CROS_TOP_SUB_CALLBACK_ERR;
+
+  return CROS_SUCCESS_ERR_PACK;
+}
+
+static cRosErrCodePack cRosNodeFlatPublisherCallback(DynBuffer *buffer, int non_period_msg, void* context_)
+{
+  cRosErrCodePack ret_err;
+  ProviderContext *context = (ProviderContext *)context_;
+
+  (void)non_period_msg; // Only called for the periodic publication, as cRosNodePublisherCallback()
+
+  ret_err = CROS_SUCCESS_ERR_PACK;
+  PublisherFlatApiCallback publisherApiCallback = (PublisherFlatApiCallback)context->api_callback;
+  if(publisherApiCallback != NULL)
+  {
+    if(publisherApiCallback(context->flat_msg, context->context) == 0)
+      ret_err = cRosFlatMessageSerialize(context->flat_msg, buffer);
+    else
+      ret_err = CROS_TOP_PUB_CALLBACK_ERR;
+  }
+
+  if(ret_err != CROS_SUCCESS_ERR_PACK)
+    cRosPrintErrCodePack(ret_err, "cRosNodeFlatPublisherCallback() failed encoding the packet to send");
+
+  return ret_err;
+}
+
+static cRosErrCodePack cRosNodeFlatSubscriberCallback(DynBuffer *buffer, void* context_)
+{
+  cRosErrCodePack ret_err;
+  ProviderContext *context = (ProviderContext *)context_;
+
+  // Decoded by the serializer program of the layout, reusing the strings and arrays of the previous message
+  ret_err = cRosFlatMessageDeserialize(context->flat_msg, buffer);
+  if(ret_err == CROS_SUCCESS_ERR_PACK)
+  {
+    SubscriberFlatApiCallback subs_user_callback_fn = (SubscriberFlatApiCallback)context->api_callback;
+    if(subs_user_callback_fn != NULL && subs_user_callback_fn(context->flat_msg, context->context) != 0)
+      ret_err = CROS_TOP_SUB_CALLBACK_ERR;
+  }
+  else
+    cRosPrintErrCodePack(ret_err, "cRosNodeFlatSubscriberCallback() failed decoding the received packet");
+
+  return ret_err;
+}
+
 static cRosErrCodePack cRosNodeServiceCallerCallback(DynBuffer *request, DynBuffer *response, int call_resp_flag, void* contex_)
 {
   cRosErrCodePack ret_err;
@@ -235,7 +480,7 @@ static cRosErrCodePack cRosNodeServiceCallerCallback(DynBuffer *request, DynBuff
   if(call_resp_flag) // Process service response
   {
     // If msg_queue is empty, this is a periodic call (send msg response to callback fn), otherwise this is a non-periodic call (put msg response in the queue)
-    if(cRosMessageQueueUsage(context->msg_queue) == 0) // Periodic service call
+    if(cRosMessageQueueUsage(getProviderMsgQueue(context)) == 0) // Periodic service call
     {
       ret_err = cRosMessageDeserialize(context->incoming, response); // Deserialize the message response in incoming msg buffer
       if(ret_err == CROS_SUCCESS_ERR_PACK)
@@ -250,8 +495,8 @@ static cRosErrCodePack cRosNodeServiceCallerCallback(DynBuffer *request, DynBuff
     }
     else // Non-periodic service call
     {
-      if(cRosMessageQueueAdd(context->msg_queue, context->incoming) == 0) // Add response msg to the queue (in case the svc was called non periodically)
-        ret_err = cRosMessageDeserialize(cRosMessageQueuePeekLast(context->msg_queue), response); // Deserialize the message response directly in queue previously-added msg
+      if(cRosMessageQueueAddSwap(getProviderMsgQueue(context), context->incoming) == 0) // Add response msg to the queue (in case the svc was called non periodically)
+        ret_err = cRosMessageDeserialize(cRosMessageQueuePeekLast(getProviderMsgQueue(context)), response); // Deserialize the message response directly in queue previously-added msg
       else
         ret_err = CROS_MEM_ALLOC_ERR;
     }
@@ -261,7 +506,7 @@ static cRosErrCodePack cRosNodeServiceCallerCallback(DynBuffer *request, DynBuff
   else // Generate service request
   {
     // If msg_queue is empty, this is a periodic call (get the msg request from the callback fn), otherwise this is a non-periodic call (get msg request from the queue)
-    if(cRosMessageQueueUsage(context->msg_queue) == 0) // Periodic service call
+    if(cRosMessageQueueUsage(getProviderMsgQueue(context)) == 0) // Periodic service call
     {
       if(svc_call_user_callback_fn != NULL)
       {
@@ -275,7 +520,7 @@ static cRosErrCodePack cRosNodeServiceCallerCallback(DynBuffer *request, DynBuff
         ret_err = CROS_SUCCESS_ERR_PACK;
     }
     else // Non-periodic service call
-      ret_err = cRosMessageSerialize(cRosMessageQueuePeekFirst(context->msg_queue), request); // Serialize the message request directly from the queue msg
+      ret_err = cRosMessageSerialize(cRosMessageQueuePeekFirst(getProviderMsgQueue(context)), request); // Serialize the message request directly from the queue msg
     if(ret_err != CROS_SUCCESS_ERR_PACK)
       cRosPrintErrCodePack(ret_err, "cRosNodeServiceCallerCallback() failed encoding the service request packet");
   }
@@ -303,6 +548,32 @@ static cRosErrCodePack cRosNodeServiceProviderCallback(DynBuffer *request, DynBu
   return ret_err;
 }
 
+static cRosErrCodePack cRosNodeCodecServiceProviderCallback(DynBuffer *request, DynBuffer *response, void* contex_)
+{
+  cRosErrCodePack ret_err;
+  ProviderContext *context = (ProviderContext *)contex_;
+  ServiceProviderCodecApiCallback serviceProviderApiCallback = (ServiceProviderCodecApiCallback)context->api_callback;
+
+  ret_err = context->codec->deserialize(context->codec_msg, request);
+  if(ret_err != CROS_SUCCESS_ERR_PACK)
+  {
+    cRosPrintErrCodePack(ret_err, "cRosNodeCodecServiceProviderCallback() failed decoding the received packet");
+    return ret_err;
+  }
+
+  if(serviceProviderApiCallback(context->codec_msg, context->response_codec_msg, context->context) != 0)
+    ret_err = CROS_SVC_SER_CALLBACK_ERR;
+
+  // The response is sent also when the callback fails, as in cRosNodeServiceProviderCallback()
+  cRosErrCodePack ser_err = context->response_codec->serialize(context->response_codec_msg, response);
+  if(ser_err != CROS_SUCCESS_ERR_PACK)
+  {
+    cRosPrintErrCodePack(ser_err, "cRosNodeCodecServiceProviderCallback() failed encoding the packet to send");
+    ret_err = ser_err;
+  }
+  return ret_err;
+}
+
 static void cRosNodeStatusCallback(CrosNodeStatusUsr *status, void* context_)
 {
   ProviderContext *context = (ProviderContext *)context_;
@@ -318,7 +589,7 @@ cRosErrCodePack cRosApiRegisterServiceCaller(CrosNode *node, const char *service
   int svcidx;
 
   getSrvFilePath(node, path, PATH_MAX, service_type);
-  ret_err = newProviderContext(path, CROS_SERVICE_CALLER, &nodeContext);
+  ret_err = newProviderContext(node, path, CROS_SERVICE_CALLER, &nodeContext);
   if (ret_err == CROS_SUCCESS_ERR_PACK)
   {
     nodeContext->api_callback = callback;
@@ -333,7 +604,8 @@ cRosErrCodePack cRosApiRegisterServiceCaller(CrosNode *node, const char *service
     {
       if(svcidx_ptr != NULL)
         *svcidx_ptr = svcidx; // Return the index of the created service caller
-      nodeContext->msg_queue = &node->service_callers[svcidx].msg_queue;
+      nodeContext->node = node; // Allow the callback functions to access the msg queue
+      nodeContext->provider_idx = svcidx;
     }
     else
       ret_err=CROS_MEM_ALLOC_ERR;
@@ -341,6 +613,27 @@ cRosErrCodePack cRosApiRegisterServiceCaller(CrosNode *node, const char *service
   return ret_err;
 }
 
+cRosErrCodePack cRosApiSetServiceCallerLoopPeriodUs(CrosNode *node, int svcidx, int64_t loop_period_us)
+{
+  if (svcidx < 0 || svcidx >= node->service_callers_table.size)
+    return CROS_BAD_PARAM_ERR;
+
+  ServiceCallerNode *svc = &node->service_callers[svcidx];
+  if (svc->service_name == NULL)
+    return CROS_BAD_PARAM_ERR;
+
+  svc->loop_period_ns = (loop_period_us >= 0)? loop_period_us * CROS_CLOCK_NS_PER_US : -1;
+
+  // Wake up the service connection now, so that the new period is used from the next call
+  if (svc->client_rpcros_id >= 0)
+  {
+    node->rpcros_client_proc[svc->client_rpcros_id].wake_up_time = 0;
+    cRosPollerEntryNotify(&node->rpcros_client_proc[svc->client_rpcros_id].poller_entry); // Its timer is armed again
+  }
+
+  return CROS_SUCCESS_ERR_PACK;
+}
+
 void cRosApiReleaseServiceCaller(CrosNode *node, int svcidx)
 {
   ServiceCallerNode *svc = &node->service_callers[svcidx];
@@ -358,7 +651,7 @@ cRosErrCodePack cRosApiRegisterServiceProvider(CrosNode *node, const char *servi
   int svcidx;
 
   getSrvFilePath(node, path, PATH_MAX, service_type);
-  ret_err = newProviderContext(path, CROS_SERVICE_PROVIDER, &nodeContext);
+  ret_err = newProviderContext(node, path, CROS_SERVICE_PROVIDER, &nodeContext);
   if (ret_err == CROS_SUCCESS_ERR_PACK)
   {
     nodeContext->api_callback = callback;
@@ -379,10 +672,46 @@ cRosErrCodePack cRosApiRegisterServiceProvider(CrosNode *node, const char *servi
   return ret_err;
 }
 
+cRosErrCodePack cRosApiRegisterServiceProviderCodec(CrosNode *node, const char *service_name, const char *service_type,
+                                   const CrosMessageCodec *request_codec, const CrosMessageCodec *response_codec,
+                                   ServiceProviderCodecApiCallback callback, NodeStatusCallback status_callback, void *context, int *svcidx_ptr)
+{
+  cRosErrCodePack ret_err;
+  ProviderContext *nodeContext = NULL;
+  int svcidx;
+
+  if (callback == NULL) // Unlike the publishers, the response is always generated by the callback
+    return CROS_BAD_PARAM_ERR;
+
+  ret_err = newCodecProviderContext(request_codec, response_codec, CROS_SERVICE_PROVIDER, &nodeContext);
+  if (ret_err == CROS_SUCCESS_ERR_PACK)
+  {
+    nodeContext->api_callback = callback;
+    nodeContext->status_callback = status_callback;
+    nodeContext->context = context;
+
+    svcidx = cRosNodeRegisterServiceProvider(node, service_name, service_type, nodeContext->md5sum, cRosNodeCodecServiceProviderCallback,
+                                              status_callback == NULL ? NULL : cRosNodeStatusCallback, nodeContext);
+    if(svcidx >= 0) // Success
+    {
+      nodeContext->node = node;
+      nodeContext->provider_idx = svcidx;
+      if(svcidx_ptr != NULL)
+        *svcidx_ptr = svcidx;
+    }
+    else
+    {
+      freeProviderContext(nodeContext);
+      ret_err=CROS_MEM_ALLOC_ERR;
+    }
+  }
+  return ret_err;
+}
+
 cRosErrCodePack cRosApiUnregisterServiceProvider(CrosNode *node, int svcidx)
 {
   int ret_err;
-  if (svcidx < 0 || svcidx >= CN_MAX_SERVICE_PROVIDERS)
+  if (svcidx < 0 || svcidx >= node->service_providers_table.size)
     return CROS_BAD_PARAM_ERR;
 
   ServiceProviderNode *service = &node->service_providers[svcidx];
@@ -403,7 +732,7 @@ void cRosApiReleaseServiceProvider(CrosNode *node, int svcidx)
 }
 
 cRosErrCodePack cRosApiRegisterSubscriber(CrosNode *node, const char *topic_name, const char *topic_type,
-                              SubscriberApiCallback callback, NodeStatusCallback status_callback, void *context, int tcp_nodelay, int *subidx_ptr)
+                              SubscriberApiCallback callback, NodeStatusCallback status_callback, void *context, int tcp_nodelay, int queue_size, int *subidx_ptr)
 {
   cRosErrCodePack ret_err;
   char path[PATH_MAX];
@@ -411,7 +740,7 @@ cRosErrCodePack cRosApiRegisterSubscriber(CrosNode *node, const char *topic_name
   int subidx;
 
   cRosGetMsgFilePath(node, path, PATH_MAX, topic_type);
-  ret_err = newProviderContext(path, CROS_SUBSCRIBER, &nodeContext);
+  ret_err = newProviderContext(node, path, CROS_SUBSCRIBER, &nodeContext);
   if (ret_err == CROS_SUCCESS_ERR_PACK)
   {
     nodeContext->api_callback = callback;
@@ -421,10 +750,14 @@ cRosErrCodePack cRosApiRegisterSubscriber(CrosNode *node, const char *topic_name
   // NB: Pass the private ProviderContext to the private api, not the user context
     subidx = cRosNodeRegisterSubscriber(node, nodeContext->message_definition, topic_name, topic_type,
                                   nodeContext->md5sum, cRosNodeSubscriberCallback,
-                                  status_callback == NULL ? NULL : cRosNodeStatusCallback, nodeContext, tcp_nodelay);
+                                  status_callback == NULL ? NULL : cRosNodeStatusCallback, nodeContext, tcp_nodelay, queue_size);
     if(subidx >= 0) // Success
     {
-      nodeContext->msg_queue = &node->subs[subidx].msg_queue; // Allow the callback functions to access the msg queue
+      nodeContext->node = node; // Allow the callback functions to access the msg queue
+      nodeContext->provider_idx = subidx;
+      // The large messages are decoded while they are received, each connection into its own copy of incoming
+      node->subs[subidx].msg_callback = cRosNodeSubscriberMessageCallback;
+      node->subs[subidx].msg_prototype = nodeContext->incoming;
       if(subidx_ptr != NULL)
         *subidx_ptr = subidx; // Return the index of the created service caller
     }
@@ -437,7 +770,7 @@ cRosErrCodePack cRosApiRegisterSubscriber(CrosNode *node, const char *topic_name
 cRosErrCodePack cRosApiUnregisterSubscriber(CrosNode *node, int subidx)
 {
   int ret_err;
-  if (subidx < 0 || subidx >= CN_MAX_SUBSCRIBED_TOPICS)
+  if (subidx < 0 || subidx >= node->subs_table.size)
     return CROS_BAD_PARAM_ERR;
 
   SubscriberNode *sub = &node->subs[subidx];
@@ -457,8 +790,145 @@ void cRosApiReleaseSubscriber(CrosNode *node, int subidx)
   cRosNodeReleaseSubscriber(sub);
 }
 
+cRosErrCodePack cRosApiSetSubscriberBorrowArrays(CrosNode *node, int subidx, int enable)
+{
+  if (subidx < 0 || subidx >= node->subs_table.size)
+    return CROS_BAD_PARAM_ERR;
+
+  SubscriberNode *sub = &node->subs[subidx];
+  if (sub->topic_name == NULL)
+    return CROS_TOPIC_SUB_IND_ERR;
+
+  if (sub->callback != cRosNodeSubscriberCallback) // Codec, view and flat subscribers do not decode cRosMessage objects
+    return CROS_BAD_PARAM_ERR;
+
+  ((ProviderContext *)sub->context)->borrow_arrays = (enable != 0);
+  // The borrowed arrays point into the whole received packet, so the messages cannot be decoded while they are received
+  sub->msg_callback = (enable != 0)? NULL : cRosNodeSubscriberMessageCallback;
+  return CROS_SUCCESS_ERR_PACK;
+}
+
+cRosErrCodePack cRosApiSetSubscriberStreamMinSize(CrosNode *node, int subidx, size_t min_size)
+{
+  if (subidx < 0 || subidx >= node->subs_table.size)
+    return CROS_BAD_PARAM_ERR;
+
+  SubscriberNode *sub = &node->subs[subidx];
+  if (sub->topic_name == NULL)
+    return CROS_TOPIC_SUB_IND_ERR;
+
+  if (sub->callback != cRosNodeSubscriberCallback) // Codec, view and flat subscribers do not decode cRosMessage objects
+    return CROS_BAD_PARAM_ERR;
+
+  sub->stream_min_size = min_size;
+  return CROS_SUCCESS_ERR_PACK;
+}
+
+cRosErrCodePack cRosApiRegisterSubscriberCodec(CrosNode *node, const char *topic_name, const CrosMessageCodec *codec,
+                              SubscriberCodecApiCallback callback, NodeStatusCallback status_callback, void *context, int tcp_nodelay, int *subidx_ptr)
+{
+  cRosErrCodePack ret_err;
+  ProviderContext *nodeContext = NULL;
+  int subidx;
+
+  ret_err = newCodecProviderContext(codec, NULL, CROS_SUBSCRIBER, &nodeContext);
+  if (ret_err == CROS_SUCCESS_ERR_PACK)
+  {
+    nodeContext->api_callback = callback;
+    nodeContext->status_callback = status_callback;
+    nodeContext->context = context;
+
+    subidx = cRosNodeRegisterSubscriber(node, nodeContext->message_definition, topic_name, codec->type,
+                                  nodeContext->md5sum, cRosNodeCodecSubscriberCallback,
+                                  status_callback == NULL ? NULL : cRosNodeStatusCallback, nodeContext, tcp_nodelay, 0);
+    if(subidx >= 0) // Success
+    {
+      nodeContext->node = node;
+      nodeContext->provider_idx = subidx;
+      if(subidx_ptr != NULL)
+        *subidx_ptr = subidx;
+    }
+    else
+    {
+      freeProviderContext(nodeContext);
+      ret_err=CROS_MEM_ALLOC_ERR;
+    }
+  }
+  return ret_err;
+}
+
+cRosErrCodePack cRosApiRegisterSubscriberView(CrosNode *node, const char *topic_name, const char *topic_type,
+                              SubscriberViewApiCallback callback, NodeStatusCallback status_callback, void *context, int tcp_nodelay, int *subidx_ptr)
+{
+  cRosErrCodePack ret_err;
+  char path[PATH_MAX];
+  ProviderContext *nodeContext = NULL;
+  int subidx;
+
+  cRosGetMsgFilePath(node, path, PATH_MAX, topic_type);
+  ret_err = newLayoutProviderContext(node, path, CROS_SUBSCRIBER, 0, &nodeContext);
+  if (ret_err == CROS_SUCCESS_ERR_PACK)
+  {
+    nodeContext->api_callback = callback;
+    nodeContext->status_callback = status_callback;
+    nodeContext->context = context;
+
+    subidx = cRosNodeRegisterSubscriber(node, nodeContext->message_definition, topic_name, topic_type,
+                                  nodeContext->md5sum, cRosNodeViewSubscriberCallback,
+                                  status_callback == NULL ? NULL : cRosNodeStatusCallback, nodeContext, tcp_nodelay, 0);
+    if(subidx >= 0) // Success
+    {
+      nodeContext->node = node;
+      nodeContext->provider_idx = subidx;
+      if(subidx_ptr != NULL)
+        *subidx_ptr = subidx;
+    }
+    else
+    {
+      freeProviderContext(nodeContext);
+      ret_err=CROS_MEM_ALLOC_ERR;
+    }
+  }
+  return ret_err;
+}
+
+cRosErrCodePack cRosApiRegisterSubscriberFlat(CrosNode *node, const char *topic_name, const char *topic_type,
+                              SubscriberFlatApiCallback callback, NodeStatusCallback status_callback, void *context, int tcp_nodelay, int *subidx_ptr)
+{
+  cRosErrCodePack ret_err;
+  char path[PATH_MAX];
+  ProviderContext *nodeContext = NULL;
+  int subidx;
+
+  cRosGetMsgFilePath(node, path, PATH_MAX, topic_type);
+  ret_err = newLayoutProviderContext(node, path, CROS_SUBSCRIBER, 1, &nodeContext);
+  if (ret_err == CROS_SUCCESS_ERR_PACK)
+  {
+    nodeContext->api_callback = callback;
+    nodeContext->status_callback = status_callback;
+    nodeContext->context = context;
+
+    subidx = cRosNodeRegisterSubscriber(node, nodeContext->message_definition, topic_name, topic_type,
+                                  nodeContext->md5sum, cRosNodeFlatSubscriberCallback,
+                                  status_callback == NULL ? NULL : cRosNodeStatusCallback, nodeContext, tcp_nodelay, 0);
+    if(subidx >= 0) // Success
+    {
+      nodeContext->node = node;
+      nodeContext->provider_idx = subidx;
+      if(subidx_ptr != NULL)
+        *subidx_ptr = subidx;
+    }
+    else
+    {
+      freeProviderContext(nodeContext);
+      ret_err=CROS_MEM_ALLOC_ERR;
+    }
+  }
+  return ret_err;
+}
+
 cRosErrCodePack cRosApiRegisterPublisher(CrosNode *node, const char *topic_name, const char *topic_type, int loop_period,
-                             PublisherApiCallback callback, NodeStatusCallback status_callback, void *context, int *pubidx_ptr)
+                             PublisherApiCallback callback, NodeStatusCallback status_callback, void *context, int queue_size, int *pubidx_ptr)
 {
   cRosErrCodePack ret_err;
   char path[PATH_MAX];
@@ -466,7 +936,7 @@ cRosErrCodePack cRosApiRegisterPublisher(CrosNode *node, const char *topic_name,
   int pubidx;
 
   cRosGetMsgFilePath(node, path, PATH_MAX, topic_type);
-  ret_err = newProviderContext(path, CROS_PUBLISHER, &nodeContext);
+  ret_err = newProviderContext(node, path, CROS_PUBLISHER, &nodeContext);
   if (ret_err == CROS_SUCCESS_ERR_PACK)
   {
     nodeContext->api_callback = callback;
@@ -476,11 +946,12 @@ cRosErrCodePack cRosApiRegisterPublisher(CrosNode *node, const char *topic_name,
     // NB: Pass the private ProviderContext to the private api, not the user context
     pubidx = cRosNodeRegisterPublisher(node, nodeContext->message_definition, topic_name, topic_type,
                                   nodeContext->md5sum, loop_period, cRosNodePublisherCallback,
-                                  status_callback == NULL ? NULL : cRosNodeStatusCallback, nodeContext);
+                                  status_callback == NULL ? NULL : cRosNodeStatusCallback, nodeContext, queue_size);
     if(pubidx >= 0) // Success
     {
       // Allow the callback functions to access the msg queue and send-now flag
-      nodeContext->msg_queue = &node->pubs[pubidx].msg_queue;
+      nodeContext->node = node;
+      nodeContext->provider_idx = pubidx;
       if(pubidx_ptr != NULL)
         *pubidx_ptr = pubidx; // Return the index of the created service caller
     }
@@ -493,7 +964,7 @@ cRosErrCodePack cRosApiRegisterPublisher(CrosNode *node, const char *topic_name,
 cRosErrCodePack cRosApiUnregisterPublisher(CrosNode *node, int pubidx)
 {
   int ret_err;
-  if (pubidx < 0 || pubidx >= CN_MAX_PUBLISHED_TOPICS)
+  if (pubidx < 0 || pubidx >= node->pubs_table.size)
     return CROS_BAD_PARAM_ERR;
 
   PublisherNode *pub = &node->pubs[pubidx];
@@ -505,6 +976,29 @@ cRosErrCodePack cRosApiUnregisterPublisher(CrosNode *node, int pubidx)
   return (ret_err != -1)? CROS_SUCCESS_ERR_PACK: CROS_UNSPECIFIED_ERR;
 }
 
+cRosErrCodePack cRosApiSetPublisherLoopPeriodUs(CrosNode *node, int pubidx, int64_t loop_period_us)
+{
+  int i;
+  if (pubidx < 0 || pubidx >= node->pubs_table.size)
+    return CROS_BAD_PARAM_ERR;
+
+  PublisherNode *pub = &node->pubs[pubidx];
+  if (pub->topic_name == NULL)
+    return CROS_TOPIC_PUB_IND_ERR;
+
+  pub->loop_period_ns = (loop_period_us >= 0)? loop_period_us * CROS_CLOCK_NS_PER_US : -1;
+
+  // Wake up the subscriber connections now, so that the new period is used from the next publication
+  for (i = 0; i < node->tcpros_server_proc_table.size; i++)
+    if (node->tcpros_server_proc[i].topic_idx == pubidx)
+    {
+      node->tcpros_server_proc[i].wake_up_time = 0;
+      cRosPollerEntryNotify(&node->tcpros_server_proc[i].poller_entry); // Its timer is armed again
+    }
+
+  return CROS_SUCCESS_ERR_PACK;
+}
+
 void cRosApiReleasePublisher(CrosNode *node, int pubidx)
 {
   PublisherNode *pub = &node->pubs[pubidx];
@@ -513,6 +1007,146 @@ void cRosApiReleasePublisher(CrosNode *node, int pubidx)
   cRosNodeReleasePublisher(pub);
 }
 
+cRosErrCodePack cRosApiRegisterPublisherCodec(CrosNode *node, const char *topic_name, const CrosMessageCodec *codec, int loop_period,
+                             PublisherCodecApiCallback callback, NodeStatusCallback status_callback, void *context, int queue_size, int *pubidx_ptr)
+{
+  cRosErrCodePack ret_err;
+  ProviderContext *nodeContext = NULL;
+  int pubidx;
+
+  ret_err = newCodecProviderContext(codec, NULL, CROS_PUBLISHER, &nodeContext);
+  if (ret_err == CROS_SUCCESS_ERR_PACK)
+  {
+    nodeContext->api_callback = callback;
+    nodeContext->status_callback = status_callback;
+    nodeContext->context = context;
+
+    pubidx = cRosNodeRegisterPublisher(node, nodeContext->message_definition, topic_name, codec->type,
+                                  nodeContext->md5sum, loop_period, cRosNodeCodecPublisherCallback,
+                                  status_callback == NULL ? NULL : cRosNodeStatusCallback, nodeContext, queue_size);
+    if(pubidx >= 0) // Success
+    {
+      nodeContext->node = node;
+      nodeContext->provider_idx = pubidx;
+      if(pubidx_ptr != NULL)
+        *pubidx_ptr = pubidx;
+    }
+    else
+    {
+      freeProviderContext(nodeContext);
+      ret_err=CROS_MEM_ALLOC_ERR;
+    }
+  }
+  return ret_err;
+}
+
+cRosErrCodePack cRosApiRegisterPublisherFlat(CrosNode *node, const char *topic_name, const char *topic_type, int loop_period,
+                             PublisherFlatApiCallback callback, NodeStatusCallback status_callback, void *context, int queue_size, int *pubidx_ptr)
+{
+  cRosErrCodePack ret_err;
+  char path[PATH_MAX];
+  ProviderContext *nodeContext = NULL;
+  int pubidx;
+
+  cRosGetMsgFilePath(node, path, PATH_MAX, topic_type);
+  ret_err = newLayoutProviderContext(node, path, CROS_PUBLISHER, 1, &nodeContext);
+  if (ret_err == CROS_SUCCESS_ERR_PACK)
+  {
+    nodeContext->api_callback = callback;
+    nodeContext->status_callback = status_callback;
+    nodeContext->context = context;
+
+    pubidx = cRosNodeRegisterPublisher(node, nodeContext->message_definition, topic_name, topic_type,
+                                  nodeContext->md5sum, loop_period, cRosNodeFlatPublisherCallback,
+                                  status_callback == NULL ? NULL : cRosNodeStatusCallback, nodeContext, queue_size);
+    if(pubidx >= 0) // Success
+    {
+      nodeContext->node = node;
+      nodeContext->provider_idx = pubidx;
+      if(pubidx_ptr != NULL)
+        *pubidx_ptr = pubidx;
+    }
+    else
+    {
+      freeProviderContext(nodeContext);
+      ret_err=CROS_MEM_ALLOC_ERR;
+    }
+  }
+  return ret_err;
+}
+
+// Returns the context of a publisher registered with the given callback, or NULL if pubidx is not such a publisher
+static ProviderContext *getPublisherContext(CrosNode *node, int pubidx, PublisherCallback callback)
+{
+  if (pubidx < 0 || pubidx >= node->pubs_table.size)
+    return NULL;
+
+  PublisherNode *pub = &node->pubs[pubidx];
+  if (pub->topic_name == NULL || pub->callback != callback)
+    return NULL;
+
+  return (ProviderContext *)pub->context;
+}
+
+cRosErrCodePack cRosNodeSendTopicCodecMsg(CrosNode *node, int pubidx, const void *msg, unsigned long time_out)
+{
+  cRosErrCodePack ret_err;
+  TcprosFrame *frame;
+  ProviderContext *context = getPublisherContext(node, pubidx, cRosNodeCodecPublisherCallback);
+
+  (void)time_out; // As in cRosNodeSendTopicMsg(), publishing never waits for the subscribers
+
+  if (context == NULL || msg == NULL)
+    return CROS_BAD_PARAM_ERR;
+
+  frame = cRosMessageOpenPublicationFrame(context->codec->serialized_size(msg));
+  if (frame == NULL)
+    return CROS_MEM_ALLOC_ERR;
+
+  ret_err = context->codec->serialize(msg, &frame->packet);
+  if (ret_err != CROS_SUCCESS_ERR_PACK)
+  {
+    tcprosFrameUnref(frame);
+    return ret_err;
+  }
+  cRosMessageClosePublicationFrame(frame);
+
+  return cRosNodeSendTopicFrame(node, pubidx, frame);
+}
+
+cRosFlatMessage *cRosApiCreatePublisherFlatMessage(CrosNode *node, int pubidx)
+{
+  ProviderContext *context = getPublisherContext(node, pubidx, cRosNodeFlatPublisherCallback);
+  return (context != NULL)? cRosFlatMessageNew(context->layout) : NULL;
+}
+
+cRosErrCodePack cRosNodeSendTopicFlatMsg(CrosNode *node, int pubidx, cRosFlatMessage *msg, unsigned long time_out)
+{
+  cRosErrCodePack ret_err;
+  TcprosFrame *frame;
+  ProviderContext *context = getPublisherContext(node, pubidx, cRosNodeFlatPublisherCallback);
+
+  (void)time_out; // As in cRosNodeSendTopicMsg(), publishing never waits for the subscribers
+
+  // The message can also have been created from a layout built by the user for the same type
+  if (context == NULL || msg == NULL || strcmp(msg->layout->md5sum, context->md5sum) != 0)
+    return CROS_BAD_PARAM_ERR;
+
+  frame = cRosMessageOpenPublicationFrame(cRosFlatMessageSize(msg));
+  if (frame == NULL)
+    return CROS_MEM_ALLOC_ERR;
+
+  ret_err = cRosFlatMessageSerialize(msg, &frame->packet);
+  if (ret_err != CROS_SUCCESS_ERR_PACK)
+  {
+    tcprosFrameUnref(frame);
+    return ret_err;
+  }
+  cRosMessageClosePublicationFrame(frame);
+
+  return cRosNodeSendTopicFrame(node, pubidx, frame);
+}
+
 cRosErrCodePack cRosApicRosApiLookupNode(CrosNode *node, const char *node_name, LookupNodeCallback callback, void *context, int *caller_id_ptr)
 {
   int caller_id;
@@ -1857,44 +2491,76 @@ clean:
   return NULL;
 }
 
-cRosMessage *cRosApiCreatePublisherMessage(CrosNode *node, int pubidx)
+// Returns the message pool of a publisher, subscriber or service caller, or NULL if idx is not a registered provider of that type
+static cRosMessagePool *getProviderMsgPool(CrosNode *node, ProviderType type, int idx)
 {
-  cRosMessage *new_msg;
-  ProviderContext *pub_context;
-  PublisherNode *pub;
+  void *context = NULL;
 
-  if (pubidx < 0 || pubidx >= CN_MAX_PUBLISHED_TOPICS)
-    return NULL;
+  switch(type)
+  {
+    case CROS_PUBLISHER:
+      if (idx >= 0 && idx < node->pubs_table.size && node->pubs[idx].topic_name != NULL)
+        context = node->pubs[idx].context;
+      break;
+    case CROS_SUBSCRIBER:
+      if (idx >= 0 && idx < node->subs_table.size && node->subs[idx].topic_name != NULL)
+        context = node->subs[idx].context;
+      break;
+    case CROS_SERVICE_CALLER:
+      if (idx >= 0 && idx < node->service_callers_table.size && node->service_callers[idx].service_name != NULL)
+        context = node->service_callers[idx].context;
+      break;
+    default:
+      break;
+  }
 
-  pub = &node->pubs[pubidx];
-  if (pub->topic_name == NULL)
-    return NULL;
+  return (context != NULL)? &((ProviderContext *)context)->msg_pool : NULL;
+}
 
-  pub_context = pub->context;
-  new_msg = cRosMessageCopy(pub_context->outgoing);
+static cRosMessage *acquireProviderMessage(CrosNode *node, ProviderType type, int idx)
+{
+  cRosMessagePool *pool = getProviderMsgPool(node, type, idx);
+  return (pool != NULL)? cRosMessagePoolAcquire(pool) : NULL;
+}
 
-  return new_msg;
+static void recycleProviderMessage(CrosNode *node, ProviderType type, int idx, cRosMessage *msg)
+{
+  cRosMessagePool *pool = getProviderMsgPool(node, type, idx);
+  if (pool != NULL)
+    cRosMessagePoolRecycle(pool, msg);
+  else
+    cRosMessageFree(msg);
 }
 
-cRosMessage *cRosApiCreateServiceCallerRequest(CrosNode *node, int svcidx)
+cRosMessage *cRosApiCreatePublisherMessage(CrosNode *node, int pubidx)
 {
-  cRosMessage *new_msg;
-  ServiceCallerNode *svc_caller;
-  ProviderContext *caller_context;
+  return acquireProviderMessage(node, CROS_PUBLISHER, pubidx);
+}
 
-  if (svcidx < 0 || svcidx >= CN_MAX_SERVICE_CALLERS)
-    return NULL;
+void cRosApiRecyclePublisherMessage(CrosNode *node, int pubidx, cRosMessage *msg)
+{
+  recycleProviderMessage(node, CROS_PUBLISHER, pubidx, msg);
+}
 
-  svc_caller = &node->service_callers[svcidx];
-  if (svc_caller->service_name == NULL)
-    return NULL;
+cRosMessage *cRosApiCreateSubscriberMessage(CrosNode *node, int subidx)
+{
+  return acquireProviderMessage(node, CROS_SUBSCRIBER, subidx);
+}
 
-  caller_context = svc_caller->context;
-  new_msg = cRosMessageCopy(caller_context->outgoing);
+void cRosApiRecycleSubscriberMessage(CrosNode *node, int subidx, cRosMessage *msg)
+{
+  recycleProviderMessage(node, CROS_SUBSCRIBER, subidx, msg);
+}
 
-  return new_msg;
+cRosMessage *cRosApiCreateServiceCallerRequest(CrosNode *node, int svcidx)
+{
+  return acquireProviderMessage(node, CROS_SERVICE_CALLER, svcidx);
 }
 
+void cRosApiRecycleServiceCallerRequest(CrosNode *node, int svcidx, cRosMessage *msg)
+{
+  recycleProviderMessage(node, CROS_SERVICE_CALLER, svcidx, msg);
+}
 
 void freeLookupNodeResult(LookupNodeResult *result)
 {
@@ -0,0 +1,165 @@
+#include <stdlib.h>
+#include <string.h>
+
+#include "cros_arena.h"
+#include "cros_defs.h"
+
+// Alignment of the blocks, enough for any primitive message value (int64_t, double or a pointer)
+#define ARENA_ALIGN 8
+#define ARENA_ALIGN_UP(n) ( ( (n) + ARENA_ALIGN - 1 ) & ~( (size_t)ARENA_ALIGN - 1 ) )
+
+// Each block is preceded by a header holding its size, so that it can be reallocated without knowing its old size
+#define BLOCK_HEADER_SIZE ARENA_ALIGN_UP( sizeof(size_t) )
+
+struct CrosArenaChunk
+{
+  CrosArenaChunk *next;                 // Next chunk of the list
+  size_t size;                          // Number of bytes of the chunk data
+  size_t used;                          // Number of bytes of the chunk data that are allocated
+};
+
+#define CHUNK_HEADER_SIZE ARENA_ALIGN_UP( sizeof(CrosArenaChunk) )
+
+static unsigned char *chunkData( CrosArenaChunk *chunk )
+{
+  return ( unsigned char * )chunk + CHUNK_HEADER_SIZE;
+}
+
+static size_t *blockHeader( void *block )
+{
+  return ( size_t * )( ( unsigned char * )block - BLOCK_HEADER_SIZE );
+}
+
+// Make the current chunk one with at least n_bytes free: the next unused chunk if it is large enough, or a new one
+static int nextChunk( CrosArena *arena, size_t n_bytes )
+{
+  CrosArenaChunk *next = ( arena->current != NULL )? arena->current->next : arena->first;
+  CrosArenaChunk *chunk;
+  size_t chunk_size;
+
+  if( next != NULL && next->size >= n_bytes )
+  {
+    arena->current = next;
+    return 0;
+  }
+
+  chunk_size = ( n_bytes > arena->chunk_size )? n_bytes : arena->chunk_size;
+  chunk = ( CrosArenaChunk * )malloc( CHUNK_HEADER_SIZE + chunk_size );
+  if( chunk == NULL )
+  {
+    PRINT_ERROR( "nextChunk() : Can't allocate memory\n" );
+    return -1;
+  }
+
+  // The new chunk is inserted before the unused ones, which are kept for the allocations after it
+  chunk->size = chunk_size;
+  chunk->used = 0;
+  chunk->next = next;
+  if( arena->current != NULL )
+    arena->current->next = chunk;
+  else
+    arena->first = chunk;
+  arena->current = chunk;
+  return 0;
+}
+
+void cRosArenaInit( CrosArena *arena, size_t chunk_size )
+{
+  arena->first = NULL;
+  arena->current = NULL;
+  arena->chunk_size = ( chunk_size > 0 )? chunk_size : CROS_ARENA_DEFAULT_CHUNK_SIZE;
+  arena->last_block = NULL;
+}
+
+void *cRosArenaAlloc( CrosArena *arena, size_t size )
+{
+  size_t block_size = ARENA_ALIGN_UP( size );
+  unsigned char *block;
+
+  if( arena->current == NULL || arena->current->size - arena->current->used < BLOCK_HEADER_SIZE + block_size )
+  {
+    if( nextChunk( arena, BLOCK_HEADER_SIZE + block_size ) != 0 )
+      return NULL;
+  }
+
+  block = chunkData( arena->current ) + arena->current->used + BLOCK_HEADER_SIZE;
+  *blockHeader( block ) = block_size;
+  arena->current->used += BLOCK_HEADER_SIZE + block_size;
+  arena->last_block = block;
+  return block;
+}
+
+void *cRosArenaCalloc( CrosArena *arena, size_t n_elems, size_t elem_size )
+{
+  void *block;
+
+  if( elem_size > 0 && n_elems > ( size_t )-1 / elem_size )
+    return NULL;
+
+  block = cRosArenaAlloc( arena, n_elems * elem_size );
+  if( block != NULL )
+    memset( block, 0, n_elems * elem_size );
+  return block;
+}
+
+void *cRosArenaRealloc( CrosArena *arena, void *block, size_t size )
+{
+  size_t block_size, new_block_size;
+  void *new_block;
+
+  if( block == NULL )
+    return cRosArenaAlloc( arena, size );
+
+  block_size = *blockHeader( block );
+  if( size <= block_size )
+    return block;
+
+  new_block_size = ARENA_ALIGN_UP( size );
+  if( block == arena->last_block && arena->current->size - arena->current->used >= new_block_size - block_size )
+  {
+    // The block is at the end of the allocated data of the chunk: grow it over the free space that follows it
+    arena->current->used += new_block_size - block_size;
+    *blockHeader( block ) = new_block_size;
+    return block;
+  }
+
+  new_block = cRosArenaAlloc( arena, size );
+  if( new_block != NULL )
+    memcpy( new_block, block, block_size );
+  return new_block;
+}
+
+char *cRosArenaStrdup( CrosArena *arena, const char *str )
+{
+  size_t str_size = strlen( str ) + 1;
+  char *new_str = ( char * )cRosArenaAlloc( arena, str_size );
+
+  if( new_str != NULL )
+    memcpy( new_str, str, str_size );
+  return new_str;
+}
+
+void cRosArenaReset( CrosArena *arena )
+{
+  CrosArenaChunk *chunk;
+
+  for( chunk = arena->first; chunk != NULL; chunk = chunk->next )
+    chunk->used = 0;
+  arena->current = arena->first;
+  arena->last_block = NULL;
+}
+
+void cRosArenaRelease( CrosArena *arena )
+{
+  CrosArenaChunk *chunk = arena->first;
+
+  while( chunk != NULL )
+  {
+    CrosArenaChunk *next = chunk->next;
+    free( chunk );
+    chunk = next;
+  }
+  arena->first = NULL;
+  arena->current = NULL;
+  arena->last_block = NULL;
+}
@@ -10,6 +10,14 @@ uint64_t cRosClockGetTimeMs()
   return (uint64_t)tv.tv_sec*1000 + (uint64_t)tv.tv_usec/1000;
 }
 
+uint64_t cRosClockGetTimeNs()
+{
+  PRINT_VDEBUG ( "cRosClockGetTimeNs()\n" );
+  struct timespec ts;
+  clock_gettime( CLOCK_MONOTONIC, &ts );
+  return (uint64_t)ts.tv_sec*CROS_CLOCK_NS_PER_S + (uint64_t)ts.tv_nsec;
+}
+
 struct timeval cRosClockGetTimeVal( uint64_t msec )
 {
   PRINT_VDEBUG ( "cRosClockGetTimeVal()\n" );
@@ -27,4 +35,23 @@ struct timeval cRosClockGetTimeVal( uint64_t msec )
   }
 
   return tv;
-}
\ No newline at end of file
+}
+
+struct timespec cRosClockGetTimeSpec( uint64_t nsec )
+{
+  PRINT_VDEBUG ( "cRosClockGetTimeSpec()\n" );
+  struct timespec ts;
+  if (nsec / CROS_CLOCK_NS_PER_S > LONG_MAX)
+  {
+    // Given timespan would overflow timespec
+    ts.tv_sec = LONG_MAX;
+    ts.tv_nsec = 999999999L;
+  }
+  else
+  {
+    ts.tv_sec = (long)(nsec / CROS_CLOCK_NS_PER_S);
+    ts.tv_nsec = (long)(nsec - ts.tv_sec * CROS_CLOCK_NS_PER_S);
+  }
+
+  return ts;
+}
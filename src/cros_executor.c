@@ -0,0 +1,156 @@
+#include <stdlib.h>
+
+#include "cros_executor.h"
+#include "cros_defs.h"
+
+void cRosExecutorInit( CrosExecutor *e )
+{
+  e->workers = NULL;
+  e->n_workers = 0;
+}
+
+static void *runWorker( void *arg )
+{
+  CrosExecutorWorker *worker = (CrosExecutorWorker *)arg;
+
+  pthread_mutex_lock( &worker->mutex );
+  for(;;)
+  {
+    while( worker->first_job == NULL && !worker->stop )
+      pthread_cond_wait( &worker->job_cond, &worker->mutex );
+
+    CrosExecutorJob *job = worker->first_job;
+    if( job == NULL ) // Stopping, and every queued job has been run
+      break;
+
+    worker->first_job = job->next;
+    if( worker->first_job == NULL )
+      worker->last_job = NULL;
+    pthread_mutex_unlock( &worker->mutex );
+
+    job->fn( job->arg );
+
+    pthread_mutex_lock( &worker->mutex );
+    job->next = worker->free_jobs;
+    worker->free_jobs = job;
+  }
+  pthread_mutex_unlock( &worker->mutex );
+
+  return NULL;
+}
+
+static void releaseWorker( CrosExecutorWorker *worker )
+{
+  CrosExecutorJob *job;
+  while( ( job = worker->free_jobs ) != NULL )
+  {
+    worker->free_jobs = job->next;
+    free( job );
+  }
+  pthread_cond_destroy( &worker->job_cond );
+  pthread_mutex_destroy( &worker->mutex );
+}
+
+// Stop and join the first n_workers workers
+static void stopWorkers( CrosExecutor *e, int n_workers )
+{
+  int i;
+  for( i = 0; i < n_workers; i++ )
+  {
+    CrosExecutorWorker *worker = &e->workers[i];
+    pthread_mutex_lock( &worker->mutex );
+    worker->stop = 1;
+    pthread_cond_signal( &worker->job_cond );
+    pthread_mutex_unlock( &worker->mutex );
+  }
+
+  for( i = 0; i < n_workers; i++ )
+  {
+    pthread_join( e->workers[i].thread, NULL );
+    releaseWorker( &e->workers[i] );
+  }
+}
+
+int cRosExecutorStart( CrosExecutor *e, int n_workers )
+{
+  int i;
+
+  if( n_workers < 1 || e->n_workers > 0 )
+    return -1;
+
+  e->workers = (CrosExecutorWorker *)calloc( n_workers, sizeof(CrosExecutorWorker) );
+  if( e->workers == NULL )
+  {
+    PRINT_ERROR( "cRosExecutorStart() : Can't allocate memory\n" );
+    return -1;
+  }
+
+  for( i = 0; i < n_workers; i++ )
+  {
+    CrosExecutorWorker *worker = &e->workers[i];
+    pthread_mutex_init( &worker->mutex, NULL );
+    pthread_cond_init( &worker->job_cond, NULL );
+    if( pthread_create( &worker->thread, NULL, runWorker, worker ) != 0 )
+    {
+      PRINT_ERROR( "cRosExecutorStart() : Can't create the worker thread %i\n", i );
+      releaseWorker( worker );
+      stopWorkers( e, i );
+      free( e->workers );
+      cRosExecutorInit( e );
+      return -1;
+    }
+  }
+
+  e->n_workers = n_workers;
+  return 0;
+}
+
+void cRosExecutorStop( CrosExecutor *e )
+{
+  if( e->n_workers == 0 )
+    return;
+
+  stopWorkers( e, e->n_workers );
+  free( e->workers );
+  cRosExecutorInit( e );
+}
+
+int cRosExecutorSubmit( CrosExecutor *e, unsigned int key, CrosExecutorFn fn, void *arg )
+{
+  CrosExecutorWorker *worker;
+  CrosExecutorJob *job;
+
+  if( e->n_workers == 0 )
+    return -1;
+
+  // All the jobs of a key go to the same worker, which runs its queue in order
+  worker = &e->workers[key % (unsigned int)e->n_workers];
+
+  pthread_mutex_lock( &worker->mutex );
+  job = worker->free_jobs;
+  if( job != NULL )
+    worker->free_jobs = job->next;
+  else
+  {
+    job = (CrosExecutorJob *)malloc( sizeof(CrosExecutorJob) );
+    if( job == NULL )
+    {
+      pthread_mutex_unlock( &worker->mutex );
+      PRINT_ERROR( "cRosExecutorSubmit() : Can't allocate memory\n" );
+      return -1;
+    }
+  }
+
+  job->fn = fn;
+  job->arg = arg;
+  job->next = NULL;
+  if( worker->last_job != NULL )
+    worker->last_job->next = job;
+  else
+    worker->first_job = job;
+  worker->last_job = job;
+  pthread_cond_signal( &worker->job_cond );
+  pthread_mutex_unlock( &worker->mutex );
+
+  return 0;
+}
@@ -2,11 +2,14 @@
 #include <stdlib.h>
 #include <string.h>
 #include "cros_gentools.h"
+#include "cros_defs.h"
+#include "cros_message_codec.h"
 #include "cros_message.h"
 #include "cros_message_internal.h"
 #include "cros_service.h"
 #include "cros_service_internal.h"
 #include "md5.h"
+#include "dyn_string.h"
 
 char* cRosGentoolsMD5(char* filename)
 {
@@ -90,3 +93,626 @@ int cRosGentoolsFulltext(char* filename)
 	//free(full_text);
   return 1;
 }
+
+/*
+ * C code generator
+ */
+
+typedef struct GenType GenType;
+struct GenType
+{
+  cRosMessageDef *def;
+  char *c_name;
+};
+
+typedef struct GenTypeList GenTypeList;
+struct GenTypeList
+{
+  GenType *types;
+  int n_types;
+  int capacity;
+};
+
+// Convert a ROS type name (e.g., "std_msgs/String") into a C identifier (e.g., "std_msgs_String")
+static char *genCName(const char *package, const char *name, const char *suffix)
+{
+  size_t len = ((package != NULL)? strlen(package) + 1 : 0) + strlen(name) + strlen(suffix) + 1;
+  char *c_name = (char *)malloc(len);
+  char *it;
+
+  if(c_name == NULL)
+    return NULL;
+
+  snprintf(c_name, len, "%s%s%s%s", (package != NULL)? package : "", (package != NULL)? "_" : "", name, suffix);
+  for(it = c_name; *it != '\0'; it++)
+  {
+    if(!((*it >= 'a' && *it <= 'z') || (*it >= 'A' && *it <= 'Z') || (*it >= '0' && *it <= '9')))
+      *it = '_';
+  }
+  return c_name;
+}
+
+static GenType *genFindType(GenTypeList *list, const char *c_name)
+{
+  int i;
+
+  for(i = 0; i < list->n_types; i++)
+  {
+    if(strcmp(list->types[i].c_name, c_name) == 0)
+      return &list->types[i];
+  }
+  return NULL;
+}
+
+// Append a type to the list after the custom types of its fields, so that every struct is declared before it is used
+static int genCollectTypes(GenTypeList *list, cRosMessageDef *def, char *c_name)
+{
+  msgFieldDef *field_itr;
+
+  if(c_name == NULL)
+    return -1;
+
+  if(genFindType(list, c_name) != NULL)
+  {
+    free(c_name);
+    return 0;
+  }
+
+  for(field_itr = def->first_field; field_itr != NULL && field_itr->next != NULL; field_itr = field_itr->next)
+  {
+    if(field_itr->type == CROS_CUSTOM_TYPE)
+    {
+      char *child_c_name;
+      if(field_itr->child_msg_def == NULL)
+        break;
+      child_c_name = genCName(NULL, field_itr->type_s, "");
+      if(child_c_name == NULL || genCollectTypes(list, field_itr->child_msg_def, child_c_name) != 0)
+        break;
+    }
+  }
+  if(field_itr != NULL && field_itr->next != NULL)
+  {
+    free(c_name);
+    return -1;
+  }
+
+  if(list->n_types == list->capacity)
+  {
+    int new_capacity = (list->capacity > 0)? list->capacity * 2 : 8;
+    GenType *new_types = (GenType *)realloc(list->types, new_capacity * sizeof(GenType));
+    if(new_types == NULL)
+    {
+      free(c_name);
+      return -1;
+    }
+    list->types = new_types;
+    list->capacity = new_capacity;
+  }
+  list->types[list->n_types].def = def;
+  list->types[list->n_types].c_name = c_name;
+  list->n_types++;
+  return 0;
+}
+
+static void genReleaseTypes(GenTypeList *list)
+{
+  int i;
+
+  for(i = 0; i < list->n_types; i++)
+    free(list->types[i].c_name);
+  free(list->types);
+  list->types = NULL;
+  list->n_types = list->capacity = 0;
+}
+
+// Primitive types, time and duration are stored in memory as they are encoded, so they are copied with memcpy()
+static int genIsWireType(CrosMessageType type)
+{
+  return type != CROS_STD_MSGS_STRING && type != CROS_STD_MSGS_HEADER && type != CROS_CUSTOM_TYPE;
+}
+
+static const char *genFieldCType(msgFieldDef *field, GenTypeList *list)
+{
+  switch(field->type)
+  {
+    case CROS_STD_MSGS_INT8: return "int8_t";
+    case CROS_STD_MSGS_UINT8: return "uint8_t";
+    case CROS_STD_MSGS_INT16: return "int16_t";
+    case CROS_STD_MSGS_UINT16: return "uint16_t";
+    case CROS_STD_MSGS_INT32: return "int32_t";
+    case CROS_STD_MSGS_UINT32: return "uint32_t";
+    case CROS_STD_MSGS_INT64: return "int64_t";
+    case CROS_STD_MSGS_UINT64: return "uint64_t";
+    case CROS_STD_MSGS_FLOAT32: return "float";
+    case CROS_STD_MSGS_FLOAT64: return "double";
+    case CROS_STD_MSGS_BOOL: return "uint8_t";
+    case CROS_STD_MSGS_CHAR: return "uint8_t";
+    case CROS_STD_MSGS_BYTE: return "int8_t";
+    case CROS_STD_MSGS_STRING: return "char *";
+    case CROS_STD_MSGS_TIME: return "CrosTime";
+    case CROS_STD_MSGS_DURATION: return "CrosDuration";
+    case CROS_STD_MSGS_HEADER: return "CrosHeader";
+    case CROS_CUSTOM_TYPE:
+    {
+      char *c_name = genCName(NULL, field->type_s, "");
+      GenType *type = (c_name != NULL)? genFindType(list, c_name) : NULL;
+      free(c_name);
+      return (type != NULL)? type->c_name : NULL;
+    }
+    default:
+      return NULL;
+  }
+}
+
+// Minimum number of bytes of an encoded message (all its strings and variable-length arrays empty)
+static size_t genMinWireSize(cRosMessageDef *def)
+{
+  msgFieldDef *field_itr;
+  size_t size = 0;
+
+  for(field_itr = def->first_field; field_itr != NULL && field_itr->next != NULL; field_itr = field_itr->next)
+  {
+    size_t elem_size;
+    switch(field_itr->type)
+    {
+      case CROS_STD_MSGS_STRING: elem_size = sizeof(uint32_t); break;
+      case CROS_STD_MSGS_HEADER: elem_size = 2 * sizeof(uint32_t) + sizeof(CrosTime); break;
+      case CROS_CUSTOM_TYPE: elem_size = (field_itr->child_msg_def != NULL)? genMinWireSize(field_itr->child_msg_def) : 0; break;
+      default: elem_size = getMessageTypeSizeOf(field_itr->type); break;
+    }
+    if(!field_itr->is_array)
+      size += elem_size;
+    else if(field_itr->array_size >= 0)
+      size += elem_size * field_itr->array_size;
+    else
+      size += sizeof(uint32_t);
+  }
+  return size;
+}
+
+// Write a string as a C string literal, one source line per text line
+static void genWriteStringLiteral(FILE *f, const char *str, const char *indent)
+{
+  const char *it;
+
+  if(str == NULL || *str == '\0')
+  {
+    fprintf(f, "\"\"");
+    return;
+  }
+
+  fprintf(f, "\"");
+  for(it = str; *it != '\0'; it++)
+  {
+    switch(*it)
+    {
+      case '\\': fprintf(f, "\\\\"); break;
+      case '"': fprintf(f, "\\\""); break;
+      case '\r': fprintf(f, "\\r"); break;
+      case '\t': fprintf(f, "\\t"); break;
+      case '\n':
+        fprintf(f, "\\n\"");
+        if(*(it + 1) != '\0')
+          fprintf(f, "\n%s\"", indent);
+        else
+          return;
+        break;
+      default: fputc(*it, f); break;
+    }
+  }
+  fprintf(f, "\"");
+}
+
+static void genWriteStruct(FILE *f, GenType *type, GenTypeList *list)
+{
+  msgFieldDef *field_itr;
+  msgConst *const_itr;
+
+  fprintf(f, "#ifndef CROS_GEN_TYPE_%s\n#define CROS_GEN_TYPE_%s\n\n", type->c_name, type->c_name);
+
+  for(const_itr = type->def->first_const; const_itr != NULL && const_itr->next != NULL; const_itr = const_itr->next)
+  {
+    fprintf(f, "#define %s_%s ", type->c_name, const_itr->name);
+    if(const_itr->type == CROS_STD_MSGS_STRING)
+      genWriteStringLiteral(f, const_itr->value, "");
+    else
+      fprintf(f, "(%s)", const_itr->value);
+    fprintf(f, "\n");
+  }
+  if(type->def->first_const != NULL && type->def->first_const->next != NULL)
+    fprintf(f, "\n");
+
+  fprintf(f, "typedef struct %s %s;\nstruct %s\n{\n", type->c_name, type->c_name, type->c_name);
+  for(field_itr = type->def->first_field; field_itr != NULL && field_itr->next != NULL; field_itr = field_itr->next)
+  {
+    const char *c_type = genFieldCType(field_itr, list);
+    int is_pointer = (field_itr->type == CROS_STD_MSGS_STRING);
+
+    if(!field_itr->is_array)
+      fprintf(f, "  %s%s%s;\n", c_type, is_pointer? "" : " ", field_itr->name);
+    else if(field_itr->array_size >= 0)
+      fprintf(f, "  %s%s%s[%d];\n", c_type, is_pointer? "" : " ", field_itr->name, field_itr->array_size);
+    else
+      fprintf(f, "  CROS_CODEC_ARRAY(%s) %s;\n", c_type, field_itr->name);
+  }
+  if(type->def->first_field == NULL || type->def->first_field->next == NULL)
+    fprintf(f, "  uint8_t empty_;                       // C structs cannot be empty\n");
+  fprintf(f, "};\n\n#endif // CROS_GEN_TYPE_%s\n\n", type->c_name);
+}
+
+// Open a block that declares elem as a pointer to the value of a field, or a loop that visits the elements of an
+// array field (its first count elements if it is a variable-length array)
+static void genWriteElemBegin(FILE *f, msgFieldDef *field, const char *c_type, int is_const, const char *count)
+{
+  char decl[256];
+
+  if(field->type == CROS_STD_MSGS_STRING)
+    snprintf(decl, sizeof(decl), "%s", is_const? "char *const *" : "char **");
+  else
+    snprintf(decl, sizeof(decl), "%s%s *", is_const? "const " : "", c_type);
+
+  if(!field->is_array)
+    fprintf(f, "  {\n    %selem = &msg->%s;\n", decl, field->name);
+  else if(field->array_size >= 0)
+    fprintf(f, "  for(i = 0; i < %d; i++)\n  {\n    %selem = &msg->%s[i];\n", field->array_size, decl, field->name);
+  else
+    fprintf(f, "  for(i = 0; i < msg->%s.%s; i++)\n  {\n    %selem = &msg->%s.data[i];\n", field->name, count, decl, field->name);
+}
+
+static void genWriteReleaseFunc(FILE *f, GenType *type, GenTypeList *list)
+{
+  msgFieldDef *field_itr;
+
+  fprintf(f, "static void %s_release_fields(%s *msg)\n{\n  uint32_t i;\n\n  (void)i;\n  (void)msg;\n", type->c_name, type->c_name);
+  for(field_itr = type->def->first_field; field_itr != NULL && field_itr->next != NULL; field_itr = field_itr->next)
+  {
+    const char *c_type = genFieldCType(field_itr, list);
+    const char *release_stmt = NULL;
+
+    switch(field_itr->type)
+    {
+      case CROS_STD_MSGS_STRING: release_stmt = "free(*elem);"; break;
+      case CROS_STD_MSGS_HEADER: release_stmt = "cRosCodecHeaderRelease(elem);"; break;
+      case CROS_CUSTOM_TYPE: release_stmt = NULL; break;
+      default: break;
+    }
+
+    if(!genIsWireType(field_itr->type))
+    {
+      genWriteElemBegin(f, field_itr, c_type, 0, "capacity");
+      if(release_stmt != NULL)
+        fprintf(f, "    %s\n  }\n", release_stmt);
+      else
+        fprintf(f, "    %s_release_fields(elem);\n  }\n", c_type);
+    }
+    if(field_itr->is_array && field_itr->array_size < 0)
+      fprintf(f, "  cRosCodecArrayRelease(&msg->%s);\n", field_itr->name);
+  }
+  fprintf(f, "}\n\n");
+}
+
+static void genWriteSizeFunc(FILE *f, GenType *type, GenTypeList *list)
+{
+  msgFieldDef *field_itr;
+  size_t fixed_size = 0;
+
+  fprintf(f, "static size_t %s_wire_size(const %s *msg)\n{\n  size_t size = 0;\n  uint32_t i;\n\n  (void)i;\n  (void)msg;\n", type->c_name, type->c_name);
+  for(field_itr = type->def->first_field; field_itr != NULL && field_itr->next != NULL; field_itr = field_itr->next)
+  {
+    const char *c_type = genFieldCType(field_itr, list);
+
+    if(field_itr->is_array && field_itr->array_size < 0)
+      fixed_size += sizeof(uint32_t);
+
+    if(genIsWireType(field_itr->type))
+    {
+      size_t elem_size = getMessageTypeSizeOf(field_itr->type);
+      if(field_itr->type == CROS_STD_MSGS_TIME || field_itr->type == CROS_STD_MSGS_DURATION)
+        elem_size = sizeof(CrosTime);
+      if(!field_itr->is_array)
+        fixed_size += elem_size;
+      else if(field_itr->array_size >= 0)
+        fixed_size += elem_size * field_itr->array_size;
+      else
+        fprintf(f, "  size += (size_t)msg->%s.size * sizeof(%s);\n", field_itr->name, c_type);
+    }
+    else
+    {
+      const char *size_expr;
+      switch(field_itr->type)
+      {
+        case CROS_STD_MSGS_STRING: size_expr = "cRosCodecStringSize(*elem)"; break;
+        case CROS_STD_MSGS_HEADER: size_expr = "cRosCodecHeaderSize(elem)"; break;
+        default: size_expr = NULL; break;
+      }
+      genWriteElemBegin(f, field_itr, c_type, 1, "size");
+      if(size_expr != NULL)
+        fprintf(f, "    size += %s;\n  }\n", size_expr);
+      else
+        fprintf(f, "    size += %s_wire_size(elem);\n  }\n", c_type);
+    }
+  }
+  fprintf(f, "  return size + %lu;\n}\n\n", (unsigned long)fixed_size);
+}
+
+static void genWriteSerializeFunc(FILE *f, GenType *type, GenTypeList *list)
+{
+  msgFieldDef *field_itr;
+
+  fprintf(f, "static cRosErrCodePack %s_write(const %s *msg, DynBuffer *buffer)\n{\n  cRosErrCodePack ret_err;\n  uint32_t i;\n\n  (void)ret_err;\n  (void)i;\n  (void)msg;\n  (void)buffer;\n",
+          type->c_name, type->c_name);
+  for(field_itr = type->def->first_field; field_itr != NULL && field_itr->next != NULL; field_itr = field_itr->next)
+  {
+    const char *c_type = genFieldCType(field_itr, list);
+
+    if(field_itr->is_array && field_itr->array_size < 0)
+      fprintf(f, "  if((ret_err = cRosCodecWriteBytes(buffer, &msg->%s.size, sizeof(uint32_t))) != CROS_SUCCESS_ERR_PACK)\n    return ret_err;\n",
+              field_itr->name);
+
+    if(genIsWireType(field_itr->type))
+    {
+      if(!field_itr->is_array)
+        fprintf(f, "  if((ret_err = cRosCodecWriteBytes(buffer, &msg->%s, sizeof(msg->%s))) != CROS_SUCCESS_ERR_PACK)\n    return ret_err;\n",
+                field_itr->name, field_itr->name);
+      else if(field_itr->array_size >= 0)
+        fprintf(f, "  if((ret_err = cRosCodecWriteBytes(buffer, msg->%s, sizeof(msg->%s))) != CROS_SUCCESS_ERR_PACK)\n    return ret_err;\n",
+                field_itr->name, field_itr->name);
+      else
+        fprintf(f, "  if((ret_err = cRosCodecWriteBytes(buffer, msg->%s.data, (size_t)msg->%s.size * sizeof(%s))) != CROS_SUCCESS_ERR_PACK)\n    return ret_err;\n",
+                field_itr->name, field_itr->name, c_type);
+    }
+    else
+    {
+      const char *write_expr;
+      switch(field_itr->type)
+      {
+        case CROS_STD_MSGS_STRING: write_expr = "cRosCodecWriteString(buffer, *elem)"; break;
+        case CROS_STD_MSGS_HEADER: write_expr = "cRosCodecWriteHeader(buffer, elem)"; break;
+        default: write_expr = NULL; break;
+      }
+      genWriteElemBegin(f, field_itr, c_type, 1, "size");
+      if(write_expr != NULL)
+        fprintf(f, "    if((ret_err = %s) != CROS_SUCCESS_ERR_PACK)\n      return ret_err;\n  }\n", write_expr);
+      else
+        fprintf(f, "    if((ret_err = %s_write(elem, buffer)) != CROS_SUCCESS_ERR_PACK)\n      return ret_err;\n  }\n", c_type);
+    }
+  }
+  fprintf(f, "  return CROS_SUCCESS_ERR_PACK;\n}\n\n");
+}
+
+static void genWriteDeserializeFunc(FILE *f, GenType *type, GenTypeList *list)
+{
+  msgFieldDef *field_itr;
+
+  fprintf(f, "static cRosErrCodePack %s_read(%s *msg, DynBuffer *buffer)\n{\n  cRosErrCodePack ret_err;\n  uint32_t i;\n\n  (void)ret_err;\n  (void)i;\n  (void)msg;\n  (void)buffer;\n",
+          type->c_name, type->c_name);
+  for(field_itr = type->def->first_field; field_itr != NULL && field_itr->next != NULL; field_itr = field_itr->next)
+  {
+    const char *c_type = genFieldCType(field_itr, list);
+    const char *elem_c_type = (field_itr->type == CROS_STD_MSGS_STRING)? "char *" : c_type;
+
+    if(field_itr->is_array && field_itr->array_size < 0)
+    {
+      size_t min_elem_wire_size;
+      switch(field_itr->type)
+      {
+        case CROS_STD_MSGS_STRING: min_elem_wire_size = sizeof(uint32_t); break;
+        case CROS_STD_MSGS_HEADER: min_elem_wire_size = 2 * sizeof(uint32_t) + sizeof(CrosTime); break;
+        case CROS_CUSTOM_TYPE: min_elem_wire_size = genMinWireSize(field_itr->child_msg_def); break;
+        case CROS_STD_MSGS_TIME:
+        case CROS_STD_MSGS_DURATION: min_elem_wire_size = sizeof(CrosTime); break;
+        default: min_elem_wire_size = getMessageTypeSizeOf(field_itr->type); break;
+      }
+      fprintf(f, "  if((ret_err = cRosCodecReadArrayLength(buffer, &msg->%s, sizeof(%s), %lu)) != CROS_SUCCESS_ERR_PACK)\n    return ret_err;\n",
+              field_itr->name, elem_c_type, (unsigned long)min_elem_wire_size);
+    }
+
+    if(genIsWireType(field_itr->type))
+    {
+      if(!field_itr->is_array)
+        fprintf(f, "  if((ret_err = cRosCodecReadBytes(buffer, &msg->%s, sizeof(msg->%s))) != CROS_SUCCESS_ERR_PACK)\n    return ret_err;\n",
+                field_itr->name, field_itr->name);
+      else if(field_itr->array_size >= 0)
+        fprintf(f, "  if((ret_err = cRosCodecReadBytes(buffer, msg->%s, sizeof(msg->%s))) != CROS_SUCCESS_ERR_PACK)\n    return ret_err;\n",
+                field_itr->name, field_itr->name);
+      else
+        fprintf(f, "  if((ret_err = cRosCodecReadBytes(buffer, msg->%s.data, (size_t)msg->%s.size * sizeof(%s))) != CROS_SUCCESS_ERR_PACK)\n    return ret_err;\n",
+                field_itr->name, field_itr->name, c_type);
+    }
+    else
+    {
+      const char *read_expr;
+      switch(field_itr->type)
+      {
+        case CROS_STD_MSGS_STRING: read_expr = "cRosCodecReadString(buffer, elem)"; break;
+        case CROS_STD_MSGS_HEADER: read_expr = "cRosCodecReadHeader(buffer, elem)"; break;
+        default: read_expr = NULL; break;
+      }
+      genWriteElemBegin(f, field_itr, c_type, 0, "size");
+      if(read_expr != NULL)
+        fprintf(f, "    if((ret_err = %s) != CROS_SUCCESS_ERR_PACK)\n      return ret_err;\n  }\n", read_expr);
+      else
+        fprintf(f, "    if((ret_err = %s_read(elem, buffer)) != CROS_SUCCESS_ERR_PACK)\n      return ret_err;\n  }\n", c_type);
+    }
+  }
+  fprintf(f, "  return CROS_SUCCESS_ERR_PACK;\n}\n\n");
+}
+
+static void genWritePublicDecls(FILE *f, const char *c_name)
+{
+  fprintf(f, "void %s_init(%s *msg);\n", c_name, c_name);
+  fprintf(f, "void %s_release(%s *msg);\n", c_name, c_name);
+  fprintf(f, "size_t %s_serialized_size(const %s *msg);\n", c_name, c_name);
+  fprintf(f, "cRosErrCodePack %s_serialize(const %s *msg, DynBuffer *buffer);\n", c_name, c_name);
+  fprintf(f, "cRosErrCodePack %s_deserialize(%s *msg, DynBuffer *buffer);\n", c_name, c_name);
+  fprintf(f, "extern const CrosMessageCodec %s_codec;\n\n", c_name);
+}
+
+static void genWritePublicFuncs(FILE *f, const char *c_name, const char *ros_type, const char *md5sum, const char *message_definition)
+{
+  fprintf(f, "void %s_init(%s *msg)\n{\n  memset(msg, 0, sizeof(%s));\n}\n\n", c_name, c_name, c_name);
+  fprintf(f, "void %s_release(%s *msg)\n{\n  %s_release_fields(msg);\n  memset(msg, 0, sizeof(%s));\n}\n\n", c_name, c_name, c_name, c_name);
+  fprintf(f, "size_t %s_serialized_size(const %s *msg)\n{\n  return %s_wire_size(msg);\n}\n\n", c_name, c_name, c_name);
+  fprintf(f, "cRosErrCodePack %s_serialize(const %s *msg, DynBuffer *buffer)\n{\n"
+             "  if(dynBufferReserve(buffer, %s_wire_size(msg)) != 0)\n    return CROS_MEM_ALLOC_ERR;\n"
+             "  return %s_write(msg, buffer);\n}\n\n", c_name, c_name, c_name, c_name);
+  fprintf(f, "cRosErrCodePack %s_deserialize(%s *msg, DynBuffer *buffer)\n{\n  return %s_read(msg, buffer);\n}\n\n", c_name, c_name, c_name);
+
+  fprintf(f, "static void %s_codec_init(void *msg) { %s_init((%s *)msg); }\n", c_name, c_name, c_name);
+  fprintf(f, "static void %s_codec_release(void *msg) { %s_release((%s *)msg); }\n", c_name, c_name, c_name);
+  fprintf(f, "static size_t %s_codec_serialized_size(const void *msg) { return %s_wire_size((const %s *)msg); }\n", c_name, c_name, c_name);
+  fprintf(f, "static cRosErrCodePack %s_codec_serialize(const void *msg, DynBuffer *buffer) { return %s_serialize((const %s *)msg, buffer); }\n",
+          c_name, c_name, c_name);
+  fprintf(f, "static cRosErrCodePack %s_codec_deserialize(void *msg, DynBuffer *buffer) { return %s_read((%s *)msg, buffer); }\n\n",
+          c_name, c_name, c_name);
+
+  fprintf(f, "const CrosMessageCodec %s_codec =\n{\n  \"%s\",\n  \"%s\",\n  ", c_name, ros_type, md5sum);
+  genWriteStringLiteral(f, message_definition, "  ");
+  fprintf(f, ",\n  sizeof(%s),\n  %s_codec_init,\n  %s_codec_release,\n  %s_codec_serialized_size,\n"
+             "  %s_codec_serialize,\n  %s_codec_deserialize\n};\n\n", c_name, c_name, c_name, c_name, c_name, c_name);
+}
+
+typedef struct GenRoot GenRoot;
+struct GenRoot
+{
+  char *c_name;                 // Name of the generated struct
+  char *ros_type;               // Type of the message (e.g., "std_msgs/String")
+};
+
+static int genWriteFiles(const char *output_dir, const char *file_name, const char *source_type, GenTypeList *list,
+                         GenRoot *roots, int n_roots, const char *md5sum, const char *message_definition)
+{
+  char path[4096];
+  FILE *f_h, *f_c;
+  int i;
+
+  snprintf(path, sizeof(path), "%s/%s.h", output_dir, file_name);
+  f_h = fopen(path, "w");
+  snprintf(path, sizeof(path), "%s/%s.c", output_dir, file_name);
+  f_c = (f_h != NULL)? fopen(path, "w") : NULL;
+  if(f_c == NULL)
+  {
+    PRINT_ERROR("cRosGentoolsGenerateC() : The output files in %s could not be created\n", output_dir);
+    if(f_h != NULL)
+      fclose(f_h);
+    return 0;
+  }
+
+  fprintf(f_h, "/* Generated by cRosGentoolsGenerateC() from %s. Do not edit */\n\n", source_type);
+  fprintf(f_h, "#ifndef _CROS_GEN_%s_H_\n#define _CROS_GEN_%s_H_\n\n#include <stdint.h>\n\n#include \"cros_message_codec.h\"\n\n", file_name, file_name);
+  for(i = 0; i < list->n_types; i++)
+    genWriteStruct(f_h, &list->types[i], list);
+  for(i = 0; i < n_roots; i++)
+    genWritePublicDecls(f_h, roots[i].c_name);
+  fprintf(f_h, "#endif // _CROS_GEN_%s_H_\n", file_name);
+
+  fprintf(f_c, "/* Generated by cRosGentoolsGenerateC() from %s. Do not edit */\n\n", source_type);
+  fprintf(f_c, "#include <stdlib.h>\n#include <string.h>\n\n#include \"%s.h\"\n\n", file_name);
+  for(i = 0; i < list->n_types; i++)
+  {
+    genWriteReleaseFunc(f_c, &list->types[i], list);
+    genWriteSizeFunc(f_c, &list->types[i], list);
+    genWriteSerializeFunc(f_c, &list->types[i], list);
+    genWriteDeserializeFunc(f_c, &list->types[i], list);
+  }
+  for(i = 0; i < n_roots; i++)
+    genWritePublicFuncs(f_c, roots[i].c_name, roots[i].ros_type, md5sum, message_definition);
+
+  fclose(f_h);
+  return (fclose(f_c) == 0)? 1 : 0;
+}
+
+// Compose a ROS type name (e.g., "std_msgs/String")
+static char *genRosTypeName(const char *package, const char *name, const char *suffix)
+{
+  size_t len = strlen(package) + strlen(name) + strlen(suffix) + 2;
+  char *ros_type = (char *)malloc(len);
+
+  if(ros_type != NULL)
+    snprintf(ros_type, len, "%s/%s%s", package, name, suffix);
+  return ros_type;
+}
+
+static int genMsg(char *filename, char *output_dir)
+{
+  cRosMessageDef *msg_def;
+  GenTypeList list = { NULL, 0, 0 };
+  GenRoot root;
+  unsigned char *md5_res;
+  DynString md5_str;
+  int ret = 0;
+
+  if(cRosMessageDefBuild(&msg_def, NULL, filename) != CROS_SUCCESS_ERR_PACK)
+    return 0;
+
+  dynStringInit(&md5_str);
+  md5_res = getMD5Msg(msg_def);
+  root.c_name = genCName(msg_def->package, msg_def->name, "");
+  root.ros_type = genRosTypeName(msg_def->package, msg_def->name, "");
+  if(md5_res != NULL && root.c_name != NULL && root.ros_type != NULL &&
+     genCollectTypes(&list, msg_def, strdup(root.c_name)) == 0)
+  {
+    cRosMD5Readable(md5_res, &md5_str);
+    ret = genWriteFiles(output_dir, root.c_name, root.ros_type, &list, &root, 1, md5_str.data, msg_def->plain_text);
+  }
+
+  free(md5_res);
+  free(root.c_name);
+  free(root.ros_type);
+  dynStringRelease(&md5_str);
+  genReleaseTypes(&list);
+  cRosMessageDefFree(msg_def);
+  return ret;
+}
+
+static int genSrv(char *filename, char *output_dir)
+{
+  cRosSrvDef *srv_def;
+  GenTypeList list = { NULL, 0, 0 };
+  GenRoot roots[2];
+  char *file_name;
+  char *srv_type;
+  char md5sum[33];
+  int ret = 0;
+
+  if(cRosServiceDefBuild(&srv_def, md5sum, filename) != CROS_SUCCESS_ERR_PACK)
+    return 0;
+
+  file_name = genCName(srv_def->package, srv_def->name, "");
+  srv_type = genRosTypeName(srv_def->package, srv_def->name, "");
+  roots[0].c_name = genCName(srv_def->package, srv_def->name, "Request");
+  roots[0].ros_type = genRosTypeName(srv_def->package, srv_def->name, "Request");
+  roots[1].c_name = genCName(srv_def->package, srv_def->name, "Response");
+  roots[1].ros_type = genRosTypeName(srv_def->package, srv_def->name, "Response");
+  if(file_name != NULL && srv_type != NULL && roots[0].c_name != NULL && roots[0].ros_type != NULL &&
+     roots[1].c_name != NULL && roots[1].ros_type != NULL &&
+     genCollectTypes(&list, srv_def->request, strdup(roots[0].c_name)) == 0 &&
+     genCollectTypes(&list, srv_def->response, strdup(roots[1].c_name)) == 0)
+  {
+    ret = genWriteFiles(output_dir, file_name, srv_type, &list, roots, 2, md5sum, srv_def->plain_text);
+  }
+
+  free(file_name);
+  free(srv_type);
+  free(roots[0].c_name);
+  free(roots[0].ros_type);
+  free(roots[1].c_name);
+  free(roots[1].ros_type);
+  genReleaseTypes(&list);
+  cRosServiceDefFree(srv_def);
+  return ret;
+}
+
+int cRosGentoolsGenerateC(char* filename, char* output_dir)
+{
+  const char *file_ext = strrchr(filename, '.');
+
+  if(file_ext == NULL)
+    return 0;
+
+  if(strcmp(file_ext + 1, FILEEXT_MSG) == 0)
+    return genMsg(filename, output_dir);
+  if(strcmp(file_ext + 1, FILEEXT_SRV) == 0)
+    return genSrv(filename, output_dir);
+  return 0;
+}
@@ -0,0 +1,470 @@
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+
+#include "cros_io_shard.h"
+#include "cros_clock.h"
+#include "cros_timer_heap.h"
+#include "cros_defs.h"
+
+#define CROS_IO_SHARD_MAX_EVENTS 64               //! Maximum number of sockets reported by each wait of a shard
+#define CROS_IO_SHARD_WAKEUP_TAG UINT64_MAX       //! Poller tag of the shard wake-up (the connections are tagged with their index)
+
+void cRosIoShardInit( CrosIoShard *s )
+{
+  cRosPollerInit( &s->poller, CROS_POLLER_SELECT, 1 ); // Nothing is allocated until the shard is started
+  cRosWakeupInit( &s->wakeup );
+  cRosMpscQueueInit( &s->inbox );
+  s->inbox_pending = 0;
+  s->conns = NULL;
+  s->conn_timers = NULL;
+  s->conns_size = 0;
+  cRosTimerHeapInit( &s->timers );
+  s->out_queue_policy = CROS_OUT_QUEUE_DROP_OLDEST;
+  s->io_timeout_ns = 0;
+  s->events = NULL;
+  s->events_pending = NULL;
+  s->events_wakeup = NULL;
+  s->load = 0;
+  s->running = 0;
+  s->exit_flag = 0;
+  s->failed = 0;
+}
+
+CrosIoShardMsg *cRosIoShardNewMsg( CrosIoShardMsgType type )
+{
+  CrosIoShardMsg *msg = (CrosIoShardMsg *)malloc( sizeof(CrosIoShardMsg) );
+  if( msg == NULL )
+  {
+    PRINT_ERROR( "cRosIoShardNewMsg() : Can't allocate memory\n" );
+    return NULL;
+  }
+
+  msg->link.next = NULL;
+  msg->type = type;
+  msg->server_idx = -1;
+  msg->topic_idx = -1;
+  msg->frame = NULL;
+  msg->conn = NULL;
+  return msg;
+}
+
+static void freeConn( TcprosProcess *conn )
+{
+  tcpIpSocketClose( &conn->socket );
+  tcprosProcessRelease( conn );
+  free( conn );
+}
+
+void cRosIoShardFreeMsg( CrosIoShardMsg *msg )
+{
+  if( msg == NULL )
+    return;
+
+  tcprosFrameUnref( msg->frame );
+  if( msg->conn != NULL )
+    freeConn( msg->conn );
+  free( msg );
+}
+
+void cRosIoShardPost( CrosIoShard *s, CrosIoShardMsg *msg )
+{
+  cRosMpscQueuePush( &s->inbox, &msg->link );
+  if( __atomic_exchange_n( &s->inbox_pending, 1, __ATOMIC_ACQ_REL ) == 0 )
+    cRosWakeupSignal( &s->wakeup );
+}
+
+static void notifyClosed( CrosIoShard *s, int idx )
+{
+  CrosIoShardMsg *msg;
+
+  // If the message cannot be allocated, the node finds out when it takes the connections back (see cRosIoShardTakeConn())
+  msg = cRosIoShardNewMsg( CROS_IO_SHARD_CLOSED );
+  if( msg == NULL )
+    return;
+  msg->server_idx = idx;
+  cRosMpscQueuePush( s->events, &msg->link );
+  if( __atomic_exchange_n( s->events_pending, 1, __ATOMIC_ACQ_REL ) == 0 )
+    cRosWakeupSignal( s->events_wakeup );
+}
+
+/* Update the events watched for the socket of a connection and its I/O timeout, after it changes its state or starts
+   sending another frame */
+static void watchConn( CrosIoShard *s, int idx )
+{
+  TcprosProcess *conn = s->conns[idx];
+  unsigned int events = CROS_POLLER_ERROR;
+  uint64_t deadline = CROS_TIMER_NEVER;
+
+  if( conn->state == TCPROS_PROCESS_STATE_WRITING )
+  {
+    events |= CROS_POLLER_WRITE;
+    deadline = conn->last_change_time + s->io_timeout_ns + 1;
+  }
+  cRosPollerWatch( &s->poller, &conn->poller_entry, tcpIpSocketGetFD( &conn->socket ), events, conn->state_changes, (uint64_t)idx );
+  if( cRosTimerHeapGetDeadline( &s->timers, s->conn_timers[idx] ) != deadline )
+    cRosTimerHeapArm( &s->timers, s->conn_timers[idx], deadline );
+}
+
+static void closeConn( CrosIoShard *s, int idx )
+{
+  // The select() sets keep the watched descriptors until they are watched again
+  cRosPollerWatch( &s->poller, &s->conns[idx]->poller_entry, -1, 0, s->conns[idx]->state_changes, (uint64_t)idx );
+  cRosTimerHeapArm( &s->timers, s->conn_timers[idx], CROS_TIMER_NEVER );
+  freeConn( s->conns[idx] );
+  s->conns[idx] = NULL;
+  notifyClosed( s, idx );
+}
+
+/* Send the queued frames of a connection until its socket would block */
+static void streamConn( CrosIoShard *s, int idx )
+{
+  TcprosProcess *conn = s->conns[idx];
+
+  for(;;)
+  {
+    if( conn->frame == NULL )
+    {
+      TcprosFrame *frame = tcprosProcessPopOutFrame( conn );
+      if( frame == NULL )
+      {
+        if( conn->state != TCPROS_PROCESS_STATE_WAIT_FOR_WRITING )
+        {
+          tcprosProcessChangeState( conn, TCPROS_PROCESS_STATE_WAIT_FOR_WRITING );
+          watchConn( s, idx );
+        }
+        return;
+      }
+      tcprosProcessSetFrame( conn, frame );
+      // The state only changes when the connection starts writing, so that its poller registration is kept meanwhile
+      if( conn->state != TCPROS_PROCESS_STATE_WRITING )
+        tcprosProcessChangeState( conn, TCPROS_PROCESS_STATE_WRITING );
+      else
+        conn->last_change_time = cRosClockGetTimeNs();
+      watchConn( s, idx ); // The I/O timeout is counted from the start of each frame
+    }
+
+    switch( tcpIpSocketWriteBufferEx( &conn->socket, &conn->frame->packet, &conn->frame_pos_offset ) )
+    {
+      case TCPIPSOCKET_DONE:
+        tcprosProcessSetFrame( conn, NULL );
+        break;
+
+      case TCPIPSOCKET_IN_PROGRESS:
+        return;
+
+      case TCPIPSOCKET_DISCONNECTED:
+      case TCPIPSOCKET_FAILED:
+      default:
+        PRINT_INFO( "streamConn() : Client disconnected?\n" );
+        closeConn( s, idx );
+        return;
+    }
+  }
+}
+
+/* Queue a frame in a connection, applying the overflow policy of the outgoing queues */
+static void queueConnFrame( CrosIoShard *s, int idx, TcprosFrame *frame )
+{
+  TcprosProcess *conn = s->conns[idx];
+  int push_ret = tcprosProcessPushOutFrame( conn, frame );
+
+  if( push_ret == -2 )
+    PRINT_ERROR( "queueConnFrame() : Can't allocate memory\n" );
+  else if( push_ret != 0 ) // The subscriber is not consuming the messages as fast as they are published
+  {
+    switch( s->out_queue_policy )
+    {
+      case CROS_OUT_QUEUE_DROP_OLDEST:
+        tcprosFrameUnref( tcprosProcessPopOutFrame( conn ) );
+        tcprosProcessPushOutFrame( conn, frame );
+        break;
+      case CROS_OUT_QUEUE_DROP_NEWEST:
+        break;
+      case CROS_OUT_QUEUE_DISCONNECT:
+        PRINT_DEBUG( "queueConnFrame() : Closing the connection of a subscriber that does not keep pace with the topic\n" );
+        closeConn( s, idx );
+        return;
+    }
+  }
+
+  if( conn->frame == NULL ) // The connection was idle: try to send the frame right away
+    streamConn( s, idx );
+}
+
+static void adoptConn( CrosIoShard *s, CrosIoShardMsg *msg )
+{
+  int idx = msg->server_idx;
+  TcprosProcess *conn = msg->conn;
+
+  if( idx >= s->conns_size )
+  {
+    int i, new_size = ( idx + 1 > 2 * s->conns_size )? idx + 1 : 2 * s->conns_size;
+    TcprosProcess **new_conns = (TcprosProcess **)realloc( s->conns, new_size * sizeof(TcprosProcess *) );
+    int *new_timers = NULL;
+    if( new_conns != NULL )
+    {
+      s->conns = new_conns;
+      new_timers = (int *)realloc( s->conn_timers, new_size * sizeof(int) );
+    }
+    if( new_timers == NULL )
+    {
+      PRINT_ERROR( "adoptConn() : Can't allocate memory\n" );
+      notifyClosed( s, idx ); // The connection is closed when msg is freed
+      return;
+    }
+    s->conn_timers = new_timers;
+    for( i = s->conns_size; i < new_size; i++ )
+    {
+      s->conns[i] = NULL;
+      s->conn_timers[i] = -1;
+    }
+    s->conns_size = new_size;
+  }
+
+  if( s->conns[idx] != NULL ) // Not expected: the node passes each process once
+    closeConn( s, idx );
+
+  // Each connection slot keeps its timer, which is only armed while a frame is being sent
+  if( s->conn_timers[idx] < 0 )
+  {
+    s->conn_timers[idx] = cRosTimerHeapAdd( &s->timers, (uint64_t)idx );
+    if( s->conn_timers[idx] < 0 )
+    {
+      notifyClosed( s, idx ); // The connection is closed when msg is freed
+      return;
+    }
+  }
+
+  msg->conn = NULL;
+  s->conns[idx] = conn;
+  streamConn( s, idx );
+}
+
+static void publishFrame( CrosIoShard *s, CrosIoShardMsg *msg )
+{
+  int i;
+
+  if( msg->server_idx >= 0 ) // Frame of a single connection (periodic publication)
+  {
+    if( msg->server_idx < s->conns_size && s->conns[msg->server_idx] != NULL )
+      queueConnFrame( s, msg->server_idx, msg->frame );
+    return;
+  }
+
+  for( i = 0; i < s->conns_size; i++ )
+  {
+    if( s->conns[i] != NULL && s->conns[i]->topic_idx == msg->topic_idx )
+      queueConnFrame( s, i, msg->frame );
+  }
+}
+
+static void handleInbox( CrosIoShard *s )
+{
+  CrosMpscLink *link;
+
+  while( ( link = cRosMpscQueuePop( &s->inbox ) ) != NULL )
+  {
+    CrosIoShardMsg *msg = CROS_MPSC_CONTAINER( link, CrosIoShardMsg, link );
+    switch( msg->type )
+    {
+      case CROS_IO_SHARD_ADOPT:
+        adoptConn( s, msg );
+        break;
+      case CROS_IO_SHARD_PUBLISH:
+        publishFrame( s, msg );
+        break;
+      default:
+        break;
+    }
+    cRosIoShardFreeMsg( msg );
+  }
+}
+
+static void handleConnEvents( CrosIoShard *s, int idx, unsigned int events )
+{
+  if( events & CROS_POLLER_ERROR )
+  {
+    PRINT_ERROR( "handleConnEvents() : TCPROS server socket error\n" );
+    closeConn( s, idx );
+  }
+  else if( events & CROS_POLLER_WRITE )
+    streamConn( s, idx );
+}
+
+/* The shard cannot wait for its sockets anymore: close its connections, so that the node releases their processes, and
+   make the node stop passing connections and frames to it. The messages posted meanwhile are attended when the shard
+   is stopped */
+static void failIoShard( CrosIoShard *s )
+{
+  int i;
+
+  __atomic_store_n( &s->failed, 1, __ATOMIC_RELEASE );
+  for( i = 0; i < s->conns_size; i++ )
+  {
+    if( s->conns[i] != NULL )
+      closeConn( s, i );
+  }
+}
+
+/* Close the connections that could not send a frame in time, and return the time until the next I/O timeout (or the
+   I/O timeout if no frame is being sent) */
+static uint64_t checkConnTimeouts( CrosIoShard *s )
+{
+  uint64_t tag, deadline, cur_time = cRosClockGetTimeNs();
+
+  while( cRosTimerHeapPopExpired( &s->timers, cur_time, &tag ) )
+  {
+    if( tag < (uint64_t)s->conns_size && s->conns[tag] != NULL && s->conns[tag]->state == TCPROS_PROCESS_STATE_WRITING )
+    {
+      PRINT_DEBUG( "checkConnTimeouts() : TCPROS server I/O timeout\n" );
+      closeConn( s, (int)tag );
+    }
+  }
+
+  deadline = cRosTimerHeapNextDeadline( &s->timers );
+  if( deadline == CROS_TIMER_NEVER )
+    return s->io_timeout_ns;
+  return ( deadline > cur_time )? deadline - cur_time : 0;
+}
+
+static void *runIoShard( void *arg )
+{
+  CrosIoShard *s = (CrosIoShard *)arg;
+  unsigned char exit_flag = 0;
+  uint64_t timeout = s->io_timeout_ns;
+
+  // The connections are watched when they change their state (see watchConn())
+  cRosPollerWatch( &s->poller, &s->wakeup.poller_entry, s->wakeup.read_fd, CROS_POLLER_READ, 0, CROS_IO_SHARD_WAKEUP_TAG );
+
+  while( !exit_flag )
+  {
+    int i, woken_up = 0;
+    int n_set;
+
+    cRosPollerBegin( &s->poller );
+    n_set = cRosPollerWait( &s->poller, timeout );
+
+    if( n_set == -1 )
+    {
+      if( errno != EINTR )
+      {
+        PRINT_ERROR( "runIoShard() : poller wait failed. errno=%i\n", errno );
+        failIoShard( s );
+        break;
+      }
+      n_set = 0;
+    }
+
+    for( i = 0; i < n_set; i++ )
+    {
+      uint64_t tag = cRosPollerGetReadyTag( &s->poller, i );
+      if( tag == CROS_IO_SHARD_WAKEUP_TAG )
+        woken_up = 1;
+      else if( tag < (uint64_t)s->conns_size && s->conns[tag] != NULL )
+      {
+        unsigned int events = cRosPollerGetReadyEvents( &s->poller, i, &s->conns[tag]->poller_entry );
+        if( events != 0 )
+          handleConnEvents( s, (int)tag, events );
+      }
+    }
+
+    if( woken_up )
+    {
+      cRosWakeupDrain( &s->wakeup );
+      // The messages posted after this point wake up the shard again
+      __atomic_exchange_n( &s->inbox_pending, 0, __ATOMIC_ACQ_REL );
+      // The flag is read before attending the inbox: the messages posted before setting it are then in the inbox
+      exit_flag = __atomic_load_n( &s->exit_flag, __ATOMIC_ACQUIRE );
+      handleInbox( s );
+    }
+
+    timeout = checkConnTimeouts( s );
+  }
+
+  return NULL;
+}
+
+int cRosIoShardStart( CrosIoShard *s, CrosPollerBackend backend, CrosOutQueuePolicy out_queue_policy, uint64_t io_timeout_ns,
+                      CrosMpscQueue *events, unsigned char *events_pending, CrosWakeup *events_wakeup )
+{
+  if( s->running )
+    return -1;
+
+  cRosPollerRelease( &s->poller );
+  if( cRosPollerInit( &s->poller, backend, CROS_IO_SHARD_MAX_EVENTS ) != 0 || cRosWakeupOpen( &s->wakeup ) != 0 )
+    return -1;
+
+  s->out_queue_policy = out_queue_policy;
+  s->io_timeout_ns = io_timeout_ns;
+  s->events = events;
+  s->events_pending = events_pending;
+  s->events_wakeup = events_wakeup;
+  s->load = 0;
+  s->exit_flag = 0;
+  s->failed = 0;
+  if( pthread_create( &s->thread, NULL, runIoShard, s ) != 0 )
+  {
+    PRINT_ERROR( "cRosIoShardStart() : Can't create the shard thread\n" );
+    return -1;
+  }
+  s->running = 1;
+
+  return 0;
+}
+
+void cRosIoShardStop( CrosIoShard *s )
+{
+  if( !s->running )
+    return;
+
+  __atomic_store_n( &s->exit_flag, 1, __ATOMIC_RELEASE );
+  cRosWakeupSignal( &s->wakeup );
+  pthread_join( s->thread, NULL );
+  s->running = 0;
+
+  handleInbox( s ); // If the thread failed, the messages posted meanwhile are attended here
+}
+
+int cRosIoShardHasFailed( CrosIoShard *s )
+{
+  return __atomic_load_n( &s->failed, __ATOMIC_ACQUIRE );
+}
+
+TcprosProcess *cRosIoShardTakeConn( CrosIoShard *s, int server_idx )
+{
+  TcprosProcess *conn;
+
+  if( server_idx < 0 || server_idx >= s->conns_size )
+    return NULL;
+
+  conn = s->conns[server_idx];
+  s->conns[server_idx] = NULL;
+  return conn;
+}
+
+void cRosIoShardRelease( CrosIoShard *s )
+{
+  CrosMpscLink *link;
+  int i;
+
+  cRosIoShardStop( s );
+
+  while( ( link = cRosMpscQueuePop( &s->inbox ) ) != NULL )
+    cRosIoShardFreeMsg( CROS_MPSC_CONTAINER( link, CrosIoShardMsg, link ) );
+
+  for( i = 0; i < s->conns_size; i++ )
+  {
+    if( s->conns[i] != NULL )
+      freeConn( s->conns[i] );
+  }
+  free( s->conns );
+  free( s->conn_timers );
+  s->conns = NULL;
+  s->conn_timers = NULL;
+  s->conns_size = 0;
+  cRosTimerHeapRelease( &s->timers );
+
+  cRosPollerRelease( &s->poller );
+  cRosWakeupClose( &s->wakeup );
+}
@@ -219,19 +219,20 @@ void cRosLogPrint(CrosNode* node,
 
   log->line = line;
 
-  int i;
+  int i, pub_ind;
   log->n_pubs = node->n_pubs;
   log->pubs = (char**) calloc(log->n_pubs,sizeof(char*));
 
-  for(i = 0; i <node->n_pubs; i++)
+  // The publisher table may have free slots between the registered publishers
+  pub_ind = 0;
+  for(i = 0; i < node->pubs_table.size && pub_ind < log->n_pubs; i++)
   {
     if(node->pubs[i].topic_name != NULL)
     {
-      log->pubs[i] = calloc(strlen(node->pubs[i].topic_name) + 1, sizeof(char));
-      strncpy(log->pubs[i], node->pubs[i].topic_name,strlen(node->pubs[i].topic_name));
+      log->pubs[pub_ind] = calloc(strlen(node->pubs[i].topic_name) + 1, sizeof(char));
+      strncpy(log->pubs[pub_ind], node->pubs[i].topic_name,strlen(node->pubs[i].topic_name));
+      pub_ind++;
     }
-    else
-      log->pubs[i] = NULL;
   }
 
   fprintf(cRosOutStreamGet(),"\n[%d,%d] ",log->secs, log->nsecs);
@@ -12,6 +12,7 @@
 #define DIR_SEPARATOR_STR "/"
 
 static void * arrayFieldValueAt(cRosMessageField *field, int position, size_t element_size);
+static cRosMessage *copyWithoutDef(CrosArena *arena, cRosMessage *m_src);
 static const char * getMessageTypeDeclarationConst(msgConst *msgConst);
 static const char * getMessageTypeDeclarationField(msgFieldDef *fieldDef);
 
@@ -570,33 +571,202 @@ void cRosMD5Readable(unsigned char* data, DynString* output)
     }
 }
 
-void cRosMessageInit(cRosMessage *message)
+// Memory of the messages and their fields: it is allocated in their arena, or in the heap if they have no arena.
+// The memory of an arena is not freed block by block, but all at once by cRosArenaReset() or cRosArenaRelease()
+static void *msgMalloc(CrosArena *arena, size_t size)
+{
+  return (arena != NULL)? cRosArenaAlloc(arena, size) : malloc(size);
+}
+
+static void *msgCalloc(CrosArena *arena, size_t n_elems, size_t elem_size)
+{
+  return (arena != NULL)? cRosArenaCalloc(arena, n_elems, elem_size) : calloc(n_elems, elem_size);
+}
+
+static void *msgRealloc(CrosArena *arena, void *ptr, size_t size)
+{
+  return (arena != NULL)? cRosArenaRealloc(arena, ptr, size) : realloc(ptr, size);
+}
+
+static char *msgStrdup(CrosArena *arena, const char *str)
+{
+  return (arena != NULL)? cRosArenaStrdup(arena, str) : strdup(str);
+}
+
+static void msgFree(CrosArena *arena, void *ptr)
+{
+  if(arena == NULL)
+    free(ptr);
+}
+
+// The length of the string values of a field, and the number of characters that their memory can hold, are kept in
+// the field (see cRosMessageStringInfo), so that the strings are encoded without scanning them and overwritten without
+// reallocating them if they are not longer. They are ignored for the strings assigned directly to the field
+
+// Get the information kept for the string value of a field, or for the element elem_ind of an array of strings (NULL if
+// the array has no information for that element yet)
+static cRosMessageStringInfo *getStringInfo(cRosMessageField *field, int elem_ind)
+{
+  if(!field->is_array)
+    return &field->string_info;
+  return (elem_ind < field->string_infos_capacity)? &field->string_infos[elem_ind] : NULL;
+}
+
+static char **getStringValue(cRosMessageField *field, int elem_ind)
+{
+  return (field->is_array)? &field->data.as_string_array[elem_ind] : &field->data.as_string;
+}
+
+static uint32_t getStringLength(cRosMessageField *field, int elem_ind)
+{
+  const char *str = *getStringValue(field, elem_ind);
+  const cRosMessageStringInfo *info;
+
+  if(str == NULL)
+    return 0;
+  info = getStringInfo(field, elem_ind);
+  return (info != NULL && info->str == str)? info->len : (uint32_t)strlen(str); // Otherwise it was assigned directly
+}
+
+// Make an array of strings keep the information of n_elems elements at least
+static int reserveStringInfos(cRosMessageField *field, int n_elems)
+{
+  cRosMessageStringInfo *new_infos;
+
+  if(field->string_infos_capacity >= n_elems)
+    return 0;
+  new_infos = (cRosMessageStringInfo *)msgRealloc(field->arena, field->string_infos, n_elems * sizeof(cRosMessageStringInfo));
+  if(new_infos == NULL)
+    return -1;
+  memset(new_infos + field->string_infos_capacity, 0, (n_elems - field->string_infos_capacity) * sizeof(cRosMessageStringInfo));
+  field->string_infos = new_infos;
+  field->string_infos_capacity = n_elems;
+  return 0;
+}
+
+// Make a string value of a field (which can be NULL) able to hold len characters, reusing its memory if it is large
+// enough. Its current characters are kept (a new string is empty)
+static int reserveString(cRosMessageField *field, int elem_ind, uint32_t len)
+{
+  char **str = getStringValue(field, elem_ind);
+  cRosMessageStringInfo *info;
+  uint32_t cur_len, capacity;
+  char *new_str;
+
+  if(field->is_array && reserveStringInfos(field, (field->array_capacity > elem_ind)? field->array_capacity : elem_ind + 1) != 0)
+    return -1;
+  info = getStringInfo(field, elem_ind);
+
+  if(*str == NULL)
+  {
+    new_str = (char *)msgMalloc(field->arena, len + 1);
+    if(new_str == NULL)
+      return -1;
+    new_str[0] = '\0';
+    cur_len = 0;
+    capacity = len;
+  }
+  else if(info->str == *str)
+  {
+    cur_len = info->len;
+    capacity = info->capacity;
+    new_str = *str;
+    if(capacity < len)
+    {
+      new_str = (char *)msgRealloc(field->arena, *str, len + 1);
+      if(new_str == NULL)
+        return -1;
+      capacity = len;
+    }
+  }
+  else // Assigned directly: its memory is only known to hold its characters, and it may not belong to the arena
+  {
+    cur_len = capacity = (uint32_t)strlen(*str);
+    new_str = *str;
+    if(capacity < len)
+    {
+      new_str = (char *)msgMalloc(field->arena, len + 1);
+      if(new_str == NULL)
+        return -1;
+      memcpy(new_str, *str, cur_len + 1);
+      msgFree(field->arena, *str);
+      capacity = len;
+    }
+  }
+
+  *str = new_str;
+  info->str = new_str;
+  info->len = cur_len;
+  info->capacity = capacity;
+  return 0;
+}
+
+// Store len characters in a string value of a field, reusing its memory if it can hold them
+static int setString(cRosMessageField *field, int elem_ind, const char *chars, uint32_t len)
+{
+  char *str;
+
+  if(reserveString(field, elem_ind, len) != 0)
+    return -1;
+
+  str = *getStringValue(field, elem_ind);
+  memcpy(str, chars, len);
+  str[len] = '\0';
+  getStringInfo(field, elem_ind)->len = len;
+  return 0;
+}
+
+static void freeString(cRosMessageField *field, int elem_ind)
+{
+  char **str = getStringValue(field, elem_ind);
+  cRosMessageStringInfo *info = getStringInfo(field, elem_ind);
+
+  msgFree(field->arena, *str);
+  *str = NULL;
+  if(info != NULL)
+    info->str = NULL;
+}
+
+static void initMessage(cRosMessage *message, CrosArena *arena)
 {
     message->fields = NULL;
     message->n_fields = 0;
     message->msgDef = NULL;
+    message->fixed_size = 0;
+    message->borrowed_buffer = NULL;
+    message->arena = arena;
 
-    message->md5sum = (char*) calloc(33, sizeof(char)); // 32 chars + '\0';
+    message->md5sum = (char*) msgCalloc(arena, 33, sizeof(char)); // 32 chars + '\0';
 }
 
-cRosMessage * cRosMessageNew(void)
+void cRosMessageInit(cRosMessage *message)
 {
-  cRosMessage *ret = (cRosMessage *)calloc(1, sizeof(cRosMessage));
+  initMessage(message, NULL);
+}
+
+static cRosMessage *newMessage(CrosArena *arena)
+{
+  cRosMessage *ret = (cRosMessage *)msgCalloc(arena, 1, sizeof(cRosMessage));
 
   if (ret == NULL)
     return NULL;
 
-  cRosMessageInit(ret);
+  initMessage(ret, arena);
 
   if (ret->md5sum == NULL)
   {
-    free(ret);
+    msgFree(arena, ret);
     return NULL;
   }
 
   return ret;
 }
 
+cRosMessage * cRosMessageNew(void)
+{
+  return newMessage(NULL);
+}
+
 void cRosMessageFieldInit(cRosMessageField *field)
 {
   if(field != NULL)
@@ -610,10 +780,24 @@ void cRosMessageFieldInit(cRosMessageField *field)
     field->is_fixed_array = 0;
     field->array_size = -1;
     field->array_capacity = -1;
+    field->is_borrowed = 0;
+    field->arena = NULL;
     memset(field->data.opaque, 0, sizeof(field->data.opaque));
+    memset(&field->string_info, 0, sizeof(field->string_info));
+    field->string_infos = NULL;
+    field->string_infos_capacity = 0;
   }
 }
 
+static cRosMessageField *newField(CrosArena *arena)
+{
+  cRosMessageField *ret = (cRosMessageField *)msgCalloc(arena, 1, sizeof(cRosMessageField));
+  cRosMessageFieldInit(ret);
+  if(ret != NULL)
+    ret->arena = arena;
+  return ret;
+}
+
 //  Load message specification from a string:
 //  types, names, constants
 cRosErrCodePack loadFromStringMsg(char* text, cRosMessageDef* msg)
@@ -902,31 +1086,32 @@ cRosErrCodePack loadFromFileMsg(char* filename, cRosMessageDef* msg)
     return ret_err;
 }
 
-cRosMessage *build_time_field(void)
+cRosMessage *build_time_field(CrosArena *arena)
 {
-  cRosMessage* time_msg = cRosMessageNew();
+  cRosMessage* time_msg = newMessage(arena);
   if(time_msg != NULL)
   {
-    time_msg->fields = (cRosMessageField**) calloc(2,sizeof(cRosMessageField*));
+    time_msg->fields = (cRosMessageField**) msgCalloc(arena, 2,sizeof(cRosMessageField*));
     if(time_msg->fields != NULL)
     {
       time_msg->n_fields = 2;
 
-      cRosMessageField* sec = cRosMessageFieldNew();
-      cRosMessageField* nsec = cRosMessageFieldNew();
+      cRosMessageField* sec = newField(arena);
+      cRosMessageField* nsec = newField(arena);
       if(sec != NULL && nsec != NULL)
       {
         //int32 sec
-        sec->name = strdup("secs");
+        sec->name = msgStrdup(arena, "secs");
         sec->type = CROS_STD_MSGS_UINT32;
         sec->size = getMessageTypeSizeOf(sec->type);
         time_msg->fields[0] = sec;
 
         //int32 nsec
-        nsec->name = strdup("nsecs");
+        nsec->name = msgStrdup(arena, "nsecs");
         nsec->type = CROS_STD_MSGS_UINT32;
         nsec->size = getMessageTypeSizeOf(nsec->type);
         time_msg->fields[1] = nsec;
+        time_msg->fixed_size = sec->size + nsec->size;
 
         if(sec->name == NULL || nsec->name == NULL)
         {
@@ -952,31 +1137,32 @@ cRosMessage *build_time_field(void)
   return time_msg;
 }
 
-cRosMessage *build_duration_field(void)
+cRosMessage *build_duration_field(CrosArena *arena)
 {
-  cRosMessage* durat_msg = cRosMessageNew();
+  cRosMessage* durat_msg = newMessage(arena);
   if(durat_msg != NULL)
   {
-    durat_msg->fields = (cRosMessageField**) calloc(2,sizeof(cRosMessageField*));
+    durat_msg->fields = (cRosMessageField**) msgCalloc(arena, 2,sizeof(cRosMessageField*));
     if(durat_msg->fields != NULL)
     {
       durat_msg->n_fields = 2;
 
-      cRosMessageField* sec = cRosMessageFieldNew();
-      cRosMessageField* nsec = cRosMessageFieldNew();
+      cRosMessageField* sec = newField(arena);
+      cRosMessageField* nsec = newField(arena);
       if(sec != NULL && nsec != NULL)
       {
         //int32 sec
-        sec->name = strdup("secs");
+        sec->name = msgStrdup(arena, "secs");
         sec->type = CROS_STD_MSGS_INT32;
         sec->size = getMessageTypeSizeOf(sec->type);
         durat_msg->fields[0] = sec;
 
         //int32 nsec
-        nsec->name = strdup("nsecs");
+        nsec->name = msgStrdup(arena, "nsecs");
         nsec->type = CROS_STD_MSGS_INT32;
         nsec->size = getMessageTypeSizeOf(nsec->type);
         durat_msg->fields[1] = nsec;
+        durat_msg->fixed_size = sec->size + nsec->size;
 
         if(sec->name == NULL || nsec->name == NULL)
         {
@@ -1002,23 +1188,23 @@ cRosMessage *build_duration_field(void)
   return durat_msg;
 }
 
-cRosMessage *build_header_field(void)
+cRosMessage *build_header_field(CrosArena *arena)
 {
-  cRosMessage* header_msg = cRosMessageNew();
+  cRosMessage* header_msg = newMessage(arena);
   if(header_msg != NULL)
   {
-    header_msg->fields = (cRosMessageField**) calloc(3,sizeof(cRosMessageField*));
+    header_msg->fields = (cRosMessageField**) msgCalloc(arena, 3,sizeof(cRosMessageField*));
     if(header_msg->fields != NULL)
     {
       header_msg->n_fields = 3;
 
-      cRosMessageField* sequence_id = cRosMessageFieldNew();
-      cRosMessageField* time_stamp = cRosMessageFieldNew();
-      cRosMessageField* frame_id = cRosMessageFieldNew();
+      cRosMessageField* sequence_id = newField(arena);
+      cRosMessageField* time_stamp = newField(arena);
+      cRosMessageField* frame_id = newField(arena);
       if(sequence_id != NULL && time_stamp != NULL && frame_id != NULL)
       {
         //uint32 seq
-        sequence_id->name = strdup("seq");
+        sequence_id->name = msgStrdup(arena, "seq");
         sequence_id->type = CROS_STD_MSGS_UINT32;
         sequence_id->size = getMessageTypeSizeOf(sequence_id->type);
         header_msg->fields[0] = sequence_id;
@@ -1027,13 +1213,13 @@ cRosMessage *build_header_field(void)
         // Two-integer timestamp that is expressed as:
         // * stamp.secs: seconds (stamp_secs) since epoch
         // * stamp.nsecs: nanoseconds since stamp_secs
-        time_stamp->name = strdup("stamp");
+        time_stamp->name = msgStrdup(arena, "stamp");
         time_stamp->type = CROS_STD_MSGS_TIME;
-        time_stamp->data.as_msg = build_time_field();
+        time_stamp->data.as_msg = build_time_field(arena);
         header_msg->fields[1] = time_stamp;
 
         //string frame_id
-        frame_id->name = strdup("frame_id");
+        frame_id->name = msgStrdup(arena, "frame_id");
         frame_id->type = CROS_STD_MSGS_STRING;
         header_msg->fields[2] = frame_id;
         if(sequence_id->name == NULL || time_stamp->name == NULL || frame_id->name == NULL)
@@ -1117,13 +1303,17 @@ int cRosMessageFieldCopy(cRosMessageField* new_field, cRosMessageField* orig_fie
     new_field->is_fixed_array = orig_field->is_fixed_array;
     new_field->array_size = orig_field->array_size;
     new_field->array_capacity = orig_field->array_capacity;
+    new_field->is_borrowed = 0; // Borrowed arrays are copied like the others
+    memset(&new_field->string_info, 0, sizeof(new_field->string_info));
+    new_field->string_infos = NULL;
+    new_field->string_infos_capacity = 0;
     new_field->type = orig_field->type;
-    new_field->type_s = (orig_field->type_s != NULL)? strdup(orig_field->type_s):NULL;
-    new_field->name = (orig_field->name != NULL)? strdup(orig_field->name):NULL;
+    new_field->type_s = (orig_field->type_s != NULL)? msgStrdup(new_field->arena, orig_field->type_s):NULL;
+    new_field->name = (orig_field->name != NULL)? msgStrdup(new_field->arena, orig_field->name):NULL;
     if((new_field->type_s == NULL && orig_field->type_s != NULL) || (new_field->name == NULL && orig_field->name != NULL))
     {
-      free(new_field->type_s);
-      free(new_field->name);
+      msgFree(new_field->arena, new_field->type_s);
+      msgFree(new_field->arena, new_field->name);
       ret=-1;
     }
     else
@@ -1152,8 +1342,9 @@ int cRosMessageFieldCopy(cRosMessageField* new_field, cRosMessageField* orig_fie
           }
           case CROS_STD_MSGS_STRING:
           {
-            new_field->data.as_string = (orig_field->data.as_string != NULL)? strdup(orig_field->data.as_string) : NULL;
-            if(orig_field->data.as_string != NULL && new_field->data.as_string == NULL)
+            new_field->data.as_string = NULL;
+            if(orig_field->data.as_string != NULL &&
+               setString(new_field, 0, orig_field->data.as_string, getStringLength(orig_field, 0)) != 0)
               ret=-1; // Error allocating memory for string
             break;
           }
@@ -1163,7 +1354,7 @@ int cRosMessageFieldCopy(cRosMessageField* new_field, cRosMessageField* orig_fie
           case CROS_CUSTOM_TYPE:
           {
             if(!orig_field->is_array)
-              new_field->data.as_msg = cRosMessageCopyWithoutDef(orig_field->data.as_msg);
+              new_field->data.as_msg = copyWithoutDef(new_field->arena, orig_field->data.as_msg);
               if(new_field->data.as_msg == NULL)
                 ret=-1;
             break;
@@ -1174,12 +1365,12 @@ int cRosMessageFieldCopy(cRosMessageField* new_field, cRosMessageField* orig_fie
       {
         // Allocate the array
         if(orig_field->type == CROS_STD_MSGS_STRING) // The array is encoded as a pointer to pointers
-          new_field->data.as_array = calloc(orig_field->array_capacity, sizeof(char *)); // String pointers
+          new_field->data.as_array = msgCalloc(new_field->arena, orig_field->array_capacity, sizeof(char *)); // String pointers
         else if(orig_field->type == CROS_STD_MSGS_TIME || orig_field->type == CROS_STD_MSGS_DURATION ||
                 orig_field->type == CROS_STD_MSGS_HEADER || orig_field->type == CROS_CUSTOM_TYPE)
-          new_field->data.as_array = calloc(orig_field->array_capacity, sizeof(cRosMessage *)); // Message pointers
+          new_field->data.as_array = msgCalloc(new_field->arena, orig_field->array_capacity, sizeof(cRosMessage *)); // Message pointers
         else // The array is encoded as a pointer to elements
-          new_field->data.as_array = calloc(orig_field->array_capacity, orig_field->size); // Element pointers
+          new_field->data.as_array = msgCalloc(new_field->arena, orig_field->array_capacity, orig_field->size); // Element pointers
         if(new_field->data.as_array != NULL) // If the array was allocated, copy the elements
         {
           switch (orig_field->type)
@@ -1189,13 +1380,13 @@ int cRosMessageFieldCopy(cRosMessageField* new_field, cRosMessageField* orig_fie
               int n_str;
               for(n_str=0;n_str<orig_field->array_size && ret==0;n_str++)
               {
-                new_field->data.as_string_array[n_str] = (orig_field->data.as_string_array[n_str] != NULL)?strdup(orig_field->data.as_string_array[n_str]):NULL;
-                if(new_field->data.as_string_array[n_str] == NULL && orig_field->data.as_string_array[n_str] != NULL)
+                const char *orig_str = orig_field->data.as_string_array[n_str];
+                if(orig_str != NULL && setString(new_field, n_str, orig_str, getStringLength(orig_field, n_str)) != 0)
                   ret=-1;
               }
               if(ret != 0) // Error allocating memory for strings: free previously allocated string memory
                 for(n_str=0;n_str<orig_field->array_size && ret==0;n_str++)
-                  free(new_field->data.as_string_array[n_str]);
+                  freeString(new_field, n_str);
               break;
             }
             case CROS_STD_MSGS_TIME:
@@ -1206,7 +1397,7 @@ int cRosMessageFieldCopy(cRosMessageField* new_field, cRosMessageField* orig_fie
               int n_msg;
               for(n_msg=0;n_msg<orig_field->array_size && ret==0;n_msg++)
               {
-                new_field->data.as_msg_array[n_msg] = cRosMessageCopyWithoutDef(orig_field->data.as_msg_array[n_msg]);
+                new_field->data.as_msg_array[n_msg] = copyWithoutDef(new_field->arena, orig_field->data.as_msg_array[n_msg]);
                 if(new_field->data.as_msg_array[n_msg] == NULL && orig_field->data.as_msg_array[n_msg] != NULL)
                   ret=-1;
               }
@@ -1223,7 +1414,7 @@ int cRosMessageFieldCopy(cRosMessageField* new_field, cRosMessageField* orig_fie
           }
           if(ret != 0)
           {
-            free(new_field->data.as_array);
+            msgFree(new_field->arena, new_field->data.as_array);
           }
         }
         else
@@ -1231,8 +1422,8 @@ int cRosMessageFieldCopy(cRosMessageField* new_field, cRosMessageField* orig_fie
       }
       if(ret != 0) // Free memory to leave the message in a determined state
       {
-        free(new_field->type_s);
-        free(new_field->name);
+        msgFree(new_field->arena, new_field->type_s);
+        msgFree(new_field->arena, new_field->name);
       }
     }
   }
@@ -1497,12 +1688,308 @@ void cRosMessageFieldsPrint(cRosMessage *msg, int n_indent)
     fprintf(cRosOutStreamGet(), "MsgAt NULL\n");
 }
 
+static int isMessageFieldType(CrosMessageType type)
+{
+  return(type == CROS_STD_MSGS_TIME || type == CROS_STD_MSGS_DURATION || type == CROS_STD_MSGS_HEADER || type == CROS_CUSTOM_TYPE);
+}
+
+// Number of bytes of the encoded messages of a definition if it has no strings or variable-length arrays, or 0 otherwise
+static size_t getFixedSizeMsgDef(cRosMessageDef *msg_def)
+{
+  msgFieldDef *field_def_itr;
+  size_t total_size = 0;
+
+  for(field_def_itr = msg_def->first_field; field_def_itr->next != NULL; field_def_itr = field_def_itr->next)
+  {
+    size_t elem_size;
+
+    if(field_def_itr->is_array && field_def_itr->array_size < 0)
+      return 0;
+
+    switch(field_def_itr->type)
+    {
+      case CROS_STD_MSGS_TIME:
+      case CROS_STD_MSGS_DURATION:
+        elem_size = 2 * sizeof(uint32_t);
+        break;
+      case CROS_CUSTOM_TYPE:
+        elem_size = (field_def_itr->child_msg_def != NULL)? getFixedSizeMsgDef(field_def_itr->child_msg_def) : 0;
+        break;
+      case CROS_STD_MSGS_STRING:
+      case CROS_STD_MSGS_HEADER:
+        elem_size = 0;
+        break;
+      default:
+        elem_size = getMessageTypeSizeOf(field_def_itr->type);
+        break;
+    }
+    if(elem_size == 0)
+      return 0;
+
+    total_size += (field_def_itr->is_array)? elem_size * field_def_itr->array_size : elem_size;
+  }
+  return total_size;
+}
+
+// The following functions process the fields of POD messages (whose fixed_size is not 0), which only contain primitive
+// values, fixed-length arrays and nested POD messages, so they do not need to check the data length of each field
+
+// Encode the fields of a POD message into dest, which must hold fixed_size bytes. Returns the end of the encoded data
+static unsigned char *packFixedFields(cRosMessage *message, unsigned char *dest)
+{
+  int field_ind, elem_ind;
+
+  for(field_ind = 0; field_ind < message->n_fields; field_ind++)
+  {
+    cRosMessageField *field = message->fields[field_ind];
+
+    if(isMessageFieldType(field->type))
+    {
+      if(field->is_array)
+      {
+        for(elem_ind = 0; elem_ind < field->array_size; elem_ind++)
+          dest = packFixedFields(field->data.as_msg_array[elem_ind], dest);
+      }
+      else
+        dest = packFixedFields(field->data.as_msg, dest);
+    }
+    else if(field->is_array)
+    {
+      memcpy(dest, field->data.as_array, (size_t)field->size * field->array_size);
+      dest += (size_t)field->size * field->array_size;
+    }
+    else
+    {
+      memcpy(dest, field->data.opaque, field->size);
+      dest += field->size;
+    }
+  }
+  return dest;
+}
+
+// Decode the fields of a POD message from src, which must hold fixed_size bytes. Returns the end of the decoded data
+static const unsigned char *unpackFixedFields(cRosMessage *message, const unsigned char *src)
+{
+  int field_ind, elem_ind;
+
+  for(field_ind = 0; field_ind < message->n_fields; field_ind++)
+  {
+    cRosMessageField *field = message->fields[field_ind];
+
+    if(isMessageFieldType(field->type))
+    {
+      if(field->is_array)
+      {
+        for(elem_ind = 0; elem_ind < field->array_size; elem_ind++)
+          src = unpackFixedFields(field->data.as_msg_array[elem_ind], src);
+      }
+      else
+        src = unpackFixedFields(field->data.as_msg, src);
+    }
+    else if(field->is_array)
+    {
+      memcpy(field->data.as_array, src, (size_t)field->size * field->array_size);
+      src += (size_t)field->size * field->array_size;
+    }
+    else
+    {
+      memcpy(field->data.opaque, src, field->size);
+      src += field->size;
+    }
+  }
+  return src;
+}
+
+// Copy the field values of a POD message into another message of the same type
+static void copyFixedFields(cRosMessage *m_dst, cRosMessage *m_src)
+{
+  int field_ind, elem_ind;
+
+  for(field_ind = 0; field_ind < m_src->n_fields; field_ind++)
+  {
+    cRosMessageField *dst_field = m_dst->fields[field_ind];
+    cRosMessageField *src_field = m_src->fields[field_ind];
+
+    if(isMessageFieldType(src_field->type))
+    {
+      if(src_field->is_array)
+      {
+        for(elem_ind = 0; elem_ind < src_field->array_size; elem_ind++)
+          copyFixedFields(dst_field->data.as_msg_array[elem_ind], src_field->data.as_msg_array[elem_ind]);
+      }
+      else
+        copyFixedFields(dst_field->data.as_msg, src_field->data.as_msg);
+    }
+    else if(src_field->is_array)
+      memcpy(dst_field->data.as_array, src_field->data.as_array, (size_t)src_field->size * src_field->array_size);
+    else
+      dst_field->data = src_field->data;
+  }
+}
+
+// Returns 1 if m1 already has the fields of the message type of m2
+static int isSameMsgType(cRosMessage *m1, cRosMessage *m2)
+{
+  return(m1->fields != NULL && m1->n_fields == m2->n_fields &&
+         m1->md5sum != NULL && m2->md5sum != NULL && m1->md5sum[0] != '\0' && strcmp(m1->md5sum, m2->md5sum) == 0);
+}
+
+// Copy a string value of a field over one of another field of the same arena (or of the heap), reusing its memory if
+// it is large enough
+static int copyString(cRosMessageField *dst_field, int dst_ind, cRosMessageField *src_field, int src_ind)
+{
+  const char *src = *getStringValue(src_field, src_ind);
+
+  if(src == NULL)
+  {
+    freeString(dst_field, dst_ind);
+    return 0;
+  }
+
+  return setString(dst_field, dst_ind, src, getStringLength(src_field, src_ind));
+}
+
+// Set the number of elements of a variable-length array of strings. The remaining strings are kept to be overwritten
+// and the new ones are NULL
+static int resizeStringArrayField(cRosMessageField *field, int n_elems)
+{
+  char **new_location;
+
+  while(field->array_size > n_elems)
+  {
+    field->array_size--;
+    freeString(field, field->array_size);
+  }
+
+  if(field->array_capacity < n_elems)
+  {
+    new_location = (char **)msgRealloc(field->arena, field->data.as_string_array, n_elems * sizeof(char *));
+    if(new_location == NULL)
+      return -1;
+    field->data.as_string_array = new_location;
+    field->array_capacity = n_elems;
+  }
+
+  while(field->array_size < n_elems)
+    field->data.as_string_array[field->array_size++] = NULL;
+  return 0;
+}
+
+static int copyFieldValues(cRosMessage *m_dst, cRosMessage *m_src);
+
+// Copy the value of a field into the same field of another message of the same type. The strings, arrays and nested
+// messages of dst_field are overwritten, so their memory is only reallocated if it is too small
+static int copyFieldValue(cRosMessageField *dst_field, cRosMessageField *src_field)
+{
+  int elem_ind;
+
+  if(!src_field->is_array)
+  {
+    if(src_field->type == CROS_STD_MSGS_STRING)
+    {
+      dst_field->size = src_field->size;
+      return copyString(dst_field, 0, src_field, 0);
+    }
+    if(isMessageFieldType(src_field->type))
+      return copyFieldValues(dst_field->data.as_msg, src_field->data.as_msg);
+
+    dst_field->data = src_field->data;
+    return 0;
+  }
+
+  if(src_field->type == CROS_STD_MSGS_STRING)
+  {
+    if(resizeStringArrayField(dst_field, src_field->array_size) != 0)
+      return -1;
+    for(elem_ind = 0; elem_ind < src_field->array_size; elem_ind++)
+    {
+      if(copyString(dst_field, elem_ind, src_field, elem_ind) != 0)
+        return -1;
+    }
+    return 0;
+  }
+
+  if(isMessageFieldType(src_field->type))
+  {
+    while(dst_field->array_size > src_field->array_size)
+      cRosMessageFree(dst_field->data.as_msg_array[--dst_field->array_size]);
+
+    if(dst_field->array_capacity < src_field->array_size)
+    {
+      cRosMessage **new_location = (cRosMessage **)msgRealloc(dst_field->arena, dst_field->data.as_msg_array, src_field->array_size * sizeof(cRosMessage *));
+      if(new_location == NULL)
+        return -1;
+      dst_field->data.as_msg_array = new_location;
+      dst_field->array_capacity = src_field->array_size;
+    }
+
+    for(elem_ind = 0; elem_ind < src_field->array_size; elem_ind++)
+    {
+      if(elem_ind < dst_field->array_size)
+      {
+        if(copyFieldValues(dst_field->data.as_msg_array[elem_ind], src_field->data.as_msg_array[elem_ind]) != 0)
+          return -1;
+      }
+      else
+      {
+        cRosMessage *new_msg = copyWithoutDef(dst_field->arena, src_field->data.as_msg_array[elem_ind]);
+        if(new_msg == NULL)
+          return -1;
+        dst_field->data.as_msg_array[dst_field->array_size++] = new_msg;
+      }
+    }
+    return 0;
+  }
+
+  if(dst_field->is_borrowed) // The borrowed elements are replaced, so there is no need to copy them to the field first
+  {
+    dst_field->data.as_array = NULL;
+    dst_field->array_capacity = 0;
+    dst_field->array_size = 0;
+    dst_field->is_borrowed = 0;
+  }
+
+  if(dst_field->array_capacity < src_field->array_size)
+  {
+    void *new_location = msgRealloc(dst_field->arena, dst_field->data.as_array, (size_t)src_field->array_size * src_field->size);
+    if(new_location == NULL)
+      return -1;
+    dst_field->data.as_array = new_location;
+    dst_field->array_capacity = src_field->array_size;
+  }
+
+  if(src_field->array_size > 0)
+    memcpy(dst_field->data.as_array, src_field->data.as_array, (size_t)src_field->array_size * src_field->size);
+  dst_field->array_size = src_field->array_size;
+  return 0;
+}
+
+// Copy the field values of a message into another message of the same type, reusing the memory of its fields
+static int copyFieldValues(cRosMessage *m_dst, cRosMessage *m_src)
+{
+  int field_ind;
+
+  if(m_dst->fixed_size > 0 && m_dst->fixed_size == m_src->fixed_size)
+  {
+    copyFixedFields(m_dst, m_src);
+    return 0;
+  }
+
+  for(field_ind = 0; field_ind < m_src->n_fields; field_ind++)
+  {
+    if(copyFieldValue(m_dst->fields[field_ind], m_src->fields[field_ind]) != 0)
+      return -1;
+  }
+  return 0;
+}
+
 // This function copies the MD5 and all the fields (fields field struct) from one message (m_src) to another (m_dst).
-// It if expected than the fields field of m_dst is NULL.
+// If m_dst already has the fields of the same message type (e.g., a recycled message), their memory is reused.
 int cRosMessageFieldsCopy(cRosMessage *m_dst, cRosMessage *m_src)
 {
-  int ret;
+  int ret, same_type;
 
+  same_type = (m_dst != NULL && m_src != NULL && isSameMsgType(m_dst, m_src));
   if(m_src != NULL && m_src != NULL)
   {
     if(m_src->md5sum != NULL) // If source message has a valid MD5 field, copy it
@@ -1514,25 +2001,37 @@ int cRosMessageFieldsCopy(cRosMessage *m_dst, cRosMessage *m_src)
       }
       else
       {
-        m_dst->md5sum = strdup(m_src->md5sum);
+        m_dst->md5sum = msgStrdup(m_dst->arena, m_src->md5sum);
         ret = (m_dst->md5sum != NULL)?0:-1;
       }
     }
     else
     {
-      free(m_dst->md5sum);
+      msgFree(m_dst->arena, m_dst->md5sum);
       m_dst->md5sum=NULL;
       ret=0;
     }
   }
   else
     ret=-1;
+  if(ret == 0 && same_type)
+  {
+    // The destination message already has the fields of this type: just overwrite their values
+    ret = copyFieldValues(m_dst, m_src);
+    if(ret == 0)
+    {
+      // Its borrowed arrays have been replaced by copies
+      cRosMessageBufferUnref(m_dst->borrowed_buffer);
+      m_dst->borrowed_buffer = NULL;
+    }
+    return ret;
+  }
   if(ret == 0) // If no error copying MD5 field, continue
   {
     // Remove previous fields from destination message
     cRosMessageFieldsFree(m_dst);
     // Create a new field array in destination message
-    m_dst->fields = (cRosMessageField **)calloc(m_src->n_fields, sizeof(cRosMessageField*));
+    m_dst->fields = (cRosMessageField **)msgCalloc(m_dst->arena, m_src->n_fields, sizeof(cRosMessageField*));
     if(m_dst->fields != NULL)
     {
       int field_ind;
@@ -1541,14 +2040,14 @@ int cRosMessageFieldsCopy(cRosMessage *m_dst, cRosMessage *m_src)
       // Copy all the filed in source message while no error occurs
       for(field_ind=0;field_ind<m_src->n_fields && ret==0;field_ind++)
       {
-        cRosMessageField *new_field = cRosMessageFieldNew();
+        cRosMessageField *new_field = newField(m_dst->arena);
         if(new_field != NULL)
         {
           ret = cRosMessageFieldCopy(new_field, m_src->fields[field_ind]);
           if(ret == 0)
             m_dst->fields[field_ind] = new_field;
           else
-            free(new_field);
+            msgFree(m_dst->arena, new_field);
         }
         else
           ret=-1;
@@ -1558,6 +2057,8 @@ int cRosMessageFieldsCopy(cRosMessage *m_dst, cRosMessage *m_src)
         // Destroy already created fields
         cRosMessageFieldsFree(m_dst);
       }
+      else
+        m_dst->fixed_size = m_src->fixed_size;
     }
     else
       ret=-1;
@@ -1565,12 +2066,45 @@ int cRosMessageFieldsCopy(cRosMessage *m_dst, cRosMessage *m_src)
   return ret;
 }
 
-cRosMessage *cRosMessageCopyWithoutDef(cRosMessage *m_src)
+// This function exchanges the MD5 and all the fields (fields field struct) of two messages without copying them,
+// so the field storage of each message is transferred to the other one. The message definitions are not exchanged.
+// Both messages must be allocated in the same arena (or in the heap), since the storage of each one is freed as the other's.
+void cRosMessageFieldsSwap(cRosMessage *m1, cRosMessage *m2)
+{
+  cRosMessageField **fields;
+  char *md5sum;
+  int n_fields;
+  size_t fixed_size;
+  cRosMessageBuffer *borrowed_buffer;
+
+  fields = m1->fields;
+  m1->fields = m2->fields;
+  m2->fields = fields;
+
+  n_fields = m1->n_fields;
+  m1->n_fields = m2->n_fields;
+  m2->n_fields = n_fields;
+
+  md5sum = m1->md5sum;
+  m1->md5sum = m2->md5sum;
+  m2->md5sum = md5sum;
+
+  fixed_size = m1->fixed_size;
+  m1->fixed_size = m2->fixed_size;
+  m2->fixed_size = fixed_size;
+
+  // The borrowed fields go with the reference to the buffer they point into
+  borrowed_buffer = m1->borrowed_buffer;
+  m1->borrowed_buffer = m2->borrowed_buffer;
+  m2->borrowed_buffer = borrowed_buffer;
+}
+
+static cRosMessage *copyWithoutDef(CrosArena *arena, cRosMessage *m_src)
 {
   cRosMessage *m_dst;
   if(m_src != NULL)
   {
-    m_dst = cRosMessageNew();
+    m_dst = newMessage(arena);
     if(m_dst != NULL)
     {
       if(cRosMessageFieldsCopy(m_dst, m_src) != 0)
@@ -1586,6 +2120,11 @@ cRosMessage *cRosMessageCopyWithoutDef(cRosMessage *m_src)
   return m_dst;
 }
 
+cRosMessage *cRosMessageCopyWithoutDef(cRosMessage *m_src)
+{
+  return copyWithoutDef(NULL, m_src);
+}
+
 cRosMessage *cRosMessageCopy(cRosMessage *m_src)
 {
   cRosMessage *m_dst;
@@ -1810,22 +2349,27 @@ cRosErrCodePack cRosMessageNewBuild(const char *msg_root_dir, const char *msg_ty
   return ret_err;
 }
 
-cRosErrCodePack cRosMessageBuildFromDef(cRosMessage** message_ptr, cRosMessageDef* msg_def )
+static cRosErrCodePack buildFromDef(cRosMessage** message_ptr, cRosMessageDef* msg_def, CrosArena *arena)
 {
   cRosErrCodePack ret;
   cRosMessage* message;
 
   ret = CROS_SUCCESS_ERR_PACK; // Default return value: success
 
-  message = cRosMessageNew();
+  message = newMessage(arena);
   if(message == NULL)
     return CROS_MEM_ALLOC_ERR;
 
   DynString output;
   dynStringInit(&output);
 
-  cRosMessageDefFree(message->msgDef); // Just in case there was a previous message definition in the message
-  cRosMessageDefCopy(&message->msgDef, msg_def );
+  if(arena == NULL)
+  {
+    cRosMessageDefFree(message->msgDef); // Just in case there was a previous message definition in the message
+    cRosMessageDefCopy(&message->msgDef, msg_def );
+  }
+  else
+    message->msgDef = msg_def; // The arena messages do not own their definition, so that they can be freed by resetting the arena
 
   unsigned char* res = getMD5Msg(msg_def);
   cRosMD5Readable(res, &output);
@@ -1840,23 +2384,22 @@ cRosErrCodePack cRosMessageBuildFromDef(cRosMessage** message_ptr, cRosMessageDe
     field_def_itr = field_def_itr->next;
   }
 
-  message->fields = (cRosMessageField**) calloc(message->n_fields, sizeof(cRosMessageField*));
+  message->fields = (cRosMessageField**) msgCalloc(arena, message->n_fields, sizeof(cRosMessageField*));
 
   field_def_itr =  msg_def->first_field;
   cRosMessageField** msg_field_itr = message->fields;
 
   while(field_def_itr->next != NULL && ret == CROS_SUCCESS_ERR_PACK)
   {
-    *msg_field_itr = (cRosMessageField*) malloc(sizeof(cRosMessageField));
+    *msg_field_itr = newField(arena);
     cRosMessageField* field = *msg_field_itr;
-    cRosMessageFieldInit(field);
 
     field->type = field_def_itr->type;
-    field->name = (char*) calloc(strlen(field_def_itr->name)+1,sizeof(char));
+    field->name = (char*) msgCalloc(arena, strlen(field_def_itr->name)+1,sizeof(char));
     strcpy(field->name, field_def_itr->name);
     if (field_def_itr->type_s != NULL)
     {
-      field->type_s = (char*) calloc(strlen(field_def_itr->type_s)+1,sizeof(char));
+      field->type_s = (char*) msgCalloc(arena, strlen(field_def_itr->type_s)+1,sizeof(char));
       strcpy(field->type_s, field_def_itr->type_s);
     }
 
@@ -1894,7 +2437,7 @@ cRosErrCodePack cRosMessageBuildFromDef(cRosMessage** message_ptr, cRosMessageDe
         field->size = getMessageTypeSizeOf(field->type);
         if(field_def_itr->is_array)
         {
-          field->data.as_array = calloc(field->array_capacity,field->size);
+          field->data.as_array = msgCalloc(arena, field->array_capacity,field->size);
           if(field->data.as_array == NULL)
             ret=CROS_MEM_ALLOC_ERR;
         }
@@ -1904,7 +2447,7 @@ cRosErrCodePack cRosMessageBuildFromDef(cRosMessage** message_ptr, cRosMessageDe
       {
         if(field_def_itr->is_array)
         {
-          field->data.as_string_array = (char **)calloc(field->array_capacity,sizeof(char *));
+          field->data.as_string_array = (char **)msgCalloc(arena, field->array_capacity,sizeof(char *));
           if(field->data.as_string_array == NULL)
             ret=CROS_MEM_ALLOC_ERR;
         }
@@ -1918,7 +2461,7 @@ cRosErrCodePack cRosMessageBuildFromDef(cRosMessage** message_ptr, cRosMessageDe
         cRosMessage *new_msg;
         if(field_def_itr->is_array)
         {
-          field->data.as_msg_array = (cRosMessage **)calloc(field->array_capacity,sizeof(cRosMessage *));
+          field->data.as_msg_array = (cRosMessage **)msgCalloc(arena, field->array_capacity,sizeof(cRosMessage *));
           if(field->data.as_msg_array != NULL)
           {
             int msg_ind;
@@ -1927,14 +2470,14 @@ cRosErrCodePack cRosMessageBuildFromDef(cRosMessage** message_ptr, cRosMessageDe
             {
               new_msg = NULL;
               if(field->type == CROS_STD_MSGS_TIME)
-                new_msg = build_time_field();
+                new_msg = build_time_field(arena);
               else if(field->type == CROS_STD_MSGS_DURATION)
-                new_msg = build_duration_field();
+                new_msg = build_duration_field(arena);
               else if(field->type == CROS_STD_MSGS_HEADER)
-                new_msg = build_header_field();
+                new_msg = build_header_field(arena);
               else if(field->type == CROS_CUSTOM_TYPE)
               {
-                ret = cRosMessageBuildFromDef(&new_msg, field_def_itr->child_msg_def); // faster alternative to ret = cRosMessageNewBuild(msg_def->root_dir, field_def_itr->type_s, &new_msg)
+                ret = buildFromDef(&new_msg, field_def_itr->child_msg_def, arena); // faster alternative to ret = cRosMessageNewBuild(msg_def->root_dir, field_def_itr->type_s, &new_msg)
                 ret = cRosAddErrCodeIfErr(ret, CROS_CREATE_CUSTOM_MSG_ERR); // If the message could not be created, add more info to the error code pack
               }
 
@@ -1953,14 +2496,14 @@ cRosErrCodePack cRosMessageBuildFromDef(cRosMessage** message_ptr, cRosMessageDe
         else
         {
           if(field->type == CROS_STD_MSGS_TIME)
-            field->data.as_msg = build_time_field();
+            field->data.as_msg = build_time_field(arena);
           else if(field->type == CROS_STD_MSGS_DURATION)
-            field->data.as_msg = build_duration_field();
+            field->data.as_msg = build_duration_field(arena);
           else if(field->type == CROS_STD_MSGS_HEADER)
-            field->data.as_msg = build_header_field();
+            field->data.as_msg = build_header_field(arena);
           else if(field->type == CROS_CUSTOM_TYPE)
           {
-            ret = cRosMessageBuildFromDef(&field->data.as_msg, field_def_itr->child_msg_def);
+            ret = buildFromDef(&field->data.as_msg, field_def_itr->child_msg_def, arena);
             ret = cRosAddErrCodeIfErr(ret, CROS_CREATE_CUSTOM_MSG_ERR);
           }
 
@@ -1975,14 +2518,27 @@ cRosErrCodePack cRosMessageBuildFromDef(cRosMessage** message_ptr, cRosMessageDe
   }
 
   if(ret == CROS_SUCCESS_ERR_PACK)
+  {
+    message->fixed_size = getFixedSizeMsgDef(msg_def);
     *message_ptr = message;
+  }
   else
     cRosMessageFree(message);
 
   return ret;
 }
 
-void cRosMessageConstDefFree(msgConst* msg_const)
+cRosErrCodePack cRosMessageBuildFromDef(cRosMessage** message_ptr, cRosMessageDef* msg_def )
+{
+  return buildFromDef(message_ptr, msg_def, NULL);
+}
+
+cRosErrCodePack cRosMessageBuildFromDefArena(cRosMessage **message_ptr, cRosMessageDef *msg_def, CrosArena *arena)
+{
+  return buildFromDef(message_ptr, msg_def, arena);
+}
+
+void cRosMessageConstDefFree(msgConst* msg_const)
 {
   if(msg_const != NULL)
   {
@@ -2049,21 +2605,28 @@ void cRosMessageFieldsFree(cRosMessage *message)
 {
   int i;
 
-  for(i = 0; i < message->n_fields; i++)
-    cRosMessageFieldFree(message->fields[i]);
-  free(message->fields);
+  if(message->arena == NULL) // The fields of an arena message are freed all at once with the arena
+  {
+    for(i = 0; i < message->n_fields; i++)
+      cRosMessageFieldFree(message->fields[i]);
+    free(message->fields);
+  }
   message->fields = NULL;
   message->n_fields = 0;
+  message->fixed_size = 0;
+  cRosMessageBufferUnref(message->borrowed_buffer);
+  message->borrowed_buffer = NULL;
 }
 
 void cRosMessageRelease(cRosMessage *message)
 {
   cRosMessageFieldsFree(message);
 
-  cRosMessageDefFree(message->msgDef);
+  if(message->arena == NULL) // The arena messages do not own their definition
+    cRosMessageDefFree(message->msgDef);
   message->msgDef = NULL;
 
-  free(message->md5sum);
+  msgFree(message->arena, message->md5sum);
   message->md5sum = NULL;
 }
 
@@ -2073,22 +2636,20 @@ void cRosMessageFree(cRosMessage *message)
     return;
 
   cRosMessageRelease(message);
-  free(message);
+  msgFree(message->arena, message);
 }
 
 cRosMessageField * cRosMessageFieldNew(void)
 {
-  cRosMessageField *ret = (cRosMessageField *)calloc(1, sizeof(cRosMessageField));
-  cRosMessageFieldInit(ret);
-  return ret;
+  return newField(NULL);
 }
 
 void cRosMessageFieldRelease(cRosMessageField *field)
 {
-  free(field->name);
+  msgFree(field->arena, field->name);
   field->name = NULL;
 
-  free(field->type_s);
+  msgFree(field->arena, field->type_s);
   field->type_s = NULL;
 
   if(field->is_array)
@@ -2097,8 +2658,10 @@ void cRosMessageFieldRelease(cRosMessageField *field)
     field->type != CROS_STD_MSGS_TIME && field->type != CROS_STD_MSGS_DURATION &&
     field->type != CROS_STD_MSGS_HEADER)
     {
-      free(field->data.as_array);
+      if(!field->is_borrowed)
+        msgFree(field->arena, field->data.as_array);
       field->data.as_array = NULL;
+      field->is_borrowed = 0;
     }
     else
     {
@@ -2106,21 +2669,21 @@ void cRosMessageFieldRelease(cRosMessageField *field)
         for(elem_ind = 0; elem_ind < field->array_size; elem_ind++)
         {
           if(field->type == CROS_STD_MSGS_STRING)
-            free(field->data.as_string_array[elem_ind]);
+            freeString(field, elem_ind);
           else
             cRosMessageFree(field->data.as_msg_array[elem_ind]);
         }
-        free(field->data.as_array);
+        msgFree(field->arena, field->data.as_array);
         field->data.as_array = NULL;
+        msgFree(field->arena, field->string_infos);
+        field->string_infos = NULL;
+        field->string_infos_capacity = 0;
     }
   }
   else
   {
     if(field->type == CROS_STD_MSGS_STRING)
-    {
-      free(field->data.as_string);
-      field->data.as_string=NULL;
-    }
+      freeString(field, 0);
     else if(field->type == CROS_CUSTOM_TYPE || field->type == CROS_STD_MSGS_TIME ||
             field->type == CROS_STD_MSGS_DURATION || field->type == CROS_STD_MSGS_HEADER)
     {
@@ -2136,7 +2699,7 @@ void cRosMessageFieldFree(cRosMessageField *field)
     return;
 
   cRosMessageFieldRelease(field);
-  free(field);
+  msgFree(field->arena, field);
 }
 
 cRosMessageField* cRosMessageGetField(cRosMessage *message, char *field_name)
@@ -2157,6 +2720,72 @@ cRosMessageField* cRosMessageGetField(cRosMessage *message, char *field_name)
   return matching_field;
 }
 
+// Check if a field contains a single nested message, so that a field handle can go through it
+static int isNestedMsgField(cRosMessageField *field)
+{
+  return(!field->is_array && field->data.as_msg != NULL &&
+         (field->type == CROS_CUSTOM_TYPE || field->type == CROS_STD_MSGS_TIME ||
+          field->type == CROS_STD_MSGS_DURATION || field->type == CROS_STD_MSGS_HEADER));
+}
+
+int cRosMessageFieldHandleResolve(cRosMessage *message, const char *field_path, cRosMessageFieldHandle *handle)
+{
+  const char *name_start = field_path;
+
+  handle->depth = 0;
+  while(message != NULL && handle->depth < CROS_FIELD_HANDLE_MAX_DEPTH)
+  {
+    const char *name_end = strchr(name_start, '.');
+    size_t name_len = (name_end != NULL)? (size_t)(name_end - name_start) : strlen(name_start);
+    cRosMessageField *field = NULL;
+    int i;
+
+    for(i = 0; i < message->n_fields; i++)
+    {
+      if(strncmp(message->fields[i]->name, name_start, name_len) == 0 && message->fields[i]->name[name_len] == '\0')
+      {
+        field = message->fields[i];
+        break;
+      }
+    }
+    if(field == NULL)
+      break;
+
+    handle->indices[handle->depth++] = i;
+    if(name_end == NULL)
+      return 0;
+
+    if(!isNestedMsgField(field))
+      break;
+    message = field->data.as_msg;
+    name_start = name_end + 1;
+  }
+
+  handle->depth = 0;
+  return -1;
+}
+
+cRosMessageField* cRosMessageGetFieldByHandle(cRosMessage *message, const cRosMessageFieldHandle *handle)
+{
+  cRosMessageField *field = NULL;
+  int level;
+
+  for(level = 0; level < handle->depth; level++)
+  {
+    if(level > 0)
+    {
+      if(!isNestedMsgField(field))
+        return NULL;
+      message = field->data.as_msg;
+    }
+    if(handle->indices[level] >= message->n_fields)
+      return NULL;
+    field = message->fields[handle->indices[level]];
+  }
+
+  return field;
+}
+
 int cRosMessageSetFieldValueString(cRosMessageField* field, const char* value)
 {
   int ret;
@@ -2164,10 +2793,8 @@ int cRosMessageSetFieldValueString(cRosMessageField* field, const char* value)
     return -1;
 
   size_t str_len = strlen(value);
-  field->data.as_string = (char *)realloc(field->data.as_string, sizeof(char)*(str_len+1));
-  if(field->data.as_string != NULL)
+  if(setString(field, 0, value, (uint32_t)str_len) == 0)
   {
-    strcpy(field->data.as_string,value);
     field->size = (int)str_len;
     ret=0; // Success
   }
@@ -2176,18 +2803,37 @@ int cRosMessageSetFieldValueString(cRosMessageField* field, const char* value)
   return ret;
 }
 
+// Copy the elements of a borrowed array field to memory owned by the field
+static int ownArrayField(cRosMessageField *field, size_t element_size)
+{
+  void *owned_array;
+
+  owned_array = msgMalloc(field->arena, (field->array_size > 0)? field->array_size * element_size : element_size);
+  if(owned_array == NULL)
+    return -1;
+
+  memcpy(owned_array, field->data.as_array, field->array_size * element_size);
+  field->data.as_array = owned_array;
+  field->array_capacity = (field->array_size > 0)? field->array_size : 1;
+  field->is_borrowed = 0;
+  return 0;
+}
+
 int arrayFieldValuesPushBack(cRosMessageField *field, const void* data, int element_size, int n_new_elements)
 {
   if(field == NULL || !field->is_array || field->is_fixed_array)
     return -1;
 
+  if(field->is_borrowed && ownArrayField(field, element_size) != 0)
+    return -1;
+
   if(field->array_capacity < field->array_size + n_new_elements)
   {
     void* new_location;
     size_t new_arr_cap;
 
     new_arr_cap = (field->array_size + n_new_elements) * 3 / 2;
-    new_location = realloc(field->data.as_array, new_arr_cap * element_size); // If field->data.as_array is NULL, realloc() behaves as malloc()
+    new_location = msgRealloc(field->arena, field->data.as_array, new_arr_cap * element_size); // If field->data.as_array is NULL, realloc() behaves as malloc()
     if(new_location != NULL)
     {
       field->data.as_array = new_location;
@@ -2301,11 +2947,12 @@ int cRosMessageFieldArrayPushBackString(cRosMessageField *field, const char* val
   if(field->array_capacity == field->array_size)
   {
     char** new_location;
-    new_location = (char **)realloc(field->data.as_string_array, 2 * field->array_capacity * sizeof(char*));
+    int new_arr_cap = (field->array_capacity > 0)? 2 * field->array_capacity : 1;
+    new_location = (char **)msgRealloc(field->arena, field->data.as_string_array, new_arr_cap * sizeof(char*));
     if(new_location != NULL)
     {
       field->data.as_string_array = new_location;
-      field->array_capacity *= 2;
+      field->array_capacity = new_arr_cap;
     }
     else
     {
@@ -2313,23 +2960,12 @@ int cRosMessageFieldArrayPushBackString(cRosMessageField *field, const char* val
     }
   }
   int ret;
-  char* element_val;
   ret=0;
+  field->data.as_string_array[field->array_size] = NULL; // The slot may keep a string freed when the array was shrunk
   if(val != NULL)
-  {
-    element_val = (char*)calloc(strlen(val) + sizeof(char), 1);
-    if(element_val != NULL)
-      strcpy(element_val, val);
-    else
-      ret=-1;
-  }
-  else
-    element_val = NULL;
+    ret = setString(field, field->array_size, val, (uint32_t)strlen(val));
   if(ret == 0)
-  {
-    field->data.as_string_array[field->array_size] = element_val;
     field->array_size ++;
-  }
   return ret;
 }
 
@@ -2350,14 +2986,18 @@ int cRosMessageFieldArrayPushBackZero(cRosMessage* msg, int n_field)
 
   elem_type = field->type;
   elem_size = getMessageTypeSizeOf(elem_type);
-  if(field->array_capacity == field->array_size)
+  if(field->is_borrowed && ownArrayField(field, elem_size) != 0)
+    return -1;
+
+  if(field->array_capacity <= field->array_size)
   {
     void *new_location;
-    new_location = realloc(field->data.as_array, 2 * field->array_capacity * elem_size);
+    int new_arr_cap = (field->array_capacity > 0)? 2 * field->array_capacity : 1;
+    new_location = msgRealloc(field->arena, field->data.as_array, new_arr_cap * elem_size);
     if(new_location != NULL)
     {
       field->data.as_array = new_location;
-      field->array_capacity *= 2;
+      field->array_capacity = new_arr_cap;
     }
     else
     {
@@ -2407,7 +3047,7 @@ int cRosMessageFieldArrayPushBackZero(cRosMessage* msg, int n_field)
           return -1; // msg definition not found
 
         msg_array = field->data.as_msg_array;
-        ret_err = cRosMessageBuildFromDef(&msg_array[field->array_size], field_def_itr->child_msg_def); // instead of cRosMessageNewBuild(msg->msgDef->root_dir, field->type_s, &msg_array[field->array_size]);
+        ret_err = buildFromDef(&msg_array[field->array_size], field_def_itr->child_msg_def, field->arena); // instead of cRosMessageNewBuild(msg->msgDef->root_dir, field->type_s, &msg_array[field->array_size]);
         if(ret_err != CROS_SUCCESS_ERR_PACK)
           return -1; // Error creating the message
       }
@@ -2434,7 +3074,7 @@ int cRosMessageFieldArrayPushBackMsg(cRosMessageField *field, cRosMessage* msg)
   if(field->array_capacity == field->array_size)
   {
     cRosMessage **new_location;
-    new_location = (cRosMessage **)realloc(field->data.as_msg_array, 2 * field->array_capacity * sizeof(cRosMessage*));
+    new_location = (cRosMessage **)msgRealloc(field->arena, field->data.as_msg_array, 2 * field->array_capacity * sizeof(cRosMessage*));
     if(new_location != NULL)
     {
       field->data.as_msg_array = new_location;
@@ -2591,26 +3231,14 @@ int cRosMessageFieldArrayAtStringSet(cRosMessageField *field, int position, cons
   if(field->type != CROS_STD_MSGS_STRING || !field->is_array)
     return -1;
 
-  char *current = field->data.as_string_array[position];
   ret = 0; // Default return value: success
   if(val != NULL)
   {
-    current = (char *)realloc(current, strlen(val) + sizeof(char)); // Realloc buffer for the string
-    if(current != NULL)
-      strcpy(current, val);
-    else
+    if(setString(field, position, val, (uint32_t)strlen(val)) != 0) // Reuse the buffer of the string if it is large enough
       ret=-1;
   }
   else
-  {
-    if(current != NULL)
-    {
-      free(current);
-      current = NULL;
-    }
-  }
-
-  field->data.as_string_array[position] = current;
+    freeString(field, position);
 
   return ret;
 }
@@ -2627,7 +3255,7 @@ int cRosMessageFieldArrayClear(cRosMessageField *field)
     {
       case CROS_STD_MSGS_STRING:
       {
-        free(field->data.as_string_array[n_elem]);
+        freeString(field, n_elem);
         break;
       }
       case CROS_STD_MSGS_TIME:
@@ -2643,6 +3271,12 @@ int cRosMessageFieldArrayClear(cRosMessageField *field)
     }
   }
 
+  if(field->is_borrowed) // Forget the borrowed elements: the next ones pushed back are stored in memory of the field
+  {
+    field->data.as_array = NULL;
+    field->array_capacity = 0;
+    field->is_borrowed = 0;
+  }
   field->array_size = 0;
 
   return 0;
@@ -2661,49 +3295,82 @@ void * arrayFieldValueAt(cRosMessageField *field, int position, size_t size)
 
 size_t cRosMessageFieldSize(cRosMessageField* field)
 {
-  size_t single_size = 0;
+  size_t ret = 0;
+  int elem_ind;
 
-  if (isBuiltinMessageType(field->type))
-  {
-    single_size = field->size;
-  }
-  else
-  {
-    single_size = cRosMessageSize(field->data.as_msg);
-  }
+  if(field->is_array && !field->is_fixed_array)
+    ret += sizeof(uint32_t); // Number of elements
 
-  size_t ret = 0;
-  if(field->is_array)
+  switch (field->type)
   {
-    ret = single_size * field->array_size;
-  }
-  else
-  {
-    ret = single_size;
+    case CROS_STD_MSGS_STRING:
+    {
+      if(field->is_array)
+      {
+        for(elem_ind = 0; elem_ind < field->array_size; elem_ind++)
+          ret += sizeof(uint32_t) + getStringLength(field, elem_ind);
+      }
+      else
+        ret += sizeof(uint32_t) + getStringLength(field, 0);
+      break;
+    }
+    case CROS_STD_MSGS_TIME:
+    case CROS_STD_MSGS_DURATION:
+    case CROS_STD_MSGS_HEADER:
+    case CROS_CUSTOM_TYPE:
+    {
+      if(field->is_array)
+      {
+        for(elem_ind = 0; elem_ind < field->array_size; elem_ind++)
+        {
+          cRosMessage *arr_elem_msg = cRosMessageFieldArrayAtMsgGet(field, elem_ind);
+          if(arr_elem_msg != NULL)
+            ret += cRosMessageSize(arr_elem_msg);
+        }
+      }
+      else if(field->data.as_msg != NULL)
+        ret += cRosMessageSize(field->data.as_msg);
+      break;
+    }
+    default:
+    {
+      size_t elem_size = getMessageTypeSizeOf(field->type);
+      ret += (field->is_array)? elem_size * field->array_size : elem_size;
+      break;
+    }
   }
   return ret;
 }
 
 size_t cRosMessageSize(cRosMessage* message)
 {
-    size_t ret = 0;
-    cRosMessageField** fields_it = message->fields;
-    int i;
-    for( i = 0; i < message->n_fields; i++)
-    {
-      cRosMessageField* field = *fields_it;
-      ret += cRosMessageFieldSize(field);
-      fields_it++;
-    }
+  size_t ret = 0;
+  int i;
+
+  if(message->fixed_size > 0)
+    return message->fixed_size;
+
+  for( i = 0; i < message->n_fields; i++)
+    ret += cRosMessageFieldSize(message->fields[i]);
 
-    return ret;// + sizeof(uint32_t);
+  return ret;
 }
 
-cRosErrCodePack cRosMessageSerialize(cRosMessage *message, DynBuffer* buffer)
+static cRosErrCodePack serializeFields(cRosMessage *message, DynBuffer* buffer)
 {
   cRosErrCodePack ret_err;
   size_t it;
 
+  if(message->fixed_size > 0)
+  {
+    // POD message: a single reservation for the whole message
+    if(dynBufferReserve(buffer, message->fixed_size) < 0)
+      return CROS_MEM_ALLOC_ERR;
+    packFixedFields(message, dynBufferGetTailData(buffer));
+    dynBufferExtendSize(buffer, message->fixed_size);
+    return CROS_SUCCESS_ERR_PACK;
+  }
+
   ret_err = CROS_SUCCESS_ERR_PACK; // default error value: success
   for (it = 0; it < message->n_fields && ret_err == CROS_SUCCESS_ERR_PACK; it++)
   {
@@ -2748,13 +3415,13 @@ cRosErrCodePack cRosMessageSerialize(cRosMessage *message, DynBuffer* buffer)
             cRosMessage *arr_elem_msg;
             arr_elem_msg = cRosMessageFieldArrayAtMsgGet(field, elem_ind);
             if(arr_elem_msg != NULL)
-              ret_err = cRosMessageSerialize(arr_elem_msg, buffer);
+              ret_err = serializeFields(arr_elem_msg, buffer);
           }
         }
         else
         {
           if(field->data.as_msg != NULL)
-            ret_err = cRosMessageSerialize(field->data.as_msg, buffer);
+            ret_err = serializeFields(field->data.as_msg, buffer);
         }
         break;
       }
@@ -2766,12 +3433,9 @@ cRosErrCodePack cRosMessageSerialize(cRosMessage *message, DynBuffer* buffer)
           for(elem_ind = 0; elem_ind < field->array_size && ret_err == CROS_SUCCESS_ERR_PACK; elem_ind++)
           {
             const char* arr_elem_str;
-            size_t arr_elem_str_len;
+            uint32_t arr_elem_str_len;
             arr_elem_str = cRosMessageFieldArrayAtStringGet(field, elem_ind);
-            if(arr_elem_str != NULL)
-              arr_elem_str_len = strlen(arr_elem_str);
-            else
-              arr_elem_str_len = 0;
+            arr_elem_str_len = getStringLength(field, elem_ind);
             dynBufferPushBackInt32(buffer, arr_elem_str_len);
             ret_err = (dynBufferPushBackBuf(buffer, (unsigned char *)arr_elem_str, arr_elem_str_len) >= 0)?CROS_SUCCESS_ERR_PACK:CROS_MEM_ALLOC_ERR;
           }
@@ -2780,7 +3444,7 @@ cRosErrCodePack cRosMessageSerialize(cRosMessage *message, DynBuffer* buffer)
         {
           if(field->data.as_string != NULL)
           {
-            size_t str_len = strlen(field->data.as_string);
+            uint32_t str_len = getStringLength(field, 0);
             dynBufferPushBackInt32(buffer, str_len);
             ret_err = (dynBufferPushBackBuf(buffer,(unsigned char*)field->data.as_string, str_len) >= 0)?CROS_SUCCESS_ERR_PACK:CROS_MEM_ALLOC_ERR;
           }
@@ -2799,16 +3463,113 @@ cRosErrCodePack cRosMessageSerialize(cRosMessage *message, DynBuffer* buffer)
   return ret_err;
 }
 
+cRosErrCodePack cRosMessageSerialize(cRosMessage *message, DynBuffer* buffer)
+{
+  // Reserve the whole encoded message at once, so that the buffer is not reallocated while the fields are appended
+  if(dynBufferReserve(buffer, cRosMessageSize(message)) < 0)
+    return CROS_MEM_ALLOC_ERR;
+
+  return serializeFields(message, buffer);
+}
+
+static cRosMessageDef *getNestedMsgDef(msgFieldDef *field_def, cRosMessage *nested_msg)
+{
+  return (field_def != NULL && field_def->child_msg_def != NULL)? field_def->child_msg_def : nested_msg->msgDef;
+}
+
+// Make a variable-length array field point to n_elems elements in the received packet, instead of copying them
+static void borrowArrayField(cRosMessageField *field, const unsigned char *elems, uint32_t n_elems)
+{
+  if(!field->is_borrowed)
+    msgFree(field->arena, field->data.as_array);
+
+  field->data.as_array = (void *)elems;
+  field->array_size = (int)n_elems;
+  field->array_capacity = (int)n_elems;
+  field->is_borrowed = 1;
+}
+
+// Set the number of elements of a variable-length array of messages. The remaining messages are kept to be
+// overwritten and the new ones are built from field_def, the definition of the field (if available)
+static cRosErrCodePack resizeMsgArrayField(cRosMessageField *field, msgFieldDef *field_def, uint32_t n_elems)
+{
+  cRosErrCodePack ret_err = CROS_SUCCESS_ERR_PACK;
+
+  while((uint32_t)field->array_size < n_elems && ret_err == CROS_SUCCESS_ERR_PACK) // received more elements than the available messages: create more
+  {
+    cRosMessage *new_msg;
+    new_msg = NULL;
+    if(field->type == CROS_STD_MSGS_TIME)
+      new_msg = build_time_field(field->arena);
+    else if(field->type == CROS_STD_MSGS_DURATION)
+      new_msg = build_duration_field(field->arena);
+    else if(field->type == CROS_STD_MSGS_HEADER)
+      new_msg = build_header_field(field->arena);
+    else if(field->type == CROS_CUSTOM_TYPE)
+    {
+      if(field_def != NULL)
+        ret_err = buildFromDef(&new_msg, field_def->child_msg_def, field->arena); // instead of cRosMessageNewBuild(message->msgDef->root_dir, field->type_s, &new_msg);
+      else
+        ret_err =CROS_DEPACK_NO_MSG_DEF_ERR;
+    }
+
+    if(new_msg != NULL)
+      cRosMessageFieldArrayPushBackMsg(field, new_msg); // new_msg is now used in the array so it cannot be freed independently
+    else
+    {
+      if(ret_err == CROS_SUCCESS_ERR_PACK)
+        ret_err=CROS_MEM_ALLOC_ERR;
+    }
+  }
+
+  while((uint32_t)field->array_size > n_elems) // received less elements than the available messages: delete
+    cRosMessageFree(cRosMessageFieldArrayRemoveLastMsg(field));
+
+  return ret_err;
+}
+
+// Decode a string from the current position of a buffer into a string value of a field, reusing its memory if it is
+// large enough
+static cRosErrCodePack deserializeString(cRosMessageField *field, int elem_ind, DynBuffer *buffer)
+{
+  uint32_t str_len;
+
+  if(dynBufferGetCurrentContent( (unsigned char *)&str_len, buffer, sizeof(uint32_t) ) < 0)
+    return CROS_MEM_ALLOC_ERR;
+  dynBufferMovePoseIndicator(buffer, sizeof(uint32_t));
+  if((uint32_t)dynBufferGetRemainingDataSize(buffer) < str_len)
+    return CROS_DEPACK_INSUFF_DAT_ERR;
+
+  if(setString(field, elem_ind, (const char *)dynBufferGetCurrentData(buffer), str_len) != 0)
+    return CROS_MEM_ALLOC_ERR;
+  dynBufferMovePoseIndicator(buffer, str_len);
+  return CROS_SUCCESS_ERR_PACK;
+}
+
 // In this function we assume that the message is already build according to its definition.
-// Only when receiving a variable-length array, new elements if the message field may need to be created
-cRosErrCodePack cRosMessageDeserialize(cRosMessage *message, DynBuffer* buffer)
+// Only when receiving a variable-length array, new elements if the message field may need to be created from msg_def,
+// which is the definition of the message or, for nested messages, the one found in the definition of their parent
+// (the nested messages moved between queued messages do not keep their own definition, see cRosMessageCopyWithoutDef()).
+// If n_borrowed is not NULL, the variable-length arrays of primitive values whose elements are aligned in the buffer
+// are borrowed from it instead of copied, and n_borrowed is incremented for each of them
+static cRosErrCodePack deserializeFields(cRosMessage *message, cRosMessageDef *msg_def, DynBuffer* buffer, int *n_borrowed)
 {
   size_t it;
   cRosErrCodePack ret_err;
 
+  if(message->fixed_size > 0)
+  {
+    // POD message: a single check of the available data for the whole message
+    if((size_t)dynBufferGetRemainingDataSize(buffer) < message->fixed_size)
+      return CROS_DEPACK_INSUFF_DAT_ERR;
+    unpackFixedFields(message, dynBufferGetCurrentData(buffer));
+    dynBufferMovePoseIndicator(buffer, message->fixed_size);
+    return CROS_SUCCESS_ERR_PACK;
+  }
+
   ret_err = CROS_SUCCESS_ERR_PACK; // default error value: no error
 
-  msgFieldDef* field_def_itr =  (message->msgDef != NULL)? message->msgDef->first_field : NULL; // Keep track of the message definition (if available) corresponding to the current message field in case we need to build a msg of type custom
+  msgFieldDef* field_def_itr =  (msg_def != NULL)? msg_def->first_field : NULL; // Keep track of the message definition (if available) corresponding to the current message field in case we need to build a msg of type custom
 
   for (it = 0; it < message->n_fields && ret_err == CROS_SUCCESS_ERR_PACK; it++)
   {
@@ -2848,7 +3609,14 @@ cRosErrCodePack cRosMessageDeserialize(cRosMessage *message, DynBuffer* buffer)
             {
               if(dynBufferGetRemainingDataSize(buffer) >= array_n_elems*elem_size)
               {
-                ret_err = (arrayFieldValuesPushBack(field, (const void *)dynBufferGetCurrentData(buffer), elem_size, array_n_elems) >= 0)?CROS_SUCCESS_ERR_PACK:CROS_MEM_ALLOC_ERR;
+                const unsigned char *elems = dynBufferGetCurrentData(buffer);
+                if(n_borrowed != NULL && (uintptr_t)elems % elem_size == 0)
+                {
+                  borrowArrayField(field, elems, array_n_elems);
+                  (*n_borrowed)++;
+                }
+                else
+                  ret_err = (arrayFieldValuesPushBack(field, (const void *)elems, elem_size, array_n_elems) >= 0)?CROS_SUCCESS_ERR_PACK:CROS_MEM_ALLOC_ERR;
                 dynBufferMovePoseIndicator(buffer, array_n_elems*elem_size);
               }
               else
@@ -2873,49 +3641,26 @@ cRosErrCodePack cRosMessageDeserialize(cRosMessage *message, DynBuffer* buffer)
             curr_array_size = field->array_size;
           else // Otherwise, obtain the number of elements of the received array
           {
-            cRosMessageFieldArrayClear(field); // Remove previous strings from the array to start added the new ones one by one
             ret_err = (dynBufferGetCurrentContent( (unsigned char *)&curr_array_size, buffer, sizeof(uint32_t) ) >= 0)?CROS_SUCCESS_ERR_PACK:CROS_MEM_ALLOC_ERR; // equiv. to: curr_array_size = *((uint32_t*)dynBufferGetCurrentData(buffer));
             dynBufferMovePoseIndicator(buffer, sizeof(uint32_t));
-          }
-
-          uint32_t elem_ind;
-          for(elem_ind = 0; elem_ind < curr_array_size && ret_err == CROS_SUCCESS_ERR_PACK; elem_ind++)
-          {
-            uint32_t element_size;
-            ret_err = (dynBufferGetCurrentContent( (unsigned char *)&element_size, buffer, sizeof(uint32_t) ) >= 0)?CROS_SUCCESS_ERR_PACK:CROS_MEM_ALLOC_ERR; // equiv. to: element_size = *((uint32_t*)dynBufferGetCurrentData(buffer));
-            dynBufferMovePoseIndicator(buffer, sizeof(uint32_t));
             if(ret_err == CROS_SUCCESS_ERR_PACK)
             {
-              char* tmp_string = (char *)calloc(element_size + 1, sizeof(char));
-              if(tmp_string != NULL)
-              {
-                ret_err = (dynBufferGetCurrentContent( (unsigned char *)tmp_string, buffer, element_size ) >= 0)?CROS_SUCCESS_ERR_PACK:CROS_MEM_ALLOC_ERR; // equiv. to: memcpy(tmp_string, dynBufferGetCurrentData(buffer), element_size);
-                if(field->is_fixed_array)
-                  ret_err = (cRosMessageFieldArrayAtStringSet(field, elem_ind, tmp_string) >= 0)?CROS_SUCCESS_ERR_PACK:CROS_MEM_ALLOC_ERR;
-                else
-                  ret_err = (cRosMessageFieldArrayPushBackString(field, tmp_string) >= 0)?CROS_SUCCESS_ERR_PACK:CROS_MEM_ALLOC_ERR;
-                dynBufferMovePoseIndicator(buffer, element_size);
-                free(tmp_string);
-              }
-              else
-                ret_err=CROS_MEM_ALLOC_ERR;
+              // The previous strings of the array are overwritten by the received ones, reusing their memory
+              if(curr_array_size > (uint32_t)dynBufferGetRemainingDataSize(buffer) / sizeof(uint32_t))
+                ret_err = CROS_DEPACK_INSUFF_DAT_ERR; // Not enough data for the lengths of the strings
+              else if(resizeStringArrayField(field, (int)curr_array_size) != 0)
+                ret_err = CROS_MEM_ALLOC_ERR;
             }
           }
+
+          uint32_t elem_ind;
+          for(elem_ind = 0; elem_ind < curr_array_size && ret_err == CROS_SUCCESS_ERR_PACK; elem_ind++)
+            ret_err = deserializeString(field, (int)elem_ind, buffer);
         }
         else
         {
-          uint32_t curr_data_size;
-          ret_err = (dynBufferGetCurrentContent( (unsigned char *)&curr_data_size, buffer, sizeof(uint32_t) ) >= 0)?CROS_SUCCESS_ERR_PACK:CROS_MEM_ALLOC_ERR; // equiv. to: curr_data_size = *((uint32_t*)dynBufferGetCurrentData(buffer));
-          dynBufferMovePoseIndicator(buffer, sizeof(uint32_t));
-          field->data.as_string = (char*)realloc(field->data.as_string, (curr_data_size + 1) * sizeof(char)); // If field->data.as_string was NULL previously, realloc behaves as malloc
-          if(field->data.as_string != NULL)
-          {
-            dynBufferGetCurrentContent( (unsigned char *)field->data.as_string, buffer, curr_data_size ); // equiv. to: memcpy(field->data.as_string, dynBufferGetCurrentData(buffer), curr_data_size);
-            field->data.as_string[curr_data_size] = '\0';
-            dynBufferMovePoseIndicator(buffer, curr_data_size);
-          }
-          else
-            ret_err=CROS_MEM_ALLOC_ERR;
+          ret_err = deserializeString(field, 0, buffer);
+          field->size = (int)getStringLength(field, 0);
         }
         break;
       }
@@ -2937,46 +3682,19 @@ cRosErrCodePack cRosMessageDeserialize(cRosMessage *message, DynBuffer* buffer)
             dynBufferMovePoseIndicator(buffer, sizeof(uint32_t));
 
             // Adapt the array size of the message field to the received array length
-            for(msg_ind = field->array_size;msg_ind < received_arr_siz && ret_err == CROS_SUCCESS_ERR_PACK;msg_ind++) // received more elements than the available messages: create more
-            {
-              cRosMessage *new_msg;
-              new_msg = NULL;
-              if(field->type == CROS_STD_MSGS_TIME)
-                new_msg = build_time_field();
-              else if(field->type == CROS_STD_MSGS_DURATION)
-                new_msg = build_duration_field();
-              else if(field->type == CROS_STD_MSGS_HEADER)
-                new_msg = build_header_field();
-              else if(field->type == CROS_CUSTOM_TYPE)
-              {
-                if(field_def_itr != NULL)
-                  ret_err = cRosMessageBuildFromDef(&new_msg, field_def_itr->child_msg_def); // instead of cRosMessageNewBuild(message->msgDef->root_dir, field->type_s, &new_msg);
-                else
-                  ret_err =CROS_DEPACK_NO_MSG_DEF_ERR;
-              }
-
-              if(new_msg != NULL)
-                cRosMessageFieldArrayPushBackMsg(field, new_msg); // new_msg is now used in the array so it cannot be freed independently
-              else
-              {
-                if(ret_err == CROS_SUCCESS_ERR_PACK)
-                  ret_err=CROS_MEM_ALLOC_ERR;
-              }
-            }
-
-            while(field->array_size > received_arr_siz) // received less elements than the available messages: delete
-              cRosMessageFree(cRosMessageFieldArrayRemoveLastMsg(field));
+            if(ret_err == CROS_SUCCESS_ERR_PACK)
+              ret_err = resizeMsgArrayField(field, field_def_itr, received_arr_siz);
           }
 
           for(msg_ind = 0;msg_ind < field->array_size && ret_err == CROS_SUCCESS_ERR_PACK;msg_ind++)
           {
             cRosMessage *curr_msg;
             curr_msg = cRosMessageFieldArrayAtMsgGet(field, msg_ind);
-            ret_err = cRosMessageDeserialize(curr_msg, buffer);
+            ret_err = deserializeFields(curr_msg, getNestedMsgDef(field_def_itr, curr_msg), buffer, n_borrowed);
           }
         }
         else
-          ret_err = cRosMessageDeserialize(field->data.as_msg, buffer);
+          ret_err = deserializeFields(field->data.as_msg, getNestedMsgDef(field_def_itr, field->data.as_msg), buffer, n_borrowed);
         break;
       }
       default:
@@ -2990,6 +3708,447 @@ cRosErrCodePack cRosMessageDeserialize(cRosMessage *message, DynBuffer* buffer)
   return ret_err;
 }
 
+cRosErrCodePack cRosMessageDeserialize(cRosMessage *message, DynBuffer* buffer)
+{
+  cRosErrCodePack ret_err;
+
+  ret_err = deserializeFields(message, message->msgDef, buffer, NULL);
+  if(ret_err == CROS_SUCCESS_ERR_PACK)
+  {
+    // All the variable-length arrays have been replaced by copies, so the message does not borrow a buffer anymore
+    cRosMessageBufferUnref(message->borrowed_buffer);
+    message->borrowed_buffer = NULL;
+  }
+  return ret_err;
+}
+
+// Empty the borrowed array fields of a message and of its nested messages
+static void dropBorrowedArrays(cRosMessage *message)
+{
+  int field_ind, elem_ind;
+
+  for(field_ind = 0; field_ind < message->n_fields; field_ind++)
+  {
+    cRosMessageField *field = message->fields[field_ind];
+
+    if(field->is_borrowed)
+      cRosMessageFieldArrayClear(field);
+    else if(isMessageFieldType(field->type))
+    {
+      if(!field->is_array)
+        dropBorrowedArrays(field->data.as_msg);
+      else
+        for(elem_ind = 0; elem_ind < field->array_size; elem_ind++)
+          dropBorrowedArrays(field->data.as_msg_array[elem_ind]);
+    }
+  }
+}
+
+cRosErrCodePack cRosMessageDeserializeBorrow(cRosMessage *message, cRosMessageBuffer *msg_buf)
+{
+  cRosErrCodePack ret_err;
+  cRosMessageBuffer *prev_buffer;
+  int n_borrowed = 0;
+
+  if(message->arena != NULL) // The reference to the buffer would not be released when the arena is reset
+    return cRosMessageDeserialize(message, &msg_buf->packet);
+
+  // The fields that still point into the previous buffer are replaced while decoding, so it is released at the end
+  prev_buffer = message->borrowed_buffer;
+  message->borrowed_buffer = NULL;
+
+  ret_err = deserializeFields(message, message->msgDef, &msg_buf->packet, &n_borrowed);
+  if(ret_err != CROS_SUCCESS_ERR_PACK)
+  {
+    // Some fields may not have been replaced: none of them can be kept pointing into a buffer
+    dropBorrowedArrays(message);
+    n_borrowed = 0;
+  }
+
+  if(n_borrowed > 0)
+    message->borrowed_buffer = cRosMessageBufferRef(msg_buf);
+  cRosMessageBufferUnref(prev_buffer);
+
+  return ret_err;
+}
+
+cRosMessageBuffer *cRosMessageBufferNew(DynBuffer *packet)
+{
+  cRosMessageBuffer *msg_buf = (cRosMessageBuffer *)malloc(sizeof(cRosMessageBuffer));
+  if(msg_buf == NULL)
+    return NULL;
+
+  msg_buf->packet = *packet;
+  msg_buf->ref_count = 1;
+  dynBufferInit(packet);
+  return msg_buf;
+}
+
+cRosMessageBuffer *cRosMessageBufferRef(cRosMessageBuffer *msg_buf)
+{
+  __atomic_add_fetch(&msg_buf->ref_count, 1, __ATOMIC_RELAXED);
+  return msg_buf;
+}
+
+void cRosMessageBufferUnref(cRosMessageBuffer *msg_buf)
+{
+  if(msg_buf == NULL)
+    return;
+
+  // The messages that borrow the buffer may be released by different threads (e.g., the workers of a threaded node)
+  if(__atomic_sub_fetch(&msg_buf->ref_count, 1, __ATOMIC_ACQ_REL) == 0)
+  {
+    dynBufferRelease(&msg_buf->packet);
+    free(msg_buf);
+  }
+}
+
+// Next step of the decoding of the current field of a decoder frame
+typedef enum DecoderStep
+{
+  DECODER_STEP_FIELD_START,             // Start decoding the field
+  DECODER_STEP_FIELD_END,               // The value of the field has been received: go to the next field
+  DECODER_STEP_ARRAY_LENGTH,            // The number of elements of a variable-length array has been received
+  DECODER_STEP_STRING_ELEM,             // Start decoding the next element of an array of strings
+  DECODER_STEP_STRING_LENGTH,           // The length of a string has been received
+  DECODER_STEP_STRING_END,              // The characters of a string have been received
+  DECODER_STEP_MSG_ELEM                 // Start decoding the next element of an array of messages
+} DecoderStep;
+
+// A message (the root one or a nested one) whose fields are being decoded
+typedef struct DecoderFrame
+{
+  cRosMessage *message;
+  msgFieldDef *field_def;               // Definition of the current field (if available) to build new nested messages
+  int field_ind;                        // Index of the current field
+  uint32_t elem_ind;                    // Index of the next element of the current array field
+  uint32_t n_elems;                     // Number of elements of the current array field
+  DecoderStep step;
+} DecoderFrame;
+
+typedef enum DecoderState
+{
+  DECODER_STATE_IDLE,
+  DECODER_STATE_DECODING,
+  DECODER_STATE_DONE,                   // All the fields have been decoded: waiting for cRosMessageDecoderFinish()
+  DECODER_STATE_ERROR
+} DecoderState;
+
+struct cRosMessageDecoder
+{
+  cRosMessage *message;                 // Message filled by the decoder
+  DecoderFrame *frames;                 // Stack of the messages being decoded: the last one is the innermost
+  int n_frames;
+  int frames_capacity;
+  unsigned char *dest;                  // Where the next received bytes are copied
+  size_t left;                          // Number of bytes still to be copied to dest
+  size_t remaining;                     // Number of bytes of the encoded message that have not been requested yet
+  uint32_t length;                      // Last length (of an array or string) received
+  int string_ind;                        // Element of the current array of strings being received (0 for a string field)
+  DecoderState state;
+  cRosErrCodePack error;                // Error that stopped the decoding (if state is DECODER_STATE_ERROR)
+};
+
+// Request the next n_bytes bytes of the encoded message to be copied to dest
+static cRosErrCodePack decoderRead(cRosMessageDecoder *decoder, void *dest, size_t n_bytes)
+{
+  if(n_bytes > decoder->remaining)
+    return CROS_DEPACK_INSUFF_DAT_ERR;
+
+  decoder->dest = (unsigned char *)dest;
+  decoder->left = n_bytes;
+  decoder->remaining -= n_bytes;
+  return CROS_SUCCESS_ERR_PACK;
+}
+
+// Start decoding the fields of a message, after the ones of the current frame
+static cRosErrCodePack decoderPush(cRosMessageDecoder *decoder, cRosMessage *message, cRosMessageDef *msg_def)
+{
+  DecoderFrame *frame;
+
+  if(decoder->n_frames == decoder->frames_capacity)
+  {
+    int new_capacity = (decoder->frames_capacity > 0)? decoder->frames_capacity * 2 : 4;
+    DecoderFrame *new_frames = (DecoderFrame *)realloc(decoder->frames, new_capacity * sizeof(DecoderFrame));
+    if(new_frames == NULL)
+      return CROS_MEM_ALLOC_ERR;
+    decoder->frames = new_frames;
+    decoder->frames_capacity = new_capacity;
+  }
+
+  frame = &decoder->frames[decoder->n_frames++];
+  frame->message = message;
+  frame->field_def = (msg_def != NULL)? msg_def->first_field : NULL;
+  frame->field_ind = 0;
+  frame->elem_ind = 0;
+  frame->n_elems = 0;
+  frame->step = DECODER_STEP_FIELD_START;
+  return CROS_SUCCESS_ERR_PACK;
+}
+
+static cRosErrCodePack decoderStartField(cRosMessageDecoder *decoder, DecoderFrame *frame, cRosMessageField *field)
+{
+  if(field->type == CROS_STD_MSGS_STRING)
+  {
+    if(!field->is_array)
+    {
+      decoder->string_ind = 0;
+      frame->step = DECODER_STEP_STRING_LENGTH;
+      return decoderRead(decoder, &decoder->length, sizeof(uint32_t));
+    }
+  }
+  else if(isMessageFieldType(field->type))
+  {
+    if(!field->is_array)
+    {
+      frame->step = DECODER_STEP_FIELD_END;
+      return decoderPush(decoder, field->data.as_msg, getNestedMsgDef(frame->field_def, field->data.as_msg)); // frame is not valid anymore
+    }
+  }
+  else if(isBuiltinMessageType(field->type))
+  {
+    size_t elem_size = getMessageTypeSizeOf(field->type);
+
+    if(!field->is_array)
+    {
+      frame->step = DECODER_STEP_FIELD_END;
+      return decoderRead(decoder, field->data.opaque, elem_size);
+    }
+    if(field->is_fixed_array)
+    {
+      frame->step = DECODER_STEP_FIELD_END;
+      return decoderRead(decoder, field->data.as_array, elem_size * field->array_size);
+    }
+  }
+  else
+    return CROS_BAD_PARAM_ERR;
+
+  // Array of strings or of messages, or variable-length array of primitive values
+  if(field->is_fixed_array)
+  {
+    frame->elem_ind = 0;
+    frame->n_elems = (uint32_t)field->array_size;
+    frame->step = (field->type == CROS_STD_MSGS_STRING)? DECODER_STEP_STRING_ELEM : DECODER_STEP_MSG_ELEM;
+    return CROS_SUCCESS_ERR_PACK;
+  }
+
+  frame->step = DECODER_STEP_ARRAY_LENGTH;
+  return decoderRead(decoder, &decoder->length, sizeof(uint32_t));
+}
+
+// Adapt a variable-length array field to the received number of elements (decoder->length), which is checked against
+// the remaining data before allocating memory for them
+static cRosErrCodePack decoderStartArray(cRosMessageDecoder *decoder, DecoderFrame *frame, cRosMessageField *field)
+{
+  uint32_t n_elems = decoder->length;
+  cRosErrCodePack ret_err;
+
+  frame->elem_ind = 0;
+  frame->n_elems = n_elems;
+
+  if(field->type == CROS_STD_MSGS_STRING)
+  {
+    if(n_elems > decoder->remaining / sizeof(uint32_t))
+      return CROS_DEPACK_INSUFF_DAT_ERR; // Not enough data for the lengths of the strings
+    if(resizeStringArrayField(field, (int)n_elems) != 0)
+      return CROS_MEM_ALLOC_ERR;
+    frame->step = DECODER_STEP_STRING_ELEM;
+    return CROS_SUCCESS_ERR_PACK;
+  }
+
+  if(isMessageFieldType(field->type))
+  {
+    ret_err = resizeMsgArrayField(field, frame->field_def, n_elems);
+    frame->step = DECODER_STEP_MSG_ELEM;
+    return ret_err;
+  }
+
+  size_t elem_size = getMessageTypeSizeOf(field->type);
+  if(n_elems > decoder->remaining / elem_size)
+    return CROS_DEPACK_INSUFF_DAT_ERR;
+
+  cRosMessageFieldArrayClear(field); // A borrowed array is forgotten, so that the elements are received in memory of the field
+  if((uint32_t)field->array_capacity < n_elems)
+  {
+    void *new_location = msgRealloc(field->arena, field->data.as_array, n_elems * elem_size);
+    if(new_location == NULL)
+      return CROS_MEM_ALLOC_ERR;
+    field->data.as_array = new_location;
+    field->array_capacity = (int)n_elems;
+  }
+  field->array_size = (int)n_elems;
+  frame->step = DECODER_STEP_FIELD_END;
+  return decoderRead(decoder, field->data.as_array, n_elems * elem_size);
+}
+
+// Advance the decoding after the requested bytes have been received, until more bytes are requested
+static cRosErrCodePack decoderStep(cRosMessageDecoder *decoder)
+{
+  DecoderFrame *frame = &decoder->frames[decoder->n_frames - 1];
+  cRosMessageField *field;
+
+  if(frame->field_ind == frame->message->n_fields)
+  {
+    // All the fields of the message have been decoded: continue with its parent
+    if(--decoder->n_frames == 0)
+      decoder->state = DECODER_STATE_DONE;
+    return CROS_SUCCESS_ERR_PACK;
+  }
+
+  field = frame->message->fields[frame->field_ind];
+  switch(frame->step)
+  {
+    case DECODER_STEP_FIELD_START:
+      return decoderStartField(decoder, frame, field);
+
+    case DECODER_STEP_ARRAY_LENGTH:
+      return decoderStartArray(decoder, frame, field);
+
+    case DECODER_STEP_STRING_ELEM:
+      if(frame->elem_ind < frame->n_elems)
+      {
+        decoder->string_ind = (int)frame->elem_ind++;
+        frame->step = DECODER_STEP_STRING_LENGTH;
+        return decoderRead(decoder, &decoder->length, sizeof(uint32_t));
+      }
+      break;
+
+    case DECODER_STEP_STRING_LENGTH:
+      if(decoder->length > decoder->remaining)
+        return CROS_DEPACK_INSUFF_DAT_ERR;
+      if(reserveString(field, decoder->string_ind, decoder->length) != 0)
+        return CROS_MEM_ALLOC_ERR;
+      frame->step = DECODER_STEP_STRING_END;
+      return decoderRead(decoder, *getStringValue(field, decoder->string_ind), decoder->length);
+
+    case DECODER_STEP_STRING_END:
+      (*getStringValue(field, decoder->string_ind))[decoder->length] = '\0';
+      getStringInfo(field, decoder->string_ind)->len = decoder->length;
+      if(field->is_array)
+      {
+        frame->step = DECODER_STEP_STRING_ELEM;
+        return CROS_SUCCESS_ERR_PACK;
+      }
+      field->size = (int)decoder->length;
+      break;
+
+    case DECODER_STEP_MSG_ELEM:
+      if(frame->elem_ind < frame->n_elems)
+      {
+        cRosMessage *elem = field->data.as_msg_array[frame->elem_ind++];
+        return decoderPush(decoder, elem, getNestedMsgDef(frame->field_def, elem));
+      }
+      break;
+
+    case DECODER_STEP_FIELD_END:
+      break;
+  }
+
+  // The current field has been decoded: continue with the next one
+  frame->field_ind++;
+  frame->field_def = (frame->field_def != NULL)? frame->field_def->next : NULL;
+  frame->step = DECODER_STEP_FIELD_START;
+  return CROS_SUCCESS_ERR_PACK;
+}
+
+cRosMessageDecoder *cRosMessageDecoderNew(cRosMessage *message)
+{
+  cRosMessageDecoder *decoder = (cRosMessageDecoder *)calloc(1, sizeof(cRosMessageDecoder));
+  if(decoder == NULL)
+    return NULL;
+
+  decoder->message = message;
+  decoder->state = DECODER_STATE_IDLE;
+  decoder->error = CROS_SUCCESS_ERR_PACK;
+  return decoder;
+}
+
+void cRosMessageDecoderFree(cRosMessageDecoder *decoder)
+{
+  if(decoder == NULL)
+    return;
+
+  free(decoder->frames);
+  free(decoder);
+}
+
+void cRosMessageDecoderStart(cRosMessageDecoder *decoder, size_t size)
+{
+  cRosErrCodePack ret_err;
+
+  decoder->n_frames = 0;
+  decoder->dest = NULL;
+  decoder->left = 0;
+  decoder->remaining = size;
+  decoder->state = DECODER_STATE_DECODING;
+  decoder->error = CROS_SUCCESS_ERR_PACK;
+
+  ret_err = decoderPush(decoder, decoder->message, decoder->message->msgDef);
+  if(ret_err != CROS_SUCCESS_ERR_PACK)
+  {
+    decoder->state = DECODER_STATE_ERROR;
+    decoder->error = ret_err;
+    return;
+  }
+  cRosMessageDecoderFeed(decoder, NULL, 0); // Decode the fields that do not need data (e.g., empty messages)
+}
+
+cRosErrCodePack cRosMessageDecoderFeed(cRosMessageDecoder *decoder, const void *data, size_t size)
+{
+  const unsigned char *src = (const unsigned char *)data;
+  cRosErrCodePack ret_err;
+
+  while(decoder->state == DECODER_STATE_DECODING)
+  {
+    if(decoder->left > 0)
+    {
+      size_t n_bytes = (size < decoder->left)? size : decoder->left;
+
+      memcpy(decoder->dest, src, n_bytes);
+      decoder->dest += n_bytes;
+      decoder->left -= n_bytes;
+      src += n_bytes;
+      size -= n_bytes;
+      if(decoder->left > 0)
+        break; // Wait for more data
+    }
+
+    ret_err = decoderStep(decoder);
+    if(ret_err != CROS_SUCCESS_ERR_PACK)
+    {
+      decoder->state = DECODER_STATE_ERROR;
+      decoder->error = ret_err;
+    }
+  }
+
+  return (decoder->state == DECODER_STATE_ERROR)? decoder->error : CROS_SUCCESS_ERR_PACK;
+}
+
+int cRosMessageDecoderIsBusy(const cRosMessageDecoder *decoder)
+{
+  return decoder->state != DECODER_STATE_IDLE;
+}
+
+cRosErrCodePack cRosMessageDecoderFinish(cRosMessageDecoder *decoder)
+{
+  cRosErrCodePack ret_err;
+
+  if(decoder->state == DECODER_STATE_DONE)
+  {
+    // The borrowed arrays have been replaced, so the message does not need the borrowed buffer anymore
+    cRosMessageBufferUnref(decoder->message->borrowed_buffer);
+    decoder->message->borrowed_buffer = NULL;
+    ret_err = CROS_SUCCESS_ERR_PACK;
+  }
+  else if(decoder->state == DECODER_STATE_ERROR)
+    ret_err = decoder->error;
+  else
+    ret_err = CROS_DEPACK_INSUFF_DAT_ERR; // The message has not been received completely
+
+  decoder->state = DECODER_STATE_IDLE;
+  return ret_err;
+}
+
 const char * getMessageTypeDeclarationConst(msgConst *msgConst)
 {
   if (msgConst->type_s == NULL)
@@ -0,0 +1,160 @@
+#include <stdlib.h>
+#include <string.h>
+
+#include "cros_message_codec.h"
+#include "cros_defs.h"
+
+int cRosCodecStringSet(char **str_ptr, const char *value)
+{
+  char *new_str = NULL;
+
+  if(value != NULL && *value != '\0')
+  {
+    new_str = strdup(value);
+    if(new_str == NULL)
+      return -1;
+  }
+  free(*str_ptr);
+  *str_ptr = new_str;
+  return 0;
+}
+
+int cRosCodecArrayResize(void *array, size_t elem_size, uint32_t size)
+{
+  CrosCodecArray *arr = (CrosCodecArray *)array;
+
+  if(size > arr->capacity)
+  {
+    uint32_t new_capacity = (arr->capacity > 0)? arr->capacity : 1;
+    void *new_data;
+
+    while(new_capacity < size)
+      new_capacity = (new_capacity <= UINT32_MAX / 2)? new_capacity * 2 : size;
+
+    new_data = realloc(arr->data, (size_t)new_capacity * elem_size);
+    if(new_data == NULL)
+      return -1;
+    memset((unsigned char *)new_data + (size_t)arr->capacity * elem_size, 0, (size_t)(new_capacity - arr->capacity) * elem_size);
+    arr->data = new_data;
+    arr->capacity = new_capacity;
+  }
+  arr->size = size;
+  return 0;
+}
+
+void cRosCodecArrayRelease(void *array)
+{
+  CrosCodecArray *arr = (CrosCodecArray *)array;
+
+  free(arr->data);
+  arr->data = NULL;
+  arr->size = 0;
+  arr->capacity = 0;
+}
+
+size_t cRosCodecStringSize(const char *str)
+{
+  return sizeof(uint32_t) + ((str != NULL)? strlen(str) : 0);
+}
+
+cRosErrCodePack cRosCodecWriteString(DynBuffer *buffer, const char *str)
+{
+  size_t str_len = (str != NULL)? strlen(str) : 0;
+
+  if(dynBufferPushBackUInt32(buffer, (uint32_t)str_len) < 0 ||
+     dynBufferPushBackBuf(buffer, (const unsigned char *)str, str_len) < 0)
+    return CROS_MEM_ALLOC_ERR;
+  return CROS_SUCCESS_ERR_PACK;
+}
+
+cRosErrCodePack cRosCodecReadString(DynBuffer *buffer, char **str_ptr)
+{
+  uint32_t str_len;
+  char *new_str;
+
+  if(cRosCodecReadBytes(buffer, &str_len, sizeof(uint32_t)) != CROS_SUCCESS_ERR_PACK ||
+     (size_t)dynBufferGetRemainingDataSize(buffer) < str_len)
+    return CROS_DEPACK_INSUFF_DAT_ERR;
+
+  new_str = (char *)realloc(*str_ptr, (size_t)str_len + 1);
+  if(new_str == NULL)
+    return CROS_MEM_ALLOC_ERR;
+
+  memcpy(new_str, dynBufferGetCurrentData(buffer), str_len);
+  new_str[str_len] = '\0';
+  *str_ptr = new_str;
+  dynBufferMovePoseIndicator(buffer, str_len);
+  return CROS_SUCCESS_ERR_PACK;
+}
+
+cRosErrCodePack cRosCodecWriteBytes(DynBuffer *buffer, const void *data, size_t n)
+{
+  if(n == 0) // The data of an empty array may be NULL
+    return CROS_SUCCESS_ERR_PACK;
+
+  return (dynBufferPushBackBuf(buffer, (const unsigned char *)data, n) >= 0)? CROS_SUCCESS_ERR_PACK : CROS_MEM_ALLOC_ERR;
+}
+
+cRosErrCodePack cRosCodecReadBytes(DynBuffer *buffer, void *data, size_t n)
+{
+  if((size_t)dynBufferGetRemainingDataSize(buffer) < n)
+    return CROS_DEPACK_INSUFF_DAT_ERR;
+
+  if(n > 0) // The data of an empty array may be NULL
+  {
+    memcpy(data, dynBufferGetCurrentData(buffer), n);
+    dynBufferMovePoseIndicator(buffer, n);
+  }
+  return CROS_SUCCESS_ERR_PACK;
+}
+
+cRosErrCodePack cRosCodecReadArrayLength(DynBuffer *buffer, void *array, size_t elem_size, size_t min_elem_wire_size)
+{
+  uint32_t n_elems;
+
+  if(cRosCodecReadBytes(buffer, &n_elems, sizeof(uint32_t)) != CROS_SUCCESS_ERR_PACK)
+    return CROS_DEPACK_INSUFF_DAT_ERR;
+
+  if(min_elem_wire_size > 0 && n_elems > (size_t)dynBufferGetRemainingDataSize(buffer) / min_elem_wire_size)
+    return CROS_DEPACK_INSUFF_DAT_ERR;
+
+  if(cRosCodecArrayResize(array, elem_size, n_elems) != 0)
+    return CROS_MEM_ALLOC_ERR;
+
+  return CROS_SUCCESS_ERR_PACK;
+}
+
+void cRosCodecHeaderRelease(CrosHeader *header)
+{
+  free(header->frame_id);
+  memset(header, 0, sizeof(CrosHeader));
+}
+
+size_t cRosCodecHeaderSize(const CrosHeader *header)
+{
+  return sizeof(uint32_t) + sizeof(CrosTime) + cRosCodecStringSize(header->frame_id);
+}
+
+cRosErrCodePack cRosCodecWriteHeader(DynBuffer *buffer, const CrosHeader *header)
+{
+  cRosErrCodePack ret_err;
+
+  ret_err = cRosCodecWriteBytes(buffer, &header->seq, sizeof(uint32_t));
+  if(ret_err == CROS_SUCCESS_ERR_PACK)
+    ret_err = cRosCodecWriteBytes(buffer, &header->stamp, sizeof(CrosTime));
+  if(ret_err == CROS_SUCCESS_ERR_PACK)
+    ret_err = cRosCodecWriteString(buffer, header->frame_id);
+  return ret_err;
+}
+
+cRosErrCodePack cRosCodecReadHeader(DynBuffer *buffer, CrosHeader *header)
+{
+  cRosErrCodePack ret_err;
+
+  ret_err = cRosCodecReadBytes(buffer, &header->seq, sizeof(uint32_t));
+  if(ret_err == CROS_SUCCESS_ERR_PACK)
+    ret_err = cRosCodecReadBytes(buffer, &header->stamp, sizeof(CrosTime));
+  if(ret_err == CROS_SUCCESS_ERR_PACK)
+    ret_err = cRosCodecReadString(buffer, &header->frame_id);
+  return ret_err;
+}
@@ -0,0 +1,511 @@
+#include <stdlib.h>
+#include <string.h>
+
+#include "cros_message_layout.h"
+#include "cros_message_internal.h"
+#include "cros_defs.h"
+#include "dyn_string.h"
+
+// Alignment required by a C type
+#define LAYOUT_ALIGNOF(type) offsetof(struct { char c; type x; }, x)
+
+typedef struct BuiltinFieldSpec BuiltinFieldSpec;
+struct BuiltinFieldSpec
+{
+  const char *name;
+  CrosMessageType type;
+};
+
+// Fields of the built-in message types, which have no definition file (see build_time_field() and similar functions)
+static const BuiltinFieldSpec TIME_FIELDS[] = { { "secs", CROS_STD_MSGS_UINT32 }, { "nsecs", CROS_STD_MSGS_UINT32 } };
+static const BuiltinFieldSpec DURATION_FIELDS[] = { { "secs", CROS_STD_MSGS_INT32 }, { "nsecs", CROS_STD_MSGS_INT32 } };
+static const BuiltinFieldSpec HEADER_FIELDS[] = { { "seq", CROS_STD_MSGS_UINT32 }, { "stamp", CROS_STD_MSGS_TIME }, { "frame_id", CROS_STD_MSGS_STRING } };
+
+static cRosErrCodePack buildLayout(CrosMessageLayout **layout_ptr, cRosMessageDef *msg_def);
+
+static size_t alignUp(size_t val, size_t align)
+{
+  return (val + align - 1) / align * align;
+}
+
+static CrosMessageLayout *newLayout(int n_fields)
+{
+  CrosMessageLayout *layout = (CrosMessageLayout *)calloc(1, sizeof(CrosMessageLayout));
+  if(layout == NULL)
+    return NULL;
+
+  layout->align = 1;
+  if(n_fields > 0)
+  {
+    layout->fields = (CrosMessageLayoutField *)calloc(n_fields, sizeof(CrosMessageLayoutField));
+    if(layout->fields == NULL)
+    {
+      free(layout);
+      return NULL;
+    }
+  }
+  return layout;
+}
+
+// Place the next field of a layout after the previous ones. child is owned by the layout, even if an error occurs
+static int appendField(CrosMessageLayout *layout, const char *name, CrosMessageType type, int is_array, int array_size, CrosMessageLayout *child)
+{
+  CrosMessageLayoutField *field = &layout->fields[layout->n_fields];
+  size_t elem_align, storage_size, storage_align;
+
+  field->child = child;
+  field->name = strdup(name);
+  layout->n_fields++;
+  if(field->name == NULL)
+    return -1;
+
+  field->type = type;
+  field->is_array = is_array;
+  field->array_size = (is_array)? array_size : 0;
+
+  if(child != NULL)
+  {
+    field->elem_size = child->size;
+    elem_align = child->align;
+    if(child->has_external_data)
+      layout->has_external_data = 1;
+  }
+  else if(type == CROS_STD_MSGS_STRING)
+  {
+    field->elem_size = sizeof(char *);
+    elem_align = LAYOUT_ALIGNOF(char *);
+    layout->has_external_data = 1;
+  }
+  else
+  {
+    field->elem_size = getMessageTypeSizeOf(type);
+    elem_align = field->elem_size;
+    if(field->elem_size == 0)
+      return -1;
+  }
+
+  if(is_array && array_size < 0) // Variable-length array
+  {
+    storage_size = sizeof(CrosFlatArray);
+    storage_align = LAYOUT_ALIGNOF(CrosFlatArray);
+    layout->has_external_data = 1;
+  }
+  else
+  {
+    storage_size = (is_array)? field->elem_size * array_size : field->elem_size;
+    storage_align = elem_align;
+  }
+
+  field->offset = alignUp(layout->size, storage_align);
+  layout->size = field->offset + storage_size;
+  if(storage_align > layout->align)
+    layout->align = storage_align;
+
+  // The encoded size is only kept while all the fields have a fixed encoded size
+  if(layout->has_external_data)
+    layout->wire_size = 0;
+  else
+    layout->wire_size += ((child != NULL)? child->wire_size : field->elem_size) * ((is_array)? array_size : 1);
+
+  return 0;
+}
+
+static cRosErrCodePack buildBuiltinLayout(CrosMessageLayout **layout_ptr, CrosMessageType type)
+{
+  const BuiltinFieldSpec *specs;
+  int n_specs, spec_ind;
+  CrosMessageLayout *layout;
+
+  switch(type)
+  {
+    case CROS_STD_MSGS_TIME:
+      specs = TIME_FIELDS;
+      n_specs = sizeof(TIME_FIELDS) / sizeof(TIME_FIELDS[0]);
+      break;
+    case CROS_STD_MSGS_DURATION:
+      specs = DURATION_FIELDS;
+      n_specs = sizeof(DURATION_FIELDS) / sizeof(DURATION_FIELDS[0]);
+      break;
+    case CROS_STD_MSGS_HEADER:
+      specs = HEADER_FIELDS;
+      n_specs = sizeof(HEADER_FIELDS) / sizeof(HEADER_FIELDS[0]);
+      break;
+    default:
+      return CROS_BAD_PARAM_ERR;
+  }
+
+  layout = newLayout(n_specs);
+  if(layout == NULL)
+    return CROS_MEM_ALLOC_ERR;
+
+  for(spec_ind = 0; spec_ind < n_specs; spec_ind++)
+  {
+    CrosMessageLayout *child = NULL;
+    if(specs[spec_ind].type == CROS_STD_MSGS_TIME && buildBuiltinLayout(&child, CROS_STD_MSGS_TIME) != CROS_SUCCESS_ERR_PACK)
+      break;
+    if(appendField(layout, specs[spec_ind].name, specs[spec_ind].type, 0, 0, child) != 0)
+      break;
+  }
+  if(spec_ind < n_specs)
+  {
+    cRosMessageLayoutFree(layout);
+    return CROS_MEM_ALLOC_ERR;
+  }
+
+  layout->size = alignUp(layout->size, layout->align);
+  *layout_ptr = layout;
+  return CROS_SUCCESS_ERR_PACK;
+}
+
+static cRosErrCodePack buildLayout(CrosMessageLayout **layout_ptr, cRosMessageDef *msg_def)
+{
+  cRosErrCodePack ret_err;
+  CrosMessageLayout *layout;
+  msgFieldDef *field_def_itr;
+  int n_fields;
+
+  // The field list of a message definition ends with an empty element
+  n_fields = 0;
+  for(field_def_itr = msg_def->first_field; field_def_itr->next != NULL; field_def_itr = field_def_itr->next)
+    n_fields++;
+
+  layout = newLayout(n_fields);
+  if(layout == NULL)
+    return CROS_MEM_ALLOC_ERR;
+
+  ret_err = CROS_SUCCESS_ERR_PACK;
+  for(field_def_itr = msg_def->first_field; field_def_itr->next != NULL && ret_err == CROS_SUCCESS_ERR_PACK; field_def_itr = field_def_itr->next)
+  {
+    CrosMessageLayout *child = NULL;
+
+    switch(field_def_itr->type)
+    {
+      case CROS_STD_MSGS_TIME:
+      case CROS_STD_MSGS_DURATION:
+      case CROS_STD_MSGS_HEADER:
+        ret_err = buildBuiltinLayout(&child, field_def_itr->type);
+        break;
+      case CROS_CUSTOM_TYPE:
+        if(field_def_itr->child_msg_def != NULL)
+          ret_err = buildLayout(&child, field_def_itr->child_msg_def);
+        else
+          ret_err = CROS_DEPACK_NO_MSG_DEF_ERR;
+        ret_err = cRosAddErrCodeIfErr(ret_err, CROS_CREATE_CUSTOM_MSG_ERR);
+        break;
+      default:
+        break;
+    }
+
+    if(ret_err == CROS_SUCCESS_ERR_PACK && appendField(layout, field_def_itr->name, field_def_itr->type, field_def_itr->is_array, field_def_itr->array_size, child) != 0)
+      ret_err = CROS_MEM_ALLOC_ERR;
+  }
+
+  if(ret_err != CROS_SUCCESS_ERR_PACK)
+  {
+    cRosMessageLayoutFree(layout);
+    return ret_err;
+  }
+
+  layout->size = alignUp(layout->size, layout->align);
+  *layout_ptr = layout;
+  return CROS_SUCCESS_ERR_PACK;
+}
+
+cRosErrCodePack cRosMessageLayoutBuild(CrosMessageLayout **layout_ptr, cRosMessageDef *msg_def)
+{
+  cRosErrCodePack ret_err;
+  CrosMessageLayout *layout;
+  unsigned char *md5_res;
+
+  if(layout_ptr == NULL || msg_def == NULL)
+    return CROS_BAD_PARAM_ERR;
+
+  ret_err = buildLayout(&layout, msg_def);
+  if(ret_err != CROS_SUCCESS_ERR_PACK)
+    return ret_err;
+
+  if(cRosSerialProgramCompile(&layout->program, layout) != 0)
+  {
+    cRosMessageLayoutFree(layout);
+    return CROS_MEM_ALLOC_ERR;
+  }
+
+  md5_res = getMD5Msg(msg_def);
+  if(md5_res != NULL)
+  {
+    DynString output;
+    dynStringInit(&output);
+    cRosMD5Readable(md5_res, &output);
+    if(output.data != NULL)
+      strncpy(layout->md5sum, output.data, sizeof(layout->md5sum) - 1);
+    dynStringRelease(&output);
+    free(md5_res);
+  }
+
+  *layout_ptr = layout;
+  return CROS_SUCCESS_ERR_PACK;
+}
+
+cRosErrCodePack cRosMessageLayoutNewBuild(const char *msg_root_dir, const char *msg_type, CrosMessageLayout **layout_ptr)
+{
+  cRosErrCodePack ret_err;
+  cRosMessageDef *msg_def;
+
+  if(layout_ptr == NULL)
+    return CROS_BAD_PARAM_ERR;
+
+  ret_err = cRosMessageDefBuild(&msg_def, msg_root_dir, msg_type);
+  if(ret_err == CROS_SUCCESS_ERR_PACK)
+  {
+    ret_err = cRosMessageLayoutBuild(layout_ptr, msg_def);
+    cRosMessageDefFree(msg_def);
+  }
+  return ret_err;
+}
+
+void cRosMessageLayoutFree(CrosMessageLayout *layout)
+{
+  int field_ind;
+
+  if(layout == NULL)
+    return;
+
+  for(field_ind = 0; field_ind < layout->n_fields; field_ind++)
+  {
+    free(layout->fields[field_ind].name);
+    cRosMessageLayoutFree(layout->fields[field_ind].child);
+  }
+  free(layout->fields);
+  cRosSerialProgramRelease(&layout->program);
+  free(layout);
+}
+
+int cRosMessageLayoutGetFieldIndex(const CrosMessageLayout *layout, const char *field_name)
+{
+  int field_ind;
+
+  for(field_ind = 0; field_ind < layout->n_fields; field_ind++)
+    if(strcmp(layout->fields[field_ind].name, field_name) == 0)
+      return field_ind;
+
+  return -1;
+}
+
+int cRosMessageLayoutFieldHandleResolve(const CrosMessageLayout *layout, const char *field_path, CrosMessageLayoutFieldHandle *handle)
+{
+  const char *name_start = field_path;
+  size_t offset = 0;
+
+  while(layout != NULL)
+  {
+    const char *name_end = strchr(name_start, '.');
+    size_t name_len = (name_end != NULL)? (size_t)(name_end - name_start) : strlen(name_start);
+    const CrosMessageLayoutField *field = NULL;
+    int field_ind;
+
+    for(field_ind = 0; field_ind < layout->n_fields; field_ind++)
+    {
+      if(strncmp(layout->fields[field_ind].name, name_start, name_len) == 0 && layout->fields[field_ind].name[name_len] == '\0')
+      {
+        field = &layout->fields[field_ind];
+        break;
+      }
+    }
+    if(field == NULL)
+      break;
+
+    offset += field->offset;
+    if(name_end == NULL)
+    {
+      handle->offset = offset;
+      handle->field = field;
+      return 0;
+    }
+
+    // The nested messages stored inline are the only ones that have a fixed position in the block
+    layout = (field->is_array)? NULL : field->child;
+    name_start = name_end + 1;
+  }
+
+  handle->offset = 0;
+  handle->field = NULL;
+  return -1;
+}
+
+static void releaseBlockData(const CrosMessageLayout *layout, unsigned char *block);
+
+// Free the data stored out of the block by n consecutive values of a field
+static void releaseValues(const CrosMessageLayoutField *field, unsigned char *values, uint32_t n)
+{
+  uint32_t val_ind;
+
+  if(field->type == CROS_STD_MSGS_STRING)
+  {
+    for(val_ind = 0; val_ind < n; val_ind++)
+      free(((char **)values)[val_ind]);
+  }
+  else if(field->child != NULL && field->child->has_external_data)
+  {
+    for(val_ind = 0; val_ind < n; val_ind++)
+      releaseBlockData(field->child, values + val_ind * field->elem_size);
+  }
+}
+
+static void releaseBlockData(const CrosMessageLayout *layout, unsigned char *block)
+{
+  int field_ind;
+
+  for(field_ind = 0; field_ind < layout->n_fields; field_ind++)
+  {
+    const CrosMessageLayoutField *field = &layout->fields[field_ind];
+    unsigned char *field_ptr = block + field->offset;
+
+    if(field->is_array && field->array_size < 0)
+    {
+      CrosFlatArray *array = (CrosFlatArray *)field_ptr;
+      releaseValues(field, (unsigned char *)array->data, array->size);
+      free(array->data);
+    }
+    else
+      releaseValues(field, field_ptr, (field->is_array)? field->array_size : 1);
+  }
+}
+
+void cRosMessageLayoutBlockRelease(const CrosMessageLayout *layout, void *block)
+{
+  if(layout->has_external_data)
+    releaseBlockData(layout, (unsigned char *)block);
+  memset(block, 0, layout->size);
+}
+
+// The block is placed right after the message struct, in the same allocation
+static size_t flatMessageBlockOffset(const CrosMessageLayout *layout)
+{
+  return alignUp(sizeof(cRosFlatMessage), layout->align);
+}
+
+cRosFlatMessage *cRosFlatMessageNew(CrosMessageLayout *layout)
+{
+  cRosFlatMessage *msg;
+
+  if(layout == NULL)
+    return NULL;
+
+  msg = (cRosFlatMessage *)calloc(1, flatMessageBlockOffset(layout) + layout->size);
+  if(msg == NULL)
+  {
+    PRINT_ERROR ( "cRosFlatMessageNew() : Can't allocate memory\n" );
+    return NULL;
+  }
+
+  msg->layout = layout;
+  msg->data = (unsigned char *)msg + flatMessageBlockOffset(layout);
+  return msg;
+}
+
+void cRosFlatMessageFree(cRosFlatMessage *msg)
+{
+  if(msg == NULL)
+    return;
+
+  if(msg->layout->has_external_data)
+    releaseBlockData(msg->layout, msg->data);
+  free(msg);
+}
+
+void *cRosFlatMessageField(cRosFlatMessage *msg, int field_idx)
+{
+  if(field_idx < 0 || field_idx >= msg->layout->n_fields)
+    return NULL;
+
+  return msg->data + msg->layout->fields[field_idx].offset;
+}
+
+void *cRosFlatMessageFieldByHandle(cRosFlatMessage *msg, const CrosMessageLayoutFieldHandle *handle)
+{
+  if(handle->field == NULL)
+    return NULL;
+
+  return msg->data + handle->offset;
+}
+
+int cRosFlatStringSet(char **str_ptr, const char *value)
+{
+  char *new_str = NULL;
+
+  if(value != NULL && value[0] != '\0')
+  {
+    new_str = strdup(value);
+    if(new_str == NULL)
+      return -1;
+  }
+  free(*str_ptr);
+  *str_ptr = new_str;
+  return 0;
+}
+
+int cRosFlatArrayResize(const CrosMessageLayoutField *field, CrosFlatArray *array, uint32_t size)
+{
+  unsigned char *values;
+
+  if(size > array->capacity)
+  {
+    // Grow geometrically, so that arrays filled element by element are not reallocated every time
+    uint32_t new_capacity = (array->capacity > size / 2 && array->capacity <= UINT32_MAX / 2)? 2 * array->capacity : size;
+    void *new_data = NULL;
+
+    if(field->elem_size > 0)
+    {
+      new_data = realloc(array->data, (size_t)new_capacity * field->elem_size);
+      if(new_data == NULL)
+      {
+        PRINT_ERROR ( "cRosFlatArrayResize() : Can't allocate memory\n" );
+        return -1;
+      }
+    }
+    array->data = new_data;
+    array->capacity = new_capacity;
+  }
+
+  values = (unsigned char *)array->data;
+  if(size < array->size)
+    releaseValues(field, values + (size_t)size * field->elem_size, array->size - size);
+  else if(size > array->size && field->elem_size > 0)
+    memset(values + (size_t)array->size * field->elem_size, 0, (size_t)(size - array->size) * field->elem_size);
+  array->size = size;
+
+  return 0;
+}
+
+void *cRosFlatArrayAt(const CrosMessageLayoutField *field, void *array_ptr, uint32_t position)
+{
+  if(!field->is_array)
+    return NULL;
+
+  if(field->array_size < 0)
+  {
+    CrosFlatArray *array = (CrosFlatArray *)array_ptr;
+    if(position >= array->size)
+      return NULL;
+    return (unsigned char *)array->data + (size_t)position * field->elem_size;
+  }
+
+  if(position >= (uint32_t)field->array_size)
+    return NULL;
+  return (unsigned char *)array_ptr + (size_t)position * field->elem_size;
+}
+
+size_t cRosFlatMessageSize(cRosFlatMessage *msg)
+{
+  return cRosSerialProgramSize(&msg->layout->program, msg->data);
+}
+
+cRosErrCodePack cRosFlatMessageSerialize(cRosFlatMessage *msg, DynBuffer *buffer)
+{
+  return cRosSerialProgramSerialize(&msg->layout->program, msg->data, buffer);
+}
+
+cRosErrCodePack cRosFlatMessageDeserialize(cRosFlatMessage *msg, DynBuffer *buffer)
+{
+  return cRosSerialProgramDeserialize(&msg->layout->program, msg->data, buffer);
+}
@@ -0,0 +1,75 @@
+#include <stdlib.h>
+#include <string.h>
+
+#include "cros_message_pool.h"
+#include "cros_defs.h"
+
+void cRosMessagePoolInit(cRosMessagePool *pool, cRosMessage *prototype, unsigned int capacity)
+{
+  pool->prototype = prototype;
+  pool->msgs = NULL;
+  pool->n_msgs = 0;
+  pool->capacity = (capacity > 0)? capacity : CROS_MESSAGE_POOL_DEFAULT_CAPACITY;
+  pthread_mutex_init(&pool->mutex, NULL);
+}
+
+cRosMessage *cRosMessagePoolAcquire(cRosMessagePool *pool)
+{
+  cRosMessage *message = NULL;
+
+  pthread_mutex_lock(&pool->mutex);
+  if(pool->n_msgs > 0)
+    message = pool->msgs[--pool->n_msgs];
+  pthread_mutex_unlock(&pool->mutex);
+
+  // The prototype is never modified, so it is copied out of the lock
+  return (message != NULL)? message : cRosMessageCopy(pool->prototype);
+}
+
+// Returns 1 if a message can be given back to a pool: it must be of the pool type and not depend on a received packet
+static int isRecyclable(cRosMessagePool *pool, cRosMessage *message)
+{
+  return(pool->prototype != NULL && message->arena == NULL && message->borrowed_buffer == NULL && message->fields != NULL &&
+         message->n_fields == pool->prototype->n_fields && message->md5sum != NULL &&
+         pool->prototype->md5sum != NULL && strcmp(message->md5sum, pool->prototype->md5sum) == 0);
+}
+
+void cRosMessagePoolRecycle(cRosMessagePool *pool, cRosMessage *message)
+{
+  int kept = 0;
+
+  if(message == NULL)
+    return;
+
+  if(isRecyclable(pool, message))
+  {
+    pthread_mutex_lock(&pool->mutex);
+    if(pool->n_msgs < pool->capacity)
+    {
+      if(pool->msgs == NULL)
+      {
+        pool->msgs = (cRosMessage **)malloc(pool->capacity * sizeof(cRosMessage *));
+        if(pool->msgs == NULL)
+          PRINT_ERROR ( "cRosMessagePoolRecycle() : Can't allocate memory\n" );
+      }
+      if(pool->msgs != NULL)
+      {
+        pool->msgs[pool->n_msgs++] = message;
+        kept = 1;
+      }
+    }
+    pthread_mutex_unlock(&pool->mutex);
+  }
+
+  if(!kept)
+    cRosMessageFree(message);
+}
+
+void cRosMessagePoolRelease(cRosMessagePool *pool)
+{
+  while(pool->n_msgs > 0)
+    cRosMessageFree(pool->msgs[--pool->n_msgs]);
+  free(pool->msgs);
+  pool->msgs = NULL;
+  pthread_mutex_destroy(&pool->mutex);
+}
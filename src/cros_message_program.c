@@ -0,0 +1,423 @@
+#include <stdlib.h>
+#include <string.h>
+
+#include "cros_message_program.h"
+#include "cros_message_layout.h"
+#include "cros_defs.h"
+
+#define PROGRAM_INITIAL_CAPACITY 8
+
+static CrosSerialOp *appendOp(CrosSerialProgram *prog, CrosSerialOpCode code, size_t offset, size_t size)
+{
+  CrosSerialOp *op;
+
+  if(prog->n_ops == prog->capacity)
+  {
+    int new_capacity = (prog->capacity > 0)? prog->capacity * 2 : PROGRAM_INITIAL_CAPACITY;
+    CrosSerialOp *new_ops = (CrosSerialOp *)realloc(prog->ops, new_capacity * sizeof(CrosSerialOp));
+    if(new_ops == NULL)
+      return NULL;
+    prog->ops = new_ops;
+    prog->capacity = new_capacity;
+  }
+
+  op = &prog->ops[prog->n_ops++];
+  memset(op, 0, sizeof(CrosSerialOp));
+  op->code = code;
+  op->offset = offset;
+  op->size = size;
+  prog->can_merge_copy = 0;
+  return op;
+}
+
+// Append a copy op, or extend the previous one if the bytes follow it in the block
+static int appendCopy(CrosSerialProgram *prog, size_t offset, size_t size)
+{
+  if(size == 0)
+    return 0;
+
+  if(prog->can_merge_copy)
+  {
+    CrosSerialOp *last = &prog->ops[prog->n_ops - 1];
+    if(last->offset + last->size == offset)
+    {
+      last->size += size;
+      return 0;
+    }
+  }
+
+  if(appendOp(prog, CROS_SERIAL_OP_COPY, offset, size) == NULL)
+    return -1;
+  prog->can_merge_copy = 1;
+  return 0;
+}
+
+// Minimum number of encoded bytes of the data processed by n_ops consecutive ops
+static size_t minWireSize(const CrosSerialOp *ops, int n_ops)
+{
+  size_t total = 0;
+  int op_ind = 0;
+
+  while(op_ind < n_ops)
+  {
+    const CrosSerialOp *op = &ops[op_ind];
+
+    switch(op->code)
+    {
+      case CROS_SERIAL_OP_COPY:
+        total += op->size;
+        break;
+      case CROS_SERIAL_OP_LOOP:
+        total += op->count * minWireSize(op + 1, op->body_len);
+        break;
+      default: // Strings and arrays can be empty
+        total += sizeof(uint32_t);
+        break;
+    }
+    op_ind += 1 + op->body_len;
+  }
+  return total;
+}
+
+// If the body of a loop or array is a single copy of whole elements, return 1
+static int isCopyBody(const CrosSerialProgram *prog, int body_start, size_t elem_size)
+{
+  const CrosSerialOp *body = &prog->ops[body_start];
+
+  return prog->n_ops - body_start == 1 && body->code == CROS_SERIAL_OP_COPY &&
+         body->offset == 0 && body->size == elem_size;
+}
+
+static int compileBlock(CrosSerialProgram *prog, const CrosMessageLayout *layout, size_t base);
+
+// Compile the ops of a single value of a field, stored at offset
+static int compileValue(CrosSerialProgram *prog, const CrosMessageLayoutField *field, size_t offset)
+{
+  if(field->child != NULL)
+    return compileBlock(prog, field->child, offset);
+
+  if(field->type == CROS_STD_MSGS_STRING)
+    return (appendOp(prog, CROS_SERIAL_OP_STRING, offset, sizeof(char *)) != NULL)? 0 : -1;
+
+  return appendCopy(prog, offset, field->elem_size);
+}
+
+static int compileFixedArray(CrosSerialProgram *prog, const CrosMessageLayoutField *field, size_t offset)
+{
+  int saved_can_merge_copy = prog->can_merge_copy;
+  int loop_ind = prog->n_ops;
+  CrosSerialOp *loop;
+
+  if(field->array_size <= 0)
+    return 0;
+
+  loop = appendOp(prog, CROS_SERIAL_OP_LOOP, offset, field->elem_size);
+  if(loop == NULL || compileValue(prog, field, 0) != 0)
+    return -1;
+
+  if(prog->n_ops == loop_ind + 1 || isCopyBody(prog, loop_ind + 1, field->elem_size))
+  {
+    // The elements are encoded as they are stored (or not at all): replace the loop by a copy of the whole array
+    size_t array_wire_size = (prog->n_ops > loop_ind + 1)? field->elem_size * field->array_size : 0;
+
+    prog->n_ops = loop_ind;
+    prog->can_merge_copy = saved_can_merge_copy;
+    return appendCopy(prog, offset, array_wire_size);
+  }
+
+  loop = &prog->ops[loop_ind];
+  loop->count = (uint32_t)field->array_size;
+  loop->body_len = prog->n_ops - loop_ind - 1;
+  prog->can_merge_copy = 0;
+  return 0;
+}
+
+static int compileVarArray(CrosSerialProgram *prog, const CrosMessageLayoutField *field, size_t offset)
+{
+  int array_ind = prog->n_ops;
+  CrosSerialOp *array;
+
+  array = appendOp(prog, CROS_SERIAL_OP_ARRAY, offset, field->elem_size);
+  if(array == NULL || compileValue(prog, field, 0) != 0)
+    return -1;
+
+  array = &prog->ops[array_ind];
+  array->field = field;
+  if(isCopyBody(prog, array_ind + 1, field->elem_size))
+  {
+    prog->n_ops = array_ind + 1;
+    array->code = CROS_SERIAL_OP_ARRAY_COPY;
+    array->min_elem_wire_size = field->elem_size;
+  }
+  else
+  {
+    array->body_len = prog->n_ops - array_ind - 1;
+    array->min_elem_wire_size = minWireSize(array + 1, array->body_len);
+  }
+  prog->can_merge_copy = 0;
+  return 0;
+}
+
+// Compile the ops of the fields of a block stored at base
+static int compileBlock(CrosSerialProgram *prog, const CrosMessageLayout *layout, size_t base)
+{
+  int field_ind, ret = 0;
+
+  for(field_ind = 0; field_ind < layout->n_fields && ret == 0; field_ind++)
+  {
+    const CrosMessageLayoutField *field = &layout->fields[field_ind];
+    size_t offset = base + field->offset;
+
+    if(!field->is_array)
+      ret = compileValue(prog, field, offset);
+    else if(field->array_size < 0)
+      ret = compileVarArray(prog, field, offset);
+    else
+      ret = compileFixedArray(prog, field, offset);
+  }
+  return ret;
+}
+
+int cRosSerialProgramCompile(CrosSerialProgram *prog, const CrosMessageLayout *layout)
+{
+  memset(prog, 0, sizeof(CrosSerialProgram));
+
+  if(compileBlock(prog, layout, 0) != 0)
+  {
+    PRINT_ERROR ( "cRosSerialProgramCompile() : Can't allocate memory\n" );
+    cRosSerialProgramRelease(prog);
+    return -1;
+  }
+  prog->can_merge_copy = 0;
+  return 0;
+}
+
+void cRosSerialProgramRelease(CrosSerialProgram *prog)
+{
+  free(prog->ops);
+  memset(prog, 0, sizeof(CrosSerialProgram));
+}
+
+static size_t runSize(const CrosSerialOp *ops, int n_ops, const unsigned char *block)
+{
+  size_t total = 0;
+  int op_ind = 0;
+
+  while(op_ind < n_ops)
+  {
+    const CrosSerialOp *op = &ops[op_ind];
+    const unsigned char *ptr = block + op->offset;
+    uint32_t elem_ind;
+
+    switch(op->code)
+    {
+      case CROS_SERIAL_OP_COPY:
+        total += op->size;
+        break;
+
+      case CROS_SERIAL_OP_STRING:
+      {
+        const char *str = *(char * const *)ptr;
+        total += sizeof(uint32_t) + ((str != NULL)? strlen(str) : 0);
+        break;
+      }
+
+      case CROS_SERIAL_OP_LOOP:
+        for(elem_ind = 0; elem_ind < op->count; elem_ind++)
+          total += runSize(op + 1, op->body_len, ptr + elem_ind * op->size);
+        break;
+
+      case CROS_SERIAL_OP_ARRAY:
+      {
+        const CrosFlatArray *array = (const CrosFlatArray *)ptr;
+
+        total += sizeof(uint32_t);
+        for(elem_ind = 0; elem_ind < array->size; elem_ind++)
+          total += runSize(op + 1, op->body_len, (const unsigned char *)array->data + (size_t)elem_ind * op->size);
+        break;
+      }
+
+      case CROS_SERIAL_OP_ARRAY_COPY:
+        total += sizeof(uint32_t) + (size_t)((const CrosFlatArray *)ptr)->size * op->size;
+        break;
+    }
+    op_ind += 1 + op->body_len;
+  }
+
+  return total;
+}
+
+size_t cRosSerialProgramSize(const CrosSerialProgram *prog, const void *block)
+{
+  return runSize(prog->ops, prog->n_ops, (const unsigned char *)block);
+}
+
+static cRosErrCodePack runSerialize(const CrosSerialOp *ops, int n_ops, const unsigned char *block, DynBuffer *buffer)
+{
+  cRosErrCodePack ret_err = CROS_SUCCESS_ERR_PACK;
+  int op_ind = 0;
+
+  while(op_ind < n_ops && ret_err == CROS_SUCCESS_ERR_PACK)
+  {
+    const CrosSerialOp *op = &ops[op_ind];
+    const unsigned char *ptr = block + op->offset;
+    uint32_t elem_ind;
+
+    switch(op->code)
+    {
+      case CROS_SERIAL_OP_COPY:
+        if(dynBufferPushBackBuf(buffer, ptr, op->size) < 0)
+          ret_err = CROS_MEM_ALLOC_ERR;
+        break;
+
+      case CROS_SERIAL_OP_STRING:
+      {
+        const char *str = *(char * const *)ptr;
+        uint32_t str_len = (str != NULL)? strlen(str) : 0;
+
+        if(dynBufferPushBackUInt32(buffer, str_len) < 0 ||
+           (str_len > 0 && dynBufferPushBackBuf(buffer, (const unsigned char *)str, str_len) < 0))
+          ret_err = CROS_MEM_ALLOC_ERR;
+        break;
+      }
+
+      case CROS_SERIAL_OP_LOOP:
+        for(elem_ind = 0; elem_ind < op->count && ret_err == CROS_SUCCESS_ERR_PACK; elem_ind++)
+          ret_err = runSerialize(op + 1, op->body_len, ptr + elem_ind * op->size, buffer);
+        break;
+
+      case CROS_SERIAL_OP_ARRAY:
+      case CROS_SERIAL_OP_ARRAY_COPY:
+      {
+        const CrosFlatArray *array = (const CrosFlatArray *)ptr;
+        const unsigned char *elems = (const unsigned char *)array->data;
+
+        if(dynBufferPushBackUInt32(buffer, array->size) < 0)
+          ret_err = CROS_MEM_ALLOC_ERR;
+        else if(op->code == CROS_SERIAL_OP_ARRAY_COPY)
+        {
+          if(array->size > 0 && dynBufferPushBackBuf(buffer, elems, (size_t)array->size * op->size) < 0)
+            ret_err = CROS_MEM_ALLOC_ERR;
+        }
+        else
+        {
+          for(elem_ind = 0; elem_ind < array->size && ret_err == CROS_SUCCESS_ERR_PACK; elem_ind++)
+            ret_err = runSerialize(op + 1, op->body_len, elems + (size_t)elem_ind * op->size, buffer);
+        }
+        break;
+      }
+    }
+    op_ind += 1 + op->body_len;
+  }
+
+  return ret_err;
+}
+
+cRosErrCodePack cRosSerialProgramSerialize(const CrosSerialProgram *prog, const void *block, DynBuffer *buffer)
+{
+  // Reserve the whole encoded message at once, so that the buffer is not reallocated while the ops append data
+  if(dynBufferReserve(buffer, cRosSerialProgramSize(prog, block)) < 0)
+    return CROS_MEM_ALLOC_ERR;
+
+  return runSerialize(prog->ops, prog->n_ops, (const unsigned char *)block, buffer);
+}
+
+static int readUInt32(DynBuffer *buffer, uint32_t *val)
+{
+  if(dynBufferGetCurrentContent((unsigned char *)val, buffer, sizeof(uint32_t)) < 0)
+    return -1;
+  dynBufferMovePoseIndicator(buffer, sizeof(uint32_t));
+  return 0;
+}
+
+static cRosErrCodePack readBytes(DynBuffer *buffer, unsigned char *dest, size_t n_bytes)
+{
+  if((size_t)dynBufferGetRemainingDataSize(buffer) < n_bytes)
+    return CROS_DEPACK_INSUFF_DAT_ERR;
+
+  memcpy(dest, dynBufferGetCurrentData(buffer), n_bytes);
+  dynBufferMovePoseIndicator(buffer, n_bytes);
+  return CROS_SUCCESS_ERR_PACK;
+}
+
+static cRosErrCodePack runDeserialize(const CrosSerialOp *ops, int n_ops, unsigned char *block, DynBuffer *buffer)
+{
+  cRosErrCodePack ret_err = CROS_SUCCESS_ERR_PACK;
+  int op_ind = 0;
+
+  while(op_ind < n_ops && ret_err == CROS_SUCCESS_ERR_PACK)
+  {
+    const CrosSerialOp *op = &ops[op_ind];
+    unsigned char *ptr = block + op->offset;
+    uint32_t elem_ind;
+
+    switch(op->code)
+    {
+      case CROS_SERIAL_OP_COPY:
+        ret_err = readBytes(buffer, ptr, op->size);
+        break;
+
+      case CROS_SERIAL_OP_STRING:
+      {
+        char **str_ptr = (char **)ptr;
+        uint32_t str_len;
+
+        if(readUInt32(buffer, &str_len) != 0 || (size_t)dynBufferGetRemainingDataSize(buffer) < str_len)
+          ret_err = CROS_DEPACK_INSUFF_DAT_ERR;
+        else
+        {
+          char *new_str = (char *)realloc(*str_ptr, (size_t)str_len + 1);
+          if(new_str != NULL)
+          {
+            memcpy(new_str, dynBufferGetCurrentData(buffer), str_len);
+            new_str[str_len] = '\0';
+            *str_ptr = new_str;
+            dynBufferMovePoseIndicator(buffer, str_len);
+          }
+          else
+            ret_err = CROS_MEM_ALLOC_ERR;
+        }
+        break;
+      }
+
+      case CROS_SERIAL_OP_LOOP:
+        for(elem_ind = 0; elem_ind < op->count && ret_err == CROS_SUCCESS_ERR_PACK; elem_ind++)
+          ret_err = runDeserialize(op + 1, op->body_len, ptr + elem_ind * op->size, buffer);
+        break;
+
+      case CROS_SERIAL_OP_ARRAY:
+      case CROS_SERIAL_OP_ARRAY_COPY:
+      {
+        CrosFlatArray *array = (CrosFlatArray *)ptr;
+        uint32_t n_elems;
+
+        // Reject lengths that cannot fit in the remaining data before allocating memory for them
+        if(readUInt32(buffer, &n_elems) != 0)
+          ret_err = CROS_DEPACK_INSUFF_DAT_ERR;
+        else if(op->min_elem_wire_size > 0 && n_elems > (size_t)dynBufferGetRemainingDataSize(buffer) / op->min_elem_wire_size)
+          ret_err = CROS_DEPACK_INSUFF_DAT_ERR;
+        else if(cRosFlatArrayResize(op->field, array, n_elems) != 0)
+          ret_err = CROS_MEM_ALLOC_ERR;
+        else if(op->code == CROS_SERIAL_OP_ARRAY_COPY)
+        {
+          if(n_elems > 0)
+            ret_err = readBytes(buffer, (unsigned char *)array->data, (size_t)n_elems * op->size);
+        }
+        else
+        {
+          for(elem_ind = 0; elem_ind < n_elems && ret_err == CROS_SUCCESS_ERR_PACK; elem_ind++)
+            ret_err = runDeserialize(op + 1, op->body_len, (unsigned char *)array->data + (size_t)elem_ind * op->size, buffer);
+        }
+        break;
+      }
+    }
+    op_ind += 1 + op->body_len;
+  }
+
+  return ret_err;
+}
+
+cRosErrCodePack cRosSerialProgramDeserialize(const CrosSerialProgram *prog, void *block, DynBuffer *buffer)
+{
+  return runDeserialize(prog->ops, prog->n_ops, (unsigned char *)block, buffer);
+}
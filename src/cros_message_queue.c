@@ -4,37 +4,65 @@
 #include "cros_message_queue.h"
 
 void cRosMessageQueueInit(cRosMessageQueue *q)
+{
+  // The message containers are initialized when the queue storage is allocated (see allocQueueMsgs())
+  cRosRingBufferInit(&q->msgs, sizeof(cRosMessage), DEFAULT_QUEUE_LEN);
+}
+
+// Allocate the queue storage and initialize all its messages, so that the inserted messages only need to be copied over these ones
+static int allocQueueMsgs(cRosMessageQueue *q)
 {
   unsigned int msg_ind;
-  // Initialize all messages in the queue so that the inserted messages only need to be copied over these ones
-  for(msg_ind=0;msg_ind<MAX_QUEUE_LEN;msg_ind++)
-    cRosMessageInit(&q->msgs[msg_ind]);
-  q->length = 0;
-  q->first_msg_ind = 0;
+
+  if(q->msgs.items != NULL)
+    return 0;
+
+  if(cRosRingBufferAlloc(&q->msgs) != 0)
+    return -1;
+
+  for(msg_ind=0;msg_ind<q->msgs.capacity;msg_ind++)
+    cRosMessageInit((cRosMessage *)cRosRingBufferGetSlot(&q->msgs, msg_ind));
+
+  return 0;
+}
+
+// The fields of a removed message stay in its slot, so that the next message added to the slot reuses their memory
+// (see cRosMessageFieldsCopy()). Only the fields that point into a received packet are freed, to release the packet
+static void releaseSlot(cRosMessage *slot)
+{
+  if(slot->borrowed_buffer != NULL)
+    cRosMessageFieldsFree(slot);
 }
 
 void cRosMessageQueueClear(cRosMessageQueue *q)
 {
   // Empty the queue
-  while(q->length > 0)
+  while(cRosMessageQueueRemove(q) == 0);
+}
+
+void cRosMessageQueueSetCapacity(cRosMessageQueue *q, unsigned int capacity)
+{
+  if(capacity == 0)
+    capacity = DEFAULT_QUEUE_LEN;
+
+  if(capacity == q->msgs.capacity)
   {
-    // Delete fields from message to remove
-    cRosMessageFieldsFree(&q->msgs[q->first_msg_ind]);
-    // The queue is internally implemented as a circular buffer
-    q->first_msg_ind = (q->first_msg_ind + 1) % MAX_QUEUE_LEN;
-    q->length--;
+    cRosMessageQueueClear(q);
+    return;
   }
-  q->first_msg_ind = 0;
+
+  cRosMessageQueueRelease(q);
+  cRosRingBufferInit(&q->msgs, sizeof(cRosMessage), capacity);
 }
 
 unsigned int cRosMessageQueueVacancies(cRosMessageQueue *q)
 {
-  return MAX_QUEUE_LEN - q->length;
+  return cRosRingBufferVacancies(&q->msgs);
 }
 
 unsigned int cRosMessageQueueUsage(cRosMessageQueue *q)
 {
-  return q->length;
+  return cRosRingBufferUsage(&q->msgs);
 }
 
 void cRosMessageQueueRelease(cRosMessageQueue *q)
@@ -42,20 +70,26 @@ void cRosMessageQueueRelease(cRosMessageQueue *q)
   unsigned int msg_ind;
   cRosMessageQueueClear(q);
   // Release the memory of all container messages in the queue
-  for(msg_ind=0;msg_ind<MAX_QUEUE_LEN;msg_ind++)
-    cRosMessageRelease(&q->msgs[msg_ind]);
+  if(q->msgs.items != NULL)
+  {
+    for(msg_ind=0;msg_ind<q->msgs.capacity;msg_ind++)
+      cRosMessageRelease((cRosMessage *)cRosRingBufferGetSlot(&q->msgs, msg_ind));
+  }
+  cRosRingBufferRelease(&q->msgs);
 }
 
 int cRosMessageQueueAdd(cRosMessageQueue *q, cRosMessage *m)
 {
   int ret;
-  if(q->length < MAX_QUEUE_LEN)
+  if(cRosRingBufferVacancies(&q->msgs) > 0)
   {
-    unsigned int next_msg_pos;
-    // The queue is internally implemented as a circular buffer
-    next_msg_pos = (q->first_msg_ind + q->length) % MAX_QUEUE_LEN;
-    ret = cRosMessageFieldsCopy(&q->msgs[next_msg_pos], m);
-    q->length++;
+    if(allocQueueMsgs(q) == 0)
+    {
+      ret = cRosMessageFieldsCopy((cRosMessage *)cRosRingBufferGetBack(&q->msgs), m);
+      cRosRingBufferPushBack(&q->msgs); // The message is visible to the consumer once it is filled
+    }
+    else
+      ret=-1;
   }
   else
     ret=-2;
@@ -63,14 +97,36 @@ int cRosMessageQueueAdd(cRosMessageQueue *q, cRosMessage *m)
   return ret;
 }
 
-int cRosMessageQueueGet(cRosMessageQueue *q, cRosMessage *m)
+// A queue slot can give its fields back in exchange for the added message if they are the storage of a previously extracted
+// message of the same type, so that the caller keeps a message ready to be filled again (e.g., by cRosMessageDeserialize()).
+// The fields of an arena message cannot be exchanged with the ones of the slots, which are allocated in the heap
+static int isSlotReusable(cRosMessage *slot, cRosMessage *m)
+{
+  return(m->arena == NULL && slot->fields != NULL && slot->n_fields == m->n_fields &&
+         slot->md5sum != NULL && m->md5sum != NULL && slot->md5sum[0] != '\0' && strcmp(slot->md5sum, m->md5sum) == 0);
+}
+
+int cRosMessageQueueAddSwap(cRosMessageQueue *q, cRosMessage *m)
 {
   int ret;
-  if(q->length > 0)
+  cRosMessage *slot;
+
+  if(cRosRingBufferVacancies(&q->msgs) > 0)
   {
-    cRosMessage *msg_to_peek;
-    msg_to_peek = &q->msgs[q->first_msg_ind];
-    ret = cRosMessageFieldsCopy(m, msg_to_peek);
+    if(allocQueueMsgs(q) == 0)
+    {
+      slot = (cRosMessage *)cRosRingBufferGetBack(&q->msgs);
+      if(isSlotReusable(slot, m))
+      {
+        cRosMessageFieldsSwap(slot, m);
+        ret=0;
+      }
+      else
+        ret = cRosMessageFieldsCopy(slot, m); // First time this slot receives a message of this type
+      cRosRingBufferPushBack(&q->msgs);
+    }
+    else
+      ret=-1;
   }
   else
     ret=-2;
@@ -78,19 +134,30 @@ int cRosMessageQueueGet(cRosMessageQueue *q, cRosMessage *m)
   return ret;
 }
 
+int cRosMessageQueueGet(cRosMessageQueue *q, cRosMessage *m)
+{
+  int ret;
+  cRosMessage *msg_to_peek;
+
+  msg_to_peek = (cRosMessage *)cRosRingBufferPeekFirst(&q->msgs);
+  if(msg_to_peek != NULL)
+    ret = cRosMessageFieldsCopy(m, msg_to_peek);
+  else
+    ret=-2;
+
+  return ret;
+}
+
 int cRosMessageQueueRemove(cRosMessageQueue *q)
 {
   int ret;
+  cRosMessage *msg_to_remove;
 
-  if(q->length > 0)
+  msg_to_remove = (cRosMessage *)cRosRingBufferPeekFirst(&q->msgs);
+  if(msg_to_remove != NULL)
   {
-    cRosMessage *msg_to_remove;
-    msg_to_remove = &q->msgs[q->first_msg_ind];
-    // Delete fields from removed message
-    cRosMessageFieldsFree(msg_to_remove);
-    // The queue is internally implemented as a circular buffer
-    q->first_msg_ind = (q->first_msg_ind + 1) % MAX_QUEUE_LEN;
-    q->length--;
+    releaseSlot(msg_to_remove);
+    cRosRingBufferPopFront(&q->msgs); // The slot is given back to the producer once it is released
     ret=0;
   }
   else
@@ -110,29 +177,34 @@ int cRosMessageQueueExtract(cRosMessageQueue *q, cRosMessage *m)
   return ret;
 }
 
-cRosMessage *cRosMessageQueuePeekFirst(cRosMessageQueue *q)
+int cRosMessageQueueExtractSwap(cRosMessageQueue *q, cRosMessage *m)
 {
-  cRosMessage *first_msg;
-  if(q->length > 0)
-    first_msg = &q->msgs[q->first_msg_ind];
-  else
-    first_msg = NULL;
+  int ret;
+  cRosMessage *msg_to_extract;
 
-  return first_msg;
-}
+  if(m->arena != NULL) // The fields of the queue messages, allocated in the heap, cannot be moved to an arena message
+    return cRosMessageQueueExtract(q, m);
 
-cRosMessage *cRosMessageQueuePeekLast(cRosMessageQueue *q)
-{
-  cRosMessage *last_msg;
-  if(q->length > 0)
+  msg_to_extract = (cRosMessage *)cRosRingBufferPeekFirst(&q->msgs);
+  if(msg_to_extract != NULL)
   {
-    unsigned int last_msg_pos;
-    // The queue is internally implemented as a circular buffer
-    last_msg_pos = (q->first_msg_ind + q->length - 1) % MAX_QUEUE_LEN;
-    last_msg = &q->msgs[last_msg_pos];
+    // The previous fields of m stay in the released slot, so that they can be reused by cRosMessageQueueAddSwap()
+    cRosMessageFieldsSwap(msg_to_extract, m);
+    cRosRingBufferPopFront(&q->msgs);
+    ret=0;
   }
   else
-    last_msg = NULL;
+    ret=-2;
+
+  return ret;
+}
 
-  return last_msg;
+cRosMessage *cRosMessageQueuePeekFirst(cRosMessageQueue *q)
+{
+  return (cRosMessage *)cRosRingBufferPeekFirst(&q->msgs);
+}
+
+cRosMessage *cRosMessageQueuePeekLast(cRosMessageQueue *q)
+{
+  return (cRosMessage *)cRosRingBufferPeekLast(&q->msgs);
 }
@@ -0,0 +1,170 @@
+#include <stdlib.h>
+#include <string.h>
+
+#include "cros_message_registry.h"
+#include "cros_message_internal.h"
+#include "cros_service_internal.h"
+#include "cros_defs.h"
+#include "dyn_string.h"
+
+#define REGISTRY_INITIAL_CAPACITY 8
+
+static void freeEntry( CrosMessageRegistryEntry *entry )
+{
+  if( entry == NULL )
+    return;
+
+  free( entry->file_path );
+  cRosMessageDefFree( entry->msg_def );
+  cRosServiceDefFree( entry->srv_def );
+  free( entry );
+}
+
+static CrosMessageRegistryEntry *findEntry( CrosMessageRegistry *reg, const char *file_path )
+{
+  int i;
+
+  for( i = 0; i < reg->n_entries; i++ )
+  {
+    if( strcmp( reg->entries[i]->file_path, file_path ) == 0 )
+      return reg->entries[i];
+  }
+  return NULL;
+}
+
+// Create an empty entry and append it to the registry
+static CrosMessageRegistryEntry *newEntry( CrosMessageRegistry *reg, const char *file_path )
+{
+  CrosMessageRegistryEntry *entry;
+
+  if( reg->n_entries == reg->capacity )
+  {
+    int new_capacity = ( reg->capacity > 0 )? reg->capacity * 2 : REGISTRY_INITIAL_CAPACITY;
+    CrosMessageRegistryEntry **new_entries = ( CrosMessageRegistryEntry ** ) realloc( reg->entries,
+                                                        new_capacity * sizeof( CrosMessageRegistryEntry * ) );
+    if( new_entries == NULL )
+      return NULL;
+    reg->entries = new_entries;
+    reg->capacity = new_capacity;
+  }
+
+  entry = ( CrosMessageRegistryEntry * ) calloc( 1, sizeof( CrosMessageRegistryEntry ) );
+  if( entry == NULL )
+    return NULL;
+
+  entry->file_path = strdup( file_path );
+  if( entry->file_path == NULL )
+  {
+    free( entry );
+    return NULL;
+  }
+
+  reg->entries[reg->n_entries++] = entry;
+  return entry;
+}
+
+// Remove the last entry of the registry (used when the definition of a new entry cannot be loaded)
+static void dropLastEntry( CrosMessageRegistry *reg )
+{
+  reg->n_entries--;
+  freeEntry( reg->entries[reg->n_entries] );
+}
+
+void cRosMessageRegistryInit( CrosMessageRegistry *reg )
+{
+  reg->entries = NULL;
+  reg->n_entries = 0;
+  reg->capacity = 0;
+}
+
+void cRosMessageRegistryRelease( CrosMessageRegistry *reg )
+{
+  int i;
+
+  for( i = 0; i < reg->n_entries; i++ )
+    freeEntry( reg->entries[i] );
+  free( reg->entries );
+  cRosMessageRegistryInit( reg );
+}
+
+cRosErrCodePack cRosMessageRegistryGetMsg( CrosMessageRegistry *reg, const char *msg_file_path,
+                                           const CrosMessageRegistryEntry **entry_ptr )
+{
+  cRosErrCodePack ret_err;
+  CrosMessageRegistryEntry *entry;
+
+  entry = findEntry( reg, msg_file_path );
+  if( entry != NULL && entry->msg_def != NULL )
+  {
+    *entry_ptr = entry;
+    return CROS_SUCCESS_ERR_PACK;
+  }
+
+  entry = newEntry( reg, msg_file_path );
+  if( entry == NULL )
+  {
+    PRINT_ERROR( "cRosMessageRegistryGetMsg() : Can't allocate memory\n" );
+    return CROS_MEM_ALLOC_ERR;
+  }
+
+  PRINT_VDEBUG( "cRosMessageRegistryGetMsg() : Loading message definition %s\n", msg_file_path );
+  ret_err = cRosMessageDefBuild( &entry->msg_def, NULL, msg_file_path );
+  if( ret_err == CROS_SUCCESS_ERR_PACK )
+  {
+    unsigned char *md5_res = getMD5Msg( entry->msg_def );
+    if( md5_res != NULL )
+    {
+      DynString md5_str;
+      dynStringInit( &md5_str );
+      cRosMD5Readable( md5_res, &md5_str );
+      free( md5_res );
+      strncpy( entry->md5sum, md5_str.data, sizeof( entry->md5sum ) - 1 );
+      dynStringRelease( &md5_str );
+    }
+    else
+      ret_err = CROS_MEM_ALLOC_ERR;
+  }
+
+  if( ret_err != CROS_SUCCESS_ERR_PACK )
+  {
+    dropLastEntry( reg );
+    return ret_err;
+  }
+
+  entry->message_definition = entry->msg_def->plain_text;
+  *entry_ptr = entry;
+  return CROS_SUCCESS_ERR_PACK;
+}
+
+cRosErrCodePack cRosMessageRegistryGetSrv( CrosMessageRegistry *reg, const char *srv_file_path,
+                                           const CrosMessageRegistryEntry **entry_ptr )
+{
+  cRosErrCodePack ret_err;
+  CrosMessageRegistryEntry *entry;
+
+  entry = findEntry( reg, srv_file_path );
+  if( entry != NULL && entry->srv_def != NULL )
+  {
+    *entry_ptr = entry;
+    return CROS_SUCCESS_ERR_PACK;
+  }
+
+  entry = newEntry( reg, srv_file_path );
+  if( entry == NULL )
+  {
+    PRINT_ERROR( "cRosMessageRegistryGetSrv() : Can't allocate memory\n" );
+    return CROS_MEM_ALLOC_ERR;
+  }
+
+  PRINT_VDEBUG( "cRosMessageRegistryGetSrv() : Loading service definition %s\n", srv_file_path );
+  ret_err = cRosServiceDefBuild( &entry->srv_def, entry->md5sum, srv_file_path );
+  if( ret_err != CROS_SUCCESS_ERR_PACK )
+  {
+    dropLastEntry( reg );
+    return ret_err;
+  }
+
+  entry->message_definition = entry->srv_def->plain_text;
+  *entry_ptr = entry;
+  return CROS_SUCCESS_ERR_PACK;
+}
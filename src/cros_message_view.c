@@ -0,0 +1,264 @@
+#include <string.h>
+
+#include "cros_message_view.h"
+
+// All the functions that read the encoded data keep pos <= size, so size - pos is the number of remaining bytes
+
+static int readLength(const unsigned char *data, size_t size, size_t *pos, uint32_t *len)
+{
+  if(size - *pos < sizeof(uint32_t))
+    return -1;
+
+  memcpy(len, data + *pos, sizeof(uint32_t));
+  *pos += sizeof(uint32_t);
+  return 0;
+}
+
+// Skip n values of n_bytes each
+static int skipBytes(size_t size, size_t *pos, uint32_t n, size_t n_bytes)
+{
+  if(n_bytes > 0 && n > (size - *pos) / n_bytes)
+    return -1;
+
+  *pos += (size_t)n * n_bytes;
+  return 0;
+}
+
+static int skipBlock(const CrosMessageLayout *layout, const unsigned char *data, size_t size, size_t *pos);
+
+// Skip n consecutive values of a field
+static int skipValues(const CrosMessageLayoutField *field, const unsigned char *data, size_t size, size_t *pos, uint32_t n)
+{
+  uint32_t val_ind, len;
+
+  if(field->child != NULL)
+  {
+    if(!field->child->has_external_data)
+      return skipBytes(size, pos, n, field->child->wire_size);
+
+    for(val_ind = 0; val_ind < n; val_ind++)
+    {
+      if(skipBlock(field->child, data, size, pos) != 0)
+        return -1;
+    }
+  }
+  else if(field->type == CROS_STD_MSGS_STRING)
+  {
+    for(val_ind = 0; val_ind < n; val_ind++)
+    {
+      if(readLength(data, size, pos, &len) != 0 || skipBytes(size, pos, len, 1) != 0)
+        return -1;
+    }
+  }
+  else
+    return skipBytes(size, pos, n, field->elem_size);
+
+  return 0;
+}
+
+// Move pos to the first value of a field, and get its number of values
+static int enterField(const CrosMessageLayoutField *field, const unsigned char *data, size_t size, size_t *pos, uint32_t *n_values)
+{
+  if(field->is_array && field->array_size < 0)
+    return readLength(data, size, pos, n_values);
+
+  *n_values = (field->is_array)? (uint32_t)field->array_size : 1;
+  return 0;
+}
+
+static int skipField(const CrosMessageLayoutField *field, const unsigned char *data, size_t size, size_t *pos)
+{
+  uint32_t n_values;
+
+  if(enterField(field, data, size, pos, &n_values) != 0)
+    return -1;
+  return skipValues(field, data, size, pos, n_values);
+}
+
+static int skipBlock(const CrosMessageLayout *layout, const unsigned char *data, size_t size, size_t *pos)
+{
+  int field_ind;
+
+  if(!layout->has_external_data)
+    return skipBytes(size, pos, 1, layout->wire_size);
+
+  for(field_ind = 0; field_ind < layout->n_fields; field_ind++)
+  {
+    if(skipField(&layout->fields[field_ind], data, size, pos) != 0)
+      return -1;
+  }
+  return 0;
+}
+
+// Find the position of a field, starting from the last indexed field before it
+static int locateField(cRosMessageView *view, int field_idx, size_t *pos)
+{
+  int field_ind;
+
+  if(field_idx < 0 || field_idx >= view->layout->n_fields)
+    return -1;
+
+  if(field_idx < view->n_indexed)
+  {
+    *pos = view->offsets[field_idx];
+    return 0;
+  }
+
+  field_ind = view->n_indexed - 1;
+  *pos = view->offsets[field_ind];
+  while(field_ind < field_idx)
+  {
+    if(skipField(&view->layout->fields[field_ind], view->data, view->size, pos) != 0)
+      return -1;
+
+    field_ind++;
+    if(field_ind < CROS_MESSAGE_VIEW_INDEX_SIZE)
+    {
+      view->offsets[field_ind] = *pos;
+      view->n_indexed = field_ind + 1;
+    }
+  }
+  return 0;
+}
+
+// Find the position of an element of an array field
+static int locateElement(cRosMessageView *view, int field_idx, uint32_t position, size_t *pos)
+{
+  const CrosMessageLayoutField *field;
+  uint32_t n_elems;
+
+  if(locateField(view, field_idx, pos) != 0)
+    return -1;
+
+  field = &view->layout->fields[field_idx];
+  if(!field->is_array || enterField(field, view->data, view->size, pos, &n_elems) != 0 || position >= n_elems)
+    return -1;
+
+  return skipValues(field, view->data, view->size, pos, position);
+}
+
+static int readString(const cRosMessageView *view, size_t pos, const char **str, uint32_t *len)
+{
+  if(readLength(view->data, view->size, &pos, len) != 0 || view->size - pos < *len)
+    return -1;
+
+  *str = (const char *)view->data + pos;
+  return 0;
+}
+
+void cRosMessageViewInit(cRosMessageView *view, const CrosMessageLayout *layout, const void *data, size_t size)
+{
+  view->layout = layout;
+  view->data = (const unsigned char *)data;
+  view->size = size;
+  view->offsets[0] = 0;
+  view->n_indexed = 1;
+}
+
+int cRosMessageViewGetValue(cRosMessageView *view, int field_idx, void *value)
+{
+  const CrosMessageLayoutField *field;
+  size_t pos;
+
+  if(locateField(view, field_idx, &pos) != 0)
+    return -1;
+
+  field = &view->layout->fields[field_idx];
+  if(field->is_array || field->child != NULL || field->type == CROS_STD_MSGS_STRING || view->size - pos < field->elem_size)
+    return -1;
+
+  memcpy(value, view->data + pos, field->elem_size);
+  return 0;
+}
+
+int cRosMessageViewGetString(cRosMessageView *view, int field_idx, const char **str, uint32_t *len)
+{
+  const CrosMessageLayoutField *field;
+  size_t pos;
+
+  if(locateField(view, field_idx, &pos) != 0)
+    return -1;
+
+  field = &view->layout->fields[field_idx];
+  if(field->is_array || field->type != CROS_STD_MSGS_STRING)
+    return -1;
+
+  return readString(view, pos, str, len);
+}
+
+int cRosMessageViewGetMsg(cRosMessageView *view, int field_idx, cRosMessageView *msg_view)
+{
+  const CrosMessageLayoutField *field;
+  size_t pos;
+
+  if(locateField(view, field_idx, &pos) != 0)
+    return -1;
+
+  field = &view->layout->fields[field_idx];
+  if(field->is_array || field->child == NULL)
+    return -1;
+
+  cRosMessageViewInit(msg_view, field->child, view->data + pos, view->size - pos);
+  return 0;
+}
+
+int cRosMessageViewGetArrayLength(cRosMessageView *view, int field_idx, uint32_t *n_elems)
+{
+  const CrosMessageLayoutField *field;
+  size_t pos;
+
+  if(locateField(view, field_idx, &pos) != 0)
+    return -1;
+
+  field = &view->layout->fields[field_idx];
+  if(!field->is_array)
+    return -1;
+
+  return enterField(field, view->data, view->size, &pos, n_elems);
+}
+
+int cRosMessageViewGetArray(cRosMessageView *view, int field_idx, const void **values, uint32_t *n_elems)
+{
+  const CrosMessageLayoutField *field;
+  size_t pos;
+
+  if(locateField(view, field_idx, &pos) != 0)
+    return -1;
+
+  field = &view->layout->fields[field_idx];
+  if(!field->is_array || field->child != NULL || field->type == CROS_STD_MSGS_STRING ||
+     enterField(field, view->data, view->size, &pos, n_elems) != 0)
+    return -1;
+
+  *values = view->data + pos;
+  return skipBytes(view->size, &pos, *n_elems, field->elem_size);
+}
+
+int cRosMessageViewGetArrayString(cRosMessageView *view, int field_idx, uint32_t position, const char **str, uint32_t *len)
+{
+  size_t pos;
+
+  if(field_idx < 0 || field_idx >= view->layout->n_fields || view->layout->fields[field_idx].type != CROS_STD_MSGS_STRING)
+    return -1;
+
+  if(locateElement(view, field_idx, position, &pos) != 0)
+    return -1;
+
+  return readString(view, pos, str, len);
+}
+
+int cRosMessageViewGetArrayMsg(cRosMessageView *view, int field_idx, uint32_t position, cRosMessageView *msg_view)
+{
+  const CrosMessageLayoutField *field;
+  size_t pos;
+
+  if(field_idx < 0 || field_idx >= view->layout->n_fields || view->layout->fields[field_idx].child == NULL)
+    return -1;
+
+  if(locateElement(view, field_idx, position, &pos) != 0)
+    return -1;
+
+  field = &view->layout->fields[field_idx];
+  cRosMessageViewInit(msg_view, field->child, view->data + pos, view->size - pos);
+  return 0;
+}
@@ -0,0 +1,52 @@
+#include "cros_mpsc_queue.h"
+
+void cRosMpscQueueInit( CrosMpscQueue *q )
+{
+  q->stub.next = NULL;
+  q->head = &q->stub;
+  q->tail = &q->stub;
+}
+
+void cRosMpscQueuePush( CrosMpscQueue *q, CrosMpscLink *link )
+{
+  CrosMpscLink *prev;
+
+  __atomic_store_n( &link->next, NULL, __ATOMIC_RELAXED );
+  prev = __atomic_exchange_n( &q->head, link, __ATOMIC_ACQ_REL );
+  // Until this store the link cannot be reached from the tail: the consumer sees the queue as empty from prev on
+  __atomic_store_n( &prev->next, link, __ATOMIC_RELEASE );
+}
+
+CrosMpscLink *cRosMpscQueuePop( CrosMpscQueue *q )
+{
+  CrosMpscLink *tail = q->tail;
+  CrosMpscLink *next = __atomic_load_n( &tail->next, __ATOMIC_ACQUIRE );
+
+  if( tail == &q->stub ) // Skip the stub
+  {
+    if( next == NULL )
+      return NULL;
+    q->tail = next;
+    tail = next;
+    next = __atomic_load_n( &tail->next, __ATOMIC_ACQUIRE );
+  }
+
+  if( next != NULL )
+  {
+    q->tail = next;
+    return tail;
+  }
+
+  if( tail != __atomic_load_n( &q->head, __ATOMIC_ACQUIRE ) )
+    return NULL; // A producer has not linked its object yet
+
+  // tail is the last object: the stub is pushed behind it so that it can be popped without emptying the list
+  cRosMpscQueuePush( q, &q->stub );
+  next = __atomic_load_n( &tail->next, __ATOMIC_ACQUIRE );
+  if( next != NULL )
+  {
+    q->tail = next;
+    return tail;
+  }
+  return NULL;
+}
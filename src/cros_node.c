@@ -5,6 +5,7 @@
 #include <errno.h>
 #include <ctype.h>
 #include <unistd.h>
+#include <limits.h> // for PATH_MAX
 
 #include "cros_node.h"
 #include "cros_api_internal.h"
@@ -15,6 +16,27 @@
 #include "cros_node_api.h"
 #include "cros_tcpros.h"
 #include "cros_log.h"
+#include "cros_poller.h"
+
+/*! Types of the node processes whose sockets are watched by the poller. When the select() backend
+ *  is used, the ready processes are attended in this order */
+typedef enum
+{
+  CN_PROC_XMLRPC_CLIENT = 0,
+  CN_PROC_XMLRPC_LISTNER,
+  CN_PROC_XMLRPC_SERVER,
+  CN_PROC_TCPROS_CLIENT,
+  CN_PROC_TCPROS_LISTNER,
+  CN_PROC_TCPROS_SERVER,
+  CN_PROC_RPCROS_CLIENT,
+  CN_PROC_RPCROS_LISTNER,
+  CN_PROC_RPCROS_SERVER,
+  CN_PROC_WAKEUP                        //! Not a process: the wake-up of the node loop from other threads
+} CrosNodeProcType;
+
+/*! Tag used to identify a process in the poller and in the timer heap: the process type and its index in the node arrays */
+#define CN_POLLER_TAG(proc_type, idx) ( ((uint64_t)(proc_type) << 32) | (uint32_t)(idx) )
+
 
 static void initPublisherNode(PublisherNode *node);
 static void initSubscriberNode(SubscriberNode *node);
@@ -27,10 +49,92 @@ static int enqueueServiceAdvertise(CrosNode *node, int servivceidx);
 static int enqueueServiceLookup(CrosNode *node, int serviceidx);
 static int enqueueParameterSubscription(CrosNode *node, int parameteridx);
 static int enqueueParameterUnsubscription(CrosNode *node, int parameteridx);
-static void getIdleXmplrpcClients(CrosNode *node, int array[], size_t *count);
 static int enqueueSlaveApiCallInternal(CrosNode *node, RosApiCall *call);
 static int enqueueMasterApiCallInternal(CrosNode *node, RosApiCall *call);
 static void printNodeProcState( CrosNode *n );
+static int getNodeProcCount( CrosNode *n, CrosNodeProcType proc_type );
+static CrosPollerEntry *getNodeProcPollerEntry( CrosNode *n, CrosNodeProcType proc_type, int i );
+static void failServiceCallerCalls( CrosNode *n, int svc_idx, cRosErrCodePack err );
+
+static void initPublisherSlot( void *slot ) { initPublisherNode( (PublisherNode *)slot ); }
+static void initSubscriberSlot( void *slot ) { initSubscriberNode( (SubscriberNode *)slot ); }
+static void initServiceProviderSlot( void *slot ) { initServiceProviderNode( (ServiceProviderNode *)slot ); }
+static void initServiceCallerSlot( void *slot ) { initServiceCallerNode( (ServiceCallerNode *)slot ); }
+static void initParameterSubscriptionSlot( void *slot ) { initParameterSubscrition( (ParameterSubscription *)slot ); }
+static void initXmlrpcProcessSlot( void *slot ) { xmlrpcProcessInit( (XmlrpcProcess *)slot ); }
+static void initTcprosProcessSlot( void *slot ) { tcprosProcessInit( (TcprosProcess *)slot ); }
+
+static void initNodeTable( CrosNodeTable *table )
+{
+  table->size = 0;
+  table->free_slots = NULL;
+  table->n_free_slots = 0;
+}
+
+static void releaseNodeTable( CrosNodeTable *table )
+{
+  free( table->free_slots );
+  initNodeTable( table );
+}
+
+/* Size of a node table after growing: tables double their size, so that the cost of the reallocations is amortized */
+static int getNodeTableGrowthSize( const CrosNodeTable *table )
+{
+  return ( table->size > 0 )? 2 * table->size : 1;
+}
+
+/* Enlarge the slot array of a node table to new_size slots, initializing the new slots with init_slot().
+ * If keep_free_slots is 1, the new slots are pushed to the free-slot stack so that the lowest index is used first.
+ * It returns the new slot array, or NULL on failure (then the slot array is not modified) */
+static void *growNodeTable( void *slots, size_t slot_size, CrosNodeTable *table, int new_size,
+                            int keep_free_slots, void (*init_slot)(void *) )
+{
+  char *new_slots;
+  int i;
+
+  if( new_size <= table->size )
+    return slots;
+
+  if( keep_free_slots )
+  {
+    int *new_free_slots = ( int * ) realloc( table->free_slots, new_size * sizeof(int) );
+    if( new_free_slots == NULL )
+      return NULL;
+    table->free_slots = new_free_slots;
+  }
+
+  new_slots = ( char * ) realloc( slots, new_size * slot_size );
+  if( new_slots == NULL )
+    return NULL;
+
+  for( i = table->size; i < new_size; i++ )
+    init_slot( new_slots + i * slot_size );
+
+  if( keep_free_slots )
+  {
+    for( i = new_size - 1; i >= table->size; i-- )
+      table->free_slots[table->n_free_slots++] = i;
+  }
+  table->size = new_size;
+
+  return new_slots;
+}
+
+/* Take the index of an unused slot from the free-slot stack of a table. Returns -1 if all the slots are in use */
+static int popNodeTableFreeSlot( CrosNodeTable *table )
+{
+  if( table->n_free_slots == 0 )
+    return -1;
+
+  return table->free_slots[--table->n_free_slots];
+}
+
+/* Give back a slot that is not used anymore to the free-slot stack of a table */
+static void pushNodeTableFreeSlot( CrosNodeTable *table, int idx )
+{
+  if( idx >= 0 && idx < table->size && table->n_free_slots < table->size )
+    table->free_slots[table->n_free_slots++] = idx;
+}
 
 static int openXmlrpcClientSocket( CrosNode *n, int i )
 {
@@ -83,13 +187,104 @@ static int openRpcrosClientSocket( CrosNode *n, int i )
   return(ret);
 }
 
+/* Enlarge the table of processes of type proc_type to new_size processes. The sockets of the new client
+ * processes are opened. It returns 0 on success, or -1 on failure */
+static int growNodeProcTable( CrosNode *n, CrosNodeProcType proc_type, int new_size )
+{
+  int i, old_size = getNodeProcCount( n, proc_type ), ret = 0;
+
+  if( new_size <= old_size )
+    return 0; // The table is already large enough
+
+  // The new processes are bound to the poller, so that their state changes update their watched events
+  if( cRosPollerReserveBindings( &n->poller, new_size - old_size ) != 0 )
+    return -1;
+
+  switch( proc_type )
+  {
+    case CN_PROC_XMLRPC_CLIENT:
+    {
+      XmlrpcProcess *new_procs;
+      new_procs = growNodeTable( n->xmlrpc_client_proc, sizeof(XmlrpcProcess), &n->xmlrpc_client_proc_table,
+                                 new_size, 0, initXmlrpcProcessSlot );
+      if( new_procs == NULL )
+        return -1;
+      n->xmlrpc_client_proc = new_procs;
+      for( i = old_size; i < new_size && ret == 0; i++ )
+        ret = openXmlrpcClientSocket( n, i );
+      break;
+    }
+    case CN_PROC_XMLRPC_SERVER:
+    {
+      XmlrpcProcess *new_procs = growNodeTable( n->xmlrpc_server_proc, sizeof(XmlrpcProcess), &n->xmlrpc_server_proc_table,
+                                                new_size, 0, initXmlrpcProcessSlot );
+      if( new_procs == NULL )
+        return -1;
+      n->xmlrpc_server_proc = new_procs;
+      break;
+    }
+    case CN_PROC_TCPROS_CLIENT:
+    {
+      TcprosProcess *new_procs;
+      new_procs = growNodeTable( n->tcpros_client_proc, sizeof(TcprosProcess), &n->tcpros_client_proc_table,
+                                 new_size, 0, initTcprosProcessSlot );
+      if( new_procs == NULL )
+        return -1;
+      n->tcpros_client_proc = new_procs;
+      for( i = old_size; i < new_size && ret == 0; i++ )
+        ret = openTcprosClientSocket( n, i );
+      break;
+    }
+    case CN_PROC_TCPROS_SERVER:
+    {
+      TcprosProcess *new_procs = growNodeTable( n->tcpros_server_proc, sizeof(TcprosProcess), &n->tcpros_server_proc_table,
+                                                new_size, 0, initTcprosProcessSlot );
+      if( new_procs == NULL )
+        return -1;
+      n->tcpros_server_proc = new_procs;
+      break;
+    }
+    case CN_PROC_RPCROS_CLIENT:
+    {
+      TcprosProcess *new_procs;
+      new_procs = growNodeTable( n->rpcros_client_proc, sizeof(TcprosProcess), &n->rpcros_client_proc_table,
+                                 new_size, 0, initTcprosProcessSlot );
+      if( new_procs == NULL )
+        return -1;
+      n->rpcros_client_proc = new_procs;
+      for( i = old_size; i < new_size && ret == 0; i++ )
+        ret = openRpcrosClientSocket( n, i );
+      break;
+    }
+    case CN_PROC_RPCROS_SERVER:
+    {
+      TcprosProcess *new_procs = growNodeTable( n->rpcros_server_proc, sizeof(TcprosProcess), &n->rpcros_server_proc_table,
+                                                new_size, 0, initTcprosProcessSlot );
+      if( new_procs == NULL )
+        return -1;
+      n->rpcros_server_proc = new_procs;
+      break;
+    }
+    default:
+      return -1; // Listeners are not kept in tables
+  }
+
+  for( i = old_size; i < new_size; i++ )
+    cRosPollerEntryBind( &n->poller, getNodeProcPollerEntry( n, proc_type, i ), CN_POLLER_TAG( proc_type, i ) );
+
+  if( ret != 0 )
+    PRINT_ERROR( "growNodeProcTable() : The sockets of the new client processes could not be opened\n" );
+
+  return ret;
+}
+
 static int openXmlrpcListnerSocket( CrosNode *n )
 {
   int ret;
   if( !tcpIpSocketOpen( &(n->xmlrpc_listner_proc.socket) ) ||
       !tcpIpSocketSetReuse( &(n->xmlrpc_listner_proc.socket) ) ||
       !tcpIpSocketSetNonBlocking( &(n->xmlrpc_listner_proc.socket) ) ||
-      !tcpIpSocketBindListen( &(n->xmlrpc_listner_proc.socket), n->host, 0, CN_MAX_XMLRPC_SERVER_CONNECTIONS ) )
+      !tcpIpSocketBindListen( &(n->xmlrpc_listner_proc.socket), n->host, 0, n->xmlrpc_server_proc_table.size ) )
   {
     PRINT_ERROR("openXmlrpcListnerSocket() failed");
     ret=-1;
@@ -109,7 +304,7 @@ static int openRpcrosListnerSocket( CrosNode *n )
   if( !tcpIpSocketOpen( &(n->rpcros_listner_proc.socket) ) ||
       !tcpIpSocketSetReuse( &(n->rpcros_listner_proc.socket) ) ||
       !tcpIpSocketSetNonBlocking( &(n->rpcros_listner_proc.socket) ) ||
-      !tcpIpSocketBindListen( &(n->rpcros_listner_proc.socket), n->host, 0, CN_MAX_RPCROS_SERVER_CONNECTIONS ) )
+      !tcpIpSocketBindListen( &(n->rpcros_listner_proc.socket), n->host, 0, n->rpcros_server_proc_table.size ) )
   {
     PRINT_ERROR("openRpcrosListnerSocket() failed");
     ret=-1;
@@ -129,7 +324,7 @@ static int openTcprosListnerSocket( CrosNode *n )
   if( !tcpIpSocketOpen( &(n->tcpros_listner_proc.socket) ) ||
       !tcpIpSocketSetReuse( &(n->tcpros_listner_proc.socket) ) ||
       !tcpIpSocketSetNonBlocking( &(n->tcpros_listner_proc.socket) ) ||
-      !tcpIpSocketBindListen( &(n->tcpros_listner_proc.socket), n->host, 0, CN_MAX_TCPROS_SERVER_CONNECTIONS ) )
+      !tcpIpSocketBindListen( &(n->tcpros_listner_proc.socket), n->host, 0, n->tcpros_server_proc_table.size ) )
   {
     PRINT_ERROR("openTcprosListnerSocket() failed");
     ret=-1;
@@ -178,9 +373,11 @@ static void handleApiCallAttempt(CrosNode *node, RosApiCall *call)
         callback(&status, pub->context);
       }
 
-      // Finally release publisher
+      // Finally release publisher (the callback may have enlarged the table, so pub is not used anymore)
       cRosApiReleasePublisher(node, call->provider_idx);
-      initPublisherNode(pub);
+      initPublisherNode(&node->pubs[call->provider_idx]);
+      pushNodeTableFreeSlot(&node->pubs_table, call->provider_idx);
+      node->n_pubs--;
       call->provider_idx = -1;
       break;
     }
@@ -200,7 +397,9 @@ static void handleApiCallAttempt(CrosNode *node, RosApiCall *call)
 
       // Finally release subscriber
       cRosApiReleaseSubscriber(node, call->provider_idx);
-      initSubscriberNode(sub);
+      initSubscriberNode(&node->subs[call->provider_idx]);
+      pushNodeTableFreeSlot(&node->subs_table, call->provider_idx);
+      node->n_subs--;
       call->provider_idx = -1;
       break;
     }
@@ -220,7 +419,9 @@ static void handleApiCallAttempt(CrosNode *node, RosApiCall *call)
 
       // Finally release service provider
       cRosApiReleaseServiceProvider(node, call->provider_idx);
-      initServiceProviderNode(service);
+      initServiceProviderNode(&node->service_providers[call->provider_idx]);
+      pushNodeTableFreeSlot(&node->service_providers_table, call->provider_idx);
+      node->n_service_providers--;
       call->provider_idx = -1;
       break;
     }
@@ -242,8 +443,11 @@ static void handleApiCallAttempt(CrosNode *node, RosApiCall *call)
       }
 
       // Finally release parameter subscription
+      subscription = &node->paramsubs[call->provider_idx];
       cRosNodeReleaseParameterSubscrition(subscription);
       initParameterSubscrition(subscription);
+      pushNodeTableFreeSlot(&node->paramsubs_table, call->provider_idx);
+      node->n_paramsubs--;
       call->provider_idx = -1;
       break;
     }
@@ -328,6 +532,7 @@ static void handleRpcrosClientError(CrosNode *n, int i)
 {
   TcprosProcess *process = &n->rpcros_client_proc[i];
   closeTcprosProcess(process);
+  failServiceCallerCalls(n, i, CROS_RPCROS_CLI_CONN_ERR); // The calls posted by other threads can no longer be sent
 }
 
 static void handleRpcrosServerError(CrosNode *n, int i)
@@ -836,6 +1041,7 @@ static cRosErrCodePack doWithTcprosClientSocket( CrosNode *n, int client_idx)
             ROS_TO_HOST_UINT32(*((uint32_t *)data), msg_size);
             tcprosProcessClear( client_proc, 0);
             client_proc->left_to_recv = msg_size;
+            cRosMessageStartPublicationStream( n, client_idx, msg_size );
             tcprosProcessChangeState( client_proc, TCPROS_PROCESS_STATE_READING);
             goto read_msg;
           }
@@ -854,18 +1060,25 @@ static cRosErrCodePack doWithTcprosClientSocket( CrosNode *n, int client_idx)
     case TCPROS_PROCESS_STATE_READING:
     {
       size_t n_reads;
+      int decoding = tcprosProcessIsDecoding( client_proc );
+      // A message decoded while it is received is read in chunks, so that the packet holds only one chunk at a time
+      size_t max_reads = ( decoding && client_proc->left_to_recv > CN_SUBSCRIBER_STREAM_CHUNK_SIZE )?
+                         CN_SUBSCRIBER_STREAM_CHUNK_SIZE : client_proc->left_to_recv;
       TcpIpSocketState sock_state = tcpIpSocketReadBufferEx( &(client_proc->socket),
                                                           &(client_proc->packet),
-                                                          client_proc->left_to_recv,
+                                                          max_reads,
                                                           &n_reads);
 
       switch ( sock_state )
       {
         case TCPIPSOCKET_DONE:
           client_proc->left_to_recv -= n_reads;
+          if (decoding)
+            ret_err = cRosMessageParsePublicationChunk(n, client_idx);
           if (client_proc->left_to_recv == 0)
           {
-              ret_err = cRosMessageParsePublicationPacket(n, client_idx);
+              if (!decoding)
+                ret_err = cRosMessageParsePublicationPacket(n, client_idx);
               tcprosProcessClear( client_proc, 0);
               client_proc->left_to_recv = sizeof(uint32_t);
               tcprosProcessChangeState( client_proc, TCPROS_PROCESS_STATE_READING_SIZE );
@@ -890,6 +1103,46 @@ static cRosErrCodePack doWithTcprosClientSocket( CrosNode *n, int client_idx)
   return ret_err;
 }
 
+/* Move the connection of a TCPROS server process to the least loaded I/O shard that is still running. If it cannot be
+   moved, the process keeps sending its messages from the node loop */
+static void shardTcprosServerProc( CrosNode *n, int i )
+{
+  TcprosProcess *proc = &n->tcpros_server_proc[i];
+  CrosIoShardMsg *msg;
+  int s, min_s = -1;
+
+  for( s = 0; s < n->n_io_shards; s++ )
+  {
+    if( !cRosIoShardHasFailed( &n->io_shards[s] ) && ( min_s < 0 || n->io_shards[s].load < n->io_shards[min_s].load ) )
+      min_s = s;
+  }
+  if( min_s < 0 )
+    return;
+
+  msg = cRosIoShardNewMsg( CROS_IO_SHARD_ADOPT );
+  if( msg == NULL )
+    return;
+  msg->conn = (TcprosProcess *)malloc( sizeof(TcprosProcess) );
+  if( msg->conn == NULL )
+  {
+    PRINT_ERROR ( "shardTcprosServerProc() : Can't allocate memory\n" );
+    cRosIoShardFreeMsg( msg );
+    return;
+  }
+  tcprosProcessInit( msg->conn );
+  msg->conn->topic_idx = proc->topic_idx;
+  msg->server_idx = i;
+
+  // Stop watching the socket before it changes hands (the poller identifies the epoll registration by its file descriptor)
+  cRosPollerWatch( &n->poller, &proc->poller_entry, tcpIpSocketGetFD( &proc->socket ), 0, proc->state_changes,
+                   CN_POLLER_TAG( CN_PROC_TCPROS_SERVER, i ) );
+  tcprosProcessMoveStream( msg->conn, proc );
+  proc->io_shard = min_s;
+  tcprosProcessChangeState( proc, TCPROS_PROCESS_STATE_SHARDED );
+  n->io_shards[min_s].load++;
+  cRosIoShardPost( &n->io_shards[min_s], msg );
+}
+
 static cRosErrCodePack doWithTcprosServerSocket( CrosNode *n, int i )
 {
   cRosErrCodePack ret_err;
@@ -951,10 +1204,15 @@ static cRosErrCodePack doWithTcprosServerSocket( CrosNode *n, int i )
     {
       tcprosProcessClear( server_proc, 0 );
       ret_err = cRosMessagePreparePublicationPacket( n, i );
+      server_proc = &(n->tcpros_server_proc[i]); // The node tables may have been moved by the callback
       tcprosProcessChangeState( server_proc, TCPROS_PROCESS_STATE_WRITING );
     }
-    TcpIpSocketState sock_state =  tcpIpSocketWriteBuffer( &(server_proc->socket),
-                                                           &(server_proc->packet) );
+    TcpIpSocketState sock_state;
+    if( server_proc->frame != NULL ) // Message packet shared with the other subscribers of the topic
+      sock_state = tcpIpSocketWriteBufferEx( &(server_proc->socket), &(server_proc->frame->packet),
+                                             &(server_proc->frame_pos_offset) );
+    else
+      sock_state = tcpIpSocketWriteBuffer( &(server_proc->socket), &(server_proc->packet) );
 
     switch ( sock_state )
     {
@@ -962,6 +1220,8 @@ static cRosErrCodePack doWithTcprosServerSocket( CrosNode *n, int i )
         PRINT_DEBUG ( "doWithTcprosServerSocket() : Done write() with no error\n" );
         tcprosProcessClear( server_proc, 0);
         tcprosProcessChangeState( server_proc, TCPROS_PROCESS_STATE_WAIT_FOR_WRITING );
+        if( n->n_io_shards > 0 )
+          shardTcprosServerProc( n, i );
         break;
 
       case TCPIPSOCKET_IN_PROGRESS:
@@ -1166,6 +1426,7 @@ static cRosErrCodePack doWithRpcrosClientSocket(CrosNode *n, int client_idx)
     {
       tcprosProcessClear(client_proc, 0);
       ret_err = cRosMessagePrepareServiceCallPacket(n, client_idx);
+      client_proc = &(n->rpcros_client_proc[client_idx]); // The node tables may have been moved by the callback
       tcprosProcessChangeState( client_proc, TCPROS_PROCESS_STATE_WRITING );
     }
 
@@ -1251,6 +1512,7 @@ static cRosErrCodePack doWithRpcrosClientSocket(CrosNode *n, int client_idx)
           if (client_proc->left_to_recv == 0)
           {
               ret_err = cRosMessageParseServiceResponsePacket(n, client_idx);
+              client_proc = &(n->rpcros_client_proc[client_idx]); // The node tables may have been moved by the callback
               if(client_proc->persistent)
               {
                 tcprosProcessClear( client_proc, 0);
@@ -1454,6 +1716,8 @@ static cRosErrCodePack doWithRpcrosServerSocket(CrosNode *n, int i)
             if (msg_size == 0)
             {
               PRINT_DEBUG ( "doWithRpcrosServerSocket() : Done read() with no error\n" );
+              if( cRosMessageDispatchServiceRequest(n, i) == 0 )
+                break; // A worker thread prepares the response
               ret_err = cRosMessagePrepareServiceResponsePacket(n, i);
               tcprosProcessChangeState( server_proc, TCPROS_PROCESS_STATE_WRITING);
               goto write_msg;
@@ -1494,8 +1758,11 @@ static cRosErrCodePack doWithRpcrosServerSocket(CrosNode *n, int i)
           if (server_proc->left_to_recv == 0)
           {
               PRINT_DEBUG ( "doWithRpcrosServerSocket() : Done read() with no error\n" );
-              ret_err = cRosMessagePrepareServiceResponsePacket(n, i);
-              tcprosProcessChangeState( server_proc, TCPROS_PROCESS_STATE_WRITING );
+              if( cRosMessageDispatchServiceRequest(n, i) != 0 ) // Otherwise a worker thread prepares the response
+              {
+                ret_err = cRosMessagePrepareServiceResponsePacket(n, i);
+                tcprosProcessChangeState( server_proc, TCPROS_PROCESS_STATE_WRITING );
+              }
           }
           break;
         case TCPIPSOCKET_IN_PROGRESS:
@@ -1645,47 +1912,91 @@ static char* LogLevelToString(CrosLogLevel log_level)
   return ret;
 }
 
+// Resolve the handle of a field of the /rosout messages, checking that it has the type that callback_pub_log() writes
+static int resolveRosoutField(cRosMessage *message, const char *field_path, CrosMessageType type, int is_array,
+                              cRosMessageFieldHandle *handle)
+{
+  cRosMessageField *field;
+
+  if(cRosMessageFieldHandleResolve(message, field_path, handle) != 0)
+    return -1;
+
+  field = cRosMessageGetFieldByHandle(message, handle);
+  return (field != NULL && field->type == type && field->is_array == is_array)? 0 : -1;
+}
+
+/* Resolve the handles of the fields of the /rosout messages from the rosgraph_msgs/Log definition of the node */
+static int resolveRosoutFields(CrosNode *node)
+{
+  CrosRosoutFields *fields = &node->rosout_fields;
+  const CrosMessageRegistryEntry *log_type;
+  cRosMessage *message;
+  char path[PATH_MAX];
+
+  cRosGetMsgFilePath(node, path, PATH_MAX, "rosgraph_msgs/Log");
+  if(cRosMessageRegistryGetMsg(&node->msg_registry, path, &log_type) != CROS_SUCCESS_ERR_PACK ||
+     cRosMessageBuildFromDef(&message, log_type->msg_def) != CROS_SUCCESS_ERR_PACK)
+    return -1;
+
+  fields->resolved =
+    resolveRosoutField(message, "header.seq", CROS_STD_MSGS_UINT32, 0, &fields->seq) == 0 &&
+    resolveRosoutField(message, "header.stamp.secs", CROS_STD_MSGS_UINT32, 0, &fields->stamp_secs) == 0 &&
+    resolveRosoutField(message, "header.stamp.nsecs", CROS_STD_MSGS_UINT32, 0, &fields->stamp_nsecs) == 0 &&
+    resolveRosoutField(message, "header.frame_id", CROS_STD_MSGS_STRING, 0, &fields->frame_id) == 0 &&
+    resolveRosoutField(message, "level", CROS_STD_MSGS_BYTE, 0, &fields->level) == 0 &&
+    resolveRosoutField(message, "name", CROS_STD_MSGS_STRING, 0, &fields->name) == 0 &&
+    resolveRosoutField(message, "msg", CROS_STD_MSGS_STRING, 0, &fields->msg) == 0 &&
+    resolveRosoutField(message, "file", CROS_STD_MSGS_STRING, 0, &fields->file) == 0 &&
+    resolveRosoutField(message, "function", CROS_STD_MSGS_STRING, 0, &fields->function) == 0 &&
+    resolveRosoutField(message, "line", CROS_STD_MSGS_UINT32, 0, &fields->line) == 0 &&
+    resolveRosoutField(message, "topics", CROS_STD_MSGS_STRING, 1, &fields->topics) == 0;
+
+  cRosMessageFree(message);
+  return (fields->resolved)? 0 : -1;
+}
+
 static CallbackResponse callback_pub_log(cRosMessage *message, void* data_context)
 {
   CrosNode* node = (CrosNode*) data_context;
   CrosLogQueue* queue = node->log_queue;
+  CrosRosoutFields *fields = &node->rosout_fields; // Resolved when the /rosout publisher was registered
 
   if(!cRosLogQueueIsEmpty(queue))
   {
-    CrosLog* log = cRosLogQueueDequeue(queue);
+    cRosMessageField *seq = cRosMessageGetFieldByHandle(message, &fields->seq);
+    cRosMessageField *stamp_secs = cRosMessageGetFieldByHandle(message, &fields->stamp_secs);
+    cRosMessageField *stamp_nsecs = cRosMessageGetFieldByHandle(message, &fields->stamp_nsecs);
+    cRosMessageField *frame_id = cRosMessageGetFieldByHandle(message, &fields->frame_id);
+    cRosMessageField *level = cRosMessageGetFieldByHandle(message, &fields->level);
+    cRosMessageField *name = cRosMessageGetFieldByHandle(message, &fields->name);
+    cRosMessageField *msg = cRosMessageGetFieldByHandle(message, &fields->msg);
+    cRosMessageField *file = cRosMessageGetFieldByHandle(message, &fields->file);
+    cRosMessageField *function = cRosMessageGetFieldByHandle(message, &fields->function);
+    cRosMessageField *line = cRosMessageGetFieldByHandle(message, &fields->line);
+    cRosMessageField *topics = cRosMessageGetFieldByHandle(message, &fields->topics);
+    if(seq == NULL || stamp_secs == NULL || stamp_nsecs == NULL || frame_id == NULL || level == NULL || name == NULL ||
+       msg == NULL || file == NULL || function == NULL || line == NULL || topics == NULL)
+    {
+      PRINT_ERROR ( "callback_pub_log() : The /rosout message does not have the fields of rosgraph_msgs/Log\n" );
+      return 1;
+    }
 
-    cRosMessageField* header_field = cRosMessageGetField(message, "header");
-    cRosMessage* header_msg = header_field->data.as_msg;
-    cRosMessageField* seq_id = cRosMessageGetField(header_msg, "seq");
-    seq_id->data.as_uint32 = node->log_last_id++;
-    cRosMessageField* time_field = cRosMessageGetField(header_msg, "stamp");
-    cRosMessage* time_msg = time_field->data.as_msg;
-    cRosMessageField* time_secs = cRosMessageGetField(time_msg, "secs");
-    time_secs->data.as_uint32 = log->secs;
-    cRosMessageField* time_nsecs = cRosMessageGetField(time_msg, "nsecs");
-    time_nsecs->data.as_uint32 = log->nsecs;
-    cRosMessageSetFieldValueString(cRosMessageGetField(header_msg, "frame_id"), "0");
+    CrosLog* log = cRosLogQueueDequeue(queue);
 
+    seq->data.as_uint32 = node->log_last_id++;
+    stamp_secs->data.as_uint32 = log->secs;
+    stamp_nsecs->data.as_uint32 = log->nsecs;
+    cRosMessageSetFieldValueString(frame_id, "0");
 
-    cRosMessageField* level = cRosMessageGetField(message, "level");
     level->data.as_uint8 = log->level;
-
-    cRosMessageField* name = cRosMessageGetField(message, "name"); //name of the node
-    cRosMessageSetFieldValueString(name, node->name);
-
-    cRosMessageField* msg = cRosMessageGetField(message, "msg"); //message
-    cRosMessageSetFieldValueString(msg, log->msg);
-
-    cRosMessageField* file = cRosMessageGetField(message, "file"); //file the message came from
-    cRosMessageSetFieldValueString(file, log->file);
-
-    cRosMessageField* function = cRosMessageGetField(message, "function"); //function the message came from
-    cRosMessageSetFieldValueString(function, log->function);
-
-    cRosMessageField* line = cRosMessageGetField(message, "line"); //line the message came from
-    line->data.as_uint32 = log->line;
-
-    cRosMessageField* topics = cRosMessageGetField(message, "topics"); //topic names that the node publishes
+    cRosMessageSetFieldValueString(name, node->name); //name of the node
+    cRosMessageSetFieldValueString(msg, log->msg); //message
+    cRosMessageSetFieldValueString(file, log->file); //file the message came from
+    cRosMessageSetFieldValueString(function, log->function); //function the message came from
+    line->data.as_uint32 = log->line; //line the message came from
+
+    //topic names that the node publishes
+    cRosMessageFieldArrayClear(topics); // The message is reused for every log entry
     int i;
     for(i = 0; i < log->n_pubs; i++)
     {
@@ -1712,10 +2023,18 @@ static CallbackResponse callback_srv_get_loggers(cRosMessage *request, cRosMessa
   cRosMessageField* loggers = cRosMessageGetField(response, "loggers");
 
   cRosMessage* logger_msg;
+  const CrosMessageRegistryEntry *logger_type;
+  char path[PATH_MAX];
 
   CrosNode* node = (CrosNode*) context;
 
-  cRosMessageNewBuild(node->message_root_path, "roscpp/Logger", &logger_msg);
+  cRosGetMsgFilePath(node, path, PATH_MAX, "roscpp/Logger");
+  if(cRosMessageRegistryGetMsg(&node->msg_registry, path, &logger_type) != CROS_SUCCESS_ERR_PACK ||
+     cRosMessageBuildFromDef(&logger_msg, logger_type->msg_def) != CROS_SUCCESS_ERR_PACK)
+  {
+    PRINT_ERROR("callback_srv_get_loggers() : The roscpp/Logger message could not be built\n");
+    return 1;
+  }
 
   cRosMessageField* logger = cRosMessageGetField(logger_msg, "name");
   cRosMessageSetFieldValueString(logger, "ros.cros_node");
@@ -1830,8 +2149,97 @@ char* cRosNamespaceBuild(CrosNode* node, const char* resource_name)
 
 CrosNode *cRosNodeCreate (char* node_name, char *node_host, char *roscore_host, unsigned short roscore_port,
                           char *message_root_path)
+{
+  return cRosNodeCreateWithConfig(node_name, node_host, roscore_host, roscore_port, message_root_path, NULL);
+}
+
+CrosNode *cRosNodeCreateWithPoller (char* node_name, char *node_host, char *roscore_host, unsigned short roscore_port,
+                                    char *message_root_path, CrosPollerBackend poller_backend)
+{
+  CrosNodeConfig config;
+
+  cRosNodeConfigInit(&config);
+  config.poller_backend = poller_backend;
+  return cRosNodeCreateWithConfig(node_name, node_host, roscore_host, roscore_port, message_root_path, &config);
+}
+
+void cRosNodeConfigInit( CrosNodeConfig *config )
+{
+  config->poller_backend = CROS_POLLER_SELECT;
+  config->published_topics = CN_MAX_PUBLISHED_TOPICS;
+  config->subscribed_topics = CN_MAX_SUBSCRIBED_TOPICS;
+  config->service_providers = CN_MAX_SERVICE_PROVIDERS;
+  config->service_callers = CN_MAX_SERVICE_CALLERS;
+  config->parameter_subscriptions = CN_MAX_PARAMETER_SUBSCRIPTIONS;
+  config->xmlrpc_client_connections = CN_MAX_XMLRPC_CLIENT_CONNECTIONS;
+  config->xmlrpc_server_connections = CN_MAX_XMLRPC_SERVER_CONNECTIONS;
+  config->tcpros_client_connections = CN_MAX_TCPROS_CLIENT_CONNECTIONS;
+  config->tcpros_server_connections = CN_MAX_TCPROS_SERVER_CONNECTIONS;
+  config->rpcros_server_connections = CN_MAX_RPCROS_SERVER_CONNECTIONS;
+  config->tcpros_out_queue_length = CN_TCPROS_OUT_QUEUE_LENGTH;
+  config->tcpros_out_queue_policy = CROS_OUT_QUEUE_DROP_OLDEST;
+  config->tcpros_io_shards = 0;
+}
+
+/* Allocate the initial node tables. The process tables must be allocated before opening the sockets */
+static int initNodeTables( CrosNode *n, const CrosNodeConfig *config )
+{
+  int xmlrpc_client_connections;
+
+  // The first XMLRPC client is reserved to roscore, so one more is needed at least for the calls to other nodes
+  xmlrpc_client_connections = ( config->xmlrpc_client_connections > 2 )? config->xmlrpc_client_connections : 2;
+
+  n->pubs = growNodeTable( NULL, sizeof(PublisherNode), &n->pubs_table,
+                           config->published_topics, 1, initPublisherSlot );
+  n->subs = growNodeTable( NULL, sizeof(SubscriberNode), &n->subs_table,
+                           config->subscribed_topics, 1, initSubscriberSlot );
+  n->service_providers = growNodeTable( NULL, sizeof(ServiceProviderNode), &n->service_providers_table,
+                                        config->service_providers, 1, initServiceProviderSlot );
+  n->service_callers = growNodeTable( NULL, sizeof(ServiceCallerNode), &n->service_callers_table,
+                                      config->service_callers, 1, initServiceCallerSlot );
+  n->paramsubs = growNodeTable( NULL, sizeof(ParameterSubscription), &n->paramsubs_table,
+                                config->parameter_subscriptions, 1, initParameterSubscriptionSlot );
+  if( ( config->published_topics > 0 && n->pubs == NULL ) ||
+      ( config->subscribed_topics > 0 && n->subs == NULL ) ||
+      ( config->service_providers > 0 && n->service_providers == NULL ) ||
+      ( config->service_callers > 0 && n->service_callers == NULL ) ||
+      ( config->parameter_subscriptions > 0 && n->paramsubs == NULL ) )
+    return -1;
+
+  // Listening sockets need a backlog of one connection at least
+  if( growNodeProcTable( n, CN_PROC_XMLRPC_CLIENT, xmlrpc_client_connections ) != 0 ||
+      growNodeProcTable( n, CN_PROC_XMLRPC_SERVER, ( config->xmlrpc_server_connections > 1 )? config->xmlrpc_server_connections : 1 ) != 0 ||
+      growNodeProcTable( n, CN_PROC_TCPROS_CLIENT, config->tcpros_client_connections ) != 0 ||
+      growNodeProcTable( n, CN_PROC_TCPROS_SERVER, ( config->tcpros_server_connections > 1 )? config->tcpros_server_connections : 1 ) != 0 ||
+      growNodeProcTable( n, CN_PROC_RPCROS_CLIENT, n->service_callers_table.size ) != 0 ||
+      growNodeProcTable( n, CN_PROC_RPCROS_SERVER, ( config->rpcros_server_connections > 1 )? config->rpcros_server_connections : 1 ) != 0 )
+    return -1;
+
+  return 0;
+}
+
+#if defined(__APPLE__)
+#  define CN_RECV_COND_CLOCK CLOCK_REALTIME // pthread_condattr_setclock() is not available
+#else
+#  define CN_RECV_COND_CLOCK CLOCK_MONOTONIC // The wait of the receiving threads is not affected by wall-clock changes
+#endif
+
+static void initRecvCond( pthread_cond_t *cond )
+{
+  pthread_condattr_t attr;
+  pthread_condattr_init( &attr );
+#if !defined(__APPLE__)
+  pthread_condattr_setclock( &attr, CN_RECV_COND_CLOCK );
+#endif
+  pthread_cond_init( cond, &attr );
+  pthread_condattr_destroy( &attr );
+}
+
+CrosNode *cRosNodeCreateWithConfig (char* node_name, char *node_host, char *roscore_host, unsigned short roscore_port,
+                                    char *message_root_path, const CrosNodeConfig *config)
 {
   CrosNode *new_n; // Value to be returned by this function. NULL on failure
+  CrosNodeConfig default_config;
   PRINT_VDEBUG ( "cRosNodeCreate()\n" );
 
   signal(SIGPIPE, SIG_IGN);
@@ -1842,6 +2250,12 @@ CrosNode *cRosNodeCreate (char* node_name, char *node_host, char *roscore_host,
     return NULL;
   }
 
+  if(config == NULL)
+  {
+    cRosNodeConfigInit(&default_config);
+    config = &default_config;
+  }
+
   new_n = ( CrosNode * ) malloc ( sizeof ( CrosNode ) );
 
   if ( new_n == NULL )
@@ -1850,7 +2264,75 @@ CrosNode *cRosNodeCreate (char* node_name, char *node_host, char *roscore_host,
     return NULL;
   }
 
-  new_n->name = new_n->host = new_n->roscore_host = NULL;
+  // Initial size of the poller event list: all the initial processes (and the listeners)
+  if( cRosPollerInit( &(new_n->poller), config->poller_backend,
+                      config->xmlrpc_client_connections + config->xmlrpc_server_connections +
+                      config->tcpros_client_connections + config->tcpros_server_connections +
+                      config->service_callers + config->rpcros_server_connections + 3 ) != 0 )
+  {
+    PRINT_ERROR ( "cRosNodeCreate() : The poller could not be initialized\n" );
+    free( new_n );
+    return NULL;
+  }
+
+  new_n->name = new_n->host = new_n->roscore_host = new_n->message_root_path = NULL;
+  new_n->tcpros_out_queue_length = ( config->tcpros_out_queue_length > 0 )? config->tcpros_out_queue_length : 1;
+  new_n->tcpros_out_queue_policy = config->tcpros_out_queue_policy;
+  new_n->tcpros_io_shards = ( config->tcpros_io_shards < 0 )? 0 :
+                            ( config->tcpros_io_shards > CN_MAX_IO_SHARDS )? CN_MAX_IO_SHARDS : config->tcpros_io_shards;
+  cRosTimerHeapInit( &(new_n->timers) );
+
+  cRosWakeupInit( &(new_n->wakeup) );
+  cRosExecutorInit( &(new_n->executor) );
+  new_n->io_thread_running = 0;
+  cRosMpscQueueInit( &(new_n->posted_frames) );
+  cRosMpscQueueInit( &(new_n->posted_calls) );
+  new_n->posts_pending = 0;
+  initRecvCond( &(new_n->recv_cond) );
+  pthread_mutex_init( &(new_n->recv_mutex), NULL );
+  new_n->recv_waiters = 0;
+  new_n->io_shards = NULL;
+  new_n->n_io_shards = 0;
+  cRosMpscQueueInit( &(new_n->io_shard_events) );
+  pthread_mutex_init( &(new_n->tasks_mutex), NULL );
+  new_n->io_thread_exit = 0;
+  new_n->io_thread_err = CROS_SUCCESS_ERR_PACK;
+  new_n->free_tasks = new_n->done_tasks = NULL;
+
+  xmlrpcProcessInit( &(new_n->xmlrpc_listner_proc) );
+  tcprosProcessInit( &(new_n->tcpros_listner_proc) );
+  tcprosProcessInit( &(new_n->rpcros_listner_proc) );
+
+  new_n->next_call_id = 0;
+  initApiCallQueue(&new_n->master_api_queue);
+  initApiCallQueue(&new_n->slave_api_queue);
+
+  new_n->xmlrpc_client_proc = new_n->xmlrpc_server_proc = NULL;
+  new_n->tcpros_client_proc = new_n->tcpros_server_proc = NULL;
+  new_n->rpcros_client_proc = new_n->rpcros_server_proc = NULL;
+  new_n->pubs = NULL;
+  new_n->subs = NULL;
+  new_n->service_providers = NULL;
+  new_n->service_callers = NULL;
+  new_n->paramsubs = NULL;
+  initNodeTable( &new_n->xmlrpc_client_proc_table );
+  initNodeTable( &new_n->xmlrpc_server_proc_table );
+  initNodeTable( &new_n->tcpros_client_proc_table );
+  initNodeTable( &new_n->tcpros_server_proc_table );
+  initNodeTable( &new_n->rpcros_client_proc_table );
+  initNodeTable( &new_n->rpcros_server_proc_table );
+  initNodeTable( &new_n->pubs_table );
+  initNodeTable( &new_n->subs_table );
+  initNodeTable( &new_n->service_providers_table );
+  initNodeTable( &new_n->service_callers_table );
+  initNodeTable( &new_n->paramsubs_table );
+  new_n->n_pubs = 0;
+  new_n->n_subs = 0;
+  new_n->n_service_providers = 0;
+  new_n->n_service_callers = 0;
+  new_n->n_paramsubs = 0;
+  new_n->log_queue = NULL;
+  cRosMessageRegistryInit( &new_n->msg_registry );
 
   new_n->name = cRosNamespaceBuild(NULL, node_name);
   new_n->host = ( char * ) malloc ( ( strlen ( node_host ) + 1 ) *sizeof ( char ) );
@@ -1875,72 +2357,10 @@ CrosNode *cRosNodeCreate (char* node_name, char *node_host, char *roscore_host,
   new_n->roscore_port = roscore_port;
   new_n->roscore_pid = -1;
 
-  xmlrpcProcessInit( &(new_n->xmlrpc_listner_proc) );
-
-  new_n->next_call_id = 0;
-  initApiCallQueue(&new_n->master_api_queue);
-  initApiCallQueue(&new_n->slave_api_queue);
-
-  int i, fn_ret;
-  for (i = 0 ; i < CN_MAX_XMLRPC_SERVER_CONNECTIONS; i++)
-    xmlrpcProcessInit( &(new_n->xmlrpc_server_proc[i]) );
-
-  for ( i = 0 ; i < CN_MAX_XMLRPC_CLIENT_CONNECTIONS; i++)
-    xmlrpcProcessInit( &(new_n->xmlrpc_client_proc[i]) );
-
-  tcprosProcessInit( &(new_n->tcpros_listner_proc) );
-
-  for ( i = 0; i < CN_MAX_TCPROS_SERVER_CONNECTIONS; i++)
-    tcprosProcessInit( &(new_n->tcpros_server_proc[i]) );
-
-  for ( i = 0; i < CN_MAX_TCPROS_CLIENT_CONNECTIONS; i++)
-    tcprosProcessInit( &(new_n->tcpros_client_proc[i]) );
-
-  tcprosProcessInit( &(new_n->rpcros_listner_proc) );
-
-  for ( i = 0; i < CN_MAX_RPCROS_SERVER_CONNECTIONS; i++)
-    tcprosProcessInit( &(new_n->rpcros_server_proc[i]) );
-
-  for ( i = 0; i < CN_MAX_RPCROS_CLIENT_CONNECTIONS; i++)
-    tcprosProcessInit( &(new_n->rpcros_client_proc[i]) );
-
-  for ( i = 0; i < CN_MAX_PUBLISHED_TOPICS; i++)
-    initPublisherNode(&new_n->pubs[i]);
-  new_n->n_pubs = 0;
-
-  for ( i = 0; i < CN_MAX_SUBSCRIBED_TOPICS; i++)
-    initSubscriberNode(&new_n->subs[i]);
-  new_n->n_subs = 0;
-
-  for ( i = 0; i < CN_MAX_SERVICE_PROVIDERS; i++)
-    initServiceProviderNode(&new_n->service_providers[i]);
-  new_n->n_service_providers = 0;
-
-  for ( i = 0; i < CN_MAX_SERVICE_CALLERS; i++)
-    initServiceCallerNode(&new_n->service_callers[i]);
-  new_n->n_service_callers = 0;
-
-  for ( i = 0; i < CN_MAX_PARAMETER_SUBSCRIPTIONS; i++)
-    initParameterSubscrition(&new_n->paramsubs[i]);
-  new_n->n_paramsubs = 0;
-
   new_n->pid = (int)getpid();
 
-  fn_ret = 0;
-  for(i = 0; i < CN_MAX_XMLRPC_CLIENT_CONNECTIONS && fn_ret == 0; i++)
-  {
-    fn_ret = openXmlrpcClientSocket( new_n, i );
-  }
-
-  for(i = 0; i < CN_MAX_TCPROS_CLIENT_CONNECTIONS && fn_ret == 0; i++)
-  {
-    fn_ret = openTcprosClientSocket( new_n, i );
-  }
-
-  for(i = 0; i < CN_MAX_RPCROS_CLIENT_CONNECTIONS && fn_ret == 0; i++)
-  {
-    fn_ret = openRpcrosClientSocket( new_n, i );
-  }
+  int fn_ret;
+  fn_ret = initNodeTables( new_n, config );
   if(fn_ret == 0)
     fn_ret = openXmlrpcListnerSocket( new_n );
   if(fn_ret == 0)
@@ -1950,13 +2370,17 @@ CrosNode *cRosNodeCreate (char* node_name, char *node_host, char *roscore_host,
 
   if(fn_ret != 0)
   {
-    PRINT_ERROR ( "cRosNodeCreate() : socket could not be opened\n" );
+    PRINT_ERROR ( "cRosNodeCreate() : socket could not be opened or memory could not be allocated\n" );
     cRosNodeDestroy ( new_n );
     return NULL;
   }
 
+  // The roscore client arms its ping timer in the first loop iteration
+  cRosPollerEntryNotify( &(new_n->xmlrpc_client_proc[0].poller_entry) );
+
   new_n->log_queue = cRosLogQueueNew();
   new_n-> log_last_id = 0;
+  new_n->rosout_fields.resolved = 0;
 
   /*
    * Registering logging callback
@@ -1964,8 +2388,15 @@ CrosNode *cRosNodeCreate (char* node_name, char *node_host, char *roscore_host,
 
   cRosErrCodePack ret_err;
 
-  ret_err = cRosApiRegisterPublisher(new_n,"/rosout","rosgraph_msgs/Log", 100,
-                                  callback_pub_log, NULL, new_n, NULL);
+  // The fields of the log messages are located once, and /rosout is not published if they do not match rosgraph_msgs/Log
+  if (resolveRosoutFields(new_n) == 0)
+    ret_err = cRosApiRegisterPublisher(new_n,"/rosout","rosgraph_msgs/Log", 100,
+                                    callback_pub_log, NULL, new_n, 0, NULL);
+  else
+  {
+    PRINT_ERROR ( "cRosNodeCreate(): The rosgraph_msgs/Log definition does not have the fields published in /rosout.\n");
+    ret_err = CROS_BAD_PARAM_ERR;
+  }
   if (ret_err != CROS_SUCCESS_ERR_PACK)
   {
     PRINT_ERROR ( "cRosNodeCreate(): Error registering rosout.\n");
@@ -1997,19 +2428,19 @@ int cRosUnregistrationCompleted(CrosNode *n)
 
   unreg_finished = 1;
 
-  for ( i = 0; i < CN_MAX_PUBLISHED_TOPICS && unreg_finished == 1; i++)
+  for ( i = 0; i < n->pubs_table.size && unreg_finished == 1; i++)
     if(n->pubs[i].topic_name != NULL)
       unreg_finished = 0;
 
-  for ( i = 0; i < CN_MAX_SUBSCRIBED_TOPICS && unreg_finished == 1; i++)
+  for ( i = 0; i < n->subs_table.size && unreg_finished == 1; i++)
     if(n->subs[i].topic_name != NULL)
       unreg_finished = 0;
 
-  for ( i = 0; i < CN_MAX_SERVICE_PROVIDERS && unreg_finished == 1; i++)
+  for ( i = 0; i < n->service_providers_table.size && unreg_finished == 1; i++)
     if(n->service_providers[i].service_name != NULL)
       unreg_finished = 0;
 
-  for ( i = 0; i < CN_MAX_PARAMETER_SUBSCRIPTIONS && unreg_finished == 1; i++)
+  for ( i = 0; i < n->paramsubs_table.size && unreg_finished == 1; i++)
     if(n->paramsubs[i].parameter_key != NULL)
       unreg_finished = 0;
 
@@ -2036,13 +2467,13 @@ void cRosNodePauseAllCallersPublishers(CrosNode *n)
 {
   int i;
 
-  for ( i = 0; i < CN_MAX_PUBLISHED_TOPICS; i++)
+  for ( i = 0; i < n->pubs_table.size; i++)
     if(n->pubs[i].topic_name != NULL)
-      n->pubs[i].loop_period = -1;
+      n->pubs[i].loop_period_ns = -1;
 
-  for ( i = 0; i < CN_MAX_SERVICE_CALLERS; i++)
+  for ( i = 0; i < n->service_callers_table.size; i++)
     if(n->service_callers[i].service_name != NULL)
-      n->service_callers[i].loop_period = -1;
+      n->service_callers[i].loop_period_ns = -1;
 }
 
 
@@ -2051,25 +2482,36 @@ cRosErrCodePack cRosNodeUnregisterAll(CrosNode *n)
   int i;
   cRosErrCodePack ret_err=CROS_SUCCESS_ERR_PACK;
 
-  for ( i = 0; i < CN_MAX_PUBLISHED_TOPICS && ret_err == CROS_SUCCESS_ERR_PACK; i++)
+  for ( i = 0; i < n->pubs_table.size && ret_err == CROS_SUCCESS_ERR_PACK; i++)
     if(n->pubs[i].topic_name != NULL)
       ret_err = cRosApiUnregisterPublisher(n, i);
 
-  for ( i = 0; i < CN_MAX_SUBSCRIBED_TOPICS && ret_err == CROS_SUCCESS_ERR_PACK; i++)
+  for ( i = 0; i < n->subs_table.size && ret_err == CROS_SUCCESS_ERR_PACK; i++)
     if(n->subs[i].topic_name != NULL)
       ret_err = cRosApiUnregisterSubscriber(n, i);
 
-  for ( i = 0; i < CN_MAX_SERVICE_PROVIDERS && ret_err == CROS_SUCCESS_ERR_PACK; i++)
+  for ( i = 0; i < n->service_providers_table.size && ret_err == CROS_SUCCESS_ERR_PACK; i++)
     if(n->service_providers[i].service_name != NULL)
       ret_err = cRosApiUnregisterServiceProvider(n, i);
 
-  for ( i = 0; i < CN_MAX_PARAMETER_SUBSCRIPTIONS && ret_err == CROS_SUCCESS_ERR_PACK; i++)
+  for ( i = 0; i < n->paramsubs_table.size && ret_err == CROS_SUCCESS_ERR_PACK; i++)
     if(n->paramsubs[i].parameter_key != NULL)
       ret_err = cRosApiUnsubscribeParam(n, i);
 
   return ret_err;
 }
 
+static void freeNodeTasks( CrosNodeTask *task )
+{
+  while( task != NULL )
+  {
+    CrosNodeTask *next_task = task->next;
+    dynBufferRelease( &task->packet );
+    free( task );
+    task = next_task;
+  }
+}
+
 cRosErrCodePack cRosNodeDestroy ( CrosNode *n )
 {
   cRosErrCodePack ret_err;
@@ -2079,6 +2521,9 @@ cRosErrCodePack cRosNodeDestroy ( CrosNode *n )
   if ( n == NULL )
     return CROS_BAD_PARAM_ERR;
 
+  if( n->io_thread_running )
+    cRosNodeStopThreads( n ); // The node loop is run next by this thread to unregister the node
+
   cRosNodePauseAllCallersPublishers( n );
   ret_err = cRosNodeUnregisterAll(n);
   if(ret_err == CROS_SUCCESS_ERR_PACK)
@@ -2090,59 +2535,103 @@ cRosErrCodePack cRosNodeDestroy ( CrosNode *n )
   releaseApiCallQueue(&n->slave_api_queue);
 
   int i;
-  for (i = 0; i < CN_MAX_XMLRPC_SERVER_CONNECTIONS; i++)
+  for (i = 0; i < n->xmlrpc_server_proc_table.size; i++)
     xmlrpcProcessRelease( &(n->xmlrpc_server_proc[i]) );
 
-  for(i = 0; i < CN_MAX_XMLRPC_CLIENT_CONNECTIONS; i++)
+  for(i = 0; i < n->xmlrpc_client_proc_table.size; i++)
     xmlrpcProcessRelease( &(n->xmlrpc_client_proc[i]) );
 
   tcprosProcessRelease( &(n->tcpros_listner_proc) );
 
-  for ( i = 0; i < CN_MAX_TCPROS_SERVER_CONNECTIONS; i++)
+  for ( i = 0; i < n->tcpros_server_proc_table.size; i++)
     tcprosProcessRelease( &(n->tcpros_server_proc[i]) );
 
-  for ( i = 0; i < CN_MAX_TCPROS_CLIENT_CONNECTIONS; i++)
+  for ( i = 0; i < n->tcpros_client_proc_table.size; i++)
     tcprosProcessRelease( &(n->tcpros_client_proc[i]) );
 
-  for ( i = 0; i < CN_MAX_RPCROS_SERVER_CONNECTIONS; i++)
+  for ( i = 0; i < n->rpcros_server_proc_table.size; i++)
     tcprosProcessRelease( &(n->rpcros_server_proc[i]) );
 
-  for ( i = 0; i < CN_MAX_RPCROS_CLIENT_CONNECTIONS; i++)
+  for ( i = 0; i < n->rpcros_client_proc_table.size; i++)
     tcprosProcessRelease( &(n->rpcros_client_proc[i]) );
 
   if ( n->name != NULL ) free ( n->name );
   if ( n->host != NULL ) free ( n->host );
   if ( n->roscore_host != NULL ) free ( n->roscore_host );
 
-  for ( i = 0; i < CN_MAX_PUBLISHED_TOPICS; i++)
+  for ( i = 0; i < n->pubs_table.size; i++)
     cRosApiReleasePublisher(n, i);
 
-  for ( i = 0; i < CN_MAX_SUBSCRIBED_TOPICS; i++)
+  for ( i = 0; i < n->subs_table.size; i++)
     cRosApiReleaseSubscriber(n, i);
 
-  for ( i = 0; i < CN_MAX_SERVICE_PROVIDERS; i++)
+  for ( i = 0; i < n->service_providers_table.size; i++)
     cRosApiReleaseServiceProvider(n, i);
 
-  for ( i = 0; i < CN_MAX_SERVICE_CALLERS; i++)
+  for ( i = 0; i < n->service_callers_table.size; i++)
     cRosApiReleaseServiceCaller(n, i);
 
-  for ( i = 0; i < CN_MAX_PARAMETER_SUBSCRIPTIONS; i++)
+  for ( i = 0; i < n->paramsubs_table.size; i++)
     cRosNodeReleaseParameterSubscrition(&n->paramsubs[i]);
 
+  free( n->xmlrpc_client_proc );
+  free( n->xmlrpc_server_proc );
+  free( n->tcpros_client_proc );
+  free( n->tcpros_server_proc );
+  free( n->rpcros_client_proc );
+  free( n->rpcros_server_proc );
+  free( n->pubs );
+  free( n->subs );
+  free( n->service_providers );
+  free( n->service_callers );
+  free( n->paramsubs );
+
+  releaseNodeTable( &n->xmlrpc_client_proc_table );
+  releaseNodeTable( &n->xmlrpc_server_proc_table );
+  releaseNodeTable( &n->tcpros_client_proc_table );
+  releaseNodeTable( &n->tcpros_server_proc_table );
+  releaseNodeTable( &n->rpcros_client_proc_table );
+  releaseNodeTable( &n->rpcros_server_proc_table );
+  releaseNodeTable( &n->pubs_table );
+  releaseNodeTable( &n->subs_table );
+  releaseNodeTable( &n->service_providers_table );
+  releaseNodeTable( &n->service_callers_table );
+  releaseNodeTable( &n->paramsubs_table );
+
+  cRosMessageRegistryRelease( &n->msg_registry ); // After releasing the providers, which reference its entries
+
+  cRosPollerRelease( &(n->poller) );
+  cRosTimerHeapRelease( &(n->timers) );
+
+  cRosWakeupClose( &(n->wakeup) );
+  freeNodeTasks( n->done_tasks );
+  freeNodeTasks( n->free_tasks );
+  pthread_mutex_destroy( &(n->tasks_mutex) );
+  pthread_cond_destroy( &(n->recv_cond) );
+  pthread_mutex_destroy( &(n->recv_mutex) );
+
   return ret_err;
 }
 
 int cRosNodeRegisterPublisher (CrosNode *node, const char *message_definition,
                                const char *topic_name, const char *topic_type, const char *md5sum, int loop_period,
-                               PublisherCallback callback, NodeStatusCallback status_callback, void *data_context)
+                               PublisherCallback callback, NodeStatusCallback status_callback, void *data_context, int queue_size)
 {
   PRINT_VDEBUG ( "cRosNodeRegisterPublisher()\n" );
 
-  if ( node->n_pubs >= CN_MAX_PUBLISHED_TOPICS )
+  int pubidx = popNodeTableFreeSlot( &node->pubs_table );
+  if ( pubidx == -1 )
   {
-    PRINT_ERROR ( "cRosNodeRegisterPublisher() : Can't register a new publisher: \
-                 reached the maximum number of published topics\n");
-    return -1;
+    PublisherNode *new_pubs = growNodeTable( node->pubs, sizeof(PublisherNode), &node->pubs_table,
+                                             getNodeTableGrowthSize( &node->pubs_table ), 1, initPublisherSlot );
+    if ( new_pubs == NULL )
+    {
+      PRINT_ERROR ( "cRosNodeRegisterPublisher() : Can't register a new publisher: \
+                   the published-topic table could not be enlarged\n");
+      return -1;
+    }
+    node->pubs = new_pubs;
+    pubidx = popNodeTableFreeSlot( &node->pubs_table );
   }
 
   char *pub_message_definition = ( char * ) malloc ( ( strlen ( message_definition ) + 1 ) * sizeof ( char ) );
@@ -2154,6 +2643,7 @@ int cRosNodeRegisterPublisher (CrosNode *node, const char *message_definition,
        pub_topic_type == NULL || pub_md5sum == NULL)
   {
     PRINT_ERROR ( "cRosNodeRegisterPublisher() : Can't allocate memory\n" );
+    pushNodeTableFreeSlot( &node->pubs_table, pubidx );
     return -1;
   }
 
@@ -2163,28 +2653,17 @@ int cRosNodeRegisterPublisher (CrosNode *node, const char *message_definition,
 
   PRINT_INFO ( "Publishing topic %s type %s \n", pub_topic_name, pub_topic_type );
 
-  int pubidx = -1;
-  int it = 0;
-  for (; it < CN_MAX_PUBLISHED_TOPICS; it++)
-  {
-    if (node->pubs[it].topic_name == NULL)
-    {
-      pubidx = it;
-      break;
-    }
-  }
-
   PublisherNode *pub = &node->pubs[pubidx];
   pub->message_definition = pub_message_definition;
   pub->topic_name = pub_topic_name;
   pub->topic_type = pub_topic_type;
   pub->md5sum = pub_md5sum;
 
-  pub->loop_period = loop_period;
+  pub->loop_period_ns = ( loop_period >= 0 )? (int64_t)loop_period * CROS_CLOCK_NS_PER_MS : -1;
   pub->callback = callback;
   pub->status_callback = status_callback;
   pub->context = data_context;
-  cRosMessageQueueClear(&pub->msg_queue);
+  pub->queue_size = ( queue_size > 0 )? queue_size : node->tcpros_out_queue_length;
 
   node->n_pubs++;
 
@@ -2202,11 +2681,19 @@ int cRosNodeRegisterServiceProvider(CrosNode *node, const char *service_name,
 {
   PRINT_VDEBUG ( "cRosNodeRegisterServiceProvider()\n" );
 
-  if (node->n_service_providers >= CN_MAX_SERVICE_PROVIDERS)
+  int serviceidx = popNodeTableFreeSlot( &node->service_providers_table );
+  if (serviceidx == -1)
   {
-    PRINT_ERROR ( "cRosNodeRegisterServiceProvider() : Can't register a new service provider: \
-                 reached the maximum number of service providers\n");
-    return -1;
+    ServiceProviderNode *new_providers = growNodeTable( node->service_providers, sizeof(ServiceProviderNode), &node->service_providers_table,
+                                                        getNodeTableGrowthSize( &node->service_providers_table ), 1, initServiceProviderSlot );
+    if (new_providers == NULL)
+    {
+      PRINT_ERROR ( "cRosNodeRegisterServiceProvider() : Can't register a new service provider: \
+                   the service-provider table could not be enlarged\n");
+      return -1;
+    }
+    node->service_providers = new_providers;
+    serviceidx = popNodeTableFreeSlot( &node->service_providers_table );
   }
 
   char *srv_service_name =  cRosNamespaceBuild(node, service_name);
@@ -2219,6 +2706,7 @@ int cRosNodeRegisterServiceProvider(CrosNode *node, const char *service_name,
        srv_md5sum == NULL)
   {
     PRINT_ERROR ( "cRosNodeRegisterServiceProvider() : Can't allocate memory\n" );
+    pushNodeTableFreeSlot( &node->service_providers_table, serviceidx );
     return -1;
   }
 
@@ -2231,17 +2719,6 @@ int cRosNodeRegisterServiceProvider(CrosNode *node, const char *service_name,
 
   PRINT_INFO ( "Registering service provider %s type %s \n", srv_service_name, srv_service_type);
 
-  int serviceidx = -1;
-  int it = 0;
-  for (; it < CN_MAX_SERVICE_PROVIDERS; it++)
-  {
-    if (node->service_providers[it].service_name == NULL)
-    {
-      serviceidx = it;
-      break;
-    }
-  }
-
   ServiceProviderNode *service = &(node->service_providers[serviceidx]);
 
   service->service_name = srv_service_name;
@@ -2273,15 +2750,27 @@ int cRosNodeRecruitTcprosClientProc(CrosNode *node, int subidx)
   client_proc=NULL;
   sub = &node->subs[subidx];
   ret=-1; // Default return value (No free Tcpros client proc is available)
-  for(clientidx=0;clientidx<CN_MAX_TCPROS_CLIENT_CONNECTIONS && ret==-1;clientidx++)
+  for(clientidx=0;clientidx<node->tcpros_client_proc_table.size && ret==-1;clientidx++)
   {
     client_proc = &node->tcpros_client_proc[clientidx];
     if(client_proc->topic_idx == -1) // A free Tcpros client proc has been found
-    {
-      client_proc->topic_idx = subidx;
-      client_proc->tcp_nodelay = (unsigned char)sub->tcp_nodelay;
       ret=clientidx; // Exit loop
-    }
+  }
+
+  if(ret == -1) // All the Tcpros client procs are in use: enlarge the table
+  {
+    clientidx = node->tcpros_client_proc_table.size;
+    if(growNodeProcTable(node, CN_PROC_TCPROS_CLIENT, getNodeTableGrowthSize(&node->tcpros_client_proc_table)) == 0)
+      ret = clientidx; // The first new proc
+    else
+      PRINT_ERROR ( "cRosNodeRecruitTcprosClientProc() : The TCPROS client table could not be enlarged\n");
+  }
+
+  if(ret != -1)
+  {
+    client_proc = &node->tcpros_client_proc[ret];
+    client_proc->topic_idx = subidx;
+    client_proc->tcp_nodelay = (unsigned char)sub->tcp_nodelay;
   }
   return ret;
 }
@@ -2293,7 +2782,7 @@ int cRosNodeFindFirstTcprosClientProc(CrosNode *node, int subidx, const char *tc
 
   // Look for the first Tcpros client proc that was recruited for subidx subscriber and a specific publisher host and port
   ret=-1;
-  for(clientidx=0;clientidx<CN_MAX_TCPROS_CLIENT_CONNECTIONS && ret==-1;clientidx++)
+  for(clientidx=0;clientidx<node->tcpros_client_proc_table.size && ret==-1;clientidx++)
   {
     TcprosProcess *cur_cli = &node->tcpros_client_proc[clientidx];
     if((subidx == -1 || cur_cli->topic_idx == subidx) &&
@@ -2307,15 +2796,24 @@ int cRosNodeFindFirstTcprosClientProc(CrosNode *node, int subidx, const char *tc
 
 int cRosNodeRegisterSubscriber(CrosNode *node, const char *message_definition,
                                const char *topic_name, const char *topic_type, const char *md5sum,
-                               SubscriberCallback callback, NodeStatusCallback status_callback, void *data_context, int tcp_nodelay)
+                               SubscriberCallback callback, NodeStatusCallback status_callback, void *data_context, int tcp_nodelay,
+                               int queue_size)
 {
   PRINT_VDEBUG ( "cRosNodeRegisterSubscriber()\n" );
 
-  if (node->n_subs >= CN_MAX_SUBSCRIBED_TOPICS)
+  int subidx = popNodeTableFreeSlot( &node->subs_table );
+  if (subidx == -1)
   {
-    PRINT_ERROR ( "cRosNodeRegisterSubscriber() : Can't register a new subscriber: \
-                  reached the maximum number of published topics\n");
-    return -1;
+    SubscriberNode *new_subs = growNodeTable( node->subs, sizeof(SubscriberNode), &node->subs_table,
+                                              getNodeTableGrowthSize( &node->subs_table ), 1, initSubscriberSlot );
+    if (new_subs == NULL)
+    {
+      PRINT_ERROR ( "cRosNodeRegisterSubscriber() : Can't register a new subscriber: \
+                    the subscribed-topic table could not be enlarged\n");
+      return -1;
+    }
+    node->subs = new_subs;
+    subidx = popNodeTableFreeSlot( &node->subs_table );
   }
 
   char *pub_message_definition = ( char * ) malloc ( ( strlen ( message_definition ) + 1 ) * sizeof ( char ) );
@@ -2326,6 +2824,7 @@ int cRosNodeRegisterSubscriber(CrosNode *node, const char *message_definition,
   if ( pub_topic_name == NULL || pub_topic_type == NULL )
   {
     PRINT_ERROR ( "cRosNodeRegisterSubscriber() : Can't allocate memory\n" );
+    pushNodeTableFreeSlot( &node->subs_table, subidx );
     return -1;
   }
 
@@ -2336,17 +2835,6 @@ int cRosNodeRegisterSubscriber(CrosNode *node, const char *message_definition,
 
   PRINT_INFO ( "Subscribing to topic %s type %s \n", pub_topic_name, pub_topic_type );
 
-  int subidx = node->n_subs;
-  int it = 0;
-  for (; it < CN_MAX_SUBSCRIBED_TOPICS; it++)
-  {
-    if (node->subs[it].topic_name == NULL)
-    {
-      subidx = it;
-      break;
-    }
-  }
-
   SubscriberNode *sub = &node->subs[subidx];
   sub->message_definition = pub_message_definition;
   sub->topic_name = pub_topic_name;
@@ -2354,10 +2842,13 @@ int cRosNodeRegisterSubscriber(CrosNode *node, const char *message_definition,
   sub->md5sum = pub_md5sum;
   sub->status_callback = status_callback;
   sub->callback = callback;
+  sub->msg_callback = NULL;
+  sub->msg_prototype = NULL;
+  sub->stream_min_size = CN_SUBSCRIBER_STREAM_MIN_SIZE;
   sub->context = data_context;
   sub->tcp_nodelay = (unsigned char)tcp_nodelay;
   sub->msg_queue_overflow = 0;
-  cRosMessageQueueClear(&sub->msg_queue);
+  cRosMessageQueueSetCapacity(&sub->msg_queue, ( queue_size > 0 )? (unsigned int)queue_size : 0);
 
   node->n_subs++;
 
@@ -2375,10 +2866,28 @@ int cRosNodeRegisterServiceCaller(CrosNode *node, const char *message_definition
 {
   PRINT_VDEBUG ( "cRosNodeRegisterServiceCaller()\n" );
 
-  if (node->n_service_callers >= CN_MAX_SERVICE_CALLERS)
+  int serviceidx = popNodeTableFreeSlot( &node->service_callers_table );
+  if (serviceidx == -1)
+  {
+    ServiceCallerNode *new_callers = growNodeTable( node->service_callers, sizeof(ServiceCallerNode), &node->service_callers_table,
+                                                    getNodeTableGrowthSize( &node->service_callers_table ), 1, initServiceCallerSlot );
+    if (new_callers == NULL)
+    {
+      PRINT_ERROR ( "cRosNodeRegisterServiceCaller() : Can't register a new service caller: \
+                   the service-caller table could not be enlarged\n");
+      return -1;
+    }
+    node->service_callers = new_callers;
+    serviceidx = popNodeTableFreeSlot( &node->service_callers_table );
+  }
+
+  // node->service_callers[i] uses node->rpcros_client_proc[i], so both tables have the same size
+  if (node->rpcros_client_proc_table.size < node->service_callers_table.size &&
+      growNodeProcTable( node, CN_PROC_RPCROS_CLIENT, node->service_callers_table.size ) != 0)
   {
     PRINT_ERROR ( "cRosNodeRegisterServiceCaller() : Can't register a new service caller: \
-                 reached the maximum number of service callers\n");
+                 the RPCROS client table could not be enlarged\n");
+    pushNodeTableFreeSlot( &node->service_callers_table, serviceidx );
     return -1;
   }
 
@@ -2393,6 +2902,7 @@ int cRosNodeRegisterServiceCaller(CrosNode *node, const char *message_definition
        srv_md5sum == NULL)
   {
     PRINT_ERROR ( "cRosNodeRegisterServiceCaller() : Can't allocate memory\n" );
+    pushNodeTableFreeSlot( &node->service_callers_table, serviceidx );
     return -1;
   }
 
@@ -2406,17 +2916,6 @@ int cRosNodeRegisterServiceCaller(CrosNode *node, const char *message_definition
 
   PRINT_INFO ( "Starting service caller %s type %s \n", srv_service_name, srv_service_type);
 
-  int serviceidx = -1;
-  int it = 0;
-  for (; it < CN_MAX_SERVICE_CALLERS; it++)
-  {
-    if (node->service_callers[it].service_name == NULL)
-    {
-      serviceidx = it;
-      break;
-    }
-  }
-
   ServiceCallerNode *service = &(node->service_callers[serviceidx]);
   service->message_definition = srv_message_definition;
   service->service_name = srv_service_name;
@@ -2427,7 +2926,7 @@ int cRosNodeRegisterServiceCaller(CrosNode *node, const char *message_definition
   service->callback = callback;
   service->status_callback = status_callback;
   service->context = data_context;
-  service->loop_period = loop_period;
+  service->loop_period_ns = ( loop_period >= 0 )? (int64_t)loop_period * CROS_CLOCK_NS_PER_MS : -1;
   service->persistent = (unsigned char)persistent;
   service->tcp_nodelay = (unsigned char)tcp_nodelay;
 
@@ -2452,7 +2951,7 @@ int cRosNodeRegisterServiceCaller(CrosNode *node, const char *message_definition
 int cRosNodeUnregisterSubscriber(CrosNode *node, int subidx)
 {
   int client_tcpros_ind, client_xmlrpc_ind;
-  if (subidx < 0 || subidx >= CN_MAX_SUBSCRIBED_TOPICS)
+  if (subidx < 0 || subidx >= node->subs_table.size)
     return -1;
 
   SubscriberNode *sub = &node->subs[subidx];
@@ -2473,7 +2972,7 @@ int cRosNodeUnregisterSubscriber(CrosNode *node, int subidx)
   }
 
   // Check if any xmlrpc_client_proc is working for the subscriber being unregistered and if so, close them
-  for(client_xmlrpc_ind=0;client_xmlrpc_ind < CN_MAX_XMLRPC_CLIENT_CONNECTIONS;client_xmlrpc_ind++)
+  for(client_xmlrpc_ind=0;client_xmlrpc_ind < node->xmlrpc_client_proc_table.size;client_xmlrpc_ind++)
   {
     XmlrpcProcess *xmlrpcProc = &node->xmlrpc_client_proc[client_xmlrpc_ind];
     if(xmlrpcProc->state != XMLRPC_PROCESS_STATE_IDLE && xmlrpcProc->current_call != NULL &&
@@ -2509,7 +3008,7 @@ int cRosNodeUnregisterSubscriber(CrosNode *node, int subidx)
 
 int cRosNodeUnregisterPublisher(CrosNode *node, int pubidx)
 {
-  if (pubidx < 0 || pubidx >= CN_MAX_PUBLISHED_TOPICS)
+  if (pubidx < 0 || pubidx >= node->pubs_table.size)
     return -1;
 
   PublisherNode *pub = &node->pubs[pubidx];
@@ -2523,8 +3022,11 @@ int cRosNodeUnregisterPublisher(CrosNode *node, int pubidx)
     return -1;
   }
 
-  TcprosProcess *tcprosProc = &node->tcpros_server_proc[pub->client_tcpros_id];
-  closeTcprosProcess(tcprosProc);
+  if (pub->client_tcpros_id >= 0) // The publisher may have not been connected to any subscriber yet
+  {
+    TcprosProcess *tcprosProc = &node->tcpros_server_proc[pub->client_tcpros_id];
+    closeTcprosProcess(tcprosProc);
+  }
 
   XmlrpcProcess *coreproc = &node->xmlrpc_client_proc[0];
   if (coreproc->current_call != NULL
@@ -2554,7 +3056,7 @@ int cRosNodeUnregisterPublisher(CrosNode *node, int pubidx)
 
 int cRosNodeUnregisterServiceProvider(CrosNode *node, int serviceidx)
 {
-  if (serviceidx < 0 || serviceidx >= CN_MAX_SERVICE_PROVIDERS)
+  if (serviceidx < 0 || serviceidx >= node->service_providers_table.size)
     return -1;
 
   ServiceProviderNode *svc = &node->service_providers[serviceidx];
@@ -2601,33 +3103,31 @@ cRosErrCodePack cRosApiSubscribeParam(CrosNode *node, const char *key, NodeStatu
   PRINT_VDEBUG ( "cRosApiSubscribeParam()\n" );
   PRINT_INFO ( "Subscribing to parameter %s\n", key);
 
-  if (node->n_paramsubs >= CN_MAX_PARAMETER_SUBSCRIPTIONS)
+  int paramsubidx = popNodeTableFreeSlot( &node->paramsubs_table );
+  if (paramsubidx == -1)
   {
-    PRINT_ERROR ( "cRosApiSubscribeParam() : Can't register a new parameter subscription: \
-                  reached the maximum number of parameters\n");
-    return CROS_MANY_PARAM_ERR;
+    ParameterSubscription *new_paramsubs = growNodeTable( node->paramsubs, sizeof(ParameterSubscription), &node->paramsubs_table,
+                                                          getNodeTableGrowthSize( &node->paramsubs_table ), 1, initParameterSubscriptionSlot );
+    if (new_paramsubs == NULL)
+    {
+      PRINT_ERROR ( "cRosApiSubscribeParam() : Can't register a new parameter subscription: \
+                    the parameter-subscription table could not be enlarged\n");
+      return CROS_MANY_PARAM_ERR;
+    }
+    node->paramsubs = new_paramsubs;
+    paramsubidx = popNodeTableFreeSlot( &node->paramsubs_table );
   }
 
   char *parameter_key = ( char * ) malloc ( ( strlen ( key ) + 1 ) * sizeof ( char ) );
   if (parameter_key == NULL)
   {
     PRINT_ERROR ( "cRosApiSubscribeParam() : Can't allocate memory\n" );
+    pushNodeTableFreeSlot( &node->paramsubs_table, paramsubidx );
     return CROS_MEM_ALLOC_ERR;
   }
 
   strcpy (parameter_key, key);
 
-  int paramsubidx = -1; // This value should never be used
-  int it;
-  for (it = 0; it < CN_MAX_PARAMETER_SUBSCRIPTIONS; it++)
-  {
-    if (node->paramsubs[it].parameter_key == NULL)
-    {
-      paramsubidx = it;
-      break;
-    }
-  }
-
   ParameterSubscription *sub = &node->paramsubs[paramsubidx];
   sub->parameter_key = parameter_key;
   sub->context = context;
@@ -2641,6 +3141,7 @@ cRosErrCodePack cRosApiSubscribeParam(CrosNode *node, const char *key, NodeStatu
     free(parameter_key);
     sub->parameter_key = NULL;
     node->n_paramsubs--;
+    pushNodeTableFreeSlot( &node->paramsubs_table, paramsubidx );
     return CROS_MEM_ALLOC_ERR;
   }
   if(paramsubidx_ptr != NULL)
@@ -2652,7 +3153,7 @@ cRosErrCodePack cRosApiUnsubscribeParam(CrosNode *node, int paramsubidx)
 {
   int caller_id;
 
-  if (paramsubidx < 0 || paramsubidx >= CN_MAX_PARAMETER_SUBSCRIPTIONS)
+  if (paramsubidx < 0 || paramsubidx >= node->paramsubs_table.size)
     return CROS_BAD_PARAM_ERR;
 
   ParameterSubscription *sub = &node->paramsubs[paramsubidx];
@@ -2675,723 +3176,1421 @@ cRosErrCodePack cRosApiUnsubscribeParam(CrosNode *node, int paramsubidx)
 
 void printNodeProcState( CrosNode *n )
 {
-  char stat_str[CN_MAX_XMLRPC_CLIENT_CONNECTIONS+CN_MAX_XMLRPC_SERVER_CONNECTIONS+CN_MAX_TCPROS_CLIENT_CONNECTIONS+CN_MAX_TCPROS_SERVER_CONNECTIONS+CN_MAX_RPCROS_CLIENT_CONNECTIONS+CN_MAX_RPCROS_SERVER_CONNECTIONS+6*3+3*4+2];
+  char *stat_str;
   int i;
 
+  stat_str = (char *)malloc(n->xmlrpc_client_proc_table.size+n->xmlrpc_server_proc_table.size+n->tcpros_client_proc_table.size+
+                            n->tcpros_server_proc_table.size+n->rpcros_client_proc_table.size+n->rpcros_server_proc_table.size+6*3+3*4+2);
+  if(stat_str == NULL)
+    return;
+
   sprintf(stat_str, "XL%X XC",n->xmlrpc_listner_proc.state);
-  for(i = 0; i < CN_MAX_XMLRPC_CLIENT_CONNECTIONS; i++ )
+  for(i = 0; i < n->xmlrpc_client_proc_table.size; i++ )
     sprintf(stat_str+strlen(stat_str), "%X",n->xmlrpc_client_proc[i].state);
 
   sprintf(stat_str+strlen(stat_str), " XS");
-  for( i = 0; i < CN_MAX_XMLRPC_SERVER_CONNECTIONS; i++ )
+  for( i = 0; i < n->xmlrpc_server_proc_table.size; i++ )
     sprintf(stat_str+strlen(stat_str), "%X",n->xmlrpc_server_proc[i].state);
 
   sprintf(stat_str+strlen(stat_str), " TL%X TC",n->tcpros_listner_proc.state);
-  for(i = 0; i < CN_MAX_TCPROS_CLIENT_CONNECTIONS; i++ )
+  for(i = 0; i < n->tcpros_client_proc_table.size; i++ )
     sprintf(stat_str+strlen(stat_str), "%X",n->tcpros_client_proc[i].state);
 
   sprintf(stat_str+strlen(stat_str), " TS");
-  for( i = 0; i < CN_MAX_TCPROS_SERVER_CONNECTIONS; i++ )
+  for( i = 0; i < n->tcpros_server_proc_table.size; i++ )
     sprintf(stat_str+strlen(stat_str), "%X",n->tcpros_server_proc[i].state);
 
   sprintf(stat_str+strlen(stat_str), " RL%X RC",n->rpcros_listner_proc.state);
-  for(i = 0; i < CN_MAX_RPCROS_CLIENT_CONNECTIONS; i++ )
+  for(i = 0; i < n->rpcros_client_proc_table.size; i++ )
     sprintf(stat_str+strlen(stat_str), "%X",n->rpcros_client_proc[i].state);
 
   sprintf(stat_str+strlen(stat_str), " RS");
-  for( i = 0; i < CN_MAX_RPCROS_SERVER_CONNECTIONS; i++ )
+  for( i = 0; i < n->rpcros_server_proc_table.size; i++ )
     sprintf(stat_str+strlen(stat_str), "%X",n->rpcros_server_proc[i].state);
 
   // Print a compact string indicating the state of all the node processed for debug purposes
   PRINT_DEBUG("%s\n",stat_str);
+  free(stat_str);
 }
 
-cRosErrCodePack cRosNodeDoEventsLoop ( CrosNode *n, uint64_t timeout )
+static int findIdleXmlrpcProcess( XmlrpcProcess *procs, int n_procs )
 {
-  cRosErrCodePack ret_err;
-  int nfds = -1;
-  fd_set r_fds, w_fds, err_fds;
-  int i = 0;
+  int i;
+  for( i = 0; i < n_procs; i++ )
+  {
+    if( procs[i].state == XMLRPC_PROCESS_STATE_IDLE )
+      return i;
+  }
+  return -1;
+}
 
-  PRINT_VDEBUG ( "cRosNodeDoEventsLoop ()\n" );
+static int findIdleTcprosProcess( TcprosProcess *procs, int n_procs )
+{
+  int i;
+  for( i = 0; i < n_procs; i++ )
+  {
+    if( procs[i].state == TCPROS_PROCESS_STATE_IDLE )
+      return i;
+  }
+  return -1;
+}
 
-  if(n == NULL)
-    return CROS_BAD_PARAM_ERR;
+static int getNodeProcCount( CrosNode *n, CrosNodeProcType proc_type )
+{
+  switch( proc_type )
+  {
+    case CN_PROC_XMLRPC_CLIENT: return n->xmlrpc_client_proc_table.size;
+    case CN_PROC_XMLRPC_SERVER: return n->xmlrpc_server_proc_table.size;
+    case CN_PROC_TCPROS_CLIENT: return n->tcpros_client_proc_table.size;
+    case CN_PROC_TCPROS_SERVER: return n->tcpros_server_proc_table.size;
+    case CN_PROC_RPCROS_CLIENT: return n->rpcros_client_proc_table.size;
+    case CN_PROC_RPCROS_SERVER: return n->rpcros_server_proc_table.size;
+    default: return 1; // Listeners
+  }
+}
 
-  ret_err = CROS_SUCCESS_ERR_PACK; // Default return value: success
+/* Find an idle server process of type proc_type to attend a new connection. If all the server processes are busy,
+ * the table is enlarged. It returns the process index, or -1 if no process is available */
+static int recruitNodeServerProc( CrosNode *n, CrosNodeProcType proc_type )
+{
+  CrosNodeTable *table;
+  int server_i;
 
-  #if CROS_DEBUG_LEVEL >= 2
-  printNodeProcState( n );
-  #endif
-  FD_ZERO( &r_fds );
-  FD_ZERO( &w_fds );
-  FD_ZERO( &err_fds );
+  if( proc_type == CN_PROC_XMLRPC_SERVER )
+  {
+    table = &n->xmlrpc_server_proc_table;
+    server_i = findIdleXmlrpcProcess( n->xmlrpc_server_proc, table->size );
+  }
+  else if( proc_type == CN_PROC_TCPROS_SERVER )
+  {
+    table = &n->tcpros_server_proc_table;
+    server_i = findIdleTcprosProcess( n->tcpros_server_proc, table->size );
+  }
+  else
+  {
+    table = &n->rpcros_server_proc_table;
+    server_i = findIdleTcprosProcess( n->rpcros_server_proc, table->size );
+  }
 
-  int xmlrpc_listner_fd = tcpIpSocketGetFD( &(n->xmlrpc_listner_proc.socket) );
-  int tcpros_listner_fd = tcpIpSocketGetFD( &(n->tcpros_listner_proc.socket) );
-  int rpcros_listner_fd = tcpIpSocketGetFD( &(n->rpcros_listner_proc.socket) );
+  if( server_i == -1 )
+  {
+    int n_procs = table->size;
+    if( growNodeProcTable( n, proc_type, getNodeTableGrowthSize( table ) ) == 0 )
+      server_i = n_procs; // The first new process
+    else
+      PRINT_ERROR( "recruitNodeServerProc() : The server table could not be enlarged\n" );
+  }
 
-  XmlrpcProcess *coreproc = &n->xmlrpc_client_proc[0];
-  if (coreproc->state == XMLRPC_PROCESS_STATE_IDLE && !isQueueEmpty(&n->master_api_queue))
+  return server_i;
+}
+
+static CrosPollerEntry *getNodeProcPollerEntry( CrosNode *n, CrosNodeProcType proc_type, int i )
+{
+  if( i < 0 || i >= getNodeProcCount( n, proc_type ) )
+    return NULL;
+
+  switch( proc_type )
   {
-    RosApiCall *call = dequeueApiCall(&n->master_api_queue);
-    coreproc->current_call = call;
-    xmlrpcProcessChangeState( coreproc, XMLRPC_PROCESS_STATE_CONNECTING );
+    case CN_PROC_XMLRPC_CLIENT: return &n->xmlrpc_client_proc[i].poller_entry;
+    case CN_PROC_XMLRPC_LISTNER: return &n->xmlrpc_listner_proc.poller_entry;
+    case CN_PROC_XMLRPC_SERVER: return &n->xmlrpc_server_proc[i].poller_entry;
+    case CN_PROC_TCPROS_CLIENT: return &n->tcpros_client_proc[i].poller_entry;
+    case CN_PROC_TCPROS_LISTNER: return &n->tcpros_listner_proc.poller_entry;
+    case CN_PROC_TCPROS_SERVER: return &n->tcpros_server_proc[i].poller_entry;
+    case CN_PROC_RPCROS_CLIENT: return &n->rpcros_client_proc[i].poller_entry;
+    case CN_PROC_RPCROS_LISTNER: return &n->rpcros_listner_proc.poller_entry;
+    case CN_PROC_RPCROS_SERVER: return &n->rpcros_server_proc[i].poller_entry;
+    case CN_PROC_WAKEUP: return &n->wakeup.poller_entry;
+    default: return NULL;
   }
+}
+
+static void watchXmlrpcProcess( CrosNode *n, XmlrpcProcess *proc, CrosNodeProcType proc_type, int i, unsigned int events )
+{
+  cRosPollerWatch( &n->poller, &proc->poller_entry, tcpIpSocketGetFD( &proc->socket ), events,
+                   proc->state_changes, CN_POLLER_TAG( proc_type, i ) );
+}
 
-  size_t idle_client_count;
-  int idle_clients[CN_MAX_XMLRPC_CLIENT_CONNECTIONS];
-  getIdleXmplrpcClients(n, idle_clients, &idle_client_count);
+static void watchTcprosProcess( CrosNode *n, TcprosProcess *proc, CrosNodeProcType proc_type, int i, unsigned int events )
+{
+  cRosPollerWatch( &n->poller, &proc->poller_entry, tcpIpSocketGetFD( &proc->socket ), events,
+                   proc->state_changes, CN_POLLER_TAG( proc_type, i ) );
+}
 
-  int next_idle_client_idx = 0;
-  while (!isQueueEmpty(&n->slave_api_queue) && next_idle_client_idx != idle_client_count)
+static unsigned int getXmlrpcClientEvents( XmlrpcProcess *proc )
+{
+  switch( proc->state )
   {
-    int idle_client_idx = idle_clients[next_idle_client_idx];
-    RosApiCall *call = dequeueApiCall(&n->slave_api_queue);
+    case XMLRPC_PROCESS_STATE_CONNECTING: // The socket connection completion is acknowledged as ready for writing
+    case XMLRPC_PROCESS_STATE_WRITING:
+      return CROS_POLLER_WRITE | CROS_POLLER_ERROR;
+    case XMLRPC_PROCESS_STATE_READING:
+      return CROS_POLLER_READ | CROS_POLLER_ERROR;
+    default:
+      return 0;
+  }
+}
 
-    XmlrpcProcess *proc =  &n->xmlrpc_client_proc[idle_client_idx];
-    proc->current_call = call;
-    xmlrpcProcessChangeState( proc, XMLRPC_PROCESS_STATE_CONNECTING );
+static unsigned int getXmlrpcServerEvents( XmlrpcProcess *proc )
+{
+  switch( proc->state )
+  {
+    case XMLRPC_PROCESS_STATE_WRITING:
+      return CROS_POLLER_WRITE | CROS_POLLER_ERROR;
+    case XMLRPC_PROCESS_STATE_READING:
+      return CROS_POLLER_READ | CROS_POLLER_ERROR;
+    default:
+      return 0;
+  }
+}
 
-    next_idle_client_idx++;
+static unsigned int getTcprosClientEvents( TcprosProcess *proc )
+{
+  switch( proc->state )
+  {
+    case TCPROS_PROCESS_STATE_CONNECTING:
+    case TCPROS_PROCESS_STATE_WRITING_HEADER:
+      return CROS_POLLER_WRITE | CROS_POLLER_ERROR;
+    case TCPROS_PROCESS_STATE_READING_HEADER_SIZE:
+    case TCPROS_PROCESS_STATE_READING_HEADER:
+    case TCPROS_PROCESS_STATE_READING_SIZE:
+    case TCPROS_PROCESS_STATE_READING:
+      return CROS_POLLER_READ | CROS_POLLER_ERROR;
+    default:
+      return 0;
   }
+}
 
-  /* If active (not idle state), add to the select() the XMLRPC clients */
-  for(i = 0; i < CN_MAX_XMLRPC_CLIENT_CONNECTIONS; i++)
+static unsigned int getTcprosServerEvents( TcprosProcess *proc )
+{
+  switch( proc->state )
   {
-    fd_set *fdset = NULL;
-    if( n->xmlrpc_client_proc[i].state == XMLRPC_PROCESS_STATE_CONNECTING )
+    case TCPROS_PROCESS_STATE_READING_HEADER:
+      return CROS_POLLER_READ | CROS_POLLER_ERROR;
+    case TCPROS_PROCESS_STATE_START_WRITING:
+    case TCPROS_PROCESS_STATE_WRITING:
+      return CROS_POLLER_WRITE | CROS_POLLER_ERROR;
+    case TCPROS_PROCESS_STATE_WAIT_FOR_WRITING:
+      return CROS_POLLER_ERROR;
+    case TCPROS_PROCESS_STATE_SHARDED: // The socket is watched by its shard
+    default:
+      return 0;
+  }
+}
+
+static unsigned int getRpcrosClientEvents( TcprosProcess *proc )
+{
+  switch( proc->state )
+  {
+    case TCPROS_PROCESS_STATE_CONNECTING:
+    case TCPROS_PROCESS_STATE_WRITING_HEADER:
+    case TCPROS_PROCESS_STATE_START_WRITING:
+    case TCPROS_PROCESS_STATE_WRITING:
+      return CROS_POLLER_WRITE | CROS_POLLER_ERROR;
+    case TCPROS_PROCESS_STATE_READING_HEADER_SIZE:
+    case TCPROS_PROCESS_STATE_READING_HEADER:
+    case TCPROS_PROCESS_STATE_READING_SIZE:
+    case TCPROS_PROCESS_STATE_READING:
+      return CROS_POLLER_READ | CROS_POLLER_ERROR;
+    case TCPROS_PROCESS_STATE_WAIT_FOR_WRITING:
+      return CROS_POLLER_ERROR;
+    default:
+      return 0;
+  }
+}
+
+static unsigned int getRpcrosServerEvents( TcprosProcess *proc )
+{
+  switch( proc->state )
+  {
+    case TCPROS_PROCESS_STATE_READING_HEADER_SIZE:
+    case TCPROS_PROCESS_STATE_READING_HEADER:
+    case TCPROS_PROCESS_STATE_READING_SIZE:
+    case TCPROS_PROCESS_STATE_READING:
+      return CROS_POLLER_READ | CROS_POLLER_ERROR;
+    case TCPROS_PROCESS_STATE_WRITING_HEADER:
+    case TCPROS_PROCESS_STATE_WRITING:
+      return CROS_POLLER_WRITE | CROS_POLLER_ERROR;
+    case TCPROS_PROCESS_STATE_WAIT_FOR_RESPONSE:
+      return CROS_POLLER_ERROR;
+    default:
+      return 0;
+  }
+}
+
+/* Queue a serialized message in every connection of a publisher, applying the overflow policy of the outgoing queues */
+static cRosErrCodePack queuePublicationFrame( CrosNode *node, int pubidx, TcprosFrame *frame )
+{
+  cRosErrCodePack ret_err = CROS_SUCCESS_ERR_PACK;
+  int srv_proc_ind, push_ret, shard_ind;
+  uint64_t shard_mask = 0; // I/O shards with connections of the topic
+
+  for(srv_proc_ind=0;srv_proc_ind<node->tcpros_server_proc_table.size;srv_proc_ind++)
+  {
+    TcprosProcess *server_proc = &node->tcpros_server_proc[srv_proc_ind];
+    if(server_proc->topic_idx != pubidx || server_proc->state == TCPROS_PROCESS_STATE_IDLE)
+      continue;
+
+    if(server_proc->state == TCPROS_PROCESS_STATE_SHARDED)
     {
-      cRosErrCodePack new_errors;
-      new_errors =  xmlrpcClientConnect(n, i);
-      ret_err = cRosAddErrCodePackIfErr(ret_err, new_errors);
-      fdset = &w_fds; // select() will acknowledge the socket connection completion in the file descriptors checked for writing
+      shard_mask |= (uint64_t)1 << server_proc->io_shard;
+      continue;
     }
-    else if( n->xmlrpc_client_proc[i].state == XMLRPC_PROCESS_STATE_WRITING )
-      fdset = &w_fds;
-    else if( n->xmlrpc_client_proc[i].state == XMLRPC_PROCESS_STATE_READING )
-      fdset = &r_fds;
 
-    if (fdset != NULL)
+    push_ret = tcprosProcessPushOutFrame(server_proc, frame);
+    cRosPollerEntryNotify(&server_proc->poller_entry); // A waiting process must start writing now
+    if(push_ret == 0)
+      continue;
+
+    if(push_ret == -2)
     {
-      int xmlrpc_client_fd = tcpIpSocketGetFD( &(n->xmlrpc_client_proc[i].socket) );
-      if(xmlrpc_client_fd != -1)
-      {
-        if( xmlrpc_client_fd > nfds )
-          nfds = xmlrpc_client_fd;
+      PRINT_ERROR ( "queuePublicationFrame() : Can't allocate memory\n" );
+      ret_err = CROS_MEM_ALLOC_ERR;
+      continue;
+    }
 
-        FD_SET( xmlrpc_client_fd, fdset);
-        FD_SET( xmlrpc_client_fd, &err_fds);
-      }
+    // The subscriber is not consuming the messages as fast as they are published
+    switch(node->tcpros_out_queue_policy)
+    {
+      case CROS_OUT_QUEUE_DROP_OLDEST:
+        tcprosFrameUnref(tcprosProcessPopOutFrame(server_proc));
+        tcprosProcessPushOutFrame(server_proc, frame);
+        break;
+      case CROS_OUT_QUEUE_DROP_NEWEST:
+        break;
+      case CROS_OUT_QUEUE_DISCONNECT:
+        PRINT_DEBUG ( "queuePublicationFrame() : Closing the connection of a subscriber that does not keep pace with topic %s\n", node->pubs[pubidx].topic_name );
+        handleTcprosServerError(node, srv_proc_ind);
+        break;
+    }
+  }
+
+  // Each shard applies the overflow policy to its own connections (a failed shard is closing them)
+  for(shard_ind=0;shard_mask!=0;shard_ind++,shard_mask>>=1)
+  {
+    if(!(shard_mask & 1) || cRosIoShardHasFailed(&node->io_shards[shard_ind]))
+      continue;
+
+    CrosIoShardMsg *msg = cRosIoShardNewMsg(CROS_IO_SHARD_PUBLISH);
+    if(msg == NULL)
+    {
+      ret_err = CROS_MEM_ALLOC_ERR;
+      continue;
     }
+    msg->topic_idx = pubidx;
+    msg->frame = tcprosFrameRef(frame);
+    cRosIoShardPost(&node->io_shards[shard_ind], msg);
   }
+  return ret_err;
+}
 
-  //printf("FD_SET COUNT. R: %d W: %d\n", r_count, w_count);
+/* Release the TCPROS server processes whose connections have been closed by their I/O shards */
+static void handleIoShardEvents( CrosNode *n )
+{
+  CrosMpscLink *link;
+
+  while( ( link = cRosMpscQueuePop( &n->io_shard_events ) ) != NULL )
+  {
+    CrosIoShardMsg *msg = CROS_MPSC_CONTAINER( link, CrosIoShardMsg, link );
+    int i = msg->server_idx;
+    if( msg->type == CROS_IO_SHARD_CLOSED && i >= 0 && i < n->tcpros_server_proc_table.size &&
+        n->tcpros_server_proc[i].state == TCPROS_PROCESS_STATE_SHARDED )
+    {
+      n->io_shards[n->tcpros_server_proc[i].io_shard].load--;
+      n->tcpros_server_proc[i].io_shard = -1;
+      handleTcprosServerError( n, i );
+    }
+    cRosIoShardFreeMsg( msg );
+  }
+}
+
+/* Queue the messages published by other threads (see cRosNodeSendTopicMsg()) */
+static void handlePostedFrames( CrosNode *n )
+{
+  CrosMpscLink *link;
+
+  while( ( link = cRosMpscQueuePop( &n->posted_frames ) ) != NULL )
+  {
+    TcprosFrame *frame = CROS_MPSC_CONTAINER( link, TcprosFrame, post_link );
+    cRosErrCodePack ret_err = queuePublicationFrame( n, frame->post_topic_idx, frame );
+    if( ret_err != CROS_SUCCESS_ERR_PACK )
+      cRosPrintErrCodePack( ret_err, "handlePostedFrames() : a message published by another thread could not be queued" );
+    tcprosFrameUnref( frame );
+  }
+}
+
+/* Threaded mode: send the first call posted for a service caller once its connection is ready, and pass the response
+   to the thread waiting for it. The calls abandoned by their threads are dropped (or just completed, if already sent) */
+static void attendPostedServiceCalls( CrosNode *n, int svc_idx )
+{
+  ServiceCallerNode *caller = &n->service_callers[svc_idx];
+  CrosNodeServiceCall *call;
 
-  /* Add to the select() the active XMLRPC servers */
-  int next_xmlrpc_server_i = -1;
-  for( i = 0; i < CN_MAX_XMLRPC_SERVER_CONNECTIONS; i++ )
+  while( ( call = caller->posted_calls ) != NULL )
   {
-    int server_fd = tcpIpSocketGetFD( &(n->xmlrpc_server_proc[i].socket) );
+    TcprosProcess *client_proc = &n->rpcros_client_proc[caller->client_rpcros_id];
+    cRosErrCodePack ret_err = CROS_SUCCESS_ERR_PACK;
+    int finished = 0, free_call;
 
-    if( next_xmlrpc_server_i < 0 &&
-        n->xmlrpc_server_proc[i].state == XMLRPC_PROCESS_STATE_IDLE )
+    pthread_mutex_lock( &n->recv_mutex );
+    if( !call->sent )
     {
-      next_xmlrpc_server_i = i;
+      if( call->abandoned )
+        finished = 1;
+      else if( client_proc->service_idx < 0 ) // The connection was closed by an error
+      {
+        ret_err = CROS_RPCROS_CLI_CONN_ERR;
+        finished = 1;
+      }
+      else if( client_proc->state == TCPROS_PROCESS_STATE_WAIT_FOR_WRITING )
+      {
+        cRosMessageQueueClear( &caller->msg_queue ); // Left by a call of the node loop that timed out
+        if( cRosMessageQueueAdd( &caller->msg_queue, call->req_msg ) == 0 )
+        {
+          client_proc->send_msg_now = 1;
+          cRosPollerEntryNotify( &client_proc->poller_entry ); // The process must start writing now
+          call->sent = 1;
+        }
+        else
+        {
+          ret_err = CROS_MEM_ALLOC_ERR;
+          finished = 1;
+        }
+      }
+    }
+    else if( cRosMessageQueueUsage( &caller->msg_queue ) > 1 && client_proc->send_msg_now == 0 ) // The response has been received
+    {
+      cRosMessageQueueRemove( &caller->msg_queue ); // Request
+      if( !call->abandoned && call->resp_msg != NULL )
+        ret_err = ( cRosMessageQueueExtractSwap( &caller->msg_queue, call->resp_msg ) == 0 )? CROS_SUCCESS_ERR_PACK : CROS_MEM_ALLOC_ERR;
+      else
+        cRosMessageQueueRemove( &caller->msg_queue );
+      finished = 1;
     }
-    else if( n->xmlrpc_server_proc[i].state == XMLRPC_PROCESS_STATE_READING )
+    else if( client_proc->state == TCPROS_PROCESS_STATE_IDLE ||
+             client_proc->state == TCPROS_PROCESS_STATE_WAIT_FOR_CONNECTING ) // The connection was closed before the response
     {
-      FD_SET( server_fd, &r_fds);
-      FD_SET( server_fd, &err_fds);
-      if( server_fd > nfds ) nfds = server_fd;
+      cRosMessageQueueClear( &caller->msg_queue );
+      client_proc->send_msg_now = 0;
+      ret_err = CROS_RPCROS_CLI_CONN_ERR;
+      finished = 1;
     }
-    else if( n->xmlrpc_server_proc[i].state == XMLRPC_PROCESS_STATE_WRITING )
+
+    if( finished )
     {
-      FD_SET( server_fd, &w_fds);
-      FD_SET( server_fd, &err_fds);
-      if( server_fd > nfds ) nfds = server_fd;
+      caller->posted_calls = call->next;
+      call->err = ret_err;
+      call->done = 1;
+      pthread_cond_broadcast( &n->recv_cond );
     }
+    free_call = finished && call->abandoned; // Otherwise the waiting thread frees it
+    pthread_mutex_unlock( &n->recv_mutex );
+
+    if( !finished )
+      break;
+    if( free_call )
+      free( call );
   }
+}
+
+/* Append the service calls made by other threads (see cRosNodeServiceCall()) to their service callers */
+static void handlePostedCalls( CrosNode *n )
+{
+  CrosMpscLink *link;
 
-  /* If one XMLRPC server is active at least, add to the select() the listener socket */
-  if( next_xmlrpc_server_i >= 0)
+  while( ( link = cRosMpscQueuePop( &n->posted_calls ) ) != NULL )
   {
-    if(xmlrpc_listner_fd != -1) // If the listener socket is still opened, add it to the select() file descriptors
+    CrosNodeServiceCall *call = CROS_MPSC_CONTAINER( link, CrosNodeServiceCall, link );
+    CrosNodeServiceCall **last = &n->service_callers[call->svc_idx].posted_calls;
+
+    while( *last != NULL )
+      last = &(*last)->next;
+    *last = call;
+    attendPostedServiceCalls( n, call->svc_idx );
+  }
+}
+
+/* Wake up the thread waiting for a posted call with the specified error, or free the call if it was abandoned */
+static void finishPostedCall( CrosNode *n, CrosNodeServiceCall *call, cRosErrCodePack err )
+{
+  int free_call;
+
+  pthread_mutex_lock( &n->recv_mutex );
+  call->err = err;
+  call->done = 1;
+  free_call = call->abandoned;
+  pthread_cond_broadcast( &n->recv_cond );
+  pthread_mutex_unlock( &n->recv_mutex );
+  if( free_call )
+    free( call );
+}
+
+/* Finish with an error all the calls posted for a service caller (the ones sent and the ones waiting to be sent) */
+static void failServiceCallerCalls( CrosNode *n, int svc_idx, cRosErrCodePack err )
+{
+  CrosNodeServiceCall *call, *next_call;
+
+  for( call = n->service_callers[svc_idx].posted_calls; call != NULL; call = next_call )
+  {
+    next_call = call->next;
+    finishPostedCall( n, call, err );
+  }
+  n->service_callers[svc_idx].posted_calls = NULL;
+}
+
+/* Finish the service calls that the stopped I/O thread could not attend: their threads are woken up with an error */
+static void failPostedCalls( CrosNode *n )
+{
+  int i;
+
+  handlePostedCalls( n );
+  for( i = 0; i < n->service_callers_table.size; i++ )
+  {
+    CrosNodeServiceCall *call, *next_call;
+
+    for( call = n->service_callers[i].posted_calls; call != NULL; call = next_call )
     {
-      FD_SET( xmlrpc_listner_fd, &r_fds);
-      FD_SET( xmlrpc_listner_fd, &err_fds);
-      if( xmlrpc_listner_fd > nfds ) nfds = xmlrpc_listner_fd;
+      next_call = call->next;
+      finishPostedCall( n, call, ( call->sent )? CROS_CALL_SVC_TIMEOUT_ERR : CROS_CALL_INI_TIMEOUT_ERR );
     }
+    n->service_callers[i].posted_calls = NULL;
   }
+}
 
-  /*
-   *
-   * TCPROS PROCESSES SELECT() MANAGEMENT
-   *
-   */
+/* Send the service responses prepared by the worker threads */
+static void handleDoneTasks( CrosNode *n )
+{
+  CrosNodeTask *task, *next_task;
+
+  pthread_mutex_lock( &n->tasks_mutex );
+  task = n->done_tasks;
+  n->done_tasks = NULL;
+  pthread_mutex_unlock( &n->tasks_mutex );
 
-  /* If active (not idle state), add to the select() the TCPROS clients */
-  int next_tcpros_client_i = -1; // Unused ???
-  for(i = 0; i < CN_MAX_TCPROS_CLIENT_CONNECTIONS; i++)
+  for( ; task != NULL; task = next_task )
   {
-    TcprosProcess *client_proc = &(n->tcpros_client_proc[i]);
-    int tcpros_client_fd;
+    next_task = task->next;
+    if( task->proc_idx < n->rpcros_server_proc_table.size )
+    {
+      TcprosProcess *server_proc = &n->rpcros_server_proc[task->proc_idx];
+      // If the connection was closed meanwhile, the response is dropped
+      if( server_proc->state == TCPROS_PROCESS_STATE_WAIT_FOR_RESPONSE && server_proc->state_changes == task->proc_stamp )
+      {
+        dynBufferSwap( &server_proc->packet, &task->packet );
+        tcprosProcessChangeState( server_proc, TCPROS_PROCESS_STATE_WRITING );
+      }
+    }
+    cRosNodeReleaseTask( n, task );
+  }
+}
+
+/* Attend a process whose socket has been reported as ready by the poller */
+static cRosErrCodePack handleNodeProcEvents( CrosNode *n, CrosNodeProcType proc_type, int i, unsigned int events )
+{
+  cRosErrCodePack ret_err = CROS_SUCCESS_ERR_PACK;
 
-    if( next_tcpros_client_i < 0 &&
-        i != 0 && //the zero-index is reserved to the roscore communications
-        client_proc->state == TCPROS_PROCESS_STATE_IDLE )
+  switch( proc_type )
+  {
+    case CN_PROC_XMLRPC_CLIENT:
     {
-      next_tcpros_client_i = i;
+      XmlrpcProcess *client_proc = &n->xmlrpc_client_proc[i];
+      if( client_proc->state != XMLRPC_PROCESS_STATE_IDLE && (events & CROS_POLLER_ERROR) )
+      {
+        PRINT_ERROR ( "cRosNodeDoEventsLoop() : XMLRPC client socket error\n" );
+        handleXmlrpcClientError( n, i );
+      }
+      /* Check what is the socket unblocked by the poller, and start the requested operations */
+      else if( ( client_proc->state == XMLRPC_PROCESS_STATE_CONNECTING && (events & CROS_POLLER_WRITE) ) ||
+               ( client_proc->state == XMLRPC_PROCESS_STATE_WRITING && (events & CROS_POLLER_WRITE) ) ||
+               ( client_proc->state == XMLRPC_PROCESS_STATE_READING && (events & CROS_POLLER_READ) ) )
+      {
+        ret_err = doWithXmlrpcClientSocket( n, i );
+      }
+      break;
     }
-    else if(client_proc->state == TCPROS_PROCESS_STATE_CONNECTING)
+    case CN_PROC_XMLRPC_LISTNER:
     {
-      cRosErrCodePack new_errors;
-      new_errors =  tcprosClientConnect(n, i);
-      ret_err = cRosAddErrCodePackIfErr(ret_err, new_errors);
+      int server_i;
+      if( events & CROS_POLLER_ERROR )
+      {
+        PRINT_ERROR ( "cRosNodeDoEventsLoop() : XMLRPC server listener-socket error\n" );
+      }
+      else if( (events & CROS_POLLER_READ) &&
+               (server_i = recruitNodeServerProc( n, CN_PROC_XMLRPC_SERVER )) >= 0 ) // Get a free (idle) xmlrpc process
+      {
+        PRINT_DEBUG ( "cRosNodeDoEventsLoop() : XMLRPC server listener-socket ready\n" );
+        if( tcpIpSocketAccept( &(n->xmlrpc_listner_proc.socket),
+            &(n->xmlrpc_server_proc[server_i].socket) ) == TCPIPSOCKET_DONE &&
+            tcpIpSocketSetReuse( &(n->xmlrpc_server_proc[server_i].socket) ) &&
+            tcpIpSocketSetNonBlocking( &(n->xmlrpc_server_proc[server_i].socket ) ) )
 
-      tcpros_client_fd = tcpIpSocketGetFD( &(client_proc->socket) );
-      FD_SET( tcpros_client_fd, &w_fds);
-      FD_SET( tcpros_client_fd, &err_fds);
-      if( tcpros_client_fd > nfds ) nfds = tcpros_client_fd;
+          xmlrpcProcessChangeState( &(n->xmlrpc_server_proc[server_i]), XMLRPC_PROCESS_STATE_READING );
+      }
+      break;
     }
-    else if(client_proc->state == TCPROS_PROCESS_STATE_WRITING_HEADER)
+    case CN_PROC_XMLRPC_SERVER:
     {
-      tcpros_client_fd = tcpIpSocketGetFD( &(client_proc->socket) );
-      FD_SET( tcpros_client_fd, &w_fds);
-      FD_SET( tcpros_client_fd, &err_fds);
-      if( tcpros_client_fd > nfds ) nfds = tcpros_client_fd;
+      XmlrpcProcess *server_proc = &n->xmlrpc_server_proc[i];
+      if( server_proc->state != XMLRPC_PROCESS_STATE_IDLE && (events & CROS_POLLER_ERROR) )
+      {
+        PRINT_ERROR ( "cRosNodeDoEventsLoop() : XMLRPC server socket error\n" );
+        tcpIpSocketClose( &(server_proc->socket) );
+        xmlrpcProcessChangeState( server_proc, XMLRPC_PROCESS_STATE_IDLE );
+      }
+      else if( ( server_proc->state == XMLRPC_PROCESS_STATE_WRITING && (events & CROS_POLLER_WRITE) ) ||
+               ( server_proc->state == XMLRPC_PROCESS_STATE_READING && (events & CROS_POLLER_READ) ) )
+      {
+        ret_err = doWithXmlrpcServerSocket( n, i );
+      }
+      break;
     }
-    else if(client_proc->state == TCPROS_PROCESS_STATE_READING_HEADER_SIZE ||
-            client_proc->state == TCPROS_PROCESS_STATE_READING_HEADER ||
-            client_proc->state == TCPROS_PROCESS_STATE_READING_SIZE ||
-            client_proc->state == TCPROS_PROCESS_STATE_READING)
+    case CN_PROC_TCPROS_CLIENT:
     {
-      tcpros_client_fd = tcpIpSocketGetFD( &(client_proc->socket) );
-      FD_SET( tcpros_client_fd, &r_fds);
-      FD_SET( tcpros_client_fd, &err_fds);
-      if( tcpros_client_fd > nfds ) nfds = tcpros_client_fd;
+      TcprosProcess *client_proc = &(n->tcpros_client_proc[i]);
+      if( client_proc->state != TCPROS_PROCESS_STATE_IDLE && (events & CROS_POLLER_ERROR) )
+      {
+        PRINT_ERROR ( "cRosNodeDoEventsLoop() : TCPROS client socket error\n" );
+        handleTcprosClientError( n, i );
+      }
+      else if( ( client_proc->state == TCPROS_PROCESS_STATE_CONNECTING && (events & CROS_POLLER_WRITE) ) || // The poller indicates connection completion through write readiness
+               ( client_proc->state == TCPROS_PROCESS_STATE_WRITING_HEADER && (events & CROS_POLLER_WRITE) ) ||
+               ( client_proc->state == TCPROS_PROCESS_STATE_READING_SIZE && (events & CROS_POLLER_READ) ) ||
+               ( client_proc->state == TCPROS_PROCESS_STATE_READING && (events & CROS_POLLER_READ) ) ||
+               ( client_proc->state == TCPROS_PROCESS_STATE_READING_HEADER_SIZE && (events & CROS_POLLER_READ) ) ||
+               ( client_proc->state == TCPROS_PROCESS_STATE_READING_HEADER && (events & CROS_POLLER_READ) ) )
+      {
+        ret_err = doWithTcprosClientSocket( n, i );
+      }
+      break;
+    }
+    case CN_PROC_TCPROS_LISTNER:
+    {
+      int server_i;
+      if( events & CROS_POLLER_ERROR )
+      {
+        PRINT_ERROR ( "cRosNodeDoEventsLoop() : TCPROS listener-socket error\n" );
+      }
+      else if( (events & CROS_POLLER_READ) &&
+               (server_i = recruitNodeServerProc( n, CN_PROC_TCPROS_SERVER )) >= 0 )
+      {
+        PRINT_DEBUG ( "cRosNodeDoEventsLoop() : TCPROS listner ready\n" );
+        if( tcpIpSocketAccept( &(n->tcpros_listner_proc.socket),
+            &(n->tcpros_server_proc[server_i].socket) ) == TCPIPSOCKET_DONE &&
+            tcpIpSocketSetReuse( &(n->tcpros_server_proc[server_i].socket) ) &&
+            tcpIpSocketSetNonBlocking( &(n->tcpros_server_proc[server_i].socket ) ) &&
+            tcpIpSocketSetKeepAlive( &(n->tcpros_server_proc[server_i].socket ), 60, 10, 9 ) )
+        {
+          tcprosProcessChangeState( &(n->tcpros_server_proc[server_i]), TCPROS_PROCESS_STATE_READING_HEADER ); // A TCPROS process has been activated to attend the connection
+          n->tcpros_server_proc[server_i].wake_up_time = cRosClockGetTimeNs();
+        }
+      }
+      break;
+    }
+    case CN_PROC_TCPROS_SERVER:
+    {
+      TcprosProcess *server_proc = &n->tcpros_server_proc[i];
+      if( server_proc->state != TCPROS_PROCESS_STATE_IDLE && (events & CROS_POLLER_ERROR) )
+      {
+        PRINT_ERROR ( "cRosNodeDoEventsLoop() : TCPROS server socket error\n" );
+        tcpIpSocketClose( &(server_proc->socket) );
+        tcprosProcessChangeState( server_proc, TCPROS_PROCESS_STATE_IDLE );
+      }
+      else if( ( server_proc->state == TCPROS_PROCESS_STATE_READING_HEADER && (events & CROS_POLLER_READ) ) ||
+               ( server_proc->state == TCPROS_PROCESS_STATE_START_WRITING && (events & CROS_POLLER_WRITE) ) ||
+               ( server_proc->state == TCPROS_PROCESS_STATE_WRITING && (events & CROS_POLLER_WRITE) ) )
+      {
+        ret_err = doWithTcprosServerSocket( n, i );
+      }
+      break;
+    }
+    case CN_PROC_RPCROS_CLIENT:
+    {
+      TcprosProcess *client_proc = &(n->rpcros_client_proc[i]);
+      if( client_proc->state != TCPROS_PROCESS_STATE_IDLE && (events & CROS_POLLER_ERROR) )
+      {
+        PRINT_ERROR ( "cRosNodeDoEventsLoop() : RPCROS client socket error\n" );
+        handleRpcrosClientError( n, i );
+      }
+      else if( ( client_proc->state == TCPROS_PROCESS_STATE_CONNECTING && (events & CROS_POLLER_WRITE) ) ||
+               ( client_proc->state == TCPROS_PROCESS_STATE_WRITING_HEADER && (events & CROS_POLLER_WRITE) ) ||
+               ( client_proc->state == TCPROS_PROCESS_STATE_READING_SIZE && (events & CROS_POLLER_READ) ) ||
+               ( client_proc->state == TCPROS_PROCESS_STATE_READING && (events & CROS_POLLER_READ) ) ||
+               ( client_proc->state == TCPROS_PROCESS_STATE_READING_HEADER_SIZE && (events & CROS_POLLER_READ) ) ||
+               ( client_proc->state == TCPROS_PROCESS_STATE_READING_HEADER && (events & CROS_POLLER_READ) ) ||
+               ( client_proc->state == TCPROS_PROCESS_STATE_START_WRITING && (events & CROS_POLLER_WRITE) ) ||
+               ( client_proc->state == TCPROS_PROCESS_STATE_WRITING && (events & CROS_POLLER_WRITE) ) )
+      {
+        ret_err = doWithRpcrosClientSocket( n, i );
+      }
+      // The connection may be ready for the next call posted by other threads, or have received the response of the current one
+      // (client process i always serves service caller i, even once an error has closed it)
+      if( n->service_callers[i].posted_calls != NULL )
+        attendPostedServiceCalls( n, i );
+      break;
+    }
+    case CN_PROC_RPCROS_LISTNER:
+    {
+      int server_i;
+      if( events & CROS_POLLER_ERROR )
+      {
+        PRINT_ERROR ( "cRosNodeDoEventsLoop() : RPCROS listener-socket error\n" );
+      }
+      else if( (events & CROS_POLLER_READ) &&
+               (server_i = recruitNodeServerProc( n, CN_PROC_RPCROS_SERVER )) >= 0 )
+      {
+        PRINT_DEBUG ( "cRosNodeDoEventsLoop() : RPCROS listener ready\n" );
+        if( tcpIpSocketAccept( &(n->rpcros_listner_proc.socket),
+            &(n->rpcros_server_proc[server_i].socket) ) == TCPIPSOCKET_DONE &&
+            tcpIpSocketSetReuse( &(n->rpcros_server_proc[server_i].socket) ) &&
+            tcpIpSocketSetNonBlocking( &(n->rpcros_server_proc[server_i].socket ) ) &&
+            tcpIpSocketSetKeepAlive( &(n->rpcros_server_proc[server_i].socket ), 60, 10, 9 ) )
+        {
+          tcprosProcessChangeState( &(n->rpcros_server_proc[server_i]), TCPROS_PROCESS_STATE_READING_HEADER_SIZE );
+        }
+      }
+      break;
+    }
+    case CN_PROC_RPCROS_SERVER:
+    {
+      TcprosProcess *server_proc = &(n->rpcros_server_proc[i]);
+      if( server_proc->state != TCPROS_PROCESS_STATE_IDLE && (events & CROS_POLLER_ERROR) )
+      {
+        PRINT_ERROR ( "cRosNodeDoEventsLoop() : RPCROS server socket error\n" );
+        tcpIpSocketClose( &(server_proc->socket) );
+        tcprosProcessChangeState( server_proc, TCPROS_PROCESS_STATE_IDLE );
+      }
+      else if( ( server_proc->state == TCPROS_PROCESS_STATE_READING_HEADER_SIZE && (events & CROS_POLLER_READ) ) ||
+               ( server_proc->state == TCPROS_PROCESS_STATE_READING_HEADER && (events & CROS_POLLER_READ) ) ||
+               ( server_proc->state == TCPROS_PROCESS_STATE_READING_SIZE && (events & CROS_POLLER_READ) ) ||
+               ( server_proc->state == TCPROS_PROCESS_STATE_READING && (events & CROS_POLLER_READ) ) ||
+               ( server_proc->state == TCPROS_PROCESS_STATE_WRITING_HEADER && (events & CROS_POLLER_WRITE) ) ||
+               ( server_proc->state == TCPROS_PROCESS_STATE_WRITING && (events & CROS_POLLER_WRITE) ) )
+      {
+        ret_err = doWithRpcrosServerSocket( n, i );
+      }
+      break;
+    }
+    case CN_PROC_WAKEUP:
+    {
+      if( events & CROS_POLLER_READ )
+      {
+        cRosWakeupDrain( &n->wakeup );
+        // The threads that post a message after this point wake up the loop again
+        __atomic_exchange_n( &n->posts_pending, 0, __ATOMIC_ACQ_REL );
+        handleDoneTasks( n );
+        handlePostedFrames( n );
+        handlePostedCalls( n );
+        handleIoShardEvents( n );
+      }
+      break;
     }
   }
 
-  /* Add to the select() the active TCPROS servers */
-  int next_tcpros_server_i = -1; // Index of the first server that is idle (ready to be activated). -1 = no one is idle
-  for( i = 0; i < CN_MAX_TCPROS_SERVER_CONNECTIONS; i++ )
+  return ret_err;
+}
+
+/* Set the deadline of the timer of a process, creating the timer the first time that it is armed */
+static void scheduleProcTimer( CrosNode *n, int *timer_id, CrosNodeProcType proc_type, int i, uint64_t deadline )
+{
+  if( *timer_id < 0 )
   {
-    int server_fd = tcpIpSocketGetFD( &(n->tcpros_server_proc[i].socket) );
+    if( deadline == CROS_TIMER_NEVER )
+      return;
+    *timer_id = cRosTimerHeapAdd( &n->timers, CN_POLLER_TAG( proc_type, i ) );
+    if( *timer_id < 0 )
+      return;
+  }
+
+  if( cRosTimerHeapGetDeadline( &n->timers, *timer_id ) != deadline )
+    cRosTimerHeapArm( &n->timers, *timer_id, deadline );
+}
+
+/* The deadline of a process whose last I/O operation must be completed within CN_IO_TIMEOUT milliseconds */
+static uint64_t getIoTimeoutDeadline( uint64_t last_change_time )
+{
+  return last_change_time + CN_IO_TIMEOUT * CROS_CLOCK_NS_PER_MS + 1;
+}
+
+/* The XMLRPC client of roscore wakes up periodically to ping it, and times out when it is not idle */
+static uint64_t getRoscoreClientDeadline( XmlrpcProcess *proc )
+{
+  uint64_t deadline = proc->wake_up_time;
+  if( proc->state != XMLRPC_PROCESS_STATE_IDLE && getIoTimeoutDeadline( proc->last_change_time ) < deadline )
+    deadline = getIoTimeoutDeadline( proc->last_change_time );
+  return deadline;
+}
 
-    if( next_tcpros_server_i < 0 &&
-        n->tcpros_server_proc[i].state == TCPROS_PROCESS_STATE_IDLE )
+static uint64_t getTcprosServerDeadline( CrosNode *n, TcprosProcess *proc )
+{
+  switch( proc->state )
+  {
+    case TCPROS_PROCESS_STATE_WAIT_FOR_WRITING:
+      if( cRosRingBufferUsage( &(proc->out_frames) ) > 0 ) // Published messages are waiting to be sent
+        return 0;
+      if( n->pubs[proc->topic_idx].loop_period_ns >= 0 ) // Periodic publication
+        return proc->wake_up_time;
+      return CROS_TIMER_NEVER;
+    case TCPROS_PROCESS_STATE_SHARDED: // The shard times out the I/O, but the periodic messages are still prepared here
+      if( n->pubs[proc->topic_idx].loop_period_ns >= 0 )
+        return proc->wake_up_time;
+      return CROS_TIMER_NEVER;
+    case TCPROS_PROCESS_STATE_READING_HEADER:
+    case TCPROS_PROCESS_STATE_WRITING:
+      return getIoTimeoutDeadline( proc->last_change_time );
+    default:
+      return CROS_TIMER_NEVER;
+  }
+}
+
+static uint64_t getRpcrosClientDeadline( CrosNode *n, TcprosProcess *proc )
+{
+  switch( proc->state )
+  {
+    case TCPROS_PROCESS_STATE_WAIT_FOR_WRITING:
+      if( proc->send_msg_now != 0 ) // A service call is waiting to be sent
+        return 0;
+      if( n->service_callers[proc->service_idx].loop_period_ns >= 0 ) // Periodic calling
+        return proc->wake_up_time;
+      return CROS_TIMER_NEVER;
+    case TCPROS_PROCESS_STATE_READING_HEADER: // Add more states to the condition???
+    case TCPROS_PROCESS_STATE_WRITING:
+      return getIoTimeoutDeadline( proc->last_change_time );
+    default:
+      return CROS_TIMER_NEVER;
+  }
+}
+
+/* Arm the timer of a process with its next deadline (only the roscore client, the TCPROS servers and the RPCROS clients
+   have timers) */
+static void armNodeProcTimer( CrosNode *n, CrosNodeProcType proc_type, int i )
+{
+  switch( proc_type )
+  {
+    case CN_PROC_XMLRPC_CLIENT:
+      if( i == 0 )
+        scheduleProcTimer( n, &n->xmlrpc_client_proc[0].timer_id, proc_type, 0, getRoscoreClientDeadline( &n->xmlrpc_client_proc[0] ) );
+      break;
+    case CN_PROC_TCPROS_SERVER:
+      scheduleProcTimer( n, &n->tcpros_server_proc[i].timer_id, proc_type, i, getTcprosServerDeadline( n, &n->tcpros_server_proc[i] ) );
+      break;
+    case CN_PROC_RPCROS_CLIENT:
+      scheduleProcTimer( n, &n->rpcros_client_proc[i].timer_id, proc_type, i, getRpcrosClientDeadline( n, &n->rpcros_client_proc[i] ) );
+      break;
+    default:
+      break;
+  }
+}
+
+/* Update the events watched for the socket of a process that changed, and its timer. The clients that must connect start
+   their connections first, since the connection completion is then acknowledged as ready for writing */
+static cRosErrCodePack updateChangedNodeProc( CrosNode *n, CrosNodeProcType proc_type, int i )
+{
+  cRosErrCodePack ret_err = CROS_SUCCESS_ERR_PACK;
+
+  if( i < 0 || i >= getNodeProcCount( n, proc_type ) )
+    return ret_err;
+
+  switch( proc_type )
+  {
+    case CN_PROC_XMLRPC_CLIENT:
+      if( n->xmlrpc_client_proc[i].state == XMLRPC_PROCESS_STATE_CONNECTING )
+        ret_err = xmlrpcClientConnect( n, i );
+      watchXmlrpcProcess( n, &n->xmlrpc_client_proc[i], proc_type, i, getXmlrpcClientEvents( &n->xmlrpc_client_proc[i] ) );
+      break;
+    case CN_PROC_XMLRPC_SERVER:
+      watchXmlrpcProcess( n, &n->xmlrpc_server_proc[i], proc_type, i, getXmlrpcServerEvents( &n->xmlrpc_server_proc[i] ) );
+      break;
+    case CN_PROC_TCPROS_CLIENT:
+      if( n->tcpros_client_proc[i].state == TCPROS_PROCESS_STATE_CONNECTING )
+        ret_err = tcprosClientConnect( n, i );
+      watchTcprosProcess( n, &n->tcpros_client_proc[i], proc_type, i, getTcprosClientEvents( &n->tcpros_client_proc[i] ) );
+      break;
+    case CN_PROC_TCPROS_SERVER:
+      watchTcprosProcess( n, &n->tcpros_server_proc[i], proc_type, i, getTcprosServerEvents( &n->tcpros_server_proc[i] ) );
+      break;
+    case CN_PROC_RPCROS_CLIENT:
+      if( n->rpcros_client_proc[i].state == TCPROS_PROCESS_STATE_CONNECTING )
+        ret_err = rpcrosClientConnect( n, i );
+      watchTcprosProcess( n, &n->rpcros_client_proc[i], proc_type, i, getRpcrosClientEvents( &n->rpcros_client_proc[i] ) );
+      break;
+    case CN_PROC_RPCROS_SERVER:
+      watchTcprosProcess( n, &n->rpcros_server_proc[i], proc_type, i, getRpcrosServerEvents( &n->rpcros_server_proc[i] ) );
+      break;
+    default:
+      break;
+  }
+  armNodeProcTimer( n, proc_type, i );
+  return ret_err;
+}
+
+static cRosErrCodePack handleRoscoreClientTimer( CrosNode *n, uint64_t cur_time )
+{
+  cRosErrCodePack ret_err = CROS_SUCCESS_ERR_PACK;
+  int i;
+
+  XmlrpcProcess *rosproc = &n->xmlrpc_client_proc[0];
+  if(rosproc->wake_up_time <= cur_time ) // It's time to wakeup, ping master, and maybe look up in master for pending services
+  {
+    if(rosproc->state == XMLRPC_PROCESS_STATE_IDLE)
     {
-      next_tcpros_server_i = i;
+      /* Prepare to ping roscore ... */
+      PRINT_DEBUG("cRosNodeDoEventsLoop() : ping roscore\n");
+
+      RosApiCall *call = newRosApiCall();
+      if (call != NULL)
+      {
+        call->method = CROS_API_GET_PID;
+        int rc = xmlrpcParamVectorPushBackString(&call->params, "/rosout");
+        if(rc >= 0)
+        {
+          rosproc->message_type = XMLRPC_MESSAGE_REQUEST;
+          generateXmlrpcMessage( n->roscore_host, n->roscore_port, rosproc->message_type,
+                                getMethodName(call->method), &call->params, &rosproc->message );
+
+          rosproc->current_call = call;
+          xmlrpcProcessChangeState(rosproc, XMLRPC_PROCESS_STATE_CONNECTING );
+        }
+        else
+        {
+          PRINT_ERROR ( "cRosNodeDoEventsLoop() : Can't allocate memory\n");
+          ret_err=CROS_MEM_ALLOC_ERR;
+        }
+
+        // The ROS master does not warn us when then a new service is registered, so we have to
+        // continuously check for the required service
+        for(i = 0; i < n->rpcros_client_proc_table.size; i++ )
+        {
+           TcprosProcess *client_proc = &(n->rpcros_client_proc[i]);
+           if( client_proc->state == TCPROS_PROCESS_STATE_WAIT_FOR_CONNECTING)
+           {
+             tcprosProcessChangeState(client_proc, TCPROS_PROCESS_STATE_IDLE);
+             enqueueServiceLookup(n, client_proc->service_idx);
+           }
+        }
+        rosproc->wake_up_time = cur_time + CN_PING_LOOP_PERIOD * CROS_CLOCK_NS_PER_MS; // The process completed doing what it should, so wake up again CN_PING_LOOP_PERIOD milliseconds later
+      }
+      else
+      {
+        PRINT_ERROR ( "cRosNodeDoEventsLoop() : Can't allocate memory\n");
+        ret_err=CROS_MEM_ALLOC_ERR;
+      }
     }
-    else if( n->tcpros_server_proc[i].state == TCPROS_PROCESS_STATE_READING_HEADER )
+    else
+      rosproc->wake_up_time = cur_time + CN_PING_LOOP_PERIOD * CROS_CLOCK_NS_PER_MS / 50; // The process is busy, so try to wake up again soon (CN_PING_LOOP_PERIOD/100 milliseconds later) to do what is pending
+  }
+  if( rosproc->state != XMLRPC_PROCESS_STATE_IDLE &&
+           cur_time - rosproc->last_change_time > CN_IO_TIMEOUT * CROS_CLOCK_NS_PER_MS ) // last_change_time is updated when changing process state
+  {
+    /* Timeout between I/O operations... close the socket and re-advertise */
+    PRINT_DEBUG ( "cRosNodeDoEventsLoop() : XMLRPC client I/O timeout\n");
+    handleXmlrpcClientError( n, 0 );
+  }
+  return ret_err;
+}
+
+static cRosErrCodePack handleTcprosServerTimer( CrosNode *n, int i, uint64_t cur_time )
+{
+  cRosErrCodePack ret_err = CROS_SUCCESS_ERR_PACK;
+
+  if(n->tcpros_server_proc[i].state == TCPROS_PROCESS_STATE_SHARDED)
+  {
+    if(n->tcpros_server_proc[i].wake_up_time <= cur_time && // Periodic sending: the message is prepared here and sent by the shard
+       n->pubs[n->tcpros_server_proc[i].topic_idx].loop_period_ns >= 0 &&
+       !cRosIoShardHasFailed(&n->io_shards[n->tcpros_server_proc[i].io_shard]))
     {
-      FD_SET( server_fd, &r_fds);
-      FD_SET( server_fd, &err_fds);
-      if( server_fd > nfds ) nfds = server_fd;
+      uint64_t loop_period = (uint64_t)n->pubs[n->tcpros_server_proc[i].topic_idx].loop_period_ns;
+      uint64_t cycle_time = (loop_period > 0)? cur_time - cur_time % loop_period : cur_time;
+      n->tcpros_server_proc[i].wake_up_time = cycle_time + loop_period;
+      ret_err = cRosMessagePreparePublicationPacket( n, i );
+
+      TcprosProcess *server_proc = &(n->tcpros_server_proc[i]); // The node tables may have been moved by the callback
+      if( server_proc->frame == NULL )
+        return ret_err;
+      CrosIoShardMsg *msg = cRosIoShardNewMsg( CROS_IO_SHARD_PUBLISH );
+      if( msg == NULL )
+      {
+        tcprosProcessSetFrame( server_proc, NULL );
+        return CROS_MEM_ALLOC_ERR;
+      }
+      msg->server_idx = i;
+      msg->topic_idx = server_proc->topic_idx;
+      msg->frame = server_proc->frame; // The reference of the process is passed to the message
+      server_proc->frame = NULL;
+      cRosIoShardPost( &n->io_shards[server_proc->io_shard], msg );
     }
-    else if( n->tcpros_server_proc[i].state == TCPROS_PROCESS_STATE_START_WRITING ||
-             n->tcpros_server_proc[i].state == TCPROS_PROCESS_STATE_WRITING )
+  }
+  else if(n->tcpros_server_proc[i].state == TCPROS_PROCESS_STATE_WAIT_FOR_WRITING) // TCPROS process ready to write
+  {
+    if(cRosRingBufferUsage( &(n->tcpros_server_proc[i].out_frames) ) > 0) // Is there a published msg waiting in the outgoing queue? (immediate sending)
     {
-      FD_SET( server_fd, &w_fds);
-      FD_SET( server_fd, &err_fds);
-      if( server_fd > nfds ) nfds = server_fd;
+      tcprosProcessChangeState( &(n->tcpros_server_proc[i]), TCPROS_PROCESS_STATE_START_WRITING );
     }
-    else if( n->tcpros_server_proc[i].state == TCPROS_PROCESS_STATE_WAIT_FOR_WRITING )
+    else if(n->tcpros_server_proc[i].wake_up_time <= cur_time && // Is it time to call the callback function and send the topic msg? (periodic sending)
+            n->pubs[n->tcpros_server_proc[i].topic_idx].loop_period_ns >= 0)
     {
-      FD_SET( server_fd, &err_fds);
-      if( server_fd > nfds ) nfds = server_fd;
+      uint64_t loop_period = (uint64_t)n->pubs[n->tcpros_server_proc[i].topic_idx].loop_period_ns;
+      // Align the publication cycles to multiples of the loop period, so that all the subscribers of the
+      // topic are woken up at the same time and can share the same serialized message
+      uint64_t cycle_time = (loop_period > 0)? cur_time - cur_time % loop_period : cur_time;
+      n->tcpros_server_proc[i].wake_up_time = cycle_time + loop_period;
+      tcprosProcessChangeState( &(n->tcpros_server_proc[i]), TCPROS_PROCESS_STATE_START_WRITING );
     }
   }
+  else if( (n->tcpros_server_proc[i].state == TCPROS_PROCESS_STATE_READING_HEADER ||
+            n->tcpros_server_proc[i].state == TCPROS_PROCESS_STATE_WRITING ) &&
+           cur_time - n->tcpros_server_proc[i].last_change_time > CN_IO_TIMEOUT * CROS_CLOCK_NS_PER_MS )
+  {
+    /* Timeout between I/O operations */
+    PRINT_DEBUG ( "cRosNodeDoEventsLoop() : TCPROS server I/O timeout\n");
+    handleTcprosServerError( n, i );
+  }
+  return ret_err;
+}
 
-  /* If one TCPROS server is available at least, add to the select() the listener socket */
-  if( next_tcpros_server_i >= 0)
+static void handleRpcrosClientTimer( CrosNode *n, int i, uint64_t cur_time )
+{
+  if( n->rpcros_client_proc[i].state == TCPROS_PROCESS_STATE_WAIT_FOR_WRITING) // RPCROS process ready to write
   {
-    if(tcpros_listner_fd != -1) // If the listener socket is still opened
+    if(n->rpcros_client_proc[i].send_msg_now != 0) // Is there a service call waiting to be sent in the buffer? (immediate calling)
     {
-      FD_SET( tcpros_listner_fd, &r_fds);
-      FD_SET( tcpros_listner_fd, &err_fds);
-      if( tcpros_listner_fd > nfds ) nfds = tcpros_listner_fd;
+      tcprosProcessChangeState( &(n->rpcros_client_proc[i]), TCPROS_PROCESS_STATE_START_WRITING );
     }
+    else if(n->service_callers[n->rpcros_client_proc[i].service_idx].loop_period_ns >= 0 && // Is it time to call the callback function and send the service call? (periodic calling)
+            n->rpcros_client_proc[i].wake_up_time <= cur_time)
+    {
+      uint64_t loop_period = (uint64_t)n->service_callers[n->rpcros_client_proc[i].service_idx].loop_period_ns;
+      // Keep the calls on the grid of the previous ones, so that the period does not drift with the wake-up delays
+      uint64_t next_time = n->rpcros_client_proc[i].wake_up_time + loop_period;
+      n->rpcros_client_proc[i].wake_up_time = (next_time > cur_time)? next_time : cur_time + loop_period;
+      tcprosProcessChangeState( &(n->rpcros_client_proc[i]), TCPROS_PROCESS_STATE_START_WRITING );
+    }
+  }
+  else if( (n->rpcros_client_proc[i].state == TCPROS_PROCESS_STATE_READING_HEADER ||
+            n->rpcros_client_proc[i].state == TCPROS_PROCESS_STATE_WRITING ) &&
+           cur_time - n->rpcros_client_proc[i].last_change_time > CN_IO_TIMEOUT * CROS_CLOCK_NS_PER_MS )
+  {
+    /* Timeout between I/O operations */
+    PRINT_DEBUG ( "cRosNodeDoEventsLoop() : RPCROS client I/O timeout\n");
+    handleRpcrosClientError( n, i );
   }
+}
 
-  uint64_t tmp_timeout, cur_time = cRosClockGetTimeMs();
+/* Attend a process whose timer has expired. The process is queued as changed, so that its timer is armed again before
+   the next wait */
+static cRosErrCodePack handleNodeProcTimer( CrosNode *n, CrosNodeProcType proc_type, int i, uint64_t cur_time )
+{
+  cRosErrCodePack ret_err = CROS_SUCCESS_ERR_PACK;
 
-  if( n->xmlrpc_client_proc[0].wake_up_time_ms > cur_time )
-    tmp_timeout = n->xmlrpc_client_proc[0].wake_up_time_ms - cur_time;
-  else
-    tmp_timeout = 0;
+  if( i < 0 || i >= getNodeProcCount( n, proc_type ) )
+    return ret_err;
+
+  switch( proc_type )
+  {
+    case CN_PROC_XMLRPC_CLIENT:
+      if( i == 0 )
+        ret_err = handleRoscoreClientTimer( n, cur_time );
+      break;
+    case CN_PROC_TCPROS_SERVER:
+      ret_err = handleTcprosServerTimer( n, i, cur_time );
+      break;
+    case CN_PROC_RPCROS_CLIENT:
+      handleRpcrosClientTimer( n, i, cur_time );
+      break;
+    default:
+      break;
+  }
+  cRosPollerEntryNotify( getNodeProcPollerEntry( n, proc_type, i ) );
+  return ret_err;
+}
+
+static cRosErrCodePack doNodeEventsLoop ( CrosNode *n, uint64_t timeout )
+{
+  cRosErrCodePack ret_err;
+  uint64_t tag;
+  int i = 0;
+
+  ret_err = CROS_SUCCESS_ERR_PACK; // Default return value: success
 
-  if( tmp_timeout < timeout )
-    timeout = tmp_timeout;
+  #if CROS_DEBUG_LEVEL >= 2
+  printNodeProcState( n );
+  #endif
 
-  for( i = 0; i < CN_MAX_TCPROS_SERVER_CONNECTIONS; i++ )
+  XmlrpcProcess *coreproc = &n->xmlrpc_client_proc[0];
+  if (coreproc->state == XMLRPC_PROCESS_STATE_IDLE && !isQueueEmpty(&n->master_api_queue))
   {
-    if( n->tcpros_server_proc[i].state == TCPROS_PROCESS_STATE_WAIT_FOR_WRITING)
-    {
-      if( n->tcpros_server_proc[i].wake_up_time_ms > cur_time )
-        tmp_timeout = n->tcpros_server_proc[i].wake_up_time_ms - cur_time;
-      else
-        tmp_timeout = 0;
+    RosApiCall *call = dequeueApiCall(&n->master_api_queue);
+    coreproc->current_call = call;
+    xmlrpcProcessChangeState( coreproc, XMLRPC_PROCESS_STATE_CONNECTING );
+  }
 
-      if( tmp_timeout < timeout )
-        timeout = tmp_timeout;
+  // Assign the pending slave API calls to the idle XMLRPC clients (xmlrpc_client_proc[0] is for roscore only)
+  for(i = 1; i < n->xmlrpc_client_proc_table.size && !isQueueEmpty(&n->slave_api_queue); i++)
+  {
+    XmlrpcProcess *proc =  &n->xmlrpc_client_proc[i];
+    if (proc->state == XMLRPC_PROCESS_STATE_IDLE)
+    {
+      RosApiCall *call = dequeueApiCall(&n->slave_api_queue);
+      proc->current_call = call;
+      xmlrpcProcessChangeState( proc, XMLRPC_PROCESS_STATE_CONNECTING );
     }
   }
 
-  /*
-   *
-   * RPCROS PROCESSES SELECT() MANAGEMENT
-   *
-   */
+  cRosPollerBegin( &n->poller );
 
-  /* If active (not idle state), add to the select() the TCPROS clients */
-  for(i = 0; i < CN_MAX_RPCROS_CLIENT_CONNECTIONS; i++)
+  /* Update the watched sockets and the timers of the processes that changed since the last wait */
+  while( cRosPollerPopChange( &n->poller, &tag ) )
   {
-    int rpcros_client_fd;
+    cRosErrCodePack new_errors;
+    new_errors = updateChangedNodeProc( n, (CrosNodeProcType)(tag >> 32), (int)(tag & 0xFFFFFFFFU) );
+    ret_err = cRosAddErrCodePackIfErr(ret_err, new_errors);
+  }
 
-    rpcros_client_fd = tcpIpSocketGetFD( &(n->rpcros_client_proc[i].socket) );
-    if(n->rpcros_client_proc[i].state == TCPROS_PROCESS_STATE_CONNECTING)
-    {
-      cRosErrCodePack new_errors;
-      new_errors =  rpcrosClientConnect(n, i);
-      ret_err = cRosAddErrCodePackIfErr(ret_err, new_errors);
+  /* Watch the listener sockets (if they are still opened): the server tables are enlarged if no server is idle */
+  watchXmlrpcProcess( n, &n->xmlrpc_listner_proc, CN_PROC_XMLRPC_LISTNER, 0, CROS_POLLER_READ | CROS_POLLER_ERROR );
+  watchTcprosProcess( n, &n->tcpros_listner_proc, CN_PROC_TCPROS_LISTNER, 0, CROS_POLLER_READ | CROS_POLLER_ERROR );
+  watchTcprosProcess( n, &n->rpcros_listner_proc, CN_PROC_RPCROS_LISTNER, 0, CROS_POLLER_READ | CROS_POLLER_ERROR );
 
-      rpcros_client_fd = tcpIpSocketGetFD( &(n->rpcros_client_proc[i].socket) ); // update file descriptor after connecting
-      FD_SET( rpcros_client_fd, &w_fds);
-      FD_SET( rpcros_client_fd, &err_fds);
-      if( rpcros_client_fd > nfds ) nfds = rpcros_client_fd;
-    }
-    else if(n->rpcros_client_proc[i].state == TCPROS_PROCESS_STATE_WRITING_HEADER ||
-       n->rpcros_client_proc[i].state == TCPROS_PROCESS_STATE_START_WRITING ||
-       n->rpcros_client_proc[i].state == TCPROS_PROCESS_STATE_WRITING)
+  /* Watch the wake-up from other threads (once the node has been run in threaded mode) */
+  cRosPollerWatch( &n->poller, &n->wakeup.poller_entry, n->wakeup.read_fd, CROS_POLLER_READ, 0, CN_POLLER_TAG( CN_PROC_WAKEUP, 0 ) );
+
+  /* Sleep until the earliest deadline of the processes at most */
+  uint64_t next_deadline = cRosTimerHeapNextDeadline( &n->timers ), cur_time = cRosClockGetTimeNs();
+  uint64_t timeout_ns = ( timeout < UINT64_MAX / CROS_CLOCK_NS_PER_MS )? timeout * CROS_CLOCK_NS_PER_MS : UINT64_MAX;
+  uint64_t tmp_timeout = ( next_deadline > cur_time )? next_deadline - cur_time : 0;
+  if( tmp_timeout < timeout_ns )
+    timeout_ns = tmp_timeout;
+
+  int n_set = cRosPollerWait( &n->poller, timeout_ns );
+
+  if (n_set == -1)
+  {
+    if (errno == EINTR)
     {
-      FD_SET( rpcros_client_fd, &w_fds);
-      FD_SET( rpcros_client_fd, &err_fds);
-      if( rpcros_client_fd > nfds ) nfds = rpcros_client_fd;
+      PRINT_DEBUG("cRosNodeDoEventsLoop() : poller wait returned EINTR\n");
     }
-    else if(n->rpcros_client_proc[i].state == TCPROS_PROCESS_STATE_READING_HEADER_SIZE ||
-            n->rpcros_client_proc[i].state == TCPROS_PROCESS_STATE_READING_HEADER ||
-            n->rpcros_client_proc[i].state == TCPROS_PROCESS_STATE_READING_SIZE ||
-            n->rpcros_client_proc[i].state == TCPROS_PROCESS_STATE_READING)
+    else
     {
-      FD_SET( rpcros_client_fd, &r_fds);
-      FD_SET( rpcros_client_fd, &err_fds);
-      if( rpcros_client_fd > nfds ) nfds = rpcros_client_fd;
+      PRINT_ERROR("cRosNodeDoEventsLoop() : poller wait (select() or epoll_wait()) failed. errno=%i\n", errno);
+      ret_err=CROS_SELECT_FD_ERR;
     }
-    else if(n->rpcros_client_proc[i].state == TCPROS_PROCESS_STATE_WAIT_FOR_WRITING)
+  }
+  else if( n_set == 0 )
+  {
+    PRINT_DEBUG ("cRosNodeDoEventsLoop() : poller timeout: %llu ns\n", (long long unsigned)timeout_ns);
+  }
+  else
+  {
+    PRINT_DEBUG ( "cRosNodeDoEventsLoop() : poller unblocked (timeout: %llu ns)\n", (long long unsigned)timeout_ns);
+    /* Only the processes whose sockets are ready are attended */
+    for( i = 0; i < n_set; i++ )
     {
-      FD_SET( rpcros_client_fd, &err_fds);
-      if( rpcros_client_fd > nfds ) nfds = rpcros_client_fd;
+      tag = cRosPollerGetReadyTag( &n->poller, i );
+      CrosNodeProcType proc_type = (CrosNodeProcType)(tag >> 32);
+      int proc_idx = (int)(tag & 0xFFFFFFFFU);
+      CrosPollerEntry *entry = getNodeProcPollerEntry( n, proc_type, proc_idx );
+      if( entry != NULL )
+      {
+        unsigned int events = cRosPollerGetReadyEvents( &n->poller, i, entry );
+        if( events != 0 )
+        {
+          cRosErrCodePack new_errors;
+          new_errors = handleNodeProcEvents( n, proc_type, proc_idx, events );
+          ret_err = cRosAddErrCodePackIfErr(ret_err, new_errors);
+        }
+      }
     }
+  }
 
+  if( n_set >= 0 )
+  {
+    /* Attend the processes whose deadlines have expired, also when sockets were ready so that they do not delay them */
+    cur_time = cRosClockGetTimeNs();
+    while( cRosTimerHeapPopExpired( &n->timers, cur_time, &tag ) )
+    {
+      cRosErrCodePack new_errors;
+      new_errors = handleNodeProcTimer( n, (CrosNodeProcType)(tag >> 32), (int)(tag & 0xFFFFFFFFU), cur_time );
+      ret_err = cRosAddErrCodePackIfErr(ret_err, new_errors);
+    }
   }
+  return ret_err;
+}
+
+cRosErrCodePack cRosNodeDoEventsLoop ( CrosNode *n, uint64_t timeout )
+{
+  PRINT_VDEBUG ( "cRosNodeDoEventsLoop ()\n" );
+
+  if(n == NULL)
+    return CROS_BAD_PARAM_ERR;
+
+  if(n->io_thread_running && !pthread_equal(pthread_self(), n->io_thread))
+    return CROS_NODE_THREADED_ERR; // The node loop is already run by its I/O thread
+
+  return doNodeEventsLoop( n, timeout );
+}
+
+cRosErrCodePack cRosNodeStart( CrosNode *n, unsigned long time_out, unsigned char *exit_flag )
+{
+  uint64_t start_time, elapsed_time;
+  cRosErrCodePack ret_err;
+  PRINT_VDEBUG ( "cRosNodeStart ()\n" );
+
+  start_time = cRosClockGetTimeMs();
+  ret_err = CROS_SUCCESS_ERR_PACK;
+  while(ret_err == CROS_SUCCESS_ERR_PACK && (exit_flag==NULL || !(*exit_flag)) && (time_out == CROS_INFINITE_TIMEOUT || (elapsed_time=cRosClockGetTimeMs()-start_time) <= time_out))
+    ret_err = cRosNodeDoEventsLoop( n, (time_out == CROS_INFINITE_TIMEOUT)? UINT64_MAX : time_out-elapsed_time);
+
+  return ret_err;
+}
+
+static void *runNodeIoThread( void *arg )
+{
+  CrosNode *n = (CrosNode *)arg;
+  cRosErrCodePack ret_err = CROS_SUCCESS_ERR_PACK;
+  unsigned char exit_flag = 0;
 
-  for( i = 0; i < CN_MAX_RPCROS_CLIENT_CONNECTIONS; i++ )
+  while( ret_err == CROS_SUCCESS_ERR_PACK && !exit_flag )
   {
-    if( n->rpcros_client_proc[i].state == TCPROS_PROCESS_STATE_WAIT_FOR_WRITING)
-    {
-      if( n->rpcros_client_proc[i].wake_up_time_ms > cur_time )
-        tmp_timeout = n->rpcros_client_proc[i].wake_up_time_ms - cur_time;
-      else
-        tmp_timeout = 0;
+    ret_err = doNodeEventsLoop( n, UINT64_MAX ); // cRosNodeStopThreads() wakes it up
 
-      if( tmp_timeout < timeout )
-        timeout = tmp_timeout;
-    }
+    pthread_mutex_lock( &n->tasks_mutex );
+    exit_flag = n->io_thread_exit;
+    pthread_mutex_unlock( &n->tasks_mutex );
   }
 
-  /* Add to the select() the active RPCROS servers */
-  int next_rpcros_server_i = -1;
+  if( ret_err != CROS_SUCCESS_ERR_PACK )
+    cRosPrintErrCodePack( ret_err, "runNodeIoThread() : the node loop has been stopped" );
 
-  for( i = 0; i < CN_MAX_RPCROS_SERVER_CONNECTIONS; i++ )
-  {
-    int server_fd = tcpIpSocketGetFD( &(n->rpcros_server_proc[i].socket) );
+  pthread_mutex_lock( &n->tasks_mutex );
+  n->io_thread_err = ret_err;
+  pthread_mutex_unlock( &n->tasks_mutex );
+  return NULL;
+}
 
-    if( next_rpcros_server_i < 0 &&
-        n->rpcros_server_proc[i].state == TCPROS_PROCESS_STATE_IDLE )
-    {
-    	next_rpcros_server_i = i;
-    }
-    else if (n->rpcros_server_proc[i].state == TCPROS_PROCESS_STATE_READING_HEADER_SIZE ||
-             n->rpcros_server_proc[i].state == TCPROS_PROCESS_STATE_READING_HEADER ||
-             n->rpcros_server_proc[i].state == TCPROS_PROCESS_STATE_READING_SIZE ||
-             n->rpcros_server_proc[i].state == TCPROS_PROCESS_STATE_READING)
-    {
-      FD_SET( server_fd, &r_fds);
-      FD_SET( server_fd, &err_fds);
-      if( server_fd > nfds ) nfds = server_fd;
-    }
-    else if( n->rpcros_server_proc[i].state == TCPROS_PROCESS_STATE_WRITING_HEADER ||
-             n->rpcros_server_proc[i].state == TCPROS_PROCESS_STATE_WRITING )
-    {
-      FD_SET( server_fd, &w_fds);
-      FD_SET( server_fd, &err_fds);
-      if( server_fd > nfds ) nfds = server_fd;
-    }
-  }
+/* Stop the I/O shards once they have attended the messages posted to them, and take their connections back */
+static void stopIoShards( CrosNode *n )
+{
+  int s, i;
 
-  /* If one RPCROS server is available at least, add to the select() the listner socket */
-  if( next_rpcros_server_i >= 0)
+  if( n->io_shards == NULL )
+    return;
+
+  for( s = 0; s < n->n_io_shards; s++ )
+    cRosIoShardStop( &n->io_shards[s] );
+  handleIoShardEvents( n );
+
+  for( i = 0; i < n->tcpros_server_proc_table.size; i++ )
   {
-    if(rpcros_listner_fd != -1) // If the listener socket is still opened
+    TcprosProcess *proc = &n->tcpros_server_proc[i];
+    if( proc->state != TCPROS_PROCESS_STATE_SHARDED )
+      continue;
+
+    TcprosProcess *conn = cRosIoShardTakeConn( &n->io_shards[proc->io_shard], i );
+    proc->io_shard = -1;
+    if( conn == NULL ) // Closed without notifying it
     {
-      FD_SET( rpcros_listner_fd, &r_fds);
-      FD_SET( rpcros_listner_fd, &err_fds);
-      if( rpcros_listner_fd > nfds ) nfds = rpcros_listner_fd;
+      handleTcprosServerError( n, i );
+      continue;
     }
+    tcprosProcessMoveStream( proc, conn );
+    tcprosProcessChangeState( proc, ( proc->frame != NULL )? TCPROS_PROCESS_STATE_WRITING : TCPROS_PROCESS_STATE_WAIT_FOR_WRITING );
+    tcprosProcessRelease( conn );
+    free( conn );
   }
 
-  struct timeval tv = cRosClockGetTimeVal( timeout );
+  for( s = 0; s < n->n_io_shards; s++ )
+    cRosIoShardRelease( &n->io_shards[s] );
+  free( n->io_shards );
+  n->io_shards = NULL;
+  n->n_io_shards = 0;
+}
 
-  int n_set = select(nfds + 1, &r_fds, &w_fds, &err_fds, &tv);
+static int startIoShards( CrosNode *n )
+{
+  int s;
 
-  if (n_set == -1)
+  n->io_shards = (CrosIoShard *)malloc( n->tcpros_io_shards * sizeof(CrosIoShard) );
+  if( n->io_shards == NULL )
   {
-    if (errno == EINTR)
-    {
-      PRINT_DEBUG("cRosNodeDoEventsLoop() : select() returned EINTR\n");
-    }
-    else
+    PRINT_ERROR ( "cRosNodeStartThreads() : Can't allocate memory\n" );
+    return -1;
+  }
+
+  for( s = 0; s < n->tcpros_io_shards; s++ )
+  {
+    cRosIoShardInit( &n->io_shards[s] );
+    // The closed connections are notified through the same wake-up as the frames posted by other threads
+    if( cRosIoShardStart( &n->io_shards[s], n->poller.backend, n->tcpros_out_queue_policy, CN_IO_TIMEOUT * CROS_CLOCK_NS_PER_MS,
+                          &n->io_shard_events, &n->posts_pending, &n->wakeup ) != 0 )
     {
-      PRINT_ERROR("cRosNodeDoEventsLoop() : select() function failed. errno=%i\n", errno);
-      ret_err=CROS_SELECT_FD_ERR;
+      PRINT_ERROR ( "cRosNodeStartThreads() : Can't start the I/O shard %i\n", s );
+      cRosIoShardRelease( &n->io_shards[s] );
+      n->n_io_shards = s;
+      stopIoShards( n );
+      return -1;
     }
   }
-  else if( n_set == 0 )
-  {
-    PRINT_DEBUG ("cRosNodeDoEventsLoop() : select() timeout: %llu ms\n", (long long unsigned)timeout);
+  n->n_io_shards = n->tcpros_io_shards;
 
-    uint64_t cur_time = cRosClockGetTimeMs();
+  // The connections that have already completed their handshake are moved to the shards as well
+  for( s = 0; s < n->tcpros_server_proc_table.size; s++ )
+  {
+    if( n->tcpros_server_proc[s].state == TCPROS_PROCESS_STATE_WAIT_FOR_WRITING )
+      shardTcprosServerProc( n, s );
+  }
 
-    XmlrpcProcess *rosproc = &n->xmlrpc_client_proc[0];
-    if(rosproc->wake_up_time_ms <= cur_time ) // It's time to wakeup, ping master, and maybe look up in master for pending services
-    {
-      if(rosproc->state == XMLRPC_PROCESS_STATE_IDLE)
-      {
-        /* Prepare to ping roscore ... */
-        PRINT_DEBUG("cRosNodeDoEventsLoop() : ping roscore\n");
+  return 0;
+}
 
-        RosApiCall *call = newRosApiCall();
-        if (call != NULL)
-        {
-          call->method = CROS_API_GET_PID;
-          int rc = xmlrpcParamVectorPushBackString(&call->params, "/rosout");
-          if(rc >= 0)
-          {
-            rosproc->message_type = XMLRPC_MESSAGE_REQUEST;
-            generateXmlrpcMessage( n->roscore_host, n->roscore_port, rosproc->message_type,
-                                  getMethodName(call->method), &call->params, &rosproc->message );
+cRosErrCodePack cRosNodeStartThreads( CrosNode *n, int n_workers )
+{
+  PRINT_VDEBUG ( "cRosNodeStartThreads ()\n" );
 
-            rosproc->current_call = call;
-            xmlrpcProcessChangeState(rosproc, XMLRPC_PROCESS_STATE_CONNECTING );
-          }
-          else
-          {
-            PRINT_ERROR ( "cRosNodeDoEventsLoop() : Can't allocate memory\n");
-            ret_err=CROS_MEM_ALLOC_ERR;
-          }
+  if( n == NULL || n_workers < 0 || n->io_thread_running )
+    return CROS_BAD_PARAM_ERR;
 
-          // The ROS master does not warn us when then a new service is registered, so we have to
-          // continuously check for the required service
-          for(i = 0; i < CN_MAX_RPCROS_CLIENT_CONNECTIONS; i++ )
-          {
-             TcprosProcess *client_proc = &(n->rpcros_client_proc[i]);
-             if( client_proc->state == TCPROS_PROCESS_STATE_WAIT_FOR_CONNECTING)
-             {
-               tcprosProcessChangeState(client_proc, TCPROS_PROCESS_STATE_IDLE);
-               enqueueServiceLookup(n, client_proc->service_idx);
-             }
-          }
-          rosproc->wake_up_time_ms = cur_time + CN_PING_LOOP_PERIOD; // The process completed doing what it should, so wake up again CN_PING_LOOP_PERIOD milliseconds later
-        }
-        else
-        {
-          PRINT_ERROR ( "cRosNodeDoEventsLoop() : Can't allocate memory\n");
-          ret_err=CROS_MEM_ALLOC_ERR;
-        }
-      }
-      else
-        rosproc->wake_up_time_ms = cur_time + CN_PING_LOOP_PERIOD/50; // The process is busy, so try to wake up again soon (CN_PING_LOOP_PERIOD/100 milliseconds later) to do what is pending
-    }
-    if( rosproc->state != XMLRPC_PROCESS_STATE_IDLE &&
-             cur_time - rosproc->last_change_time > CN_IO_TIMEOUT ) // last_change_time is updated when changing process state
-    {
-      /* Timeout between I/O operations... close the socket and re-advertise */
-      PRINT_DEBUG ( "cRosNodeDoEventsLoop() : XMLRPC client I/O timeout\n");
-      handleXmlrpcClientError( n, 0 );
-    }
+  if( cRosWakeupOpen( &n->wakeup ) != 0 )
+    return CROS_UNSPECIFIED_ERR;
 
-    for( i = 0; i < CN_MAX_TCPROS_SERVER_CONNECTIONS && ret_err==CROS_SUCCESS_ERR_PACK; i++ )
-    {
-      if(n->tcpros_server_proc[i].state == TCPROS_PROCESS_STATE_WAIT_FOR_WRITING) // TCPROS process ready to write
-      {
-        if(n->tcpros_server_proc[i].send_msg_now != 0) // Is there a msg waiting to be sent in the queue signaled to be sent? (immediate sending)
-        {
-          tcprosProcessChangeState( &(n->tcpros_server_proc[i]), TCPROS_PROCESS_STATE_START_WRITING );
-        }
-        else if(n->tcpros_server_proc[i].wake_up_time_ms <= cur_time && // Is it time to call the callback function and send the topic msg? (periodic sending)
-                n->pubs[n->tcpros_server_proc[i].topic_idx].loop_period >= 0)
-        {
-          n->tcpros_server_proc[i].wake_up_time_ms = cur_time + n->pubs[n->tcpros_server_proc[i].topic_idx].loop_period;
-          tcprosProcessChangeState( &(n->tcpros_server_proc[i]), TCPROS_PROCESS_STATE_START_WRITING );
-        }
-      }
-      else if( (n->tcpros_server_proc[i].state == TCPROS_PROCESS_STATE_READING_HEADER ||
-                n->tcpros_server_proc[i].state == TCPROS_PROCESS_STATE_WRITING ) &&
-               cur_time - n->tcpros_server_proc[i].last_change_time > CN_IO_TIMEOUT )
-      {
-        /* Timeout between I/O operations */
-        PRINT_DEBUG ( "cRosNodeDoEventsLoop() : TCPROS server I/O timeout\n");
-        handleTcprosServerError( n, i );
-      }
-    }
+  if( n_workers > 0 && cRosExecutorStart( &n->executor, n_workers ) != 0 )
+  {
+    cRosWakeupClose( &n->wakeup );
+    return CROS_UNSPECIFIED_ERR;
+  }
 
-    for( i = 0; i < CN_MAX_RPCROS_CLIENT_CONNECTIONS && ret_err==CROS_SUCCESS_ERR_PACK; i++ )
-    {
-      if( n->rpcros_client_proc[i].state == TCPROS_PROCESS_STATE_WAIT_FOR_WRITING) // RPCROS process ready to write
-      {
-        if(n->rpcros_client_proc[i].send_msg_now != 0) // Is there a service call waiting to be sent in the buffer? (immediate calling)
-        {
-          tcprosProcessChangeState( &(n->rpcros_client_proc[i]), TCPROS_PROCESS_STATE_START_WRITING );
-        }
-        else if(n->service_callers[n->rpcros_client_proc[i].service_idx].loop_period >= 0 && // Is it time to call the callback function and send the service call? (periodic calling)
-                n->rpcros_client_proc[i].wake_up_time_ms <= cur_time)
-        {
-          n->rpcros_client_proc[i].wake_up_time_ms = cur_time + n->service_callers[n->rpcros_client_proc[i].service_idx].loop_period;
-          tcprosProcessChangeState( &(n->rpcros_client_proc[i]), TCPROS_PROCESS_STATE_START_WRITING );
-        }
-      }
-      else if( (n->rpcros_client_proc[i].state == TCPROS_PROCESS_STATE_READING_HEADER || // Add more states to the condition???
-                n->rpcros_client_proc[i].state == TCPROS_PROCESS_STATE_WRITING ) &&
-               cur_time - n->rpcros_client_proc[i].last_change_time > CN_IO_TIMEOUT )
-      {
-        /* Timeout between I/O operations */
-        PRINT_DEBUG ( "cRosNodeDoEventsLoop() : TCPROS server I/O timeout\n");
-        handleTcprosServerError( n, i );
-      }
-    }
+  if( n->tcpros_io_shards > 0 && startIoShards( n ) != 0 )
+  {
+    cRosExecutorStop( &n->executor );
+    cRosWakeupClose( &n->wakeup );
+    return CROS_UNSPECIFIED_ERR;
   }
-  else
+
+  n->io_thread_exit = 0;
+  n->io_thread_err = CROS_SUCCESS_ERR_PACK;
+  if( pthread_create( &n->io_thread, NULL, runNodeIoThread, n ) != 0 )
   {
-    PRINT_DEBUG ( "cRosNodeDoEventsLoop() : select() unblocked (timeout: %llu ms)\n", (long long unsigned)timeout);
-    for(i = 0; i < CN_MAX_XMLRPC_CLIENT_CONNECTIONS; i++ )
-    {
-      XmlrpcProcess *client_proc;
-      int xmlrpc_client_fd;
+    PRINT_ERROR ( "cRosNodeStartThreads() : Can't create the I/O thread\n" );
+    stopIoShards( n );
+    cRosExecutorStop( &n->executor );
+    cRosWakeupClose( &n->wakeup );
+    return CROS_UNSPECIFIED_ERR;
+  }
+  n->io_thread_running = 1;
 
-      client_proc = &n->xmlrpc_client_proc[i];
-      xmlrpc_client_fd = tcpIpSocketGetFD( &client_proc->socket );
-      if( client_proc->state != XMLRPC_PROCESS_STATE_IDLE && FD_ISSET(xmlrpc_client_fd, &err_fds) )
-      {
-        PRINT_ERROR ( "cRosNodeDoEventsLoop() : XMLRPC client socket error\n" );
-        handleXmlrpcClientError( n, i );
-      }
-      /* Check what is the socket unblocked by the select, and start the requested operations */
-      else if( ( client_proc->state == XMLRPC_PROCESS_STATE_CONNECTING && FD_ISSET(xmlrpc_client_fd, &w_fds) ) ||
-          ( client_proc->state == XMLRPC_PROCESS_STATE_WRITING && FD_ISSET(xmlrpc_client_fd, &w_fds) ) ||
-          ( client_proc->state == XMLRPC_PROCESS_STATE_READING && FD_ISSET(xmlrpc_client_fd, &r_fds) ) )
-      {
-        cRosErrCodePack new_errors;
-        new_errors = doWithXmlrpcClientSocket( n, i );;
-        ret_err = cRosAddErrCodePackIfErr(ret_err, new_errors);
-      }
-    }
+  return CROS_SUCCESS_ERR_PACK;
+}
 
-    if ( next_xmlrpc_server_i >= 0 && xmlrpc_listner_fd != -1) // Check that there is an available free (idle) xmlrpx process and that the listener socket is still open
-    {
-      if( FD_ISSET( xmlrpc_listner_fd, &err_fds) )
-      {
-        PRINT_ERROR ( "cRosNodeDoEventsLoop() : XMLRPC server listener-socket error\n" );
-      }
-      else if( FD_ISSET( xmlrpc_listner_fd, &r_fds) )
-      {
-        PRINT_DEBUG ( "cRosNodeDoEventsLoop() : XMLRPC server listener-socket ready\n" );
-        if( tcpIpSocketAccept( &(n->xmlrpc_listner_proc.socket),
-            &(n->xmlrpc_server_proc[next_xmlrpc_server_i].socket) ) == TCPIPSOCKET_DONE &&
-            tcpIpSocketSetReuse( &(n->xmlrpc_server_proc[next_xmlrpc_server_i].socket) ) &&
-            tcpIpSocketSetNonBlocking( &(n->xmlrpc_server_proc[next_xmlrpc_server_i].socket ) ) )
+cRosErrCodePack cRosNodeStopThreads( CrosNode *n )
+{
+  PRINT_VDEBUG ( "cRosNodeStopThreads ()\n" );
 
-          xmlrpcProcessChangeState( &(n->xmlrpc_server_proc[next_xmlrpc_server_i]), XMLRPC_PROCESS_STATE_READING );
-      }
-    }
+  if( n == NULL || !n->io_thread_running )
+    return CROS_BAD_PARAM_ERR;
 
-    for( i = 0; i < CN_MAX_XMLRPC_SERVER_CONNECTIONS; i++ )
-    {
-      XmlrpcProcess *server_proc;
-      int server_fd;
+  pthread_mutex_lock( &n->tasks_mutex );
+  n->io_thread_exit = 1;
+  pthread_mutex_unlock( &n->tasks_mutex );
+  cRosWakeupSignal( &n->wakeup );
 
-      server_proc = &n->xmlrpc_server_proc[i];
-      server_fd = tcpIpSocketGetFD( &server_proc->socket );
-      if( server_proc->state != XMLRPC_PROCESS_STATE_IDLE && FD_ISSET(server_fd, &err_fds) )
-      {
-        PRINT_ERROR ( "cRosNodeDoEventsLoop() : XMLRPC server socket error\n" );
-        tcpIpSocketClose( &(n->xmlrpc_server_proc[i].socket) );
-        xmlrpcProcessChangeState( &(n->xmlrpc_server_proc[next_xmlrpc_server_i]), XMLRPC_PROCESS_STATE_IDLE ); // maybe server_proc instead of &(n->xmlrpc_server_proc[next_xmlrpc_server_i]) ???
-      }
-      else if( ( server_proc->state == XMLRPC_PROCESS_STATE_WRITING && FD_ISSET(server_fd, &w_fds) ) ||
-               ( server_proc->state == XMLRPC_PROCESS_STATE_READING && FD_ISSET(server_fd, &r_fds) ) )
-      {
-        cRosErrCodePack new_errors;
-        new_errors = doWithXmlrpcServerSocket( n, i );
-        ret_err = cRosAddErrCodePackIfErr(ret_err, new_errors);
-      }
-    }
+  pthread_join( n->io_thread, NULL );
+  n->io_thread_running = 0;
 
-    for(i = 0; i < CN_MAX_TCPROS_CLIENT_CONNECTIONS; i++ )
-    {
-      TcprosProcess *client_proc = &(n->tcpros_client_proc[i]);
-      int tcpros_client_fd = tcpIpSocketGetFD( &(client_proc->socket) );
+  // The service responses prepared meanwhile are sent by the next cRosNodeDoEventsLoop() calls
+  cRosExecutorStop( &n->executor );
+  handlePostedFrames( n ); // The messages published by the other threads before stopping are sent as well
+  failPostedCalls( n ); // Their threads must not wait for a node loop that they don't run
+  stopIoShards( n ); // After the last frames have been posted to the shards
 
-      if( client_proc->state != TCPROS_PROCESS_STATE_IDLE && FD_ISSET(tcpros_client_fd, &err_fds) )
-      {
-        PRINT_ERROR ( "cRosNodeDoEventsLoop() : XMLRPC client socket error\n" );
-        handleTcprosClientError( n, i );
-      }
+  return n->io_thread_err;
+}
 
-      if( (client_proc->state == TCPROS_PROCESS_STATE_CONNECTING && FD_ISSET(tcpros_client_fd, &w_fds) ) || // select() indicates connection completion through write-fd
-          ( client_proc->state == TCPROS_PROCESS_STATE_WRITING_HEADER && FD_ISSET(tcpros_client_fd, &w_fds) ) ||
-          ( client_proc->state == TCPROS_PROCESS_STATE_READING_SIZE && FD_ISSET(tcpros_client_fd, &r_fds) ) ||
-          ( client_proc->state == TCPROS_PROCESS_STATE_READING && FD_ISSET(tcpros_client_fd, &r_fds) ) ||
-          ( client_proc->state == TCPROS_PROCESS_STATE_READING_HEADER_SIZE && FD_ISSET(tcpros_client_fd, &r_fds) ) ||
-          ( client_proc->state == TCPROS_PROCESS_STATE_READING_HEADER && FD_ISSET(tcpros_client_fd, &r_fds) ) )
-      {
-        cRosErrCodePack new_errors;
-        new_errors = doWithTcprosClientSocket( n, i );
-        ret_err = cRosAddErrCodePackIfErr(ret_err, new_errors);
-      }
-    }
+CrosNodeTask *cRosNodeAcquireTask( CrosNode *n )
+{
+  CrosNodeTask *task;
 
-    if ( next_tcpros_server_i >= 0 && tcpros_listner_fd != -1)
-    {
-      if( FD_ISSET( tcpros_listner_fd, &err_fds) )
-      {
-        PRINT_ERROR ( "cRosNodeDoEventsLoop() : TCPROS listener-socket error\n" );
-      }
-      else if( FD_ISSET( tcpros_listner_fd, &r_fds) )
-      {
-        PRINT_DEBUG ( "cRosNodeDoEventsLoop() : TCPROS listner ready\n" );
-        if( tcpIpSocketAccept( &(n->tcpros_listner_proc.socket),
-            &(n->tcpros_server_proc[next_tcpros_server_i].socket) ) == TCPIPSOCKET_DONE &&
-            tcpIpSocketSetReuse( &(n->tcpros_server_proc[next_tcpros_server_i].socket) ) &&
-            tcpIpSocketSetNonBlocking( &(n->tcpros_server_proc[next_tcpros_server_i].socket ) ) &&
-            tcpIpSocketSetKeepAlive( &(n->tcpros_server_proc[next_tcpros_server_i].socket ), 60, 10, 9 ) )
-        {
-          tcprosProcessChangeState( &(n->tcpros_server_proc[next_tcpros_server_i]), TCPROS_PROCESS_STATE_READING_HEADER ); // A TCPROS process has been activated to attend the connection
-          uint64_t cur_time = cRosClockGetTimeMs();
-          n->tcpros_server_proc[next_tcpros_server_i].wake_up_time_ms = cur_time;
-        }
-      }
-    }
+  pthread_mutex_lock( &n->tasks_mutex );
+  task = n->free_tasks;
+  if( task != NULL )
+    n->free_tasks = task->next;
+  pthread_mutex_unlock( &n->tasks_mutex );
 
-    for( i = 0; i < CN_MAX_TCPROS_SERVER_CONNECTIONS; i++ )
+  if( task == NULL )
+  {
+    task = (CrosNodeTask *)malloc( sizeof(CrosNodeTask) );
+    if( task == NULL )
     {
-      TcprosProcess *server_proc;
-      int server_fd;
-
-      server_proc = &n->tcpros_server_proc[i];
-      server_fd = tcpIpSocketGetFD( &server_proc->socket );
-      if( server_proc->state != TCPROS_PROCESS_STATE_IDLE && FD_ISSET(server_fd, &err_fds) )
-      {
-        PRINT_ERROR ( "cRosNodeDoEventsLoop() : TCPROS server socket error\n" );
-        tcpIpSocketClose( &(server_proc->socket) );
-        tcprosProcessChangeState( &(n->tcpros_server_proc[next_tcpros_server_i]), TCPROS_PROCESS_STATE_IDLE );
-      }
-      else if( ( server_proc->state == TCPROS_PROCESS_STATE_READING_HEADER && FD_ISSET(server_fd, &r_fds) ) ||
-        ( server_proc->state == TCPROS_PROCESS_STATE_START_WRITING && FD_ISSET(server_fd, &w_fds) ) ||
-        ( server_proc->state == TCPROS_PROCESS_STATE_WRITING && FD_ISSET(server_fd, &w_fds) ) )
-      {
-        cRosErrCodePack new_errors;
-        new_errors = doWithTcprosServerSocket( n, i );
-        ret_err = cRosAddErrCodePackIfErr(ret_err, new_errors);
-      }
+      PRINT_ERROR ( "cRosNodeAcquireTask() : Can't allocate memory\n" );
+      return NULL;
     }
+    dynBufferInit( &task->packet );
+  }
 
-    for(i = 0; i < CN_MAX_RPCROS_CLIENT_CONNECTIONS; i++ )
-    {
-      TcprosProcess *client_proc = &(n->rpcros_client_proc[i]);
-      int rpcros_client_fd = tcpIpSocketGetFD( &(client_proc->socket) );
+  task->node = n;
+  task->owner_idx = task->proc_idx = -1;
+  task->proc_stamp = 0;
+  task->msg = NULL;
+  task->next = NULL;
+  return task;
+}
 
-      if( client_proc->state != TCPROS_PROCESS_STATE_IDLE && FD_ISSET(rpcros_client_fd, &err_fds) )
-      {
-        PRINT_ERROR ( "cRosNodeDoEventsLoop() : RPCROS client socket error\n" );
-        handleRpcrosClientError( n, i );
-      }
+void cRosNodeReleaseTask( CrosNode *n, CrosNodeTask *task )
+{
+  dynBufferClear( &task->packet ); // The packet memory is kept for the next message
 
-      if( ( client_proc->state == TCPROS_PROCESS_STATE_CONNECTING && FD_ISSET(rpcros_client_fd, &w_fds) ) ||
-          ( client_proc->state == TCPROS_PROCESS_STATE_WRITING_HEADER && FD_ISSET(rpcros_client_fd, &w_fds) ) ||
-          ( client_proc->state == TCPROS_PROCESS_STATE_READING_SIZE && FD_ISSET(rpcros_client_fd, &r_fds) ) ||
-          ( client_proc->state == TCPROS_PROCESS_STATE_READING && FD_ISSET(rpcros_client_fd, &r_fds) ) ||
-          ( client_proc->state == TCPROS_PROCESS_STATE_READING_HEADER_SIZE && FD_ISSET(rpcros_client_fd, &r_fds) ) ||
-          ( client_proc->state == TCPROS_PROCESS_STATE_READING_HEADER && FD_ISSET(rpcros_client_fd, &r_fds) ) ||
-          ( client_proc->state == TCPROS_PROCESS_STATE_START_WRITING && FD_ISSET(rpcros_client_fd, &w_fds) ) ||
-          ( client_proc->state == TCPROS_PROCESS_STATE_WRITING && FD_ISSET(rpcros_client_fd, &w_fds) ) )
-      {
-        cRosErrCodePack new_errors;
-        new_errors = doWithRpcrosClientSocket( n, i );
-        ret_err = cRosAddErrCodePackIfErr(ret_err, new_errors);
-      }
-    }
+  pthread_mutex_lock( &n->tasks_mutex );
+  task->next = n->free_tasks;
+  n->free_tasks = task;
+  pthread_mutex_unlock( &n->tasks_mutex );
+}
 
-    if ( next_rpcros_server_i >= 0 && rpcros_listner_fd != -1)
-    {
-      if( FD_ISSET( rpcros_listner_fd, &err_fds) )
-      {
-        PRINT_ERROR ( "cRosNodeDoEventsLoop() : TCPROS listener-socket error\n" );
-      }
-      else if( next_rpcros_server_i >= 0 && FD_ISSET( rpcros_listner_fd, &r_fds) )
-      {
-        PRINT_DEBUG ( "cRosNodeDoEventsLoop() : TCPROS listener ready\n" );
-        if( tcpIpSocketAccept( &(n->rpcros_listner_proc.socket),
-            &(n->rpcros_server_proc[next_rpcros_server_i].socket) ) == TCPIPSOCKET_DONE &&
-            tcpIpSocketSetReuse( &(n->rpcros_server_proc[next_rpcros_server_i].socket) ) &&
-            tcpIpSocketSetNonBlocking( &(n->rpcros_server_proc[next_rpcros_server_i].socket ) ) &&
-            tcpIpSocketSetKeepAlive( &(n->rpcros_server_proc[next_rpcros_server_i].socket ), 60, 10, 9 ) )
-        {
-          tcprosProcessChangeState( &(n->rpcros_server_proc[next_rpcros_server_i]), TCPROS_PROCESS_STATE_READING_HEADER_SIZE );
-        }
-      }
-    }
+void cRosNodeCompleteTask( CrosNode *n, CrosNodeTask *task )
+{
+  pthread_mutex_lock( &n->tasks_mutex );
+  task->next = n->done_tasks;
+  n->done_tasks = task;
+  pthread_mutex_unlock( &n->tasks_mutex );
 
-    for( i = 0; i < CN_MAX_RPCROS_SERVER_CONNECTIONS; i++ )
-    {
-      TcprosProcess *server_proc = &(n->rpcros_server_proc[i]);
-      int server_fd = tcpIpSocketGetFD( &(server_proc->socket) );
+  cRosWakeupSignal( &n->wakeup );
+}
 
-      if( server_proc->state != TCPROS_PROCESS_STATE_IDLE && FD_ISSET(server_fd, &err_fds) )
-      {
-        PRINT_ERROR ( "cRosNodeDoEventsLoop() : TCPROS server socket error\n" );
-        tcpIpSocketClose( &(server_proc->socket) );
-        tcprosProcessChangeState( &(n->rpcros_server_proc[next_rpcros_server_i]), TCPROS_PROCESS_STATE_IDLE );
-      }
-      else if( ( server_proc->state == TCPROS_PROCESS_STATE_READING_HEADER_SIZE && FD_ISSET(server_fd, &r_fds) ) ||
-        ( server_proc->state == TCPROS_PROCESS_STATE_READING_HEADER && FD_ISSET(server_fd, &r_fds) ) ||
-        ( server_proc->state == TCPROS_PROCESS_STATE_READING_SIZE && FD_ISSET(server_fd, &r_fds) ) ||
-        ( server_proc->state == TCPROS_PROCESS_STATE_READING && FD_ISSET(server_fd, &r_fds) ) ||
-        ( server_proc->state == TCPROS_PROCESS_STATE_WRITING_HEADER && FD_ISSET(server_fd, &w_fds) ) ||
-        ( server_proc->state == TCPROS_PROCESS_STATE_WRITING && FD_ISSET(server_fd, &w_fds) ) )
-      {
-        cRosErrCodePack new_errors;
-        new_errors = doWithRpcrosServerSocket( n, i );
-        ret_err = cRosAddErrCodePackIfErr(ret_err, new_errors);
-      }
-    }
-  }
-  return ret_err;
+void cRosNodeNotifyReceivers( CrosNode *n )
+{
+  // Pairs with the fence of waitForSubscriberMsg(): either the waiter is counted here or it finds the message in the queue
+  __atomic_thread_fence( __ATOMIC_SEQ_CST );
+  if( __atomic_load_n( &n->recv_waiters, __ATOMIC_RELAXED ) == 0 )
+    return;
+
+  pthread_mutex_lock( &n->recv_mutex );
+  pthread_cond_broadcast( &n->recv_cond );
+  pthread_mutex_unlock( &n->recv_mutex );
 }
 
-cRosErrCodePack cRosNodeStart( CrosNode *n, unsigned long time_out, unsigned char *exit_flag )
+/* Returns the time of recv_cond at which a wait of time_out milliseconds expires */
+static struct timespec getRecvCondDeadline( uint64_t time_out )
 {
-  uint64_t start_time, elapsed_time;
-  cRosErrCodePack ret_err;
-  PRINT_VDEBUG ( "cRosNodeStart ()\n" );
+  struct timespec now;
+  uint64_t deadline_ns;
 
-  start_time = cRosClockGetTimeMs();
-  ret_err = CROS_SUCCESS_ERR_PACK;
-  while(ret_err == CROS_SUCCESS_ERR_PACK && (exit_flag==NULL || !(*exit_flag)) && (time_out == CROS_INFINITE_TIMEOUT || (elapsed_time=cRosClockGetTimeMs()-start_time) <= time_out))
-    ret_err = cRosNodeDoEventsLoop( n, (time_out == CROS_INFINITE_TIMEOUT)? UINT64_MAX : time_out-elapsed_time);
+  clock_gettime( CN_RECV_COND_CLOCK, &now );
+  deadline_ns = (uint64_t)now.tv_sec * CROS_CLOCK_NS_PER_S + (uint64_t)now.tv_nsec;
+  deadline_ns = ( time_out < ( UINT64_MAX - deadline_ns ) / CROS_CLOCK_NS_PER_MS )? deadline_ns + time_out * CROS_CLOCK_NS_PER_MS : UINT64_MAX;
+  return cRosClockGetTimeSpec( deadline_ns );
+}
 
-  return ret_err;
+/* Threaded mode: wait until the subscriber callback, run by another thread, adds a message to the queue or the timeout expires */
+static void waitForSubscriberMsg( CrosNode *n, cRosMessageQueue *q, uint64_t time_out )
+{
+  struct timespec deadline = getRecvCondDeadline( time_out );
+
+  pthread_mutex_lock( &n->recv_mutex );
+  __atomic_add_fetch( &n->recv_waiters, 1, __ATOMIC_RELAXED );
+  __atomic_thread_fence( __ATOMIC_SEQ_CST );
+  while( cRosMessageQueueUsage( q ) == 0 )
+  {
+    if( pthread_cond_timedwait( &n->recv_cond, &n->recv_mutex, &deadline ) == ETIMEDOUT )
+      break;
+  }
+  __atomic_sub_fetch( &n->recv_waiters, 1, __ATOMIC_RELAXED );
+  pthread_mutex_unlock( &n->recv_mutex );
 }
 
 cRosErrCodePack cRosNodeReceiveTopicMsg( CrosNode *node, int subidx, cRosMessage *msg, unsigned char *buff_overflow, unsigned long time_out )
@@ -3399,86 +4598,137 @@ cRosErrCodePack cRosNodeReceiveTopicMsg( CrosNode *node, int subidx, cRosMessage
   cRosErrCodePack ret_err;
   SubscriberNode *subs_node;
   uint64_t start_time, elapsed_time = 0; // Initialized just to avoid a compiler warning
+  unsigned char overflow;
+  int threaded;
   PRINT_VDEBUG ( "cRosNodeReceiveTopicMsg ()\n" );
 
-  if(subidx < 0 || subidx >= CN_MAX_SUBSCRIBED_TOPICS)
+  if(subidx < 0 || subidx >= node->subs_table.size)
     return CROS_BAD_PARAM_ERR;
 
   subs_node = &node->subs[subidx];
   if(subs_node->topic_name == NULL)
     return CROS_BAD_PARAM_ERR;
 
+  // Read and reset the overflow flag, which the callback threads may set meanwhile
+  overflow = __atomic_exchange_n(&subs_node->msg_queue_overflow, 0, __ATOMIC_RELAXED);
   if(buff_overflow != NULL)
-    *buff_overflow = subs_node->msg_queue_overflow;
-  subs_node->msg_queue_overflow = 0; // Reset overflow flag
+    *buff_overflow = overflow;
+
+  // In threaded mode the I/O thread and the workers fill the queue, which this thread just empties
+  threaded = node->io_thread_running && !pthread_equal(pthread_self(), node->io_thread);
 
   start_time = cRosClockGetTimeMs();
   ret_err = CROS_SUCCESS_ERR_PACK; // default return value
   // While the buffer is empty and the timeout is not reached wait
   while(cRosMessageQueueUsage(&subs_node->msg_queue) == 0 && ret_err == CROS_SUCCESS_ERR_PACK && (time_out == CROS_INFINITE_TIMEOUT || (elapsed_time=cRosClockGetTimeMs()-start_time) <= time_out))
   {
-    ret_err = cRosNodeDoEventsLoop ( node, time_out - elapsed_time);
+    if(threaded)
+      waitForSubscriberMsg(node, &subs_node->msg_queue, time_out - elapsed_time);
+    else
+    {
+      ret_err = cRosNodeDoEventsLoop ( node, time_out - elapsed_time);
+      subs_node = &node->subs[subidx]; // The node tables may have been moved by the callbacks
+    }
   }
   if(ret_err == CROS_SUCCESS_ERR_PACK)
   {
     if(cRosMessageQueueUsage(&subs_node->msg_queue) > 0) // If no error and there is at least one message in the queue, get the message
-      ret_err = (cRosMessageQueueExtract(&subs_node->msg_queue, msg) == 0)? CROS_SUCCESS_ERR_PACK:CROS_MEM_ALLOC_ERR;
+      ret_err = (cRosMessageQueueExtractSwap(&subs_node->msg_queue, msg) == 0)? CROS_SUCCESS_ERR_PACK:CROS_MEM_ALLOC_ERR;
     else
       ret_err = CROS_RCV_TOP_TIMEOUT_ERR;
   }
   return ret_err;
 }
 
+/* The message is serialized once and queued in every connection of the topic, so that each subscriber
+   consumes its own queue at its own pace. time_out is ignored: publishing never waits for the subscribers */
 cRosErrCodePack cRosNodeSendTopicMsg( CrosNode *node, int pubidx, cRosMessage *msg, unsigned long time_out)
 {
   cRosErrCodePack ret_err;
-  PublisherNode *pub_node;
-  uint64_t start_time, elapsed_time = 0; // Initialized just to avoid a compiler warning
+  TcprosFrame *frame;
   PRINT_VDEBUG ( "cRosNodeSendTopicMsg ()\n" );
 
-  if(pubidx < 0 || pubidx >= CN_MAX_PUBLISHED_TOPICS)
+  (void)time_out;
+
+  if(pubidx < 0 || pubidx >= node->pubs_table.size)
     return CROS_BAD_PARAM_ERR;
 
-  pub_node = &node->pubs[pubidx];
-  if(pub_node->topic_name == NULL)
+  if(node->pubs[pubidx].topic_name == NULL)
     return CROS_BAD_PARAM_ERR;
 
-  start_time = cRosClockGetTimeMs();
-  ret_err = CROS_SUCCESS_ERR_PACK; // default return value
-  // While the buffer is full and the timeout is not reached wait
-  while(cRosMessageQueueVacancies(&pub_node->msg_queue) == 0 && ret_err == CROS_SUCCESS_ERR_PACK && (time_out == CROS_INFINITE_TIMEOUT || (elapsed_time=cRosClockGetTimeMs()-start_time) <= time_out))
+  ret_err = cRosMessagePreparePublicationFrame(msg, &frame);
+  if(ret_err != CROS_SUCCESS_ERR_PACK)
+    return ret_err;
+
+  return cRosNodeSendTopicFrame(node, pubidx, frame);
+}
+
+cRosErrCodePack cRosNodeSendTopicFrame( CrosNode *node, int pubidx, TcprosFrame *frame )
+{
+  cRosErrCodePack ret_err;
+
+  if(node->io_thread_running && !pthread_equal(pthread_self(), node->io_thread))
   {
-    ret_err = cRosNodeDoEventsLoop ( node, time_out - elapsed_time);
+    // The connections belong to the I/O thread: the frame is passed to it, and it is woken up unless it already was
+    frame->post_topic_idx = pubidx;
+    cRosMpscQueuePush(&node->posted_frames, &frame->post_link);
+    if(__atomic_exchange_n(&node->posts_pending, 1, __ATOMIC_ACQ_REL) == 0)
+      cRosWakeupSignal(&node->wakeup);
+    return CROS_SUCCESS_ERR_PACK;
   }
 
-  if(ret_err == CROS_SUCCESS_ERR_PACK)
-  {
-    if(cRosMessageQueueVacancies(&pub_node->msg_queue) > 0) // If no error and there is at space in the queue, put the new message
-    {
-      if(cRosMessageQueueAdd(&pub_node->msg_queue, msg) == 0)
-      {
-        ret_err = CROS_SUCCESS_ERR_PACK;
+  ret_err = queuePublicationFrame(node, pubidx, frame);
+  tcprosFrameUnref(frame);
 
-        if(cRosMessageQueueUsage(&pub_node->msg_queue) == 1) // First message added to the queue: trigger the msg sending process
-        {
-          // Set the msg-send flag of all associated processes
-          int srv_proc_ind;
-          for(srv_proc_ind=0;srv_proc_ind<CN_MAX_TCPROS_SERVER_CONNECTIONS;srv_proc_ind++)
-            if(node->tcpros_server_proc[srv_proc_ind].topic_idx == pubidx)
-              node->tcpros_server_proc[srv_proc_ind].send_msg_now = 1; // Msg must be sent now
-        }
-      }
-      else
-        ret_err = CROS_MEM_ALLOC_ERR;
-    }
-    else
-      ret_err = CROS_SEND_TOP_TIMEOUT_ERR;
+  return ret_err;
+}
+
+/* Threaded mode: pass a service call to the I/O thread, which owns the connections, and wait until it finishes or the
+   timeout expires. If it expires, the I/O thread frees the call and no longer accesses the messages of the caller */
+static cRosErrCodePack postServiceCall( CrosNode *n, int svcidx, cRosMessage *req_msg, cRosMessage *resp_msg, unsigned long time_out )
+{
+  struct timespec deadline = getRecvCondDeadline( time_out );
+  cRosErrCodePack ret_err;
+  int free_call;
+
+  CrosNodeServiceCall *call = (CrosNodeServiceCall *)malloc( sizeof(CrosNodeServiceCall) );
+  if( call == NULL )
+  {
+    PRINT_ERROR ( "cRosNodeServiceCall() : Can't allocate memory\n" );
+    return CROS_MEM_ALLOC_ERR;
+  }
+  call->svc_idx = svcidx;
+  call->next = NULL;
+  call->req_msg = req_msg;
+  call->resp_msg = resp_msg;
+  call->sent = call->done = call->abandoned = 0;
+  call->err = CROS_SUCCESS_ERR_PACK;
+
+  cRosMpscQueuePush( &n->posted_calls, &call->link );
+  if( __atomic_exchange_n( &n->posts_pending, 1, __ATOMIC_ACQ_REL ) == 0 )
+    cRosWakeupSignal( &n->wakeup );
+
+  pthread_mutex_lock( &n->recv_mutex );
+  while( !call->done )
+  {
+    if( pthread_cond_timedwait( &n->recv_cond, &n->recv_mutex, &deadline ) == ETIMEDOUT )
+      break;
   }
+  if( call->done )
+    ret_err = call->err;
+  else
+  {
+    ret_err = ( call->sent )? CROS_CALL_SVC_TIMEOUT_ERR : CROS_CALL_INI_TIMEOUT_ERR;
+    call->abandoned = 1;
+  }
+  free_call = call->done;
+  pthread_mutex_unlock( &n->recv_mutex );
 
+  if( free_call )
+    free( call );
   return ret_err;
 }
 
-
 cRosErrCodePack cRosNodeServiceCall( CrosNode *node, int svcidx, cRosMessage *req_msg, cRosMessage *resp_msg, unsigned long time_out)
 {
   cRosErrCodePack ret_err;
@@ -3487,13 +4737,17 @@ cRosErrCodePack cRosNodeServiceCall( CrosNode *node, int svcidx, cRosMessage *re
   uint64_t start_time, elapsed_time = 0; // Initialized just to avoid a compiler warning
   PRINT_VDEBUG ( "cRosNodeServiceCall ()\n" );
 
-  if(svcidx < 0 || svcidx >= CN_MAX_SERVICE_CALLERS)
+  if(svcidx < 0 || svcidx >= node->service_callers_table.size)
     return CROS_BAD_PARAM_ERR;
 
   caller_node = &node->service_callers[svcidx];
   if(caller_node->service_name == NULL)
     return CROS_BAD_PARAM_ERR;
 
+  // In threaded mode the I/O thread makes the call
+  if(node->io_thread_running && !pthread_equal(pthread_self(), node->io_thread))
+    return postServiceCall(node, svcidx, req_msg, resp_msg, time_out);
+
   svc_client_proc = &node->rpcros_client_proc[caller_node->client_rpcros_id];
 
   start_time = cRosClockGetTimeMs();
@@ -3502,6 +4756,9 @@ cRosErrCodePack cRosNodeServiceCall( CrosNode *node, int svcidx, cRosMessage *re
   while(svc_client_proc->state != TCPROS_PROCESS_STATE_WAIT_FOR_WRITING && ret_err == CROS_SUCCESS_ERR_PACK && (time_out == CROS_INFINITE_TIMEOUT || (elapsed_time=cRosClockGetTimeMs()-start_time) <= time_out))
   {
     ret_err = cRosNodeDoEventsLoop ( node, time_out - elapsed_time);
+    // The node tables may have been moved by the callbacks
+    caller_node = &node->service_callers[svcidx];
+    svc_client_proc = &node->rpcros_client_proc[caller_node->client_rpcros_id];
   }
 
   if(ret_err == CROS_SUCCESS_ERR_PACK && svc_client_proc->state != TCPROS_PROCESS_STATE_WAIT_FOR_WRITING)
@@ -3518,6 +4775,7 @@ cRosErrCodePack cRosNodeServiceCall( CrosNode *node, int svcidx, cRosMessage *re
   if(cRosMessageQueueAdd(&caller_node->msg_queue, req_msg) == 0) // Put service-call request msg in the queue
   {
     svc_client_proc->send_msg_now = 1; // Set the msg-send flag of the associated process
+    cRosPollerEntryNotify(&svc_client_proc->poller_entry); // The process must start writing now
   }
   else
     ret_err = CROS_MEM_ALLOC_ERR;
@@ -3526,6 +4784,9 @@ cRosErrCodePack cRosNodeServiceCall( CrosNode *node, int svcidx, cRosMessage *re
   while(cRosMessageQueueUsage(&caller_node->msg_queue) < 2 && ret_err == CROS_SUCCESS_ERR_PACK && (time_out == CROS_INFINITE_TIMEOUT || (elapsed_time=cRosClockGetTimeMs()-start_time) <= time_out))
   {
     ret_err = cRosNodeDoEventsLoop ( node, time_out - elapsed_time);
+    // The node tables may have been moved by the callbacks
+    caller_node = &node->service_callers[svcidx];
+    svc_client_proc = &node->rpcros_client_proc[caller_node->client_rpcros_id];
   }
 
   if(ret_err == CROS_SUCCESS_ERR_PACK)
@@ -3536,7 +4797,7 @@ cRosErrCodePack cRosNodeServiceCall( CrosNode *node, int svcidx, cRosMessage *re
       if(resp_msg != NULL)
       {
         int queue_ret_val;
-        queue_ret_val = cRosMessageQueueExtract(&caller_node->msg_queue, resp_msg); // Extract response msg from queue
+        queue_ret_val = cRosMessageQueueExtractSwap(&caller_node->msg_queue, resp_msg); // Extract response msg from queue
         if(queue_ret_val == 0)
           ret_err = CROS_SUCCESS_ERR_PACK;
         else
@@ -3706,6 +4967,7 @@ int enqueueRequestTopic(CrosNode *node, int subidx, const char *host, int port)
     status.xmlrpc_host = strdup(host);
     status.xmlrpc_port = port;
     sub->status_callback(&status, sub->context);
+    sub = &node->subs[subidx]; // The node tables may have been moved by the callback
   }
 
   xmlrpcParamVectorPushBackString(&call->params, node->name );
@@ -3721,7 +4983,7 @@ int enqueueRequestTopic(CrosNode *node, int subidx, const char *host, int port)
 void restartAdversing(CrosNode* n)
 {
   int it;
-  for(it = 0; it < n->n_pubs; it++)
+  for(it = 0; it < n->pubs_table.size; it++)
   {
     if (n->pubs[it].topic_name == NULL)
       continue;
@@ -3729,7 +4991,7 @@ void restartAdversing(CrosNode* n)
     enqueuePublisherAdvertise(n, it);
   }
 
-  for(it = 0; it < n->n_subs; it++)
+  for(it = 0; it < n->subs_table.size; it++)
   {
     if (n->subs[it].topic_name == NULL)
       continue;
@@ -3737,7 +4999,7 @@ void restartAdversing(CrosNode* n)
     enqueueSubscriberAdvertise(n, it);
   }
 
-  for(it = 0; it < n->n_service_providers; it++)
+  for(it = 0; it < n->service_providers_table.size; it++)
   {
     if (n->service_providers[it].service_name == NULL)
       continue;
@@ -3756,8 +5018,10 @@ void initPublisherNode(PublisherNode *node)
   node->status_callback = NULL;
   node->context = NULL;
   node->client_tcpros_id = -1;
-  node->loop_period = -1; // Publication paused
-  cRosMessageQueueInit(&node->msg_queue);
+  node->loop_period_ns = -1; // Publication paused
+  node->queue_size = CN_TCPROS_OUT_QUEUE_LENGTH;
+  node->periodic_frame = NULL;
+  node->periodic_frame_time = 0;
 }
 
 void initSubscriberNode(SubscriberNode *node)
@@ -3767,6 +5031,9 @@ void initSubscriberNode(SubscriberNode *node)
   node->topic_type = NULL;
   node->md5sum = NULL;
   node->callback = NULL;
+  node->msg_callback = NULL;
+  node->msg_prototype = NULL;
+  node->stream_min_size = CN_SUBSCRIBER_STREAM_MIN_SIZE;
   node->status_callback = NULL;
   node->context = NULL;
   node->tcp_nodelay = 0;
@@ -3793,6 +5060,7 @@ void initServiceCallerNode(ServiceCallerNode *node)
   node->service_host = NULL;
   node->service_port = -1;
   node->md5sum = NULL;
+  node->message_definition = NULL;
   node->client_rpcros_id = -1;
   node->callback = NULL;
   node->status_callback = NULL;
@@ -3801,8 +5069,9 @@ void initServiceCallerNode(ServiceCallerNode *node)
   node->serviceresponse_type = NULL;
   node->persistent = 0;
   node->tcp_nodelay = 0;
-  node->loop_period = -1; // Calling paused
+  node->loop_period_ns = -1; // Calling paused
   cRosMessageQueueInit(&node->msg_queue);
+  node->posted_calls = NULL;
 }
 
 void initParameterSubscrition(ParameterSubscription *subscription)
@@ -3819,7 +5088,7 @@ void cRosNodeReleasePublisher(PublisherNode *node)
   free(node->topic_name);
   free(node->topic_type);
   free(node->md5sum);
-  cRosMessageQueueRelease(&node->msg_queue);
+  tcprosFrameUnref(node->periodic_frame);
 }
 
 void cRosNodeReleaseSubscriber(SubscriberNode *node)
@@ -3849,6 +5118,7 @@ void cRosNodeReleaseServiceCaller(ServiceCallerNode *node)
   free(node->md5sum);
   free(node->message_definition);
   free(node->service_host);
+  cRosMessageQueueRelease(&node->msg_queue);
 }
 
 void initCrosNodeStatus(CrosNodeStatusUsr *status)
@@ -3867,22 +5137,6 @@ void cRosNodeReleaseParameterSubscrition(ParameterSubscription *subscription)
   xmlrpcParamRelease(&subscription->parameter_value);
 }
 
-void getIdleXmplrpcClients(CrosNode *node, int idle_clients[], size_t *idle_client_count)
-{
-  int client_it = 1; // client_it = 0 is for roscore only
-  int idle_it = 0;
-  *idle_client_count = 0;
-  for(; client_it < CN_MAX_XMLRPC_CLIENT_CONNECTIONS; client_it++)
-  {
-    if (node->xmlrpc_client_proc[client_it].state == XMLRPC_PROCESS_STATE_IDLE)
-    {
-      idle_clients[idle_it] = client_it;
-      (*idle_client_count)++;
-      idle_it++;
-    }
-  }
-}
-
 int enqueueMasterApiCall(CrosNode *node, RosApiCall *call)
 {
   call->user_call = 1;
@@ -3950,7 +5204,7 @@ void getSrvFilePath(CrosNode *node, char *buffer, size_t bufsize, const char *se
 XmlrpcParam * cRosNodeGetParameterValue( CrosNode *node, const char *key)
 {
   int it = 0;
-  for (it = 0 ; it < node->n_paramsubs; it++)
+  for (it = 0 ; it < node->paramsubs_table.size; it++)
   {
     if (node->paramsubs[it].parameter_key == NULL)
       continue;
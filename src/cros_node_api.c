@@ -357,6 +357,7 @@ int cRosApiParseResponse( CrosNode *n, int client_idx )
             status.parameter_key = subscription->parameter_key;
             status.parameter_value = value;
             subscription->status_callback(&status, subscription->context);
+            subscription = &n->paramsubs[paramsubidx]; // The node tables may have been moved by the callback
           }
 
           ret = 0;
@@ -633,7 +634,7 @@ int cRosApiParseRequestPrepareResponse( CrosNode *n, int server_idx )
         int uri_found = 0;
 
         int i;
-        for(i = 0; i < n->n_subs; i++)
+        for(i = 0; i < n->subs_table.size; i++)
         {
           if (n->subs[i].topic_name == NULL)
             continue;
@@ -750,7 +751,7 @@ int cRosApiParseRequestPrepareResponse( CrosNode *n, int server_idx )
         XmlrpcParam *proto, *proto_name;
         int i = 0, topic_found = 0, protocol_found = 0;
 
-        for( i = 0 ; i < n->n_pubs; i++)
+        for( i = 0 ; i < n->pubs_table.size; i++)
         {
           PublisherNode *pub = &n->pubs[i];
           if (pub->topic_name == NULL)
@@ -861,7 +862,7 @@ int cRosApiParseRequestPrepareResponse( CrosNode *n, int server_idx )
       int paramsubidx = -1;
       char *parameter_key = xmlrpcParamGetString(key_param);
       int it = 0;
-      for (it = 0 ; it < n->n_paramsubs; it++)
+      for (it = 0 ; it < n->paramsubs_table.size; it++)
       {
         if (n->paramsubs[it].parameter_key == NULL)
           continue;
@@ -886,6 +887,7 @@ int cRosApiParseRequestPrepareResponse( CrosNode *n, int server_idx )
           status.parameter_key = parameter_key;
           status.parameter_value = value_param;
           subscription->status_callback(&status, subscription->context);
+          subscription = &n->paramsubs[it]; // The node tables may have been moved by the callback
         }
 
         XmlrpcParam param;
@@ -917,8 +919,11 @@ int cRosApiParseRequestPrepareResponse( CrosNode *n, int server_idx )
       XmlrpcParam* param_array = xmlrpcParamArrayPushBackArray(array);
 
       int i = 0;
-      for(i = 0; i < n->n_subs; i++)
+      for(i = 0; i < n->subs_table.size; i++)
       {
+        if (n->subs[i].topic_name == NULL)
+          continue;
+
         XmlrpcParam* sub_array = xmlrpcParamArrayPushBackArray(param_array);
         xmlrpcParamArrayPushBackString(sub_array, n->subs[i].topic_name);
         xmlrpcParamArrayPushBackString(sub_array, n->subs[i].topic_type);
@@ -935,8 +940,11 @@ int cRosApiParseRequestPrepareResponse( CrosNode *n, int server_idx )
       XmlrpcParam* param_array = xmlrpcParamArrayPushBackArray(array);
 
       int i = 0;
-      for(i = 0; i < n->n_pubs; i++)
+      for(i = 0; i < n->pubs_table.size; i++)
       {
+        if (n->pubs[i].topic_name == NULL)
+          continue;
+
         XmlrpcParam* sub_array = xmlrpcParamArrayPushBackArray(param_array);
         xmlrpcParamArrayPushBackString(sub_array, n->pubs[i].topic_name);
         xmlrpcParamArrayPushBackString(sub_array, n->pubs[i].topic_type);
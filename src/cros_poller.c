@@ -0,0 +1,449 @@
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <errno.h>
+#include <limits.h>
+
+#include "cros_poller.h"
+#include "cros_clock.h"
+#include "cros_defs.h"
+
+#if CROS_POLLER_HAS_EPOLL
+#include <sys/epoll.h>
+
+static uint32_t toEpollEvents( unsigned int events )
+{
+  uint32_t epoll_events = 0;
+
+  if( events & CROS_POLLER_READ )
+    epoll_events |= EPOLLIN;
+  if( events & CROS_POLLER_WRITE )
+    epoll_events |= EPOLLOUT;
+  if( events & CROS_POLLER_ERROR )
+    epoll_events |= EPOLLPRI;
+
+  return epoll_events;
+}
+
+static int epollWatch( CrosPoller *p, CrosPollerEntry *e, int fd, unsigned int events, uint64_t tag )
+{
+  struct epoll_event ev;
+
+  // If the process socket has changed, the old descriptor was closed (and so removed from the
+  // epoll set by the kernel): its number may already belong to another process, so do not touch it
+  if( e->registered && e->fd != fd )
+    e->registered = 0;
+
+  if( fd == -1 || events == 0 )
+  {
+    if( e->registered )
+      epoll_ctl( p->epoll_fd, EPOLL_CTL_DEL, e->fd, NULL ); // ENOENT is expected if the socket was reopened
+    e->registered = 0;
+    return 0;
+  }
+
+  memset( &ev, 0, sizeof(ev) );
+  ev.events = toEpollEvents( events );
+  ev.data.u64 = tag;
+
+  // The descriptor may have been closed and opened again with the same number since the last
+  // registration, so MOD can fail with ENOENT and ADD with EEXIST: try the other operation then
+  if( e->registered )
+  {
+    if( epoll_ctl( p->epoll_fd, EPOLL_CTL_MOD, fd, &ev ) == -1 &&
+        ( errno != ENOENT || epoll_ctl( p->epoll_fd, EPOLL_CTL_ADD, fd, &ev ) == -1 ) )
+    {
+      PRINT_ERROR( "cRosPollerWatch() : epoll_ctl() failed for file descriptor %i. errno=%i\n", fd, errno );
+      e->registered = 0;
+      return -1;
+    }
+  }
+  else
+  {
+    if( epoll_ctl( p->epoll_fd, EPOLL_CTL_ADD, fd, &ev ) == -1 &&
+        ( errno != EEXIST || epoll_ctl( p->epoll_fd, EPOLL_CTL_MOD, fd, &ev ) == -1 ) )
+    {
+      PRINT_ERROR( "cRosPollerWatch() : epoll_ctl() failed for file descriptor %i. errno=%i\n", fd, errno );
+      return -1;
+    }
+  }
+  e->registered = 1;
+
+  return 0;
+}
+#endif
+
+/* Stop watching the file descriptor of an entry in the select() sets, unless it now belongs to another process */
+static void selectUnwatch( CrosPoller *p, CrosPollerEntry *e, uint64_t tag )
+{
+  int fd = e->fd;
+
+  if( p->fd_tags == NULL || fd == -1 || e->events == 0 || p->fd_tags[fd] != tag )
+    return;
+
+  FD_CLR( fd, &p->watch_r_fds );
+  FD_CLR( fd, &p->watch_w_fds );
+  FD_CLR( fd, &p->watch_err_fds );
+  while( p->max_fd >= 0 && !FD_ISSET( p->max_fd, &p->watch_r_fds ) &&
+         !FD_ISSET( p->max_fd, &p->watch_w_fds ) && !FD_ISSET( p->max_fd, &p->watch_err_fds ) )
+    p->max_fd--;
+}
+
+static int selectWatch( CrosPoller *p, CrosPollerEntry *e, int fd, unsigned int events, uint64_t tag )
+{
+  if( events != 0 && fd >= FD_SETSIZE )
+  {
+    PRINT_ERROR( "cRosPollerWatch() : File descriptor %i exceeds FD_SETSIZE and can't be watched with select()\n", fd );
+    selectUnwatch( p, e, tag );
+    return -1;
+  }
+
+  if( p->fd_tags == NULL )
+  {
+    if( events == 0 )
+      return 0; // Nothing has been watched yet
+
+    p->fd_tags = (uint64_t *)malloc( FD_SETSIZE * sizeof(uint64_t) );
+    p->ready_fds = (int *)malloc( FD_SETSIZE * sizeof(int) );
+    if( p->fd_tags == NULL || p->ready_fds == NULL )
+    {
+      PRINT_ERROR( "cRosPollerWatch() : Can't allocate memory\n" );
+      free( p->fd_tags );
+      free( p->ready_fds );
+      p->fd_tags = NULL;
+      p->ready_fds = NULL;
+      return -1;
+    }
+    memset( p->fd_tags, 0xFF, FD_SETSIZE * sizeof(uint64_t) ); // No descriptor is owned by a process (UINT64_MAX)
+  }
+
+  selectUnwatch( p, e, tag );
+  if( events == 0 )
+    return 0;
+
+  // The descriptor may still be in the sets if its previous owner closed it and has not been watched again
+  FD_CLR( fd, &p->watch_r_fds );
+  FD_CLR( fd, &p->watch_w_fds );
+  FD_CLR( fd, &p->watch_err_fds );
+  if( events & CROS_POLLER_READ )
+    FD_SET( fd, &p->watch_r_fds );
+  if( events & CROS_POLLER_WRITE )
+    FD_SET( fd, &p->watch_w_fds );
+  if( events & CROS_POLLER_ERROR )
+    FD_SET( fd, &p->watch_err_fds );
+  if( fd > p->max_fd )
+    p->max_fd = fd;
+  p->fd_tags[fd] = tag;
+
+  return 0;
+}
+
+void cRosPollerEntryInit( CrosPollerEntry *e )
+{
+  e->poller = NULL;
+  e->tag = 0;
+  e->change_pos = 0;
+  e->fd = -1;
+  e->events = 0;
+  e->stamp = 0;
+  e->registered = 0;
+}
+
+int cRosPollerReserveBindings( CrosPoller *p, int n_entries )
+{
+  uint64_t *new_tags;
+
+  if( p->n_bound_entries + n_entries <= p->max_changed_tags )
+    return 0;
+
+  // Each bound entry is queued once at most, so the queue never has to grow when a process changes its state
+  new_tags = (uint64_t *)realloc( p->changed_tags, ( p->n_bound_entries + n_entries ) * sizeof(uint64_t) );
+  if( new_tags == NULL )
+  {
+    PRINT_ERROR( "cRosPollerReserveBindings() : Can't allocate memory\n" );
+    return -1;
+  }
+  p->changed_tags = new_tags;
+  p->max_changed_tags = p->n_bound_entries + n_entries;
+  return 0;
+}
+
+int cRosPollerEntryBind( CrosPoller *p, CrosPollerEntry *e, uint64_t tag )
+{
+  if( cRosPollerReserveBindings( p, 1 ) != 0 )
+    return -1;
+  p->n_bound_entries++;
+
+  e->poller = p;
+  e->tag = tag;
+  e->change_pos = 0;
+  return 0;
+}
+
+void cRosPollerEntryNotify( CrosPollerEntry *e )
+{
+  CrosPoller *p = e->poller;
+
+  if( p == NULL )
+    return;
+
+  // The tags are unique, so the entry is still queued if its tag has not been popped or overwritten
+  if( e->change_pos > 0 && e->change_pos <= p->n_changed_tags && p->changed_tags[e->change_pos - 1] == e->tag )
+    return;
+
+  p->changed_tags[p->n_changed_tags++] = e->tag;
+  e->change_pos = p->n_changed_tags;
+}
+
+int cRosPollerPopChange( CrosPoller *p, uint64_t *tag )
+{
+  if( p->n_changed_tags == 0 )
+    return 0;
+
+  *tag = p->changed_tags[--p->n_changed_tags];
+  return 1;
+}
+
+int cRosPollerInit( CrosPoller *p, CrosPollerBackend backend, int max_events )
+{
+  PRINT_VDEBUG ( "cRosPollerInit()\n" );
+
+  p->backend = backend;
+  p->max_fd = -1;
+  p->fd_tags = NULL;
+  p->ready_fds = NULL;
+  p->changed_tags = NULL;
+  p->n_changed_tags = 0;
+  p->max_changed_tags = 0;
+  p->n_bound_entries = 0;
+  p->epoll_fd = -1;
+  p->ready_events = NULL;
+  p->max_ready_events = 0;
+  p->n_ready_events = 0;
+  p->ms_timeouts = !CROS_POLLER_HAS_EPOLL_PWAIT2;
+  FD_ZERO( &p->watch_r_fds );
+  FD_ZERO( &p->watch_w_fds );
+  FD_ZERO( &p->watch_err_fds );
+  FD_ZERO( &p->r_fds );
+  FD_ZERO( &p->w_fds );
+  FD_ZERO( &p->err_fds );
+
+  if( backend == CROS_POLLER_SELECT )
+    return 0;
+
+#if CROS_POLLER_HAS_EPOLL
+  if( backend == CROS_POLLER_EPOLL )
+  {
+    if( max_events < 1 )
+      max_events = 1;
+
+    p->ready_events = calloc( max_events, sizeof(struct epoll_event) );
+    if( p->ready_events == NULL )
+    {
+      PRINT_ERROR( "cRosPollerInit() : Can't allocate memory\n" );
+      return -1;
+    }
+    p->max_ready_events = max_events;
+
+    p->epoll_fd = epoll_create( max_events );
+    if( p->epoll_fd == -1 )
+    {
+      PRINT_ERROR( "cRosPollerInit() : epoll_create() failed. errno=%i\n", errno );
+      cRosPollerRelease( p );
+      return -1;
+    }
+    return 0;
+  }
+#endif
+
+  PRINT_ERROR( "cRosPollerInit() : Poller backend %i is not supported in this platform\n", (int)backend );
+  return -1;
+}
+
+void cRosPollerRelease( CrosPoller *p )
+{
+  PRINT_VDEBUG ( "cRosPollerRelease()\n" );
+
+  if( p->epoll_fd != -1 )
+    close( p->epoll_fd );
+  p->epoll_fd = -1;
+
+  free( p->ready_events );
+  p->ready_events = NULL;
+  p->max_ready_events = 0;
+  p->n_ready_events = 0;
+
+  free( p->fd_tags );
+  free( p->ready_fds );
+  p->fd_tags = NULL;
+  p->ready_fds = NULL;
+  FD_ZERO( &p->watch_r_fds );
+  FD_ZERO( &p->watch_w_fds );
+  FD_ZERO( &p->watch_err_fds );
+  p->max_fd = -1;
+
+  free( p->changed_tags );
+  p->changed_tags = NULL;
+  p->n_changed_tags = 0;
+  p->max_changed_tags = 0;
+  p->n_bound_entries = 0;
+}
+
+void cRosPollerBegin( CrosPoller *p )
+{
+  p->n_ready_events = 0;
+}
+
+int cRosPollerWatch( CrosPoller *p, CrosPollerEntry *e, int fd, unsigned int events, unsigned int stamp, uint64_t tag )
+{
+  int ret = 0;
+
+  if( fd == -1 )
+    events = 0;
+
+  if( fd == e->fd && events == e->events && stamp == e->stamp )
+    return 0; // Nothing changed since the last registration
+
+  if( p->backend == CROS_POLLER_SELECT )
+  {
+    ret = selectWatch( p, e, fd, events, tag );
+    if( ret != 0 )
+    {
+      fd = -1;
+      events = 0;
+    }
+  }
+#if CROS_POLLER_HAS_EPOLL
+  else if( p->backend == CROS_POLLER_EPOLL )
+    ret = epollWatch( p, e, fd, events, tag );
+#endif
+
+  e->fd = fd;
+  e->events = events;
+  e->stamp = stamp;
+
+  return ret;
+}
+
+int cRosPollerWait( CrosPoller *p, uint64_t timeout_ns )
+{
+  int n_set;
+
+  PRINT_VDEBUG ( "cRosPollerWait()\n" );
+
+#if CROS_POLLER_HAS_EPOLL
+  if( p->backend == CROS_POLLER_EPOLL )
+  {
+#if CROS_POLLER_HAS_EPOLL_PWAIT2
+    if( !p->ms_timeouts )
+    {
+      struct timespec ts = cRosClockGetTimeSpec( timeout_ns );
+      n_set = epoll_pwait2( p->epoll_fd, (struct epoll_event *)p->ready_events, p->max_ready_events, &ts, NULL );
+      if( n_set == -1 && errno == ENOSYS ) // Kernel older than 5.11
+        p->ms_timeouts = 1;
+      else
+      {
+        p->n_ready_events = (n_set > 0)? n_set : 0;
+        return n_set;
+      }
+    }
+#endif
+    uint64_t timeout_ms = timeout_ns / CROS_CLOCK_NS_PER_MS + ( timeout_ns % CROS_CLOCK_NS_PER_MS != 0 );
+    n_set = epoll_wait( p->epoll_fd, (struct epoll_event *)p->ready_events, p->max_ready_events,
+                        (timeout_ms > INT_MAX)? INT_MAX : (int)timeout_ms );
+    p->n_ready_events = (n_set > 0)? n_set : 0;
+    return n_set;
+  }
+#endif
+
+  struct timespec ts = cRosClockGetTimeSpec( timeout_ns );
+  struct timeval tv;
+  tv.tv_sec = ts.tv_sec;
+  tv.tv_usec = ( ts.tv_nsec + 999 ) / 1000; // Round up, so that the deadline has passed when select() times out
+  if( tv.tv_usec == 1000000 )
+  {
+    if( tv.tv_sec < LONG_MAX )
+    {
+      tv.tv_sec++;
+      tv.tv_usec = 0;
+    }
+    else
+      tv.tv_usec = 999999;
+  }
+  p->r_fds = p->watch_r_fds;
+  p->w_fds = p->watch_w_fds;
+  p->err_fds = p->watch_err_fds;
+  n_set = select( p->max_fd + 1, &p->r_fds, &p->w_fds, &p->err_fds, &tv );
+  if( n_set <= 0 )
+    return n_set;
+
+  // List the ready descriptors, so that they are reported in the same way as with epoll
+  int fd, n_ready = 0;
+  for( fd = 0; fd <= p->max_fd && n_ready < n_set; fd++ )
+  {
+    if( FD_ISSET( fd, &p->r_fds ) || FD_ISSET( fd, &p->w_fds ) || FD_ISSET( fd, &p->err_fds ) )
+      p->ready_fds[n_ready++] = fd;
+  }
+  p->n_ready_events = n_ready;
+  return n_ready;
+}
+
+uint64_t cRosPollerGetReadyTag( CrosPoller *p, int ready_idx )
+{
+#if CROS_POLLER_HAS_EPOLL
+  if( p->backend == CROS_POLLER_EPOLL && ready_idx >= 0 && ready_idx < p->n_ready_events )
+    return ((struct epoll_event *)p->ready_events)[ready_idx].data.u64;
+#endif
+  if( p->backend == CROS_POLLER_SELECT && ready_idx >= 0 && ready_idx < p->n_ready_events )
+    return p->fd_tags[p->ready_fds[ready_idx]];
+  return UINT64_MAX;
+}
+
+unsigned int cRosPollerGetReadyEvents( CrosPoller *p, int ready_idx, CrosPollerEntry *e )
+{
+  unsigned int events = 0;
+
+#if CROS_POLLER_HAS_EPOLL
+  if( p->backend == CROS_POLLER_EPOLL && ready_idx >= 0 && ready_idx < p->n_ready_events )
+  {
+    uint32_t epoll_events = ((struct epoll_event *)p->ready_events)[ready_idx].events;
+
+    if( epoll_events & EPOLLIN )
+      events |= CROS_POLLER_READ;
+    if( epoll_events & EPOLLOUT )
+      events |= CROS_POLLER_WRITE;
+    if( epoll_events & EPOLLPRI )
+      events |= CROS_POLLER_ERROR;
+
+    if( epoll_events & (EPOLLERR | EPOLLHUP) )
+    {
+      // As select() does, hang-ups and socket errors are reported as read/write readiness,
+      // so that the next I/O operation of the process detects them
+      if( e->events & (CROS_POLLER_READ | CROS_POLLER_WRITE) )
+        events |= e->events & (CROS_POLLER_READ | CROS_POLLER_WRITE);
+      else if( e->registered )
+      {
+        // The process is not waiting for I/O: stop watching the socket until the process
+        // changes its state, since epoll would report this condition continuously
+        epoll_ctl( p->epoll_fd, EPOLL_CTL_DEL, e->fd, NULL );
+        e->registered = 0;
+      }
+    }
+  }
+#endif
+  if( p->backend == CROS_POLLER_SELECT && ready_idx >= 0 && ready_idx < p->n_ready_events )
+  {
+    int fd = p->ready_fds[ready_idx];
+
+    if( fd != e->fd ) // The process has closed the descriptor since the wait
+      return 0;
+    if( FD_ISSET( fd, &p->r_fds ) )
+      events |= CROS_POLLER_READ;
+    if( FD_ISSET( fd, &p->w_fds ) )
+      events |= CROS_POLLER_WRITE;
+    if( FD_ISSET( fd, &p->err_fds ) )
+      events |= CROS_POLLER_ERROR;
+  }
+
+  return events & e->events;
+}
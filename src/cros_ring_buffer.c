@@ -0,0 +1,122 @@
+#include <stdlib.h>
+
+#include "cros_ring_buffer.h"
+#include "cros_defs.h"
+
+// The positions run over twice the capacity, so that a full buffer (end - first == capacity) is told apart
+// from an empty one (end == first). Each side reads the position changed by the other side with acquire
+// semantics, so that the content of the slots written before publishing a position is visible
+#define LOAD_POS( pos ) __atomic_load_n( &(pos), __ATOMIC_ACQUIRE )
+#define STORE_POS( pos, val ) __atomic_store_n( &(pos), (val), __ATOMIC_RELEASE )
+
+static unsigned int nextPos( CrosRingBuffer *rb, unsigned int pos )
+{
+  return ( pos + 1 < 2 * rb->capacity )? pos + 1 : 0;
+}
+
+static unsigned int posSlot( CrosRingBuffer *rb, unsigned int pos )
+{
+  return ( pos < rb->capacity )? pos : pos - rb->capacity;
+}
+
+static unsigned int posDistance( CrosRingBuffer *rb, unsigned int first, unsigned int end )
+{
+  return ( end >= first )? end - first : end + 2 * rb->capacity - first;
+}
+
+void cRosRingBufferInit( CrosRingBuffer *rb, size_t item_size, unsigned int capacity )
+{
+  rb->items = NULL;
+  rb->item_size = item_size;
+  rb->capacity = ( capacity > 0 )? capacity : 1;
+  rb->first = 0;
+  rb->end = 0;
+}
+
+int cRosRingBufferAlloc( CrosRingBuffer *rb )
+{
+  if( rb->items != NULL )
+    return 0;
+
+  rb->items = ( unsigned char * ) calloc( rb->capacity, rb->item_size );
+  if( rb->items == NULL )
+  {
+    PRINT_ERROR( "cRosRingBufferAlloc() : Can't allocate memory\n" );
+    return -1;
+  }
+  return 0;
+}
+
+void cRosRingBufferRelease( CrosRingBuffer *rb )
+{
+  free( rb->items );
+  rb->items = NULL;
+  rb->first = 0;
+  rb->end = 0;
+}
+
+void *cRosRingBufferGetSlot( CrosRingBuffer *rb, unsigned int slot )
+{
+  return rb->items + slot * rb->item_size;
+}
+
+void *cRosRingBufferGetBack( CrosRingBuffer *rb )
+{
+  unsigned int end = rb->end;
+
+  if( posDistance( rb, LOAD_POS( rb->first ), end ) >= rb->capacity || cRosRingBufferAlloc( rb ) != 0 )
+    return NULL;
+
+  return cRosRingBufferGetSlot( rb, posSlot( rb, end ) );
+}
+
+void *cRosRingBufferPushBack( CrosRingBuffer *rb )
+{
+  unsigned int end = rb->end;
+  void *slot = cRosRingBufferGetBack( rb );
+
+  if( slot != NULL )
+    STORE_POS( rb->end, nextPos( rb, end ) );
+  return slot;
+}
+
+void *cRosRingBufferPopFront( CrosRingBuffer *rb )
+{
+  unsigned int first = rb->first;
+
+  if( LOAD_POS( rb->end ) == first )
+    return NULL;
+
+  STORE_POS( rb->first, nextPos( rb, first ) );
+  return cRosRingBufferGetSlot( rb, posSlot( rb, first ) );
+}
+
+void *cRosRingBufferPeekFirst( CrosRingBuffer *rb )
+{
+  unsigned int first = rb->first;
+
+  if( LOAD_POS( rb->end ) == first )
+    return NULL;
+
+  return cRosRingBufferGetSlot( rb, posSlot( rb, first ) );
+}
+
+void *cRosRingBufferPeekLast( CrosRingBuffer *rb )
+{
+  unsigned int end = LOAD_POS( rb->end );
+
+  if( end == LOAD_POS( rb->first ) )
+    return NULL;
+
+  return cRosRingBufferGetSlot( rb, posSlot( rb, ( end > 0 )? end - 1 : 2 * rb->capacity - 1 ) );
+}
+
+unsigned int cRosRingBufferUsage( CrosRingBuffer *rb )
+{
+  return posDistance( rb, LOAD_POS( rb->first ), LOAD_POS( rb->end ) );
+}
+
+unsigned int cRosRingBufferVacancies( CrosRingBuffer *rb )
+{
+  return rb->capacity - cRosRingBufferUsage( rb );
+}
@@ -303,7 +303,7 @@ cRosErrCodePack cRosServiceBuild(cRosService* service, const char* filepath)
   return cRosServiceBuildInner(&service->request, &service->response, NULL, service->md5sum, filepath);
 }
 
-cRosErrCodePack cRosServiceBuildInner(cRosMessage **request_ptr, cRosMessage **response_ptr, char **message_definition, char *md5sum, const char* filepath)
+cRosErrCodePack cRosServiceDefBuild(cRosSrvDef **srv_def_ptr, char *md5sum, const char* filepath)
 {
   cRosErrCodePack ret_err;
 
@@ -364,6 +364,17 @@ cRosErrCodePack cRosServiceBuildInner(cRosMessage **request_ptr, cRosMessage **r
   strcpy(md5sum, output.data);
   dynStringRelease(&output);
 
+  *srv_def_ptr = srv;
+
+  return ret_err;
+}
+
+cRosErrCodePack cRosServiceBuildFromDef(cRosMessage **request_ptr, cRosMessage **response_ptr, cRosSrvDef *srv)
+{
+  cRosErrCodePack ret_err;
+
+  ret_err = CROS_SUCCESS_ERR_PACK;
+
   if(srv->request->plain_text != NULL)
   {
     ret_err = cRosMessageBuildFromDef(request_ptr, srv->request);
@@ -374,6 +385,20 @@ cRosErrCodePack cRosServiceBuildInner(cRosMessage **request_ptr, cRosMessage **r
     ret_err = cRosMessageBuildFromDef(response_ptr, srv->response);
   }
 
+  return ret_err;
+}
+
+cRosErrCodePack cRosServiceBuildInner(cRosMessage **request_ptr, cRosMessage **response_ptr, char **message_definition, char *md5sum, const char* filepath)
+{
+  cRosErrCodePack ret_err;
+  cRosSrvDef* srv;
+
+  ret_err = cRosServiceDefBuild(&srv, md5sum, filepath);
+  if(ret_err != CROS_SUCCESS_ERR_PACK)
+    return ret_err;
+
+  ret_err = cRosServiceBuildFromDef(request_ptr, response_ptr, srv);
+
   if(ret_err == CROS_SUCCESS_ERR_PACK && srv->plain_text != NULL && message_definition != NULL)
   {
      *message_definition=(char *)malloc((strlen(srv->plain_text)+1)*sizeof(char));
@@ -316,7 +316,7 @@ TcprosParserState cRosMessageParseSubcriptionHeader( CrosNode *n, int server_idx
   {
     int topic_found = 0;
     int i = 0;
-    for( i = 0 ; i < n->n_pubs; i++)
+    for( i = 0 ; i < n->pubs_table.size; i++)
     {
       PublisherNode *pub = &n->pubs[i];
       if (pub->topic_name == NULL)
@@ -329,8 +329,7 @@ TcprosParserState cRosMessageParseSubcriptionHeader( CrosNode *n, int server_idx
         topic_found = 1;
         server_proc->topic_idx = i; // Assign a topic (publisher index) to the TCPROS process
         pub->client_tcpros_id = server_idx;
-        if(cRosMessageQueueUsage(&pub->msg_queue) > 0) // Check whether there are messages waiting in the queue to be sent
-          server_proc->send_msg_now = 1;
+        tcprosProcessSetOutQueueLength( server_proc, pub->queue_size );
         break;
       }
     }
@@ -379,7 +378,7 @@ TcprosParserState cRosMessageParsePublicationHeader( CrosNode *n, int client_idx
   {
     int subscriber_found = 0;
     int i = 0;
-    for( i = 0 ; i < n->n_subs; i++)
+    for( i = 0 ; i < n->subs_table.size; i++)
     {
       SubscriberNode *sub = &n->subs[i];
       if (sub->topic_name == NULL)
@@ -434,6 +433,69 @@ void cRosMessagePrepareSubcriptionHeader( CrosNode *n, int client_idx )
   *header_len_p = header_out_len;
 }
 
+/*! Ordering keys of the executor jobs: the callbacks of each subscriber and of each service provider run in order */
+#define CN_SUBSCRIBER_TASK_KEY(sub_idx) ( (unsigned int)(sub_idx) * 2 )
+#define CN_SERVICE_PROVIDER_TASK_KEY(srv_idx) ( (unsigned int)(srv_idx) * 2 + 1 )
+
+// The overflow flag is read and reset by cRosNodeReceiveTopicMsg(), which may run in another thread
+static void checkSubscriberQueueSpace( SubscriberNode *sub_node )
+{
+  if(cRosMessageQueueVacancies(&sub_node->msg_queue) == 0)
+    __atomic_store_n( &sub_node->msg_queue_overflow, 1, __ATOMIC_RELAXED ); // No space in the queue for the new message
+}
+
+// Run by a worker thread: pass the received message to the subscriber
+static void runSubscriberTask( void *arg )
+{
+  CrosNodeTask *task = (CrosNodeTask *)arg;
+  CrosNode *n = task->node;
+  SubscriberNode *sub_node = &n->subs[task->owner_idx];
+  cRosErrCodePack ret_err = CROS_SUCCESS_ERR_PACK;
+
+  checkSubscriberQueueSpace( sub_node );
+
+  if( task->msg != NULL )
+  {
+    if( sub_node->msg_callback != NULL )
+      ret_err = sub_node->msg_callback( task->msg, sub_node->context );
+  }
+  else
+    ret_err = sub_node->callback( &task->packet, sub_node->context );
+
+  if( ret_err != CROS_SUCCESS_ERR_PACK )
+    cRosPrintErrCodePack(ret_err, "runSubscriberTask() : the subscriber callback failed");
+  cRosNodeNotifyReceivers( n );
+
+  cRosMessageFree( task->msg );
+  task->msg = NULL;
+  cRosNodeReleaseTask( n, task );
+}
+
+// Pass a received message to a worker thread. Either the packet is taken (the process gets an empty one) or msg is
+static cRosErrCodePack dispatchSubscriberTask( CrosNode *n, int sub_idx, DynBuffer *packet, cRosMessage *msg )
+{
+  CrosNodeTask *task = cRosNodeAcquireTask( n );
+  if( task == NULL )
+  {
+    cRosMessageFree( msg );
+    return CROS_MEM_ALLOC_ERR;
+  }
+
+  task->owner_idx = sub_idx;
+  task->msg = msg;
+  if( packet != NULL )
+    dynBufferSwap( &task->packet, packet );
+
+  if( cRosExecutorSubmit( &n->executor, CN_SUBSCRIBER_TASK_KEY( sub_idx ), runSubscriberTask, task ) != 0 )
+  {
+    cRosMessageFree( task->msg );
+    task->msg = NULL;
+    cRosNodeReleaseTask( n, task );
+    return CROS_MEM_ALLOC_ERR;
+  }
+  return CROS_SUCCESS_ERR_PACK;
+}
+
 cRosErrCodePack cRosMessageParsePublicationPacket( CrosNode *n, int client_idx )
 {
   cRosErrCodePack ret_err;
@@ -447,10 +509,84 @@ cRosErrCodePack cRosMessageParsePublicationPacket( CrosNode *n, int client_idx )
   sub_node = &n->subs[client_proc->topic_idx];
   data_context = sub_node->context;
 
-  if(cRosMessageQueueVacancies(&sub_node->msg_queue) == 0)
-    sub_node->msg_queue_overflow = 1; // No space in the queue for the new message
+  if( n->executor.n_workers > 0 ) // Threaded mode: the callback is run by a worker thread
+    return dispatchSubscriberTask( n, client_proc->topic_idx, packet, NULL );
+
+  checkSubscriberQueueSpace( sub_node );
 
   ret_err = sub_node->callback(packet,data_context);
+  cRosNodeNotifyReceivers( n );
+
+  return ret_err;
+}
+
+int cRosMessageStartPublicationStream( CrosNode *n, int client_idx, size_t msg_size )
+{
+  SubscriberNode *sub_node;
+  TcprosProcess *client_proc;
+
+  client_proc = &(n->tcpros_client_proc[client_idx]);
+  sub_node = &n->subs[client_proc->topic_idx];
+
+  if( tcprosProcessIsDecoding( client_proc ) )
+    cRosMessageDecoderFinish( client_proc->decoder ); // Abandon the previous message
+
+  if( sub_node->msg_callback == NULL || sub_node->msg_prototype == NULL || msg_size < sub_node->stream_min_size )
+    return 0;
+
+  if( client_proc->decoder == NULL )
+  {
+    // The decoder and its message are created for the first large message, and kept for the next ones
+    cRosMessage *decoded_msg = cRosMessageCopy( sub_node->msg_prototype );
+    cRosMessageDecoder *decoder = ( decoded_msg != NULL )? cRosMessageDecoderNew( decoded_msg ) : NULL;
+    if( decoder == NULL )
+    {
+      PRINT_ERROR("cRosMessageStartPublicationStream() : Can't allocate memory: the message will be decoded once received\n");
+      cRosMessageFree( decoded_msg );
+      return 0;
+    }
+    tcprosProcessSetDecoder( client_proc, decoder, decoded_msg );
+  }
+
+  cRosMessageDecoderStart( client_proc->decoder, msg_size );
+  return 1;
+}
+
+cRosErrCodePack cRosMessageParsePublicationChunk( CrosNode *n, int client_idx )
+{
+  cRosErrCodePack ret_err;
+  SubscriberNode *sub_node;
+  TcprosProcess *client_proc;
+  DynBuffer *packet;
+
+  client_proc = &(n->tcpros_client_proc[client_idx]);
+  packet = &(client_proc->packet);
+  sub_node = &n->subs[client_proc->topic_idx];
+
+  // The received bytes are decoded into the message and then dropped, so the packet does not grow with the message
+  cRosMessageDecoderFeed( client_proc->decoder, dynBufferGetCurrentData( packet ), dynBufferGetRemainingDataSize( packet ) );
+  dynBufferClear( packet );
+  if( client_proc->left_to_recv > 0 )
+    return CROS_SUCCESS_ERR_PACK;
+
+  ret_err = cRosMessageDecoderFinish( client_proc->decoder );
+  if( ret_err != CROS_SUCCESS_ERR_PACK )
+  {
+    cRosPrintErrCodePack(ret_err, "cRosMessageParsePublicationChunk() failed decoding the received message");
+    return ret_err;
+  }
+
+  if( sub_node->msg_callback == NULL ) // The subscriber stopped decoding the messages while they are received
+    return CROS_SUCCESS_ERR_PACK;
+
+  // In threaded mode the worker thread takes the message, and the process creates a new one for the next large message
+  if( n->executor.n_workers > 0 )
+    return dispatchSubscriberTask( n, client_proc->topic_idx, NULL, tcprosProcessTakeDecodedMessage( client_proc ) );
+
+  checkSubscriberQueueSpace( sub_node );
+
+  ret_err = sub_node->msg_callback( client_proc->decoded_msg, sub_node->context );
+  cRosNodeNotifyReceivers( n );
 
   return ret_err;
 }
@@ -480,52 +616,118 @@ void cRosMessagePreparePublicationHeader( CrosNode *n, int server_idx )
   *header_len_p = header_out_len;
 }
 
+TcprosFrame *cRosMessageOpenPublicationFrame( size_t msg_size )
+{
+  TcprosFrame *frame;
+  DynBuffer *packet;
+
+  frame = tcprosFrameNew();
+  if(frame == NULL)
+  {
+    PRINT_ERROR("cRosMessageOpenPublicationFrame() : Can't allocate memory\n");
+    return NULL;
+  }
+  packet = &(frame->packet);
+  // Allocate the frame once with its final size: the size field and the encoded message
+  if( dynBufferReserve( packet, sizeof(uint32_t) + msg_size ) < 0 )
+  {
+    tcprosFrameUnref(frame);
+    return NULL;
+  }
+  dynBufferPushBackUInt32( packet, 0 ); // Placeholder for packet size
+  return frame;
+}
+
+void cRosMessageClosePublicationFrame( TcprosFrame *frame )
+{
+  DynBuffer *packet = &(frame->packet);
+  *(uint32_t *)packet->data = (uint32_t)dynBufferGetSize(packet) - sizeof(uint32_t);
+}
+
+cRosErrCodePack cRosMessagePreparePublicationFrame( cRosMessage *msg, TcprosFrame **frame_ptr )
+{
+  cRosErrCodePack ret_err;
+  TcprosFrame *frame;
+  PRINT_VDEBUG("cRosMessagePreparePublicationFrame()\n");
+
+  *frame_ptr = NULL;
+  frame = cRosMessageOpenPublicationFrame( cRosMessageSize(msg) );
+  if(frame == NULL)
+    return CROS_MEM_ALLOC_ERR;
+
+  ret_err = cRosMessageSerialize(msg, &(frame->packet));
+  if(ret_err != CROS_SUCCESS_ERR_PACK)
+  {
+    tcprosFrameUnref(frame);
+    return ret_err;
+  }
+
+  cRosMessageClosePublicationFrame(frame);
+  *frame_ptr = frame;
+  return CROS_SUCCESS_ERR_PACK;
+}
+
 cRosErrCodePack cRosMessagePreparePublicationPacket( CrosNode *node, int server_idx )
 {
   cRosErrCodePack ret_err;
   PublisherNode *pub_node;
   TcprosProcess *server_proc;
+  TcprosFrame *frame;
   int pub_idx;
+  uint64_t cycle_time;
   DynBuffer *packet;
   void *data_context;
   uint32_t packet_size;
   PRINT_VDEBUG("cRosMessagePreparePublicationPacket()\n");
 
   server_proc = &(node->tcpros_server_proc[server_idx]);
+
+  // Messages published explicitly are already serialized in the outgoing queue of the process
+  frame = tcprosProcessPopOutFrame( server_proc );
+  if(frame != NULL)
+  {
+    tcprosProcessSetFrame( server_proc, frame );
+    return CROS_SUCCESS_ERR_PACK;
+  }
+
   pub_idx = server_proc->topic_idx;
-  packet = &(server_proc->packet);
+  pub_node = &node->pubs[pub_idx];
+  // Start time of the periodic publication cycle (the wake-up time has already been moved to the next cycle)
+  cycle_time = server_proc->wake_up_time - pub_node->loop_period_ns;
+
+  // The message is serialized only once: the processes of the topic that send it in the same cycle share its frame
+  if(pub_node->periodic_frame != NULL && pub_node->periodic_frame_time == cycle_time)
+  {
+    tcprosProcessSetFrame( server_proc, tcprosFrameRef( pub_node->periodic_frame ) );
+    return CROS_SUCCESS_ERR_PACK;
+  }
+
+  frame = tcprosFrameNew();
+  if(frame == NULL)
+  {
+    PRINT_ERROR("cRosMessagePreparePublicationPacket() : Can't allocate memory\n");
+    return CROS_MEM_ALLOC_ERR;
+  }
+  packet = &(frame->packet);
   dynBufferPushBackUInt32( packet, 0 ); // Placeholder for packet size
 
-  pub_node = &node->pubs[pub_idx];
   data_context = pub_node->context;
-  ret_err = pub_node->callback( packet, server_proc->send_msg_now, data_context);
+  ret_err = pub_node->callback( packet, 0, data_context);
+
+  // The callback may have registered new elements in the node, so its tables may have been moved
+  server_proc = &(node->tcpros_server_proc[server_idx]);
+  pub_node = &node->pubs[pub_idx];
 
   packet_size = (uint32_t)dynBufferGetSize(packet) - sizeof(uint32_t);
   *(uint32_t *)packet->data = packet_size;
 
-  // The following code block manages the logic of non-periodic msg sending
-  if(server_proc->send_msg_now != 0) // A non-periodic msg has just been sent
+  if(ret_err == CROS_SUCCESS_ERR_PACK) // Keep the frame for the other processes of the topic
   {
-    int srv_proc_ind, all_proc_sent;
-    server_proc->send_msg_now = 0; // Indicate that the current msg does not have to been sent anymore
-    // Check if all processes of this topic publisher have already sent the first msg in the queue. If so,
-    // delete msg from queue and activate the sending process again if more messages remain in the queue
-    all_proc_sent = 1; // Flag indicating that all processes sent the first queue message
-    for(srv_proc_ind=0;srv_proc_ind<CN_MAX_TCPROS_SERVER_CONNECTIONS && all_proc_sent == 1;srv_proc_ind++)
-      if(node->tcpros_server_proc[srv_proc_ind].topic_idx == pub_idx && node->tcpros_server_proc[srv_proc_ind].send_msg_now != 0) // for this process the msg is pending to be sent?
-        all_proc_sent = 0; // Some process has not sent the first message yet, exit loop
-
-    if(all_proc_sent == 1) // All processes sent the first queue msg
-    {
-      cRosMessageQueueRemove(&pub_node->msg_queue); // Remove first msg from queue
-      if(cRosMessageQueueUsage(&pub_node->msg_queue) > 0) // More messages in queue, restart the sending process
-      {
-        for(srv_proc_ind=0;srv_proc_ind<CN_MAX_TCPROS_SERVER_CONNECTIONS;srv_proc_ind++)
-          if(node->tcpros_server_proc[srv_proc_ind].topic_idx == pub_idx)
-            node->tcpros_server_proc[srv_proc_ind].send_msg_now = 1;
-      }
-    }
+    tcprosFrameUnref(pub_node->periodic_frame);
+    pub_node->periodic_frame = tcprosFrameRef(frame);
+    pub_node->periodic_frame_time = cycle_time;
   }
+  tcprosProcessSetFrame( server_proc, frame );
 
   return ret_err;
 }
@@ -671,8 +873,11 @@ TcprosParserState cRosMessageParseServiceCallerHeader( CrosNode *n, int server_i
   {
     int svc_name_match = 0;
     int i = 0;
-    for( i = 0 ; i < n->n_service_providers; i++)
+    for( i = 0 ; i < n->service_providers_table.size; i++)
     {
+      if (n->service_providers[i].service_name == NULL)
+        continue;
+
       if( strcmp( n->service_providers[i].service_name, dynStringGetData(&(server_proc->service))) == 0)
       {
         svc_name_match = 1;
@@ -695,8 +900,11 @@ TcprosParserState cRosMessageParseServiceCallerHeader( CrosNode *n, int server_i
   else if( header_flags == ( header_flags & TCPROS_SERVICEPROBE_HEADER_FLAGS) || header_flags == ( header_flags & TCPROS_SERVICEPROBE_MATLAB_HEADER_FLAGS) )
   {
     int i = 0;
-    for( i = 0 ; i < n->n_service_providers; i++)
+    for( i = 0 ; i < n->service_providers_table.size; i++)
     {
+      if (n->service_providers[i].service_name == NULL)
+        continue;
+
       if( strcmp( n->service_providers[i].service_name, dynStringGetData(&(server_proc->service))) == 0)
       {
         service_found = 1;
@@ -948,6 +1156,9 @@ cRosErrCodePack cRosMessagePrepareServiceCallPacket( CrosNode *n, int client_idx
 
   void* data_context = n->service_callers[svc_idx].context;
   ret_err = n->service_callers[svc_idx].callback( packet, NULL, 0, data_context);
+  // The callback may have registered new elements in the node, so its tables may have been moved
+  client_proc = &(n->rpcros_client_proc[client_idx]);
+  packet = &(client_proc->packet);
   client_proc->send_msg_now = 0; // End of service call
 
   uint32_t size = (uint32_t)dynBufferGetSize(packet) - sizeof(uint32_t);
@@ -1010,26 +1221,22 @@ void cRosMessagePrepareServiceProviderHeader( CrosNode *n, int server_idx)
   *header_len_p = header_out_len;
 }
 
-cRosErrCodePack cRosMessagePrepareServiceResponsePacket( CrosNode *n, int server_idx)
+// Run the callback of a service provider with the request in packet, and replace it with the response packet
+static cRosErrCodePack runServiceProviderCallback( ServiceProviderNode *srv_node, DynBuffer *packet )
 {
   cRosErrCodePack ret_err;
   uint8_t ok_byte; // OK field (byte size) of the service response packet
-
-  PRINT_VDEBUG("cRosMessageParseServiceArgumentsPacket()\n");
-  TcprosProcess *server_proc = &(n->rpcros_server_proc[server_idx]);
-  DynBuffer *packet = &(server_proc->packet);
-  int srv_idx = server_proc->service_idx;
-  void* service_context = n->service_providers[srv_idx].context;
   DynBuffer service_response;
   dynBufferInit(&service_response);
 
-  ret_err = n->service_providers[srv_idx].callback(packet, &service_response, service_context);
+  ret_err = srv_node->callback(packet, &service_response, srv_node->context);
 
   dynBufferClear(packet); // clear packet buffer
 
   if(ret_err == CROS_SUCCESS_ERR_PACK)
   {
     ok_byte = TCPROS_OK_BYTE_SUCCESS;
+    dynBufferReserve( packet, sizeof(uint8_t) + sizeof(uint32_t) + service_response.size );
     dynBufferPushBackBuf( packet, &ok_byte, sizeof(uint8_t) );
     dynBufferPushBackUInt32( packet, service_response.size); // data size field
     dynBufferPushBackBuf( packet, service_response.data, service_response.size); // Response data
@@ -1045,3 +1252,47 @@ cRosErrCodePack cRosMessagePrepareServiceResponsePacket( CrosNode *n, int server
 
   return ret_err;
 }
+
+cRosErrCodePack cRosMessagePrepareServiceResponsePacket( CrosNode *n, int server_idx)
+{
+  PRINT_VDEBUG("cRosMessagePrepareServiceResponsePacket()\n");
+  TcprosProcess *server_proc = &(n->rpcros_server_proc[server_idx]);
+
+  return runServiceProviderCallback( &n->service_providers[server_proc->service_idx], &server_proc->packet );
+}
+
+// Run by a worker thread: prepare the response to a service request, and pass it back to the node loop
+static void runServiceProviderTask( void *arg )
+{
+  CrosNodeTask *task = (CrosNodeTask *)arg;
+  cRosErrCodePack ret_err;
+
+  ret_err = runServiceProviderCallback( &task->node->service_providers[task->owner_idx], &task->packet );
+  if( ret_err != CROS_SUCCESS_ERR_PACK )
+    cRosPrintErrCodePack(ret_err, "runServiceProviderTask() : the service provider callback failed");
+
+  cRosNodeCompleteTask( task->node, task );
+}
+
+int cRosMessageDispatchServiceRequest( CrosNode *n, int server_idx )
+{
+  TcprosProcess *server_proc = &(n->rpcros_server_proc[server_idx]);
+  CrosNodeTask *task;
+
+  if( n->executor.n_workers == 0 || ( task = cRosNodeAcquireTask( n ) ) == NULL )
+    return -1;
+
+  task->owner_idx = server_proc->service_idx;
+  task->proc_idx = server_idx;
+  dynBufferSwap( &task->packet, &server_proc->packet );
+  tcprosProcessChangeState( server_proc, TCPROS_PROCESS_STATE_WAIT_FOR_RESPONSE );
+  task->proc_stamp = server_proc->state_changes; // The response is dropped if the process changes its state meanwhile
+
+  if( cRosExecutorSubmit( &n->executor, CN_SERVICE_PROVIDER_TASK_KEY( server_proc->service_idx ), runServiceProviderTask, task ) != 0 )
+  {
+    dynBufferSwap( &task->packet, &server_proc->packet );
+    cRosNodeReleaseTask( n, task );
+    return -1;
+  }
+  return 0;
+}
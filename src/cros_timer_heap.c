@@ -0,0 +1,158 @@
+#include <stdlib.h>
+
+#include "cros_timer_heap.h"
+#include "cros_defs.h"
+
+void cRosTimerHeapInit( CrosTimerHeap *h )
+{
+  h->timers = NULL;
+  h->n_timers = 0;
+  h->heap = NULL;
+  h->n_armed = 0;
+  h->capacity = 0;
+}
+
+void cRosTimerHeapRelease( CrosTimerHeap *h )
+{
+  free( h->timers );
+  free( h->heap );
+  cRosTimerHeapInit( h );
+}
+
+// Store a timer at a heap position, keeping track of the position in the timer
+static void placeTimer( CrosTimerHeap *h, int pos, int timer_id )
+{
+  h->heap[pos] = timer_id;
+  h->timers[timer_id].heap_pos = pos;
+}
+
+static void siftUp( CrosTimerHeap *h, int pos )
+{
+  int timer_id = h->heap[pos];
+  uint64_t deadline = h->timers[timer_id].deadline;
+
+  while( pos > 0 )
+  {
+    int parent = ( pos - 1 ) / 2;
+    if( h->timers[h->heap[parent]].deadline <= deadline )
+      break;
+    placeTimer( h, pos, h->heap[parent] );
+    pos = parent;
+  }
+  placeTimer( h, pos, timer_id );
+}
+
+static void siftDown( CrosTimerHeap *h, int pos )
+{
+  int timer_id = h->heap[pos];
+  uint64_t deadline = h->timers[timer_id].deadline;
+
+  for(;;)
+  {
+    int child = 2 * pos + 1;
+    if( child >= h->n_armed )
+      break;
+    if( child + 1 < h->n_armed && h->timers[h->heap[child + 1]].deadline < h->timers[h->heap[child]].deadline )
+      child++;
+    if( deadline <= h->timers[h->heap[child]].deadline )
+      break;
+    placeTimer( h, pos, h->heap[child] );
+    pos = child;
+  }
+  placeTimer( h, pos, timer_id );
+}
+
+// Remove the timer at a heap position, filling the gap with the last timer of the heap
+static void removeAt( CrosTimerHeap *h, int pos )
+{
+  int timer_id = h->heap[pos];
+  int last_id = h->heap[--h->n_armed];
+
+  h->timers[timer_id].heap_pos = -1;
+  h->timers[timer_id].deadline = CROS_TIMER_NEVER;
+  if( last_id == timer_id )
+    return;
+
+  placeTimer( h, pos, last_id );
+  if( pos > 0 && h->timers[h->heap[( pos - 1 ) / 2]].deadline > h->timers[last_id].deadline )
+    siftUp( h, pos );
+  else
+    siftDown( h, pos );
+}
+
+int cRosTimerHeapAdd( CrosTimerHeap *h, uint64_t tag )
+{
+  CrosTimer *timer;
+
+  if( h->n_timers == h->capacity )
+  {
+    int new_capacity = ( h->capacity > 0 )? 2 * h->capacity : 16;
+    CrosTimer *new_timers = ( CrosTimer * )realloc( h->timers, new_capacity * sizeof( CrosTimer ) );
+    if( new_timers == NULL )
+    {
+      PRINT_ERROR( "cRosTimerHeapAdd() : Can't allocate memory\n" );
+      return -1;
+    }
+    h->timers = new_timers;
+
+    int *new_heap = ( int * )realloc( h->heap, new_capacity * sizeof( int ) );
+    if( new_heap == NULL )
+    {
+      PRINT_ERROR( "cRosTimerHeapAdd() : Can't allocate memory\n" );
+      return -1;
+    }
+    h->heap = new_heap;
+    h->capacity = new_capacity;
+  }
+
+  timer = &h->timers[h->n_timers];
+  timer->deadline = CROS_TIMER_NEVER;
+  timer->tag = tag;
+  timer->heap_pos = -1;
+  return h->n_timers++;
+}
+
+void cRosTimerHeapArm( CrosTimerHeap *h, int timer_id, uint64_t deadline )
+{
+  CrosTimer *timer = &h->timers[timer_id];
+  uint64_t old_deadline = timer->deadline;
+
+  if( deadline == CROS_TIMER_NEVER )
+  {
+    if( timer->heap_pos >= 0 )
+      removeAt( h, timer->heap_pos );
+    return;
+  }
+
+  timer->deadline = deadline;
+  if( timer->heap_pos < 0 )
+  {
+    // The heap has room for all the timers, so arming one does not allocate memory
+    placeTimer( h, h->n_armed++, timer_id );
+    siftUp( h, timer->heap_pos );
+  }
+  else if( deadline < old_deadline )
+    siftUp( h, timer->heap_pos );
+  else if( deadline > old_deadline )
+    siftDown( h, timer->heap_pos );
+}
+
+uint64_t cRosTimerHeapGetDeadline( const CrosTimerHeap *h, int timer_id )
+{
+  return h->timers[timer_id].deadline;
+}
+
+uint64_t cRosTimerHeapNextDeadline( const CrosTimerHeap *h )
+{
+  return ( h->n_armed > 0 )? h->timers[h->heap[0]].deadline : CROS_TIMER_NEVER;
+}
+
+int cRosTimerHeapPopExpired( CrosTimerHeap *h, uint64_t now, uint64_t *tag )
+{
+  if( h->n_armed == 0 || h->timers[h->heap[0]].deadline > now )
+    return 0;
+
+  *tag = h->timers[h->heap[0]].tag;
+  removeAt( h, 0 );
+  return 1;
+}
@@ -0,0 +1,81 @@
+#include <unistd.h>
+#include <fcntl.h>
+#include <errno.h>
+#include <stdint.h>
+
+#if defined(__linux__)
+#  include <sys/eventfd.h>
+#endif
+
+#include "cros_wakeup.h"
+#include "cros_defs.h"
+
+void cRosWakeupInit( CrosWakeup *w )
+{
+  w->read_fd = -1;
+  w->write_fd = -1;
+  cRosPollerEntryInit( &w->poller_entry );
+}
+
+int cRosWakeupOpen( CrosWakeup *w )
+{
+  if( w->read_fd >= 0 )
+    return 0;
+
+#if defined(__linux__)
+  w->read_fd = w->write_fd = eventfd( 0, EFD_NONBLOCK | EFD_CLOEXEC );
+  if( w->read_fd < 0 )
+  {
+    PRINT_ERROR( "cRosWakeupOpen() : eventfd() failed. errno=%i\n", errno );
+    return -1;
+  }
+#else
+  int fds[2];
+  if( pipe( fds ) != 0 )
+  {
+    PRINT_ERROR( "cRosWakeupOpen() : pipe() failed. errno=%i\n", errno );
+    return -1;
+  }
+  fcntl( fds[0], F_SETFL, fcntl( fds[0], F_GETFL ) | O_NONBLOCK );
+  fcntl( fds[1], F_SETFL, fcntl( fds[1], F_GETFL ) | O_NONBLOCK );
+  w->read_fd = fds[0];
+  w->write_fd = fds[1];
+#endif
+  return 0;
+}
+
+void cRosWakeupClose( CrosWakeup *w )
+{
+  if( w->write_fd >= 0 && w->write_fd != w->read_fd )
+    close( w->write_fd );
+  if( w->read_fd >= 0 )
+    close( w->read_fd );
+  w->read_fd = -1;
+  w->write_fd = -1;
+}
+
+void cRosWakeupSignal( CrosWakeup *w )
+{
+  ssize_t ret;
+#if defined(__linux__)
+  uint64_t value = 1;
+  ret = write( w->write_fd, &value, sizeof( value ) );
+#else
+  unsigned char value = 1;
+  ret = write( w->write_fd, &value, sizeof( value ) );
+#endif
+  // If the pipe is full (EAGAIN), the loop has a wake-up pending anyway
+  (void)ret;
+}
+
+void cRosWakeupDrain( CrosWakeup *w )
+{
+#if defined(__linux__)
+  uint64_t value;
+  ssize_t ret = read( w->read_fd, &value, sizeof( value ) ); // Reading an eventfd resets its counter
+  (void)ret;
+#else
+  unsigned char values[64];
+  while( read( w->read_fd, values, sizeof( values ) ) > 0 );
+#endif
+}
@@ -29,45 +29,86 @@ void dynBufferRelease ( DynBuffer *d_buf )
   d_buf->max = 0;
 }
 
-int dynBufferPushBackBuf ( DynBuffer *d_buf, const unsigned char *new_buf, size_t n )
+void dynBufferSwap ( DynBuffer *d_buf1, DynBuffer *d_buf2 )
 {
-  PRINT_VDEBUG ( "dynBufferPushBackBuf()\n" );
+  DynBuffer tmp = *d_buf1;
+  *d_buf1 = *d_buf2;
+  *d_buf2 = tmp;
+}
 
-  if (new_buf == NULL && n > 0) // If n == 0, the function accepts NULL as new_buf since nothing have to be appended
-  {
-    PRINT_ERROR ( "dynBufferPushBackBuf() : Invalid function argument values: new buffer content must be different from NULL and no shorter than 0\n" );
-    return -1;
-  }
+int dynBufferReserve ( DynBuffer *d_buf, size_t n )
+{
+  PRINT_VDEBUG ( "dynBufferReserve()\n" );
 
   if ( d_buf->data == NULL )
   {
-    PRINT_DEBUG ( "dynBufferPushBackBuf() : allocate memory for the first time\n" );
-    d_buf->data = ( unsigned char * ) malloc ( DYNBUFFER_INIT_SIZE * sizeof ( unsigned char ) );
+    PRINT_DEBUG ( "dynBufferReserve() : allocate memory for the first time\n" );
+    size_t init_size = ( n > DYNBUFFER_INIT_SIZE )? n : DYNBUFFER_INIT_SIZE;
+    d_buf->data = ( unsigned char * ) malloc ( init_size * sizeof ( unsigned char ) );
 
     if ( d_buf->data == NULL )
     {
-      PRINT_ERROR ( "dynBufferPushBackBuf() : Can't allocate memory\n" );
+      PRINT_ERROR ( "dynBufferReserve() : Can't allocate memory\n" );
       return -1;
     }
 
     d_buf->size = 0;
-    d_buf->max = DYNBUFFER_INIT_SIZE;
+    d_buf->max = init_size;
   }
 
-  while ( d_buf->size + n > d_buf->max )
+  if ( d_buf->size + n > d_buf->max )
   {
-    PRINT_DEBUG ( "dynBufferPushBackBuf() : reallocate memory\n" );
-    unsigned char *new_d_buf = ( unsigned char * ) realloc ( d_buf->data, ( DYNBUFFER_GROW_RATE * d_buf->max ) *
-                                                                             sizeof ( unsigned char ) );
+    PRINT_DEBUG ( "dynBufferReserve() : reallocate memory\n" );
+    // Grow geometrically, unless a larger block is requested (e.g. a message of known size): then allocate it exactly
+    size_t new_max = DYNBUFFER_GROW_RATE * d_buf->max;
+    if ( d_buf->size + n > new_max )
+      new_max = d_buf->size + n;
+
+    unsigned char *new_d_buf = ( unsigned char * ) realloc ( d_buf->data, new_max * sizeof ( unsigned char ) );
     if ( new_d_buf == NULL )
     {
-      PRINT_ERROR ( "dynBufferPushBackBuf() : Can't allocate more memory\n" );
+      PRINT_ERROR ( "dynBufferReserve() : Can't allocate more memory\n" );
       return -1;
     }
-    d_buf->max *= DYNBUFFER_GROW_RATE;
+    d_buf->max = new_max;
     d_buf->data = new_d_buf;
   }
 
+  return 0;
+}
+
+unsigned char *dynBufferGetTailData ( DynBuffer *d_buf )
+{
+  PRINT_VDEBUG ( "dynBufferGetTailData()\n" );
+
+  return d_buf->data + d_buf->size;
+}
+
+void dynBufferExtendSize ( DynBuffer *d_buf, size_t n )
+{
+  PRINT_VDEBUG ( "dynBufferExtendSize()\n" );
+
+  if ( d_buf->size + n > d_buf->max )
+  {
+    PRINT_ERROR ( "dynBufferExtendSize() : The size can't exceed the reserved memory\n" );
+    n = d_buf->max - d_buf->size;
+  }
+  d_buf->size += n;
+}
+
+int dynBufferPushBackBuf ( DynBuffer *d_buf, const unsigned char *new_buf, size_t n )
+{
+  PRINT_VDEBUG ( "dynBufferPushBackBuf()\n" );
+
+  if (new_buf == NULL && n > 0) // If n == 0, the function accepts NULL as new_buf since nothing have to be appended
+  {
+    PRINT_ERROR ( "dynBufferPushBackBuf() : Invalid function argument values: new buffer content must be different from NULL and no shorter than 0\n" );
+    return -1;
+  }
+
+  if ( dynBufferReserve ( d_buf, n ) != 0 )
+    return -1;
+
   if(n>0)
   {
     memcpy ( ( void * ) ( d_buf->data + d_buf->size ), ( void * ) new_buf, n );
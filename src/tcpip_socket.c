@@ -407,19 +407,27 @@ void printTransmissionBuffer(const char *buffer, const char *msg_info, int msg_f
 
 TcpIpSocketState tcpIpSocketWriteBuffer ( TcpIpSocket *s, DynBuffer *d_buf )
 {
-  PRINT_VDEBUG ( "tcpIpSocketWriteBuffer()\n" );
+  size_t pos_offset = dynBufferGetPoseIndicatorOffset ( d_buf );
+  TcpIpSocketState state = tcpIpSocketWriteBufferEx ( s, d_buf, &pos_offset );
+  dynBufferSetPoseIndicator ( d_buf, pos_offset );
+  return state;
+}
 
-  const unsigned char *data = dynBufferGetCurrentData ( d_buf );
-  int data_size = dynBufferGetRemainingDataSize ( d_buf );
+TcpIpSocketState tcpIpSocketWriteBufferEx ( TcpIpSocket *s, DynBuffer *d_buf, size_t *pos_offset )
+{
+  PRINT_VDEBUG ( "tcpIpSocketWriteBufferEx()\n" );
+
+  const unsigned char *data = dynBufferGetData ( d_buf ) + *pos_offset;
+  int data_size = (int)( dynBufferGetSize ( d_buf ) - *pos_offset );
 
   if ( !s->connected )
   {
-    PRINT_ERROR ( "tcpIpSocketWriteBuffer() : Socket not connected\n" );
+    PRINT_ERROR ( "tcpIpSocketWriteBufferEx() : Socket not connected\n" );
     return TCPIPSOCKET_FAILED;
   }
 
   #if CROS_DEBUG_LEVEL >= 2
-  printTransmissionBuffer((const char *)data, "tcpIpSocketWriteBuffer() : Buffer", s->fd, data_size);
+  printTransmissionBuffer((const char *)data, "tcpIpSocketWriteBufferEx() : Buffer", s->fd, data_size);
   #endif
   while ( data_size > 0 )
   {
@@ -427,25 +435,25 @@ TcpIpSocketState tcpIpSocketWriteBuffer ( TcpIpSocket *s, DynBuffer *d_buf )
 
     if ( n_written > 0 )
     {
-      dynBufferMovePoseIndicator ( d_buf, n_written );
-      data = dynBufferGetCurrentData ( d_buf );
-      data_size = dynBufferGetRemainingDataSize ( d_buf );
+      *pos_offset += n_written;
+      data += n_written;
+      data_size -= n_written;
     }
     else if ( s->is_nonblocking &&
               ( errno == EWOULDBLOCK || errno == EINPROGRESS || errno == EAGAIN ) )
     {
-      PRINT_DEBUG ( "tcpIpSocketWriteBuffer() : write in progress, %d remaining bytes\n", data_size );
+      PRINT_DEBUG ( "tcpIpSocketWriteBufferEx() : write in progress, %d remaining bytes\n", data_size );
       return TCPIPSOCKET_IN_PROGRESS;
     }
     else if ( errno == ENOTCONN || errno == ECONNRESET )
     {
-      PRINT_DEBUG ( "tcpIpSocketWriteBuffer() : socket disconnected\n" );
+      PRINT_DEBUG ( "tcpIpSocketWriteBufferEx() : socket disconnected\n" );
       s->connected = 0;
       return  TCPIPSOCKET_DISCONNECTED;
     }
     else
     {
-      PRINT_ERROR ( "tcpIpSocketWriteBuffer() : Write failed. errno: %i\n" ,errno);
+      PRINT_ERROR ( "tcpIpSocketWriteBufferEx() : Write failed. errno: %i\n" ,errno);
       return TCPIPSOCKET_FAILED;
     }
   }
@@ -517,12 +525,13 @@ TcpIpSocketState tcpIpSocketReadBufferEx( TcpIpSocket *s, DynBuffer *d_buf, size
     return TCPIPSOCKET_FAILED;
   }
 
-  unsigned char *read_buf = (unsigned char *)malloc(max_size);
-  if (!read_buf)
+  // Receive directly at the end of the dynamic buffer: no intermediate buffer is needed
+  if (dynBufferReserve(d_buf, max_size) != 0)
   {
     PRINT_ERROR("tcpIpSocketReadBufferEx() : Out of memory while reading from socket");
     return TCPIPSOCKET_FAILED;
   }
+  unsigned char *read_buf = dynBufferGetTailData(d_buf);
 
   TcpIpSocketState state = TCPIPSOCKET_UNKNOWN;
   int reads = recv ( s->fd, read_buf, max_size, 0);
@@ -539,7 +548,7 @@ TcpIpSocketState tcpIpSocketReadBufferEx( TcpIpSocket *s, DynBuffer *d_buf, size
     printTransmissionBuffer((const char *)read_buf, "tcpIpSocketReadBufferEx() : Buffer", s->fd, reads);
     #endif
 
-    dynBufferPushBackBuf ( d_buf, read_buf, reads );
+    dynBufferExtendSize ( d_buf, reads );
     state = TCPIPSOCKET_DONE;
     *n_reads = reads;
   }
@@ -561,8 +570,6 @@ TcpIpSocketState tcpIpSocketReadBufferEx( TcpIpSocket *s, DynBuffer *d_buf, size
     state = TCPIPSOCKET_FAILED;
   }
 
-  free(read_buf);
-
   return state;
 }
 
@@ -14,16 +14,26 @@ void tcprosProcessInit( TcprosProcess *p )
   dynStringInit( &(p->serviceresponse_type) );
   dynStringInit( &(p->md5sum) );
   dynBufferInit( &(p->packet) );
+  p->frame = NULL;
+  p->frame_pos_offset = 0;
+  cRosRingBufferInit( &(p->out_frames), sizeof(TcprosFrame *), 1 );
   p->latching = p->tcp_nodelay = p->persistent = 0;
   p->last_change_time = 0;
-  p->wake_up_time_ms = 0;
+  p->wake_up_time = 0;
   p->topic_idx = -1;
   p->service_idx = -1;
+  p->io_shard = -1;
   p->ok_byte = 0;
   p->left_to_recv = 0;
+  p->decoder = NULL;
+  p->decoded_msg = NULL;
+  p->probe = 0;
   p->sub_tcpros_host = NULL;
   p->sub_tcpros_port = -1;
   p->send_msg_now = 0;
+  p->state_changes = 0;
+  cRosPollerEntryInit( &(p->poller_entry) );
+  p->timer_id = -1;
 }
 
 void tcprosProcessRelease( TcprosProcess *p )
@@ -39,12 +49,17 @@ void tcprosProcessRelease( TcprosProcess *p )
   dynStringRelease( &(p->serviceresponse_type) );
   dynStringRelease( &(p->md5sum) );
   dynBufferRelease( &(p->packet) );
+  tcprosProcessSetFrame( p, NULL );
+  tcprosProcessClearOutFrames( p );
+  cRosRingBufferRelease( &(p->out_frames) );
+  tcprosProcessSetDecoder( p, NULL, NULL );
   free(p->sub_tcpros_host);
 }
 
 void tcprosProcessClear( TcprosProcess *p , int fullreset)
 {
   dynBufferClear( &(p->packet) );
+  tcprosProcessSetFrame( p, NULL );
   p->left_to_recv = 0;
 
   if (fullreset)
@@ -60,19 +75,130 @@ void tcprosProcessClear( TcprosProcess *p , int fullreset)
     p->tcp_nodelay = 0;
     p->probe = 0;
     p->last_change_time = 0;
-    p->wake_up_time_ms = 0;
+    p->wake_up_time = 0;
     p->persistent = 0;
     p->topic_idx = -1;
     p->service_idx = -1;
     p->ok_byte = 0;
+    tcprosProcessClearOutFrames( p );
+    cRosRingBufferRelease( &(p->out_frames) );
+    tcprosProcessSetDecoder( p, NULL, NULL ); // The process can be used next for another topic
     free(p->sub_tcpros_host);
     p->sub_tcpros_host = NULL;
     p->sub_tcpros_port = -1;
   }
 }
 
+void tcprosProcessSetDecoder( TcprosProcess *p, cRosMessageDecoder *decoder, cRosMessage *decoded_msg )
+{
+  cRosMessageDecoderFree( p->decoder );
+  cRosMessageFree( p->decoded_msg );
+  p->decoder = decoder;
+  p->decoded_msg = decoded_msg;
+}
+
+cRosMessage *tcprosProcessTakeDecodedMessage( TcprosProcess *p )
+{
+  cRosMessage *msg = p->decoded_msg;
+  p->decoded_msg = NULL;
+  tcprosProcessSetDecoder( p, NULL, NULL );
+  return msg;
+}
+
+int tcprosProcessIsDecoding( const TcprosProcess *p )
+{
+  return p->decoder != NULL && cRosMessageDecoderIsBusy( p->decoder );
+}
+
+void tcprosProcessSetFrame( TcprosProcess *p, TcprosFrame *frame )
+{
+  tcprosFrameUnref( p->frame );
+  p->frame = frame;
+  p->frame_pos_offset = 0;
+}
+
+void tcprosProcessMoveStream( TcprosProcess *dst, TcprosProcess *src )
+{
+  dst->socket = src->socket;
+  tcpIpSocketInit( &(src->socket) ); // The descriptor now belongs to dst
+
+  cRosRingBufferRelease( &(dst->out_frames) );
+  dst->out_frames = src->out_frames;
+  cRosRingBufferInit( &(src->out_frames), sizeof(TcprosFrame *), src->out_frames.capacity );
+
+  tcprosProcessSetFrame( dst, src->frame );
+  dst->frame_pos_offset = src->frame_pos_offset;
+  src->frame = NULL;
+  src->frame_pos_offset = 0;
+}
+
+void tcprosProcessSetOutQueueLength( TcprosProcess *p, int max_frames )
+{
+  tcprosProcessClearOutFrames( p );
+  cRosRingBufferRelease( &(p->out_frames) );
+  cRosRingBufferInit( &(p->out_frames), sizeof(TcprosFrame *), ( max_frames > 0 )? (unsigned int)max_frames : 1 );
+}
+
+int tcprosProcessPushOutFrame( TcprosProcess *p, TcprosFrame *frame )
+{
+  TcprosFrame **slot;
+
+  if( cRosRingBufferVacancies( &(p->out_frames) ) == 0 )
+    return -1;
+
+  slot = ( TcprosFrame ** ) cRosRingBufferPushBack( &(p->out_frames) );
+  if( slot == NULL )
+    return -2;
+
+  *slot = tcprosFrameRef( frame );
+  return 0;
+}
+
+TcprosFrame *tcprosProcessPopOutFrame( TcprosProcess *p )
+{
+  TcprosFrame **slot = ( TcprosFrame ** ) cRosRingBufferPopFront( &(p->out_frames) );
+  return ( slot != NULL )? *slot : NULL;
+}
+
+void tcprosProcessClearOutFrames( TcprosProcess *p )
+{
+  while( cRosRingBufferUsage( &(p->out_frames) ) > 0 )
+    tcprosFrameUnref( tcprosProcessPopOutFrame( p ) );
+}
+
+TcprosFrame *tcprosFrameNew( void )
+{
+  TcprosFrame *frame = ( TcprosFrame * ) malloc( sizeof(TcprosFrame) );
+  if( frame == NULL )
+    return NULL;
+
+  dynBufferInit( &(frame->packet) );
+  frame->ref_count = 1;
+  frame->post_link.next = NULL;
+  frame->post_topic_idx = -1;
+  return frame;
+}
+
+TcprosFrame *tcprosFrameRef( TcprosFrame *frame )
+{
+  __atomic_add_fetch( &(frame->ref_count), 1, __ATOMIC_RELAXED );
+  return frame;
+}
+
+void tcprosFrameUnref( TcprosFrame *frame )
+{
+  // The last thread that drops a reference must see the writes of the others before freeing the frame
+  if( frame == NULL || __atomic_sub_fetch( &(frame->ref_count), 1, __ATOMIC_ACQ_REL ) > 0 )
+    return;
+
+  dynBufferRelease( &(frame->packet) );
+  free( frame );
+}
+
 void tcprosProcessChangeState( TcprosProcess *p, TcprosProcessState state )
 {
   p->state = state;
-  p->last_change_time = cRosClockGetTimeMs();
+  p->state_changes++;
+  p->last_change_time = cRosClockGetTimeNs();
+  cRosPollerEntryNotify( &(p->poller_entry) );
 }
@@ -15,9 +15,12 @@ void xmlrpcProcessInit( XmlrpcProcess *p )
   xmlrpcParamVectorInit( &(p->params) );
   xmlrpcParamVectorInit( &(p->response) );
   p->last_change_time = 0;
-  p->wake_up_time_ms = 0;
+  p->wake_up_time = 0;
   memset(p->host, 0, sizeof(p->host));
   p->port = -1;
+  p->state_changes = 0;
+  cRosPollerEntryInit( &(p->poller_entry) );
+  p->timer_id = -1;
 }
 
 void xmlrpcProcessRelease( XmlrpcProcess *p )
@@ -56,5 +59,7 @@ void xmlrpcProcessClear( XmlrpcProcess *p, int fullclear)
 void xmlrpcProcessChangeState( XmlrpcProcess *p, XmlrpcProcessState state )
 {
   p->state = state;
-  p->last_change_time = cRosClockGetTimeMs();
+  p->state_changes++;
+  p->last_change_time = cRosClockGetTimeNs();
+  cRosPollerEntryNotify( &(p->poller_entry) );
 }
\ No newline at end of file